@@ -14,15 +14,20 @@
 #include "namespaceAlias.h"
 
 #include "Iex.h"
+#include "IlmThreadPool.h"
 #include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <resizeImage.h>
 #include <string.h>
+#include <vector>
 
 using namespace IMF;
 using namespace std;
 using namespace IMATH;
+using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskGroup;
+using ILMTHREAD_NAMESPACE::ThreadPool;
 
 inline int
 toInt (float x)
@@ -36,6 +41,156 @@ sqr (double x)
     return x * x;
 }
 
+namespace
+{
+
+//
+// The directions and the colors of the pixels of the weighted
+// proxy image, in the order in which they are added up for each
+// pixel of the blurred image.
+//
+
+struct BlurInput
+{
+    BlurInput (const EnvmapImage& image);
+
+    vector<float> x;
+    vector<float> y;
+    vector<float> z;
+    vector<float> r;
+    vector<float> g;
+    vector<float> b;
+    vector<float> a;
+};
+
+BlurInput::BlurInput (const EnvmapImage& image)
+{
+    Box2i                dw     = image.dataWindow ();
+    int                  sof    = CubeMap::sizeOfFace (dw);
+    const Array2D<Rgba>& pixels = image.pixels ();
+
+    for (int f = CUBEFACE_POS_X; f <= CUBEFACE_NEG_Z; ++f)
+    {
+        CubeMapFace face = CubeMapFace (f);
+
+        for (int py = 0; py < sof; ++py)
+        {
+            for (int px = 0; px < sof; ++px)
+            {
+                V2f posInFace (px, py);
+
+                V3f dir = CubeMap::direction (face, dw, posInFace);
+                V2f pos = CubeMap::pixelPosition (face, dw, posInFace);
+
+                const Rgba& pixel = pixels[toInt (pos.y)][toInt (pos.x)];
+
+                x.push_back (dir.x);
+                y.push_back (dir.y);
+                z.push_back (dir.z);
+                r.push_back (pixel.r);
+                g.push_back (pixel.g);
+                b.push_back (pixel.b);
+                a.push_back (pixel.a);
+            }
+        }
+    }
+}
+
+//
+// Compute one scan line of one face of the blurred image. Each
+// input pixel is applied to the whole scan line before moving on
+// to the next one, so that the input is read only once per scan
+// line, and every output pixel still adds up the input pixels in
+// the same order.
+//
+
+class BlurTask : public Task
+{
+public:
+    BlurTask (
+        TaskGroup*       group,
+        const BlurInput& input,
+        EnvmapImage&     image,
+        CubeMapFace      face,
+        int              y)
+        : Task (group), _input (input), _image (image), _face (face), _y (y)
+    {}
+
+    virtual void execute ();
+
+private:
+    const BlurInput& _input;
+    EnvmapImage&     _image;
+    CubeMapFace      _face;
+    int              _y;
+};
+
+void
+BlurTask::execute ()
+{
+    Box2i dw  = _image.dataWindow ();
+    int   sof = CubeMap::sizeOfFace (dw);
+
+    vector<float>  x2 (sof);
+    vector<float>  y2 (sof);
+    vector<float>  z2 (sof);
+    vector<double> weightTotal (sof, 0.0);
+    vector<double> rTotal (sof, 0.0);
+    vector<double> gTotal (sof, 0.0);
+    vector<double> bTotal (sof, 0.0);
+    vector<double> aTotal (sof, 0.0);
+
+    for (int x = 0; x < sof; ++x)
+    {
+        V3f dir2 = CubeMap::direction (_face, dw, V2f (x, _y));
+
+        x2[x] = dir2.x;
+        y2[x] = dir2.y;
+        z2[x] = dir2.z;
+    }
+
+    size_t n = _input.x.size ();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        float  x1 = _input.x[i];
+        float  y1 = _input.y[i];
+        float  z1 = _input.z[i];
+        double r1 = _input.r[i];
+        double g1 = _input.g[i];
+        double b1 = _input.b[i];
+        double a1 = _input.a[i];
+
+        for (int x = 0; x < sof; ++x)
+        {
+            double weight = x1 * x2[x] + y1 * y2[x] + z1 * z2[x];
+
+            if (weight <= 0) continue;
+
+            weightTotal[x] += weight;
+            rTotal[x] += r1 * weight;
+            gTotal[x] += g1 * weight;
+            bTotal[x] += b1 * weight;
+            aTotal[x] += a1 * weight;
+        }
+    }
+
+    Array2D<Rgba>& pixels = _image.pixels ();
+
+    for (int x = 0; x < sof; ++x)
+    {
+        V2f   pos2   = CubeMap::pixelPosition (_face, dw, V2f (x, _y));
+        Rgba& pixel2 = pixels[toInt (pos2.y)][toInt (pos2.x)];
+
+        pixel2.r = rTotal[x] / weightTotal[x];
+        pixel2.g = gTotal[x] / weightTotal[x];
+        pixel2.b = bTotal[x] / weightTotal[x];
+        pixel2.a = aTotal[x] / weightTotal[x];
+    }
+}
+
+} // namespace
+
 void
 blurImage (EnvmapImage& image1, bool verbose)
 {
@@ -81,6 +236,10 @@ blurImage (EnvmapImage& image1, bool verbose)
     //           Multiply the input pixel's color by max (0, d1.dot(d2))
     //           and add the result to the output pixel.
     //
+    //   The directions d1 are computed only once, and the scan
+    //   lines of the output image are computed in parallel by
+    //   the global thread pool.
+    //
 
     const int MAX_IN_WIDTH = 40;
     const int OUT_WIDTH    = 100;
@@ -284,78 +443,28 @@ blurImage (EnvmapImage& image1, bool verbose)
     {
         if (verbose) cout << "    generating blurred image" << endl;
 
-        Box2i dw1  = iptr1->dataWindow ();
-        int   sof1 = CubeMap::sizeOfFace (dw1);
-
         Box2i dw2 (V2i (0, 0), V2i (OUT_WIDTH - 1, OUT_WIDTH * 6 - 1));
-        int   sof2 = CubeMap::sizeOfFace (dw2);
 
         iptr2->resize (ENVMAP_CUBE, dw2);
         iptr2->clear ();
 
-        Array2D<Rgba>& pixels1 = iptr1->pixels ();
-        Array2D<Rgba>& pixels2 = iptr2->pixels ();
+        BlurInput input (*iptr1);
 
-        for (int f2 = CUBEFACE_POS_X; f2 <= CUBEFACE_NEG_Z; ++f2)
-        {
-            if (verbose) cout << "        face " << f2 << endl;
+        //
+        // The destructor of the task group waits
+        // until all the scan lines are done.
+        //
 
-            CubeMapFace face2 = CubeMapFace (f2);
+        {
+            TaskGroup taskGroup;
+            int       sof2 = CubeMap::sizeOfFace (dw2);
 
-            for (int y2 = 0; y2 < sof2; ++y2)
+            for (int f2 = CUBEFACE_POS_X; f2 <= CUBEFACE_NEG_Z; ++f2)
             {
-                for (int x2 = 0; x2 < sof2; ++x2)
+                for (int y2 = 0; y2 < sof2; ++y2)
                 {
-                    V2f posInFace2 (x2, y2);
-
-                    V3f dir2 = CubeMap::direction (face2, dw2, posInFace2);
-
-                    V2f pos2 = CubeMap::pixelPosition (face2, dw2, posInFace2);
-
-                    double weightTotal = 0;
-                    double rTotal      = 0;
-                    double gTotal      = 0;
-                    double bTotal      = 0;
-                    double aTotal      = 0;
-
-                    Rgba& pixel2 = pixels2[toInt (pos2.y)][toInt (pos2.x)];
-
-                    for (int f1 = CUBEFACE_POS_X; f1 <= CUBEFACE_NEG_Z; ++f1)
-                    {
-                        CubeMapFace face1 = CubeMapFace (f1);
-
-                        for (int y1 = 0; y1 < sof1; ++y1)
-                        {
-                            for (int x1 = 0; x1 < sof1; ++x1)
-                            {
-                                V2f posInFace1 (x1, y1);
-
-                                V3f dir1 =
-                                    CubeMap::direction (face1, dw1, posInFace1);
-
-                                V2f pos1 = CubeMap::pixelPosition (
-                                    face1, dw1, posInFace1);
-
-                                double weight = dir1 ^ dir2;
-
-                                if (weight <= 0) continue;
-
-                                Rgba& pixel1 =
-                                    pixels1[toInt (pos1.y)][toInt (pos1.x)];
-
-                                weightTotal += weight;
-                                rTotal += pixel1.r * weight;
-                                gTotal += pixel1.g * weight;
-                                bTotal += pixel1.b * weight;
-                                aTotal += pixel1.a * weight;
-                            }
-                        }
-                    }
-
-                    pixel2.r = rTotal / weightTotal;
-                    pixel2.g = gTotal / weightTotal;
-                    pixel2.b = bTotal / weightTotal;
-                    pixel2.a = aTotal / weightTotal;
+                    ThreadPool::addGlobalTask (new BlurTask (
+                        &taskGroup, input, *iptr2, CubeMapFace (f2), y2));
                 }
             }
         }
@@ -10,9 +10,11 @@
 //-----------------------------------------------------------------------------
 
 #include <EnvmapImage.h>
+#include <IlmThreadPool.h>
 #include <ImfEnvmap.h>
 #include <ImfHeader.h>
 #include <ImfMisc.h>
+#include <ImfThreading.h>
 #include <OpenEXRConfig.h>
 
 #include <blurImage.h>
@@ -128,6 +130,10 @@ usageMessage (ostream& stream, const char* program_name, bool verbose = false)
             << ",\n"
                "                default is zip)\n"
                "\n"
+               "  -j n          resamples and blurs the image using n\n"
+               "                threads (default is one thread per\n"
+               "                processor)\n"
+               "\n"
                "  -v            verbose mode\n"
                "\n"
                "  -h, --help    print this message\n"
@@ -175,6 +181,8 @@ main (int argc, char** argv)
     int               numSamples        = 5;
     bool              diffuseBlur       = false;
     bool              verbose           = false;
+    int               numThreads =
+        ILMTHREAD_NAMESPACE::ThreadPool::estimateThreadCountForFileIO ();
 
     //
     // Parse the command line.
@@ -363,6 +371,24 @@ main (int argc, char** argv)
                 compression = getCompression (argv[i + 1]);
                 i += 2;
             }
+            else if (!strcmp (argv[i], "-j"))
+            {
+                //
+                // Set number of threads
+                //
+
+                if (i > argc - 2)
+                    throw invalid_argument (
+                        "Missing number of threads with -j option");
+
+                numThreads = strtol (argv[i + 1], 0, 0);
+
+                if (numThreads < 0)
+                    throw invalid_argument (
+                        "Number of threads must not be less than zero");
+
+                i += 2;
+            }
             else if (!strcmp (argv[i], "-v"))
             {
                 //
@@ -419,6 +445,8 @@ main (int argc, char** argv)
         // Load inFile, convert it, and save the result in outFile.
         //
 
+        setGlobalThreadCount (numThreads);
+
         EnvmapImage  image;
         Header       header;
         RgbaChannels channels;
@@ -14,12 +14,94 @@
 #include <resizeImage.h>
 
 #include "Iex.h"
+#include "IlmThreadPool.h"
 #include <string.h>
 
 #include "namespaceAlias.h"
 using namespace IMF;
 using namespace std;
 using namespace IMATH;
+using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskGroup;
+using ILMTHREAD_NAMESPACE::ThreadPool;
+
+namespace
+{
+
+//
+// Resample one scan line of an environment map, or for cube-face
+// maps, one scan line of one face. The scan lines are independent
+// of each other and are computed in parallel by the global thread
+// pool.
+//
+
+class ResizeTask : public Task
+{
+public:
+    ResizeTask (
+        TaskGroup*         group,
+        const EnvmapImage& image1,
+        EnvmapImage&       image2,
+        float              radius,
+        int                numSamples,
+        CubeMapFace        face,
+        int                y)
+        : Task (group)
+        , _image1 (image1)
+        , _image2 (image2)
+        , _radius (radius)
+        , _numSamples (numSamples)
+        , _face (face)
+        , _y (y)
+    {}
+
+    virtual void execute ();
+
+private:
+    const EnvmapImage& _image1;
+    EnvmapImage&       _image2;
+    float              _radius;
+    int                _numSamples;
+    CubeMapFace        _face;
+    int                _y;
+};
+
+void
+ResizeTask::execute ()
+{
+    const Box2i&   dw     = _image2.dataWindow ();
+    Array2D<Rgba>& pixels = _image2.pixels ();
+
+    if (_image2.type () == ENVMAP_LATLONG)
+    {
+        int w = dw.max.x - dw.min.x + 1;
+
+        for (int x = 0; x < w; ++x)
+        {
+            V3f dir = LatLongMap::direction (dw, V2f (x, _y));
+
+            pixels[_y][x] =
+                _image1.filteredLookup (dir, _radius, _numSamples);
+        }
+    }
+    else
+    {
+        int sof = CubeMap::sizeOfFace (dw);
+
+        for (int x = 0; x < sof; ++x)
+        {
+            V2f posInFace (x, _y);
+
+            V3f dir = CubeMap::direction (_face, dw, posInFace);
+            V2f pos = CubeMap::pixelPosition (_face, dw, posInFace);
+
+            pixels[int (pos.y + 0.5f)][int (pos.x + 0.5f)] =
+                _image1.filteredLookup (dir, _radius, _numSamples);
+        }
+    }
+}
+
+} // namespace
 
 void
 resizeLatLong (
@@ -36,15 +118,23 @@ resizeLatLong (
     image2.resize (ENVMAP_LATLONG, image2DataWindow);
     image2.clear ();
 
-    Array2D<Rgba>& pixels = image2.pixels ();
+    //
+    // The destructor of the task group waits
+    // until all the scan lines are done.
+    //
+
+    TaskGroup taskGroup;
 
     for (int y = 0; y < h; ++y)
     {
-        for (int x = 0; x < w; ++x)
-        {
-            V3f dir      = LatLongMap::direction (image2DataWindow, V2f (x, y));
-            pixels[y][x] = image1.filteredLookup (dir, radius, numSamples);
-        }
+        ThreadPool::addGlobalTask (new ResizeTask (
+            &taskGroup,
+            image1,
+            image2,
+            radius,
+            numSamples,
+            CUBEFACE_POS_X,
+            y));
     }
 }
 
@@ -88,27 +178,20 @@ resizeCube (
     image2.resize (ENVMAP_CUBE, image2DataWindow);
     image2.clear ();
 
-    Array2D<Rgba>& pixels = image2.pixels ();
+    TaskGroup taskGroup;
 
     for (int f = CUBEFACE_POS_X; f <= CUBEFACE_NEG_Z; ++f)
     {
-        CubeMapFace face = CubeMapFace (f);
-
         for (int y = 0; y < sof; ++y)
         {
-            for (int x = 0; x < sof; ++x)
-            {
-                V2f posInFace (x, y);
-
-                V3f dir =
-                    CubeMap::direction (face, image2DataWindow, posInFace);
-
-                V2f pos =
-                    CubeMap::pixelPosition (face, image2DataWindow, posInFace);
-
-                pixels[int (pos.y + 0.5f)][int (pos.x + 0.5f)] =
-                    image1.filteredLookup (dir, radius, numSamples);
-            }
+            ThreadPool::addGlobalTask (new ResizeTask (
+                &taskGroup,
+                image1,
+                image2,
+                radius,
+                numSamples,
+                CubeMapFace (f),
+                y));
         }
     }
 }
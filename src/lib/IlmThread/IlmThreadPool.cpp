@@ -5,7 +5,8 @@
 
 //-----------------------------------------------------------------------------
 //
-//  class Task, class ThreadPool, class TaskGroup
+//  class Task, class ThreadPool, class TaskGroup,
+//  class WorkStealingThreadPoolProvider
 //
 //-----------------------------------------------------------------------------
 
@@ -14,7 +15,10 @@
 #include "IlmThread.h"
 #include "IlmThreadSemaphore.h"
 
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <limits>
 #include <memory>
 #include <mutex>
@@ -327,6 +331,286 @@ DefaultThreadPoolProvider::threadLoop (
 
 } //namespace
 
+//
+// struct WorkStealingThreadPoolProvider::Data
+//
+
+namespace
+{
+
+struct WorkStealingQueue
+{
+    std::mutex        mutex;
+    std::deque<Task*> tasks;
+    char _pad[64]; // keep the locks of the queues off each others cache line
+};
+
+} // namespace
+
+struct WorkStealingThreadPoolProvider::Data
+{
+    Data ();
+    ~Data ()                      = default;
+    Data (const Data&)            = delete;
+    Data& operator= (const Data&) = delete;
+    Data (Data&&)                 = delete;
+    Data& operator= (Data&&)      = delete;
+
+    void  push (Task* task, size_t queue);
+    Task* pop (size_t first);
+    bool  stealOrSleep (size_t index, Task*& task);
+    void  threadLoop (size_t index);
+    void  lockedFinish ();
+
+    // the queues are never reallocated, so adding tasks needs no
+    // lock other than the one of the queue the task goes to. With
+    // more threads than queues some threads share their queue
+    std::vector<std::unique_ptr<WorkStealingQueue>> _queues;
+
+    std::mutex               _threadMutex; // mutual exclusion for threads list
+    std::vector<std::thread> _threads;     // the list of all threads
+
+    std::mutex              _sleepMutex; // idle threads wait on _wake
+    std::condition_variable _wake;
+
+    std::atomic<int>      _pending;  // tasks added but not yet taken
+    std::atomic<int>      _sleepers; // threads waiting on _wake
+    std::atomic<int>      _threadCount;
+    std::atomic<unsigned> _nextQueue;
+    std::atomic<bool>     _stopping;
+};
+
+namespace
+{
+
+// the provider and queue index of the worker running on this thread
+thread_local WorkStealingThreadPoolProvider::Data* tlsWorkerPool  = nullptr;
+thread_local size_t                                tlsWorkerQueue = 0;
+
+} // namespace
+
+WorkStealingThreadPoolProvider::Data::Data ()
+    : _pending (0)
+    , _sleepers (0)
+    , _threadCount (0)
+    , _nextQueue (0)
+    , _stopping (false)
+{
+    unsigned nq = std::thread::hardware_concurrency ();
+    if (nq == 0) nq = 1;
+    _queues.resize (nq);
+    for (auto& q: _queues)
+        q.reset (new WorkStealingQueue);
+}
+
+void
+WorkStealingThreadPoolProvider::Data::push (Task* task, size_t queue)
+{
+    // the task has been counted in _pending by the caller
+    {
+        WorkStealingQueue&          q = *_queues[queue];
+        std::lock_guard<std::mutex> lock (q.mutex);
+        q.tasks.push_back (task);
+    }
+
+    if (_sleepers.load () > 0)
+    {
+        // taking the lock orders this against a thread about to
+        // wait, so the notification cannot get lost
+        std::lock_guard<std::mutex> lock (_sleepMutex);
+        _wake.notify_one ();
+    }
+}
+
+Task*
+WorkStealingThreadPoolProvider::Data::pop (size_t first)
+{
+    // own queue first, then go round the others
+    size_t nq = _queues.size ();
+    for (size_t i = 0; i < nq; ++i)
+    {
+        WorkStealingQueue& q = *_queues[(first + i) % nq];
+
+        std::unique_lock<std::mutex> lock (q.mutex, std::try_to_lock);
+        // only block on the own queue, a busy one elsewhere is
+        // likely being emptied by someone else already
+        if (!lock.owns_lock ())
+        {
+            if (i != 0) continue;
+            lock.lock ();
+        }
+        if (!q.tasks.empty ())
+        {
+            Task* t = q.tasks.front ();
+            q.tasks.pop_front ();
+            lock.unlock ();
+            _pending.fetch_sub (1);
+            return t;
+        }
+    }
+    return nullptr;
+}
+
+//
+// Returns true with a task taken off one of the queues, or false once
+// the provider is stopping and every task added has been run.
+//
+bool
+WorkStealingThreadPoolProvider::Data::stealOrSleep (size_t index, Task*& task)
+{
+    while (true)
+    {
+        // a few more passes before going to sleep, a task is likely
+        // to turn up shortly while a file is being read
+        for (int spin = 0; spin < 16; ++spin)
+        {
+            if (_pending.load () == 0) break;
+            task = pop (index);
+            if (task) return true;
+            std::this_thread::yield ();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock (_sleepMutex);
+            _sleepers.fetch_add (1);
+            _wake.wait (lock, [this] {
+                return _pending.load () > 0 || _stopping.load ();
+            });
+            _sleepers.fetch_sub (1);
+
+            // only leave once everything added before the stop has
+            // been run
+            if (_stopping.load () && _pending.load () == 0) return false;
+        }
+
+        // the task that woke us may already have been taken by
+        // another thread, or not be in its queue yet, in which case
+        // go round again rather than report success without one
+        task = pop (index);
+        if (task) return true;
+    }
+}
+
+void
+WorkStealingThreadPoolProvider::Data::threadLoop (size_t index)
+{
+    tlsWorkerPool  = this;
+    tlsWorkerQueue = index;
+
+    while (true)
+    {
+        Task* task = pop (index);
+        if (!task && !stealOrSleep (index, task)) break;
+        handleProcessTask (task);
+    }
+
+    tlsWorkerPool = nullptr;
+}
+
+void
+WorkStealingThreadPoolProvider::Data::lockedFinish ()
+{
+    {
+        std::lock_guard<std::mutex> lock (_sleepMutex);
+        _stopping = true;
+        _wake.notify_all ();
+    }
+
+    for (auto& t: _threads)
+        t.join ();
+    _threads.clear ();
+
+    _threadCount = 0;
+    _stopping    = false;
+}
+
+//
+// class WorkStealingThreadPoolProvider
+//
+
+WorkStealingThreadPoolProvider::WorkStealingThreadPoolProvider (int count)
+    : _data (new Data)
+{
+    setNumThreads (count);
+}
+
+WorkStealingThreadPoolProvider::~WorkStealingThreadPoolProvider ()
+{
+    finish ();
+    delete _data;
+}
+
+int
+WorkStealingThreadPoolProvider::numThreads () const
+{
+    return _data->_threadCount.load ();
+}
+
+void
+WorkStealingThreadPoolProvider::setNumThreads (int count)
+{
+    std::lock_guard<std::mutex> lock (_data->_threadMutex);
+
+    size_t curThreads = _data->_threads.size ();
+    size_t nToAdd     = static_cast<size_t> (count < 0 ? 0 : count);
+
+    if (nToAdd < curThreads)
+    {
+        // as with the default provider, restart rather than
+        // trying to pick which threads to stop
+        _data->lockedFinish ();
+        curThreads = 0;
+    }
+
+    size_t nq = _data->_queues.size ();
+    for (size_t i = curThreads; i < nToAdd; ++i)
+    {
+        _data->_threads.emplace_back (
+            &WorkStealingThreadPoolProvider::Data::threadLoop,
+            _data,
+            i % nq);
+    }
+    _data->_threadCount = static_cast<int> (_data->_threads.size ());
+}
+
+void
+WorkStealingThreadPoolProvider::addTask (Task* task)
+{
+    Data* d = _data;
+
+    // count the task before looking at whether we are stopping:
+    // threads only exit once the count is back to zero, so the
+    // task either reaches a live thread or is run right here
+    d->_pending.fetch_add (1);
+
+    if (tlsWorkerPool == d)
+    {
+        // work spawned by a task stays with the thread running it
+        d->push (task, tlsWorkerQueue);
+        return;
+    }
+
+    int nt = d->_threadCount.load ();
+    if (nt <= 0 || d->_stopping.load ())
+    {
+        d->_pending.fetch_sub (1);
+        handleProcessTask (task);
+        return;
+    }
+
+    size_t nq    = d->_queues.size ();
+    size_t nused = std::min (static_cast<size_t> (nt), nq);
+    d->push (task, d->_nextQueue.fetch_add (1) % nused);
+}
+
+void
+WorkStealingThreadPoolProvider::finish ()
+{
+    std::lock_guard<std::mutex> lock (_data->_threadMutex);
+
+    _data->lockedFinish ();
+}
+
 //
 // struct TaskGroup::Data
 //
@@ -407,6 +691,46 @@ ThreadPool::Data::~Data ()
     setProvider (nullptr);
 }
 
+#else
+
+//
+// without threads the work-stealing provider runs tasks as they come
+//
+
+struct WorkStealingThreadPoolProvider::Data
+{};
+
+WorkStealingThreadPoolProvider::WorkStealingThreadPoolProvider (int count)
+    : _data (nullptr)
+{
+    (void) count;
+}
+
+WorkStealingThreadPoolProvider::~WorkStealingThreadPoolProvider ()
+{}
+
+int
+WorkStealingThreadPoolProvider::numThreads () const
+{
+    return 0;
+}
+
+void
+WorkStealingThreadPoolProvider::setNumThreads (int count)
+{
+    (void) count;
+}
+
+void
+WorkStealingThreadPoolProvider::addTask (Task* task)
+{
+    handleProcessTask (task);
+}
+
+void
+WorkStealingThreadPoolProvider::finish ()
+{}
+
 #endif // ENABLE_THREADING
 
 //
@@ -29,6 +29,10 @@
 //	operator new for your tasks, for instance to use a custom heap,
 //	then you must also write an appropriate operator delete.
 //
+//	Class WorkStealingThreadPoolProvider is an alternative to the
+//	default provider for machines with many cores, which can be
+//	installed with ThreadPool::setThreadProvider().
+//
 //-----------------------------------------------------------------------------
 
 #include "IlmThreadConfig.h"
@@ -70,6 +74,38 @@ public:
     ThreadPoolProvider& operator= (ThreadPoolProvider&&)      = delete;
 };
 
+//-------------------------------------------------------
+// WorkStealingThreadPoolProvider -- a provider where every
+// worker thread has its own task queue. Tasks are spread
+// over the queues, and a worker whose queue runs dry takes
+// tasks from the queues of the others, so there is no one
+// lock all threads contend on. Tasks added from within a
+// worker go to the queue of that worker.
+//
+// To use it:
+//
+//   ThreadPool::globalThreadPool ().setThreadProvider (
+//       new WorkStealingThreadPoolProvider (n));
+//-------------------------------------------------------
+class ILMTHREAD_EXPORT_TYPE WorkStealingThreadPoolProvider
+    : public ThreadPoolProvider
+{
+public:
+    ILMTHREAD_EXPORT WorkStealingThreadPoolProvider (int count);
+    ILMTHREAD_EXPORT ~WorkStealingThreadPoolProvider () override;
+
+    ILMTHREAD_EXPORT int  numThreads () const override;
+    ILMTHREAD_EXPORT void setNumThreads (int count) override;
+    ILMTHREAD_EXPORT void addTask (Task* task) override;
+
+    ILMTHREAD_EXPORT void finish () override;
+
+    struct ILMTHREAD_HIDDEN Data;
+
+private:
+    Data* _data;
+};
+
 class ILMTHREAD_EXPORT_TYPE ThreadPool
 {
 public:
@@ -73,6 +73,7 @@
 #include "ImfHeader.h"
 #include "ImfMisc.h"
 #include "ImfNamespace.h"
+#include "ImfSimd.h"
 #include <Iex.h>
 #include <ImathBox.h>
 #include <ImathFun.h>
@@ -137,6 +138,374 @@ shiftAndRound (int x, int shift)
     return (x + a + b) >> shift;
 }
 
+//
+// Vector versions of the inner parts of pack() and unpack14().
+//
+// After the first 2 bytes, the 6 bit fields of a packed block are in
+// column order, each column of the block taking 3 bytes, 4 fields,
+// one for each row: the shift and r[0] ... r[2] for column 0, which
+// is built down from the first pixel, then for the other columns the
+// running differences along each row. So with the 3 bytes of each
+// column in a lane of a vector, a row's fields can be shifted in to
+// place (or out) all at once.
+//
+
+#if defined(IMF_HAVE_SSE2)
+
+//
+// The sign magnitude to ordered mapping, as described in pack().
+//
+inline __m128i
+toOrdered_sse2 (__m128i s)
+{
+    const __m128i sign = _mm_set1_epi16 ((short) 0x8000);
+    const __m128i expm = _mm_set1_epi16 (0x7c00);
+    __m128i       neg  = _mm_srai_epi16 (s, 15);
+    __m128i       nan  = _mm_cmpeq_epi16 (_mm_and_si128 (s, expm), expm);
+    __m128i       t    = _mm_xor_si128 (s, _mm_or_si128 (neg, sign));
+
+    return _mm_or_si128 (_mm_andnot_si128 (nan, t), _mm_and_si128 (nan, sign));
+}
+
+//
+// And back again, as at the end of unpack14().
+//
+inline __m128i
+fromOrdered_sse2 (__m128i t)
+{
+    const __m128i sign = _mm_set1_epi16 ((short) 0x8000);
+    __m128i       pos  = _mm_srai_epi16 (t, 15);
+
+    return _mm_xor_si128 (
+        t, _mm_or_si128 (_mm_andnot_si128 (pos, _mm_set1_epi16 (-1)), sign));
+}
+
+inline bool
+isZero_sse2 (__m128i v)
+{
+    return _mm_movemask_epi8 (_mm_cmpeq_epi32 (v, _mm_setzero_si128 ())) ==
+           0xffff;
+}
+
+//
+// Map s to t, find tMax, and the smallest shift for which the
+// running differences fit in 6 bits. Those are returned as the
+// columns of fields (with the shift field left 0), along with t[0],
+// d[0], and whether all the differences are 0.
+//
+inline int
+findShift (
+    const unsigned short s[16],
+    unsigned short&      t0,
+    unsigned short&      tMax,
+    int&                 d0,
+    unsigned int         cols[4],
+    bool&                flat)
+{
+    const __m128i sign  = _mm_set1_epi16 ((short) 0x8000);
+    const __m128i zero  = _mm_setzero_si128 ();
+    const __m128i one   = _mm_set1_epi32 (1);
+    const __m128i first = _mm_set_epi32 (0, 0, 0, -1);
+    const __m128i bias  = _mm_set1_epi32 (0x20);
+    __m128i       lo = toOrdered_sse2 (_mm_loadu_si128 ((const __m128i*) s));
+    __m128i hi = toOrdered_sse2 (_mm_loadu_si128 ((const __m128i*) (s + 8)));
+    __m128i m, x[4], d[4], r[4], any, all;
+    int     shift = -1;
+
+    // an unsigned max, from the signed one
+    m = _mm_max_epi16 (_mm_xor_si128 (lo, sign), _mm_xor_si128 (hi, sign));
+    m = _mm_max_epi16 (m, _mm_srli_si128 (m, 8));
+    m = _mm_max_epi16 (m, _mm_srli_si128 (m, 4));
+    m = _mm_max_epi16 (m, _mm_srli_si128 (m, 2));
+    tMax = (unsigned short) (_mm_cvtsi128_si32 (m) ^ 0x8000);
+    t0   = (unsigned short) _mm_cvtsi128_si32 (lo);
+
+    // a row per vector, shiftAndRound() starts from twice the value
+    m    = _mm_set1_epi32 (tMax);
+    x[0] = _mm_slli_epi32 (_mm_sub_epi32 (m, _mm_unpacklo_epi16 (lo, zero)), 1);
+    x[1] = _mm_slli_epi32 (_mm_sub_epi32 (m, _mm_unpackhi_epi16 (lo, zero)), 1);
+    x[2] = _mm_slli_epi32 (_mm_sub_epi32 (m, _mm_unpacklo_epi16 (hi, zero)), 1);
+    x[3] = _mm_slli_epi32 (_mm_sub_epi32 (m, _mm_unpackhi_epi16 (hi, zero)), 1);
+
+    do
+    {
+        __m128i a, cnt;
+
+        shift += 1;
+        a   = _mm_set1_epi32 ((1 << shift) - 1);
+        cnt = _mm_cvtsi32_si128 (shift + 1);
+        any = zero;
+        all = zero;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            d[i] = _mm_srl_epi32 (
+                _mm_add_epi32 (
+                    _mm_add_epi32 (x[i], a),
+                    _mm_and_si128 (_mm_srl_epi32 (x[i], cnt), one)),
+                cnt);
+
+            // the fields of row i: the differences along it, after
+            // the one down column 0
+            r[i] = _mm_slli_si128 (
+                _mm_sub_epi32 (d[i], _mm_srli_si128 (d[i], 4)), 4);
+            if (i > 0)
+            {
+                r[i] = _mm_or_si128 (
+                    r[i], _mm_and_si128 (_mm_sub_epi32 (d[i - 1], d[i]), first));
+                any  = _mm_or_si128 (any, r[i]);
+                r[i] = _mm_add_epi32 (r[i], bias);
+            }
+            else
+            {
+                any  = r[i];
+                r[i] = _mm_add_epi32 (r[i], _mm_andnot_si128 (first, bias));
+            }
+            all = _mm_or_si128 (all, r[i]);
+        }
+    } while (!isZero_sse2 (_mm_and_si128 (all, _mm_set1_epi32 (~0x3f))));
+
+    d0   = _mm_cvtsi128_si32 (d[0]);
+    flat = isZero_sse2 (any);
+
+    m = _mm_or_si128 (
+        _mm_or_si128 (_mm_slli_epi32 (r[0], 18), _mm_slli_epi32 (r[1], 12)),
+        _mm_or_si128 (_mm_slli_epi32 (r[2], 6), r[3]));
+    _mm_storeu_si128 ((__m128i*) cols, m);
+
+    return shift;
+}
+
+//
+// Build the 16 pixels of a block from the columns of fields, the
+// first column of pixels c, the shift and bias.
+//
+inline void
+unpackRows (
+    const unsigned int   cols[4],
+    const unsigned short c[4],
+    int                  shift,
+    unsigned short       bias,
+    unsigned short       s[16])
+{
+    const __m128i m6  = _mm_set1_epi32 (0x3f);
+    __m128i       g   = _mm_loadu_si128 ((const __m128i*) cols);
+    __m128i       cnt = _mm_cvtsi32_si128 (shift);
+    __m128i       bv  = _mm_set1_epi16 ((short) bias);
+    __m128i       r01, r23;
+
+    // rows 0 and 1 in one vector, 2 and 3 in the other
+    r01 = _mm_packs_epi32 (
+        _mm_srli_epi32 (g, 18), _mm_and_si128 (_mm_srli_epi32 (g, 12), m6));
+    r23 = _mm_packs_epi32 (
+        _mm_and_si128 (_mm_srli_epi32 (g, 6), m6), _mm_and_si128 (g, m6));
+    r01 = _mm_sub_epi16 (_mm_sll_epi16 (r01, cnt), bv);
+    r23 = _mm_sub_epi16 (_mm_sll_epi16 (r23, cnt), bv);
+
+    // then the first column, and the running sums along the rows
+    r01 = _mm_insert_epi16 (_mm_insert_epi16 (r01, c[0], 0), c[1], 4);
+    r23 = _mm_insert_epi16 (_mm_insert_epi16 (r23, c[2], 0), c[3], 4);
+    r01 = _mm_add_epi16 (r01, _mm_slli_epi64 (r01, 16));
+    r23 = _mm_add_epi16 (r23, _mm_slli_epi64 (r23, 16));
+    r01 = _mm_add_epi16 (r01, _mm_slli_epi64 (r01, 32));
+    r23 = _mm_add_epi16 (r23, _mm_slli_epi64 (r23, 32));
+
+    _mm_storeu_si128 ((__m128i*) s, fromOrdered_sse2 (r01));
+    _mm_storeu_si128 ((__m128i*) (s + 8), fromOrdered_sse2 (r23));
+}
+
+#elif defined(IMF_HAVE_NEON_AARCH64)
+
+inline uint16x8_t
+toOrdered_neon (uint16x8_t s)
+{
+    const uint16x8_t sign = vdupq_n_u16 (0x8000);
+    const uint16x8_t expm = vdupq_n_u16 (0x7c00);
+    uint16x8_t       neg =
+        vreinterpretq_u16_s16 (vshrq_n_s16 (vreinterpretq_s16_u16 (s), 15));
+    uint16x8_t nan = vceqq_u16 (vandq_u16 (s, expm), expm);
+
+    return vbslq_u16 (nan, sign, veorq_u16 (s, vorrq_u16 (neg, sign)));
+}
+
+inline uint16x8_t
+fromOrdered_neon (uint16x8_t t)
+{
+    uint16x8_t pos =
+        vreinterpretq_u16_s16 (vshrq_n_s16 (vreinterpretq_s16_u16 (t), 15));
+
+    return veorq_u16 (t, vorrq_u16 (vmvnq_u16 (pos), vdupq_n_u16 (0x8000)));
+}
+
+inline int
+findShift (
+    const unsigned short s[16],
+    unsigned short&      t0,
+    unsigned short&      tMax,
+    int&                 d0,
+    unsigned int         cols[4],
+    bool&                flat)
+{
+    const unsigned int rowBias[4] = {0, 0x20, 0x20, 0x20};
+    const uint32x4_t zero       = vdupq_n_u32 (0);
+    const uint32x4_t one        = vdupq_n_u32 (1);
+    const uint32x4_t bias       = vdupq_n_u32 (0x20);
+    uint16x8_t       lo         = toOrdered_neon (vld1q_u16 (s));
+    uint16x8_t       hi         = toOrdered_neon (vld1q_u16 (s + 8));
+    uint32x4_t       m, x[4], d[4], r[4], any, all;
+    int              shift = -1;
+
+    tMax = vmaxvq_u16 (vmaxq_u16 (lo, hi));
+    t0   = vgetq_lane_u16 (lo, 0);
+
+    m    = vdupq_n_u32 (tMax);
+    x[0] = vshlq_n_u32 (vsubq_u32 (m, vmovl_u16 (vget_low_u16 (lo))), 1);
+    x[1] = vshlq_n_u32 (vsubq_u32 (m, vmovl_u16 (vget_high_u16 (lo))), 1);
+    x[2] = vshlq_n_u32 (vsubq_u32 (m, vmovl_u16 (vget_low_u16 (hi))), 1);
+    x[3] = vshlq_n_u32 (vsubq_u32 (m, vmovl_u16 (vget_high_u16 (hi))), 1);
+
+    do
+    {
+        uint32x4_t a;
+        int32x4_t  cnt;
+
+        shift += 1;
+        a   = vdupq_n_u32 ((1u << shift) - 1);
+        cnt = vdupq_n_s32 (-(shift + 1));
+        any = zero;
+        all = zero;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            d[i] = vshlq_u32 (
+                vaddq_u32 (
+                    vaddq_u32 (x[i], a),
+                    vandq_u32 (vshlq_u32 (x[i], cnt), one)),
+                cnt);
+
+            r[i] = vextq_u32 (
+                zero, vsubq_u32 (d[i], vextq_u32 (d[i], zero, 1)), 3);
+            if (i > 0)
+            {
+                r[i] = vsetq_lane_u32 (
+                    vgetq_lane_u32 (d[i - 1], 0) - vgetq_lane_u32 (d[i], 0),
+                    r[i],
+                    0);
+                any  = vorrq_u32 (any, r[i]);
+                r[i] = vaddq_u32 (r[i], bias);
+            }
+            else
+            {
+                any  = r[i];
+                r[i] = vaddq_u32 (r[i], vld1q_u32 (rowBias));
+            }
+            all = vorrq_u32 (all, r[i]);
+        }
+    } while (vmaxvq_u32 (vandq_u32 (all, vdupq_n_u32 (~0x3fu))) != 0);
+
+    d0   = (int) vgetq_lane_u32 (d[0], 0);
+    flat = vmaxvq_u32 (any) == 0;
+
+    m = vorrq_u32 (
+        vorrq_u32 (vshlq_n_u32 (r[0], 18), vshlq_n_u32 (r[1], 12)),
+        vorrq_u32 (vshlq_n_u32 (r[2], 6), r[3]));
+    vst1q_u32 (cols, m);
+
+    return shift;
+}
+
+inline void
+unpackRows (
+    const unsigned int   cols[4],
+    const unsigned short c[4],
+    int                  shift,
+    unsigned short       bias,
+    unsigned short       s[16])
+{
+    const uint32x4_t m6  = vdupq_n_u32 (0x3f);
+    uint32x4_t       g   = vld1q_u32 (cols);
+    int16x8_t        cnt = vdupq_n_s16 ((int16_t) shift);
+    uint16x8_t       r01, r23;
+
+    r01 = vcombine_u16 (
+        vmovn_u32 (vshrq_n_u32 (g, 18)),
+        vmovn_u32 (vandq_u32 (vshrq_n_u32 (g, 12), m6)));
+    r23 = vcombine_u16 (
+        vmovn_u32 (vandq_u32 (vshrq_n_u32 (g, 6), m6)),
+        vmovn_u32 (vandq_u32 (g, m6)));
+    r01 = vsubq_u16 (vshlq_u16 (r01, cnt), vdupq_n_u16 (bias));
+    r23 = vsubq_u16 (vshlq_u16 (r23, cnt), vdupq_n_u16 (bias));
+
+    r01 = vsetq_lane_u16 (c[1], vsetq_lane_u16 (c[0], r01, 0), 4);
+    r23 = vsetq_lane_u16 (c[3], vsetq_lane_u16 (c[2], r23, 0), 4);
+    r01 = vaddq_u16 (
+        r01,
+        vreinterpretq_u16_u64 (vshlq_n_u64 (vreinterpretq_u64_u16 (r01), 16)));
+    r23 = vaddq_u16 (
+        r23,
+        vreinterpretq_u16_u64 (vshlq_n_u64 (vreinterpretq_u64_u16 (r23), 16)));
+    r01 = vaddq_u16 (
+        r01,
+        vreinterpretq_u16_u64 (vshlq_n_u64 (vreinterpretq_u64_u16 (r01), 32)));
+    r23 = vaddq_u16 (
+        r23,
+        vreinterpretq_u16_u64 (vshlq_n_u64 (vreinterpretq_u64_u16 (r23), 32)));
+
+    vst1q_u16 (s, fromOrdered_neon (r01));
+    vst1q_u16 (s + 8, fromOrdered_neon (r23));
+}
+
+#endif
+
+#if defined(IMF_HAVE_SSE2) || defined(IMF_HAVE_NEON_AARCH64)
+
+int
+pack (
+    const unsigned short s[16],
+    unsigned char        b[14],
+    bool                 optFlatFields,
+    bool                 exactMax)
+{
+    //
+    // Pack a block of 4 by 4 16-bit pixels (32 bytes) into
+    // either 14 or 3 bytes, as below.
+    //
+
+    unsigned short t0, tMax;
+    unsigned int   cols[4];
+    int            d0;
+    bool           flat;
+
+    int shift = findShift (s, t0, tMax, d0, cols, flat);
+
+    if (flat && optFlatFields)
+    {
+        b[0] = (t0 >> 8);
+        b[1] = (unsigned char) t0;
+        b[2] = 0xfc;
+
+        return 3;
+    }
+
+    if (exactMax) t0 = tMax - (d0 << shift);
+
+    cols[0] |= shift << 18;
+
+    b[0] = (t0 >> 8);
+    b[1] = (unsigned char) t0;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        b[3 * i + 2] = (unsigned char) (cols[i] >> 16);
+        b[3 * i + 3] = (unsigned char) (cols[i] >> 8);
+        b[3 * i + 4] = (unsigned char) cols[i];
+    }
+
+    return 14;
+}
+
+#else
+
 int
 pack (
     const unsigned short s[16],
@@ -327,6 +696,8 @@ pack (
     return 14;
 }
 
+#endif
+
 inline void
 unpack14 (const unsigned char b[14], unsigned short s[16])
 {
@@ -338,6 +709,30 @@ unpack14 (const unsigned char b[14], unsigned short s[16])
     assert (b[2] != 0xfc);
 #endif
 
+#if defined(IMF_HAVE_SSE2) || defined(IMF_HAVE_NEON_AARCH64)
+
+    unsigned int   cols[4];
+    unsigned short c[4];
+
+    for (int i = 0; i < 4; ++i)
+        cols[i] = (b[3 * i + 2] << 16) | (b[3 * i + 3] << 8) | b[3 * i + 4];
+
+    unsigned short shift = (cols[0] >> 18);
+    unsigned short bias  = (0x20u << shift);
+
+    //
+    // s[0], s[4], s[8] and s[12], then the rest along the rows.
+    //
+
+    c[0] = (b[0] << 8) | b[1];
+    c[1] = c[0] + (((cols[0] >> 12) & 0x3fu) << shift) - bias;
+    c[2] = c[1] + (((cols[0] >> 6) & 0x3fu) << shift) - bias;
+    c[3] = c[2] + ((cols[0] & 0x3fu) << shift) - bias;
+
+    unpackRows (cols, c, shift, bias, s);
+
+#else
+
     s[0] = (b[0] << 8) | b[1];
 
     unsigned short shift = (b[2] >> 2);
@@ -369,6 +764,8 @@ unpack14 (const unsigned char b[14], unsigned short s[16])
         else
             s[i] = ~s[i];
     }
+
+#endif
 }
 
 inline void
@@ -901,7 +1298,18 @@ B44Compressor::uncompress (
                 int n = (x + 3 < cd.nx) ? 4 * sizeof (unsigned short)
                                         : (cd.nx - x) * sizeof (unsigned short);
 
-                if (y + 3 < cd.ny)
+                if (x + 3 < cd.nx && y + 3 < cd.ny)
+                {
+                    //
+                    // A whole block, with a fixed size copy per row.
+                    //
+
+                    memcpy (row0, &s[0], 4 * sizeof (unsigned short));
+                    memcpy (row1, &s[4], 4 * sizeof (unsigned short));
+                    memcpy (row2, &s[8], 4 * sizeof (unsigned short));
+                    memcpy (row3, &s[12], 4 * sizeof (unsigned short));
+                }
+                else if (y + 3 < cd.ny)
                 {
                     memcpy (row0, &s[0], n);
                     memcpy (row1, &s[4], n);
@@ -7,11 +7,13 @@
 #include "IlmThreadPool.h"
 #include "ImfChannelList.h"
 #include "ImfDeepCompositing.h"
+#include "ImfDeepCompositingKernels.h"
 #include "ImfDeepFrameBuffer.h"
 #include "ImfDeepScanLineInputFile.h"
 #include "ImfDeepScanLineInputPart.h"
 #include "ImfFrameBuffer.h"
 #include "ImfPixelType.h"
+#include "ImfPooledTask.h"
 
 #include <Iex.h>
 #include <stddef.h>
@@ -286,7 +288,7 @@ CompositeDeepScanLine::setFrameBuffer (const FrameBuffer& fr)
 namespace
 {
 
-class LineCompositeTask : public Task
+class LineCompositeTask : public PooledTask
 {
 public:
     LineCompositeTask (
@@ -298,7 +300,7 @@ public:
         vector<vector<vector<float*>>>* pointers,
         vector<unsigned int>*           total_sizes,
         vector<unsigned int>*           num_sources)
-        : Task (group)
+        : PooledTask (group)
         , _Data (data)
         , _y (y)
         , _start (start)
@@ -332,8 +334,8 @@ composite_line (
 {
     vector<float> output_pixel (names.size ()); //the pixel we'll output to
     vector<const float*> inputs (names.size ());
-    DeepCompositing      d; // fallback compositing engine
-    DeepCompositing*     comp = _Data->_comp ? _Data->_comp : &d;
+    DeepCompositing*     comp = _Data->_comp; // null for the default engine
+    DeepCompositeScratch scratch; // reused for every pixel of the line
 
     int pixel =
         (y - start) * (_Data->_dataWindow.max.x + 1 - _Data->_dataWindow.min.x);
@@ -363,13 +365,26 @@ composite_line (
                 inputs[channel] = pointers[0][channel][pixel];
             }
         }
-        comp->composite_pixel (
-            &output_pixel[0],
-            &inputs[0],
-            &names[0],
-            static_cast<int> (names.size ()),
-            total_sizes[pixel],
-            num_sources[pixel]);
+        if (comp)
+        {
+            comp->composite_pixel (
+                &output_pixel[0],
+                &inputs[0],
+                &names[0],
+                static_cast<int> (names.size ()),
+                total_sizes[pixel],
+                num_sources[pixel]);
+        }
+        else
+        {
+            deepCompositePixel (
+                scratch,
+                &output_pixel[0],
+                &inputs[0],
+                static_cast<int> (names.size ()),
+                total_sizes[pixel],
+                num_sources[pixel]);
+        }
 
         size_t channel_number = 0;
 
@@ -181,7 +181,7 @@ static const CompressionDesc IdToDesc[] = {
         false),
     CompressionDesc (
         "zstd",
-        "blosc zstd lossless compression, one scan line at a time.",
+        "blosc zstd lossless compression, in blocks of scan lines.",
         1,
         false,
         true),
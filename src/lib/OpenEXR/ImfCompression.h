@@ -51,8 +51,9 @@ enum IMF_EXPORT_ENUM Compression
                           // wise and faster to decode full frames
                           // than DWAA_COMPRESSION.
 
-    ZSTD_COMPRESSION = 10, // blosc zstd lossless compression, one scan line
-                           // at a time.
+    ZSTD_COMPRESSION = 10, // blosc zstd lossless compression, in blocks
+                           // of scan lines (see the zstdLinesPerChunk
+                           // attribute).
 
     NUM_COMPRESSION_METHODS // number of different compression methods.
 };
@@ -17,6 +17,7 @@
 #include "ImfPizCompressor.h"
 #include "ImfPxr24Compressor.h"
 #include "ImfRleCompressor.h"
+#include "ImfStandardAttributes.h"
 #include "ImfZipCompressor.h"
 #include "ImfZstdCompressor.h"
 #include "openexr_compression.h"
@@ -103,7 +104,17 @@ newCompressor (Compression c, size_t maxScanLineSize, const Header& hdr)
 
         case ZSTD_COMPRESSION:
 
-            return new ZstdCompressor (hdr);
+        {
+            //
+            // Chunks of a single scan line keep the layout earlier
+            // releases read, taller chunks are opt-in and stored bare.
+            //
+
+            int numScanLines = numLinesInBuffer (hdr);
+
+            return new ZstdCompressor (
+                hdr, maxScanLineSize, numScanLines, numScanLines > 1);
+        }
 
         default: return 0;
     }
@@ -122,6 +133,25 @@ numLinesInBuffer (Compression comp)
     return numScanlines;
 }
 
+int
+numLinesInBuffer (const Header& hdr)
+{
+    if (hdr.compression () != ZSTD_COMPRESSION || hdr.hasTileDescription ())
+        return numLinesInBuffer (hdr.compression ());
+
+    //
+    // Files written before the attribute existed hold one
+    // scan line per zstd chunk.
+    //
+
+    if (!hasZstdLinesPerChunk (hdr)) return 1;
+
+    int numScanlines = zstdLinesPerChunk (hdr);
+    if (numScanlines < 1 || numScanlines > 256)
+        throw IEX_NAMESPACE::ArgExc ("Invalid zstdLinesPerChunk attribute");
+    return numScanlines;
+}
+
 Compressor*
 newTileCompressor (
     Compression c, size_t tileLineSize, size_t numTileLines, const Header& hdr)
@@ -172,7 +202,8 @@ newTileCompressor (
 
         case ZSTD_COMPRESSION:
 
-            return new ZstdCompressor (hdr);
+            return new ZstdCompressor (
+                hdr, tileLineSize, numTileLines, false);
 
         default: return 0;
     }
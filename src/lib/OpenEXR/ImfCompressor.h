@@ -211,6 +211,16 @@ Compressor* newTileCompressor (
 IMF_EXPORT
 int numLinesInBuffer (Compression comp);
 
+//-----------------------------------------------------------------
+// Return the maximum number of scanlines in each chunk of the
+// scanline image described by the given header.  Unlike the
+// function above, this honours the zstdLinesPerChunk attribute
+// of zstd compressed images.
+//-----------------------------------------------------------------
+
+IMF_EXPORT
+int numLinesInBuffer (const Header& hdr);
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
 
 #endif
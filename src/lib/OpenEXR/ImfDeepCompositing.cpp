@@ -4,8 +4,10 @@
 //
 
 #include "ImfDeepCompositing.h"
+#include "ImfDeepCompositingKernels.h"
 
 #include "ImfNamespace.h"
+#include "ImfSimd.h"
 #include <algorithm>
 #include <vector>
 
@@ -13,6 +15,170 @@ OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
 using std::sort;
 using std::vector;
+
+namespace
+{
+
+//
+// sample counts up to this are sorted with an insertion sort, and
+// DeepCompositing::composite_pixel() keeps its scratch on the stack
+//
+
+const int SMALL_SAMPLE_COUNT = 32;
+
+struct sort_helper
+{
+    const float* z;
+    const float* zback;
+    bool         operator() (int a, int b) const
+    {
+        if (z[a] < z[b]) return true;
+        if (z[a] > z[b]) return false;
+        if (zback[a] < zback[b]) return true;
+        if (zback[a] > zback[b]) return false;
+        return a < b;
+    }
+    sort_helper (const float* zi, const float* zbi) : z (zi), zback (zbi) {}
+};
+
+//
+// larger pixels go through a per-thread scratch that is only ever
+// grown, rather than allocating for every pixel
+//
+
+DeepCompositeScratch&
+threadScratch ()
+{
+    static thread_local DeepCompositeScratch scratch;
+    return scratch;
+}
+
+} // namespace
+
+void
+deepCompositeSort (
+    int order[], const float* z, const float* zback, int num_samples)
+{
+    sort_helper less (z, zback);
+
+    if (num_samples > SMALL_SAMPLE_COUNT)
+    {
+        std::sort (order + 0, order + num_samples, less);
+        return;
+    }
+
+    for (int i = 1; i < num_samples; i++)
+    {
+        int v = order[i];
+        int j = i;
+        while (j > 0 && less (v, order[j - 1]))
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = v;
+    }
+}
+
+void
+deepCompositeOver (
+    float        outputs[],
+    const float* inputs[],
+    int          num_channels,
+    const int    order[],
+    int          num_samples,
+    float        weights[])
+{
+    //
+    // the weight of each sample only depends on the alpha in front of
+    // it, so work those out first: this also finds how many samples
+    // are visible at all
+    //
+
+    const float* alphas = inputs[2];
+    float        alpha  = 0.0f;
+    int          n      = 0;
+
+    for (; n < num_samples; n++)
+    {
+        if (alpha >= 1.0f) break;
+        int s      = order ? order[n] : n;
+        weights[n] = 1.0f - alpha;
+        alpha += weights[n] * alphas[s];
+    }
+
+    //
+    // then accumulate the channels. Each channel still sums its samples
+    // front to back, so the result is exactly the same as doing one
+    // sample at a time, but several channels are done at once
+    //
+
+    int c = 0;
+
+#ifdef IMF_HAVE_SSE2
+    for (; c + 4 <= num_channels; c += 4)
+    {
+        const float* in0 = inputs[c];
+        const float* in1 = inputs[c + 1];
+        const float* in2 = inputs[c + 2];
+        const float* in3 = inputs[c + 3];
+        __m128       acc = _mm_setzero_ps ();
+
+        for (int i = 0; i < n; i++)
+        {
+            int    s = order ? order[i] : i;
+            __m128 v = _mm_set_ps (in3[s], in2[s], in1[s], in0[s]);
+            acc = _mm_add_ps (acc, _mm_mul_ps (_mm_set1_ps (weights[i]), v));
+        }
+
+        _mm_storeu_ps (outputs + c, acc);
+    }
+#endif
+
+    for (; c < num_channels; c++)
+    {
+        const float* in  = inputs[c];
+        float        acc = 0.0f;
+        for (int i = 0; i < n; i++)
+            acc += weights[i] * in[order ? order[i] : i];
+        outputs[c] = acc;
+    }
+}
+
+void
+deepCompositePixel (
+    DeepCompositeScratch& scratch,
+    float                 outputs[],
+    const float*          inputs[],
+    int                   num_channels,
+    int                   num_samples,
+    int                   sources)
+{
+    for (int i = 0; i < num_channels; i++)
+        outputs[i] = 0.0;
+    // no samples? do nothing
+    if (num_samples == 0) { return; }
+
+    scratch.reserve (num_samples);
+
+    int* order = nullptr;
+    if (sources > 1)
+    {
+        order = scratch.order.data ();
+        for (int i = 0; i < num_samples; i++)
+            order[i] = i;
+        deepCompositeSort (order, inputs[0], inputs[1], num_samples);
+    }
+
+    deepCompositeOver (
+        outputs,
+        inputs,
+        num_channels,
+        order,
+        num_samples,
+        scratch.weights.data ());
+}
+
 DeepCompositing::DeepCompositing ()
 {}
 
@@ -33,47 +199,35 @@ DeepCompositing::composite_pixel (
     // no samples? do nothing
     if (num_samples == 0) { return; }
 
-    vector<int> sort_order;
-    if (sources > 1)
-    {
-        sort_order.resize (num_samples);
-        for (int i = 0; i < num_samples; i++)
-            sort_order[i] = i;
-        sort (
-            &sort_order[0],
-            inputs,
-            channel_names,
-            num_channels,
-            num_samples,
-            sources);
-    }
+    int    small_order[SMALL_SAMPLE_COUNT];
+    float  small_weights[SMALL_SAMPLE_COUNT];
+    int*   order   = small_order;
+    float* weights = small_weights;
 
-    for (int i = 0; i < num_samples; i++)
+    if (num_samples > SMALL_SAMPLE_COUNT)
     {
-        int   s     = (sources > 1) ? sort_order[i] : i;
-        float alpha = outputs[2];
-        if (alpha >= 1.0f) return;
-
-        for (int c = 0; c < num_channels; c++)
-        {
-            outputs[c] += (1.0f - alpha) * inputs[c][s];
-        }
+        DeepCompositeScratch& scratch = threadScratch ();
+        scratch.reserve (num_samples);
+        order   = scratch.order.data ();
+        weights = scratch.weights.data ();
     }
-}
 
-struct sort_helper
-{
-    const float** inputs;
-    bool          operator() (int a, int b)
+    if (sources > 1)
     {
-        if (inputs[0][a] < inputs[0][b]) return true;
-        if (inputs[0][a] > inputs[0][b]) return false;
-        if (inputs[1][a] < inputs[1][b]) return true;
-        if (inputs[1][a] > inputs[1][b]) return false;
-        return a < b;
+        for (int i = 0; i < num_samples; i++)
+            order[i] = i;
+        // sort() is virtual, derived classes may only replace the ordering
+        sort (order, inputs, channel_names, num_channels, num_samples, sources);
     }
-    sort_helper (const float** i) : inputs (i) {}
-};
+
+    deepCompositeOver (
+        outputs,
+        inputs,
+        num_channels,
+        sources > 1 ? order : nullptr,
+        num_samples,
+        weights);
+}
 
 void
 DeepCompositing::sort (
@@ -84,7 +238,7 @@ DeepCompositing::sort (
     int          num_samples,
     int          sources)
 {
-    std::sort (order + 0, order + num_samples, sort_helper (inputs));
+    deepCompositeSort (order, inputs[0], inputs[1], num_samples);
 }
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
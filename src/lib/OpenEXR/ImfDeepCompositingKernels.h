@@ -0,0 +1,83 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_DEEPCOMPOSITING_KERNELS_H
+#define INCLUDED_IMF_DEEPCOMPOSITING_KERNELS_H
+
+//-----------------------------------------------------------------------------
+//
+//	Building blocks of the default DeepCompositing behaviour, shared
+//	by DeepCompositing itself and by the compositing engines, which
+//	use them directly with per-task scratch storage when no custom
+//	compositor is installed, so no memory is allocated per pixel.
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfNamespace.h"
+
+#include <vector>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+//
+// Sort order[0 .. num_samples-1] front to back: by z, then by zback,
+// then by sample index.  Small sample counts, which are by far the
+// most common, use an insertion sort.
+//
+
+void deepCompositeSort (
+    int order[], const float* z, const float* zback, int num_samples);
+
+//
+// Composite the samples front to back using the Over operator, taking
+// them in the given order, or in storage order if order is null, and
+// stopping at the first sample where the accumulated alpha (channel 2)
+// reaches 1.  outputs[] must be zero on entry.  weights[] is scratch
+// space for num_samples values.
+//
+
+void deepCompositeOver (
+    float        outputs[],
+    const float* inputs[],
+    int          num_channels,
+    const int    order[],
+    int          num_samples,
+    float        weights[]);
+
+//
+// Reusable scratch space for the above, grown as needed.
+//
+
+struct DeepCompositeScratch
+{
+    std::vector<int>   order;
+    std::vector<float> weights;
+
+    void reserve (int num_samples)
+    {
+        if (static_cast<int> (order.size ()) < num_samples)
+        {
+            order.resize (num_samples);
+            weights.resize (num_samples);
+        }
+    }
+};
+
+//
+// Same result as DeepCompositing::composite_pixel(), with the order
+// and weights held in scratch.
+//
+
+void deepCompositePixel (
+    DeepCompositeScratch& scratch,
+    float                 outputs[],
+    const float*          inputs[],
+    int                   num_channels,
+    int                   num_samples,
+    int                   sources);
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
@@ -19,6 +19,7 @@
 #include <ImfDeepScanLineInputFile.h>
 #include <ImfMisc.h>
 #include <ImfPartType.h>
+#include <ImfPooledTask.h>
 #include <ImfStdIO.h>
 #include <ImfThreading.h>
 #include <ImfVersion.h>
@@ -738,7 +739,7 @@ fillSampleCountFromCache (int y, DeepScanLineInputFile::Data* data)
 // scanlines (line buffer) and copying them into the frame buffer.
 //
 
-class LineBufferTask : public Task
+class LineBufferTask : public PooledTask
 {
 public:
     LineBufferTask (
@@ -765,7 +766,7 @@ LineBufferTask::LineBufferTask (
     LineBuffer*                  lineBuffer,
     int                          scanLineMin,
     int                          scanLineMax)
-    : Task (group)
+    : PooledTask (group)
     , _ifd (ifd)
     , _lineBuffer (lineBuffer)
     , _scanLineMin (scanLineMin)
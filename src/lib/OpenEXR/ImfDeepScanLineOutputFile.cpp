@@ -22,6 +22,7 @@
 #include <ImfDeepScanLineOutputFile.h>
 #include <ImfMisc.h>
 #include <ImfPartType.h>
+#include <ImfPooledTask.h>
 #include <ImfPreviewImageAttribute.h>
 #include <ImfStdIO.h>
 #include <ImfXdr.h>
@@ -466,7 +467,7 @@ convertToXdr (
 // the data if necessary.
 //
 
-class LineBufferTask : public Task
+class LineBufferTask : public PooledTask
 {
 public:
     LineBufferTask (
@@ -491,7 +492,7 @@ LineBufferTask::LineBufferTask (
     int                           number,
     int                           scanLineMin,
     int                           scanLineMax)
-    : Task (group), _ofd (ofd), _lineBuffer (_ofd->getLineBuffer (number))
+    : PooledTask (group), _ofd (ofd), _lineBuffer (_ofd->getLineBuffer (number))
 {
     //
     // Wait for the lineBuffer to become available
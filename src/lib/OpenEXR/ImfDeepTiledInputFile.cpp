@@ -15,6 +15,7 @@
 #include "ImfCompressor.h"
 #include "ImfDeepFrameBuffer.h"
 #include "ImfMisc.h"
+#include "ImfPooledTask.h"
 #include "ImfStdIO.h"
 #include "ImfTileDescriptionAttribute.h"
 #include "ImfTiledMisc.h"
@@ -479,7 +480,7 @@ readTileData (
 // a single tile and copying it into the frame buffer.
 //
 
-class TileBufferTask : public Task
+class TileBufferTask : public PooledTask
 {
 public:
     TileBufferTask (
@@ -498,7 +499,7 @@ private:
 
 TileBufferTask::TileBufferTask (
     TaskGroup* group, DeepTiledInputFile::Data* ifd, TileBuffer* tileBuffer)
-    : Task (group), _ifd (ifd), _tileBuffer (tileBuffer)
+    : PooledTask (group), _ifd (ifd), _tileBuffer (tileBuffer)
 {
     // empty
 }
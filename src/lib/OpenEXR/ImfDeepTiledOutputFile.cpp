@@ -22,6 +22,7 @@
 #include "ImfOutputPartData.h"
 #include "ImfOutputStreamMutex.h"
 #include "ImfPartType.h"
+#include "ImfPooledTask.h"
 #include "ImfPreviewImageAttribute.h"
 #include "ImfStdIO.h"
 #include "ImfThreading.h"
@@ -744,7 +745,7 @@ convertToXdr (
 // if necessary.
 //
 
-class TileBufferTask : public Task
+class TileBufferTask : public PooledTask
 {
 public:
     TileBufferTask (
@@ -773,7 +774,7 @@ TileBufferTask::TileBufferTask (
     int                        dy,
     int                        lx,
     int                        ly)
-    : Task (group), _ofd (ofd), _tileBuffer (_ofd->getTileBuffer (number))
+    : PooledTask (group), _ofd (ofd), _tileBuffer (_ofd->getTileBuffer (number))
 {
     //
     // Wait for the tileBuffer to become available
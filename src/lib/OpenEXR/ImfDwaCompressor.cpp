@@ -143,8 +143,6 @@
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
-#include "dwaLookups.h"
-
 namespace
 {
 
@@ -176,6 +174,12 @@ void (*dctInverse8x8_5) (float*) = dctInverse8x8_scalar<5>;
 void (*dctInverse8x8_6) (float*) = dctInverse8x8_scalar<6>;
 void (*dctInverse8x8_7) (float*) = dctInverse8x8_scalar<7>;
 
+//
+// Dispatch the quantization of a block of DCT coefficients
+//
+void (*quantizeCoeffs64) (unsigned short*, const float*, const float*) =
+    quantizeCoeffs64_scalar;
+
 } // namespace
 
 struct DwaCompressor::ChannelData
@@ -519,10 +523,7 @@ public:
     int numDcValuesEncoded () const { return _numDcComp; }
 
 protected:
-    void toZigZag (half* dst, half* src);
-    int  countSetBits (unsigned short src);
-    half quantize (half src, float errorTolerance);
-    void rleAc (half* block, unsigned short*& acPtr);
+    void rleAc (unsigned short* block, unsigned short*& acPtr);
 
     float _quantBaseError;
 
@@ -1307,8 +1308,19 @@ DwaCompressor::LossyDctEncoderBase::execute ()
     int numBlocksX = (int) ceil ((float) _width / 8.0f);
     int numBlocksY = (int) ceil ((float) _height / 8.0f);
 
-    half halfZigCoef[64];
-    half halfCoef[64];
+    unsigned short halfZigCoef[64];
+
+    //
+    // The acceptable error of each DCT component
+    //
+
+    float quantTolY[64], quantTolCbCr[64];
+
+    for (int i = 0; i < 64; ++i)
+    {
+        quantTolY[i]    = _quantBaseError * _quantTableY[i];
+        quantTolCbCr[i] = _quantBaseError * _quantTableCbCr[i];
+    }
 
     std::vector<unsigned short*> currDcComp (_rowPtrs.size ());
     unsigned short*              currAcComp = (unsigned short*) _packedAc;
@@ -1411,6 +1423,43 @@ DwaCompressor::LossyDctEncoderBase::execute ()
                 // we'll need to explicitly do it.
                 //
 
+                if (8 * blockx + 8 <= _width && 8 * blocky + 8 <= _height)
+                {
+                    //
+                    // Interior blocks don't need any mirroring
+                    //
+
+                    for (int y = 0; y < 8; ++y)
+                    {
+                        int                   vy  = 8 * blocky + y;
+                        const unsigned short* row =
+                            (const unsigned short*) _rowPtrs[chan][vy] +
+                            8 * blockx;
+                        float* dctRow = _dctData[chan]._buffer + y * 8;
+
+                        for (int x = 0; x < 8; ++x)
+                        {
+                            if (_toNonlinear)
+                            {
+                                h.setBits (_toNonlinear[row[x]]);
+                            }
+                            else
+                            {
+                                const char* tmpConstCharPtr =
+                                    (const char*) (row + x);
+
+                                Xdr::read<CharPtrIO> (
+                                    tmpConstCharPtr, tmpShortNative);
+
+                                h.setBits (tmpShortNative);
+                            }
+
+                            dctRow[x] = (float) h;
+                        }
+                    }
+                    continue;
+                }
+
                 for (int y = 0; y < 8; ++y)
                 {
                     for (int x = 0; x < 8; ++x)
@@ -1473,26 +1522,10 @@ DwaCompressor::LossyDctEncoderBase::execute ()
                 // Quantize to half, and zigzag
                 //
 
-                if (chan == 0)
-                {
-                    for (int i = 0; i < 64; ++i)
-                    {
-                        halfCoef[i] = quantize (
-                            (half) _dctData[chan]._buffer[i],
-                            _quantBaseError * _quantTableY[i]);
-                    }
-                }
-                else
-                {
-                    for (int i = 0; i < 64; ++i)
-                    {
-                        halfCoef[i] = quantize (
-                            (half) _dctData[chan]._buffer[i],
-                            _quantBaseError * _quantTableCbCr[i]);
-                    }
-                }
-
-                toZigZag (halfZigCoef, halfCoef);
+                quantizeCoeffs64 (
+                    halfZigCoef,
+                    _dctData[chan]._buffer,
+                    chan == 0 ? quantTolY : quantTolCbCr);
 
                 //
                 // Convert from NATIVE back to XDR, before we write out
@@ -1501,8 +1534,8 @@ DwaCompressor::LossyDctEncoderBase::execute ()
                 for (int i = 0; i < 64; ++i)
                 {
                     tmpCharPtr = (char*) &tmpShortXdr;
-                    Xdr::write<CharPtrIO> (tmpCharPtr, halfZigCoef[i].bits ());
-                    halfZigCoef[i].setBits (tmpShortXdr);
+                    Xdr::write<CharPtrIO> (tmpCharPtr, halfZigCoef[i]);
+                    halfZigCoef[i] = tmpShortXdr;
                 }
 
                 //
@@ -1510,7 +1543,7 @@ DwaCompressor::LossyDctEncoderBase::execute ()
                 // its own.
                 //
 
-                *currDcComp[chan]++ = halfZigCoef[0].bits ();
+                *currDcComp[chan]++ = halfZigCoef[0];
                 _numDcComp++;
 
                 //
@@ -1524,83 +1557,6 @@ DwaCompressor::LossyDctEncoderBase::execute ()
     }         // blocky
 }
 
-//
-// Reorder from zig-zag order to normal ordering
-//
-
-void
-DwaCompressor::LossyDctEncoderBase::toZigZag (half* dst, half* src)
-{
-    const int remap[] = {0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18,
-                         11, 4,  5,  12, 19, 26, 33, 40, 48, 41, 34, 27, 20,
-                         13, 6,  7,  14, 21, 28, 35, 42, 49, 56, 57, 50, 43,
-                         36, 29, 22, 15, 23, 30, 37, 44, 51, 58, 59, 52, 45,
-                         38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
-
-    for (int i = 0; i < 64; ++i)
-        dst[i] = src[remap[i]];
-}
-
-//
-// Precomputing the bit count runs faster than using
-// the builtin instruction, at least in one case..
-//
-// Precomputing 8-bits is no slower than 16-bits,
-// and saves a fair bit of overhead..
-//
-
-int
-DwaCompressor::LossyDctEncoderBase::countSetBits (unsigned short src)
-{
-    static const unsigned short numBitsSet[256] = {
-        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 1, 2, 2, 3, 2, 3, 3, 4,
-        2, 3, 3, 4, 3, 4, 4, 5, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 1, 2, 2, 3, 2, 3, 3, 4,
-        2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6,
-        4, 5, 5, 6, 5, 6, 6, 7, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 2, 3, 3, 4, 3, 4, 4, 5,
-        3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6,
-        4, 5, 5, 6, 5, 6, 6, 7, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-        4, 5, 5, 6, 5, 6, 6, 7, 5, 6, 6, 7, 6, 7, 7, 8};
-
-    return numBitsSet[src & 0xff] + numBitsSet[src >> 8];
-}
-
-//
-// Take a DCT coefficient, as well as an acceptable error. Search
-// nearby values within the error tolerance, that have fewer
-// bits set.
-//
-// The list of candidates has been pre-computed and sorted
-// in order of increasing numbers of bits set. This way, we
-// can stop searching as soon as we find a candidate that
-// is within the error tolerance.
-//
-
-half
-DwaCompressor::LossyDctEncoderBase::quantize (half src, float errorTolerance)
-{
-    half                  tmp;
-    float                 srcFloat   = (float) src;
-    int                   numSetBits = countSetBits (src.bits ());
-    const unsigned short* closest =
-        closestData + closestDataOffset[src.bits ()];
-
-    for (int targetNumSetBits = numSetBits - 1; targetNumSetBits >= 0;
-         --targetNumSetBits)
-    {
-        tmp.setBits (*closest);
-
-        if (fabs ((float) tmp - srcFloat) < errorTolerance) return tmp;
-
-        closest++;
-    }
-
-    return src;
-}
-
 //
 // RLE the zig-zag of the AC components + copy over
 // into another tmp buffer
@@ -1622,25 +1578,32 @@ DwaCompressor::LossyDctEncoderBase::quantize (half src, float errorTolerance)
 //
 
 void
-DwaCompressor::LossyDctEncoderBase::rleAc (half* block, unsigned short*& acPtr)
+DwaCompressor::LossyDctEncoderBase::rleAc (
+    unsigned short* block, unsigned short*& acPtr)
 {
-    int            dctComp   = 1;
-    unsigned short rleSymbol = 0x0;
+    int dctComp = 1;
+
+    //
+    // Bit i is set when block[i] is not 0, so the length of
+    // a run of 0's is just the distance to the next set bit.
+    //
+
+    uint64_t nonZero = ~zeroMask64 (block);
 
     while (dctComp < 64)
     {
-        int runLen = 1;
+        uint64_t rest = nonZero >> dctComp;
 
         //
         // If we don't have a 0, output verbatim
         //
 
-        if (block[dctComp].bits () != rleSymbol)
+        if (rest & 1)
         {
-            *acPtr++ = block[dctComp].bits ();
+            *acPtr++ = block[dctComp];
             _numAcComp++;
 
-            dctComp += runLen;
+            dctComp++;
             continue;
         }
 
@@ -1648,11 +1611,7 @@ DwaCompressor::LossyDctEncoderBase::rleAc (half* block, unsigned short*& acPtr)
         // We're sitting on a 0, so see how big the run is.
         //
 
-        while ((dctComp + runLen < 64) &&
-               (block[dctComp + runLen].bits () == rleSymbol))
-        {
-            runLen++;
-        }
+        int runLen = rest ? countTrailingZeros64 (rest) : 64 - dctComp;
 
         //
         // If the run len is too small, just output verbatim
@@ -1666,13 +1625,8 @@ DwaCompressor::LossyDctEncoderBase::rleAc (half* block, unsigned short*& acPtr)
 
         if (runLen == 1)
         {
-            runLen   = 1;
-            *acPtr++ = block[dctComp].bits ();
+            *acPtr++ = block[dctComp];
             _numAcComp++;
-
-            //
-            // Using 0xff00 for "end of block"
-            //
         }
         else if (runLen + dctComp == 64)
         {
@@ -2782,6 +2736,7 @@ DwaCompressor::initializeFuncs ()
 {
     convertFloatToHalf64 = convertFloatToHalf64_scalar;
     fromHalfZigZag       = fromHalfZigZag_scalar;
+    quantizeCoeffs64     = quantizeCoeffs64_scalar;
 
     CpuId cpuId;
 
@@ -2793,12 +2748,16 @@ DwaCompressor::initializeFuncs ()
     {
         convertFloatToHalf64 = convertFloatToHalf64_f16c;
         fromHalfZigZag       = fromHalfZigZag_f16c;
+#ifdef IMF_HAVE_F16C_TARGET
+        quantizeCoeffs64 = quantizeCoeffs64_f16c;
+#endif
     }
 
 #ifdef IMF_HAVE_NEON_AARCH64
     {
         convertFloatToHalf64 = convertFloatToHalf64_neon;
         fromHalfZigZag       = fromHalfZigZag_neon;
+        quantizeCoeffs64     = quantizeCoeffs64_neon;
     }
 #endif
 
@@ -1954,7 +1954,7 @@ getScanlineChunkOffsetTableSize (const Header& header)
     // use int64_t types to prevent overflow in lineOffsetSize for images with
     // extremely high dataWindows
     //
-    int64_t linesInBuffer = numLinesInBuffer (header.compression ());
+    int64_t linesInBuffer = numLinesInBuffer (header);
 
     int64_t lineOffsetSize =
         (static_cast<int64_t> (dataWindow.max.y) -
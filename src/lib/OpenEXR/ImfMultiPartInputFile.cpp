@@ -545,11 +545,7 @@ MultiPartInputFile::Data::chunkOffsetReconstruction (
         else
         {
             tileOffsets[i] = NULL;
-            rowsizes[i] =
-                getCompressionNumScanlines (parts[i]->header.compression ());
-            if (rowsizes[i] < 1)
-                throw (IEX_NAMESPACE::ArgExc (
-                    "Unknown compression method in chunk offset reconstruction"));
+            rowsizes[i]    = numLinesInBuffer (parts[i]->header);
         }
     }
 
@@ -24,6 +24,7 @@
 #include "ImfMisc.h"
 #include "ImfOutputStreamMutex.h"
 #include "ImfPartType.h"
+#include "ImfPooledTask.h"
 #include "ImfPreviewImageAttribute.h"
 #include "ImfStdIO.h"
 #include "ImfXdr.h"
@@ -364,7 +365,7 @@ convertToXdr (
 // the data if necessary.
 //
 
-class LineBufferTask : public Task
+class LineBufferTask : public PooledTask
 {
 public:
     LineBufferTask (
@@ -389,7 +390,7 @@ LineBufferTask::LineBufferTask (
     int               number,
     int               scanLineMin,
     int               scanLineMax)
-    : Task (group), _ofd (ofd), _lineBuffer (_ofd->getLineBuffer (number))
+    : PooledTask (group), _ofd (ofd), _lineBuffer (_ofd->getLineBuffer (number))
 {
     //
     // Wait for the lineBuffer to become available
@@ -120,6 +120,22 @@ applyLut (
         data[i] = lut[data[i]];
 }
 
+//
+// applyLut in to a separate output buffer, when the data are being
+// copied anyway
+//
+
+void
+applyLut (
+    const unsigned short lut[USHORT_RANGE],
+    const unsigned short data[/*nData*/],
+    unsigned short       out[/*nData*/],
+    int                  nData)
+{
+    for (int i = 0; i < nData; ++i)
+        out[i] = lut[data[i]];
+}
+
 } // namespace
 
 struct PizCompressor::ChannelData
@@ -554,13 +570,8 @@ PizCompressor::uncompress (
     }
 
     //
-    // Expand the pixel data to their original range
-    //
-
-    applyLut (lut, _tmpBuffer, tmpBufferEnd - _tmpBuffer);
-
-    //
-    // Rearrange the pixel data into the format expected by the caller.
+    // Rearrange the pixel data into the format expected by the caller,
+    // expanding them to their original range.
     //
 
     char* outEnd = _outBuffer;
@@ -581,7 +592,7 @@ PizCompressor::uncompress (
 
                 for (int x = cd.nx * cd.size; x > 0; --x)
                 {
-                    Xdr::write<CharPtrIO> (outEnd, *cd.end);
+                    Xdr::write<CharPtrIO> (outEnd, lut[*cd.end]);
                     ++cd.end;
                 }
             }
@@ -602,7 +613,8 @@ PizCompressor::uncompress (
                 if (modp (y, cd.ys) != 0) continue;
 
                 int n = cd.nx * cd.size;
-                memcpy (outEnd, cd.end, n * sizeof (unsigned short));
+                applyLut (
+                    lut, cd.end, reinterpret_cast<unsigned short*> (outEnd), n);
                 outEnd += n * sizeof (unsigned short);
                 cd.end += n;
             }
@@ -0,0 +1,174 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+//-----------------------------------------------------------------------------
+//
+//	class PooledTask
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfPooledTask.h"
+
+#include <mutex>
+#include <new>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+namespace
+{
+
+//
+// Task storage: tasks are typically created by the thread reading a
+// file and deleted by a worker, so each thread keeps a small cache of
+// blocks per size class and trades them in batches with a shared
+// store. The common case touches no lock at all.
+//
+
+constexpr size_t kTaskSizeStep      = 64;
+constexpr int    kTaskSizeClasses   = 8; // up to 512 bytes
+constexpr int    kTaskBatch         = 32;
+constexpr int    kTaskSharedBatches = 64;
+
+struct TaskBlock
+{
+    TaskBlock* next;
+    TaskBlock* nextBatch;
+};
+
+struct TaskSharedStore
+{
+    std::mutex mutex[kTaskSizeClasses];
+    TaskBlock* batches[kTaskSizeClasses]     = {};
+    int        batchCount[kTaskSizeClasses] = {};
+};
+
+TaskSharedStore&
+taskSharedStore ()
+{
+    // never destroyed, so thread caches can hand back their
+    // blocks whatever the order of destruction at exit
+    static TaskSharedStore* store = new TaskSharedStore;
+    return *store;
+}
+
+void
+freeTaskBlocks (TaskBlock* b)
+{
+    while (b)
+    {
+        TaskBlock* n = b->next;
+        ::operator delete (b);
+        b = n;
+    }
+}
+
+struct TaskThreadCache
+{
+    TaskBlock* head[kTaskSizeClasses]  = {};
+    int        count[kTaskSizeClasses] = {};
+
+    TaskThreadCache () = default;
+    TaskThreadCache (const TaskThreadCache&)            = delete;
+    TaskThreadCache& operator= (const TaskThreadCache&) = delete;
+    TaskThreadCache (TaskThreadCache&&)                 = delete;
+    TaskThreadCache& operator= (TaskThreadCache&&)      = delete;
+
+    ~TaskThreadCache ()
+    {
+        for (int c = 0; c < kTaskSizeClasses; ++c)
+            freeTaskBlocks (head[c]);
+    }
+
+    void* allocate (int c)
+    {
+        if (!head[c])
+        {
+            TaskSharedStore&            store = taskSharedStore ();
+            std::lock_guard<std::mutex> lock (store.mutex[c]);
+            TaskBlock*                  batch = store.batches[c];
+            if (batch)
+            {
+                store.batches[c] = batch->nextBatch;
+                --store.batchCount[c];
+                head[c]  = batch;
+                count[c] = kTaskBatch;
+            }
+        }
+
+        TaskBlock* b = head[c];
+        if (!b) return ::operator new (kTaskSizeStep * (c + 1));
+        head[c] = b->next;
+        --count[c];
+        return b;
+    }
+
+    void release (void* ptr, int c)
+    {
+        TaskBlock* b = static_cast<TaskBlock*> (ptr);
+        b->next      = head[c];
+        head[c]      = b;
+        if (++count[c] < 2 * kTaskBatch) return;
+
+        // hand the oldest batch over to the threads allocating
+        TaskBlock* last = b;
+        for (int i = 1; i < kTaskBatch; ++i)
+            last = last->next;
+        TaskBlock* batch = last->next;
+        last->next       = nullptr;
+        count[c] -= kTaskBatch;
+
+        TaskSharedStore&             store = taskSharedStore ();
+        std::unique_lock<std::mutex> lock (store.mutex[c]);
+        if (store.batchCount[c] < kTaskSharedBatches)
+        {
+            batch->nextBatch = store.batches[c];
+            store.batches[c] = batch;
+            ++store.batchCount[c];
+        }
+        else
+        {
+            lock.unlock ();
+            freeTaskBlocks (batch);
+        }
+    }
+};
+
+inline TaskThreadCache&
+taskThreadCache ()
+{
+    static thread_local TaskThreadCache cache;
+    return cache;
+}
+
+inline int
+taskSizeClass (size_t size)
+{
+    if (size == 0 || size > kTaskSizeStep * kTaskSizeClasses) return -1;
+    return static_cast<int> ((size - 1) / kTaskSizeStep);
+}
+
+} // namespace
+
+void*
+PooledTask::operator new (std::size_t size)
+{
+    int c = taskSizeClass (size);
+    if (c < 0) return ::operator new (size);
+    return taskThreadCache ().allocate (c);
+}
+
+void
+PooledTask::operator delete (void* ptr, std::size_t size)
+{
+    if (!ptr) return;
+
+    int c = taskSizeClass (size);
+    if (c < 0)
+        ::operator delete (ptr);
+    else
+        taskThreadCache ().release (ptr, c);
+}
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
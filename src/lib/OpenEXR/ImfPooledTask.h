@@ -0,0 +1,44 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_POOLED_TASK_H
+#define INCLUDED_IMF_POOLED_TASK_H
+
+//-----------------------------------------------------------------------------
+//
+//	class PooledTask
+//
+//	Base class of the tasks the library hands to the thread pool for
+//	every chunk it reads or writes. Their storage is recycled rather
+//	than going back to the heap every time. This is private to the
+//	library; IlmThread::Task itself is unchanged.
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfNamespace.h"
+
+#include "IlmThreadPool.h"
+
+#include <cstddef>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+class PooledTask : public ILMTHREAD_NAMESPACE::Task
+{
+public:
+    PooledTask (ILMTHREAD_NAMESPACE::TaskGroup* group) : Task (group) {}
+
+    //
+    // Tasks which need more than the default alignment must not
+    // derive from PooledTask.
+    //
+
+    static void* operator new (std::size_t size);
+    static void  operator delete (void* ptr, std::size_t size);
+};
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
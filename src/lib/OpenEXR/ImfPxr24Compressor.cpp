@@ -41,6 +41,7 @@
 #include "ImfHeader.h"
 #include "ImfMisc.h"
 #include "ImfNamespace.h"
+#include "ImfSimd.h"
 
 #include <Iex.h>
 #include <ImathFun.h>
@@ -49,6 +50,7 @@
 #include <assert.h>
 #include <half.h>
 #include <openexr_compression.h>
+#include <string.h>
 
 using namespace std;
 using namespace IMATH_NAMESPACE;
@@ -133,6 +135,566 @@ floatToFloat24 (float f)
     return (s >> 8) | i;
 }
 
+//
+// The per row loops of compress() and uncompress() for each pixel
+// type. The vector loops do 16 pixels at a time, leaving the rest of
+// the row to the scalar loops, which carry on from the last pixel of
+// the vector loop.
+//
+
+#if defined(IMF_HAVE_SSE2)
+
+//
+// floatToFloat24() without the branches, 4 at a time.
+//
+inline __m128i
+floatToFloat24_sse2 (__m128i u)
+{
+    __m128i a, t, r, i, nan;
+
+    a = _mm_and_si128 (u, _mm_set1_epi32 (0x7fffffff));
+    t = _mm_srli_epi32 (a, 8);
+    r = _mm_and_si128 (a, _mm_set1_epi32 (0x80));
+    r = _mm_srli_epi32 (_mm_add_epi32 (a, r), 8);
+
+    // Truncate rather than round in to the exponent of infinity, which
+    // also leaves infinities and NANs as they are (a < 2^31, so the
+    // signed compares are fine).
+    i = _mm_cmpgt_epi32 (r, _mm_set1_epi32 (0x7f7fff));
+    i = _mm_or_si128 (_mm_and_si128 (i, t), _mm_andnot_si128 (i, r));
+
+    // A NAN which would turn in to an infinity keeps one bit set.
+    nan = _mm_and_si128 (
+        _mm_cmpgt_epi32 (a, _mm_set1_epi32 (0x7f800000)),
+        _mm_cmpeq_epi32 (t, _mm_set1_epi32 (0x7f8000)));
+    i = _mm_or_si128 (i, _mm_srli_epi32 (nan, 31));
+
+    return _mm_or_si128 (
+        i, _mm_and_si128 (_mm_srli_epi32 (u, 8), _mm_set1_epi32 (0x800000)));
+}
+
+//
+// The differences of the 4 values in p from their left neighbors,
+// the one left of the first being the last of prev.
+//
+inline __m128i
+differences32_sse2 (__m128i p, __m128i prev)
+{
+    return _mm_sub_epi32 (
+        p, _mm_or_si128 (_mm_slli_si128 (p, 4), _mm_srli_si128 (prev, 12)));
+}
+
+//
+// Byte shift / 8 of each of the 16 values in d.
+//
+inline __m128i
+bytePlane32_sse2 (const __m128i d[4], int shift)
+{
+    const __m128i mask = _mm_set1_epi32 (0xff);
+    const __m128i cnt  = _mm_cvtsi32_si128 (shift);
+    __m128i       lo, hi;
+
+    lo = _mm_packs_epi32 (
+        _mm_and_si128 (_mm_srl_epi32 (d[0], cnt), mask),
+        _mm_and_si128 (_mm_srl_epi32 (d[1], cnt), mask));
+    hi = _mm_packs_epi32 (
+        _mm_and_si128 (_mm_srl_epi32 (d[2], cnt), mask),
+        _mm_and_si128 (_mm_srl_epi32 (d[3], cnt), mask));
+    return _mm_packus_epi16 (lo, hi);
+}
+
+//
+// The running sum of the 4 differences in d, carrying on from the
+// last of prev.
+//
+inline __m128i
+runningSum32_sse2 (__m128i d, __m128i prev)
+{
+    d = _mm_add_epi32 (d, _mm_slli_si128 (d, 4));
+    d = _mm_add_epi32 (d, _mm_slli_si128 (d, 8));
+    return _mm_add_epi32 (d, _mm_shuffle_epi32 (prev, 0xff));
+}
+
+//
+// The same for 8 16-bit differences.
+//
+inline __m128i
+runningSum16_sse2 (__m128i d, __m128i prev)
+{
+    d    = _mm_add_epi16 (d, _mm_slli_si128 (d, 2));
+    d    = _mm_add_epi16 (d, _mm_slli_si128 (d, 4));
+    d    = _mm_add_epi16 (d, _mm_slli_si128 (d, 8));
+    prev = _mm_shufflehi_epi16 (prev, 0xff);
+    return _mm_add_epi16 (d, _mm_unpackhi_epi64 (prev, prev));
+}
+
+//
+// Rebuild 16 32-bit pixels from the byte planes b0 (most significant)
+// to b3, storing them to out and returning the last 4.
+//
+inline __m128i
+undoPlanes32_sse2 (
+    unsigned char* out,
+    __m128i        b0,
+    __m128i        b1,
+    __m128i        b2,
+    __m128i        b3,
+    __m128i        prev)
+{
+    __m128i hi = _mm_unpacklo_epi8 (b1, b0);
+    __m128i lo = _mm_unpacklo_epi8 (b3, b2);
+
+    prev = runningSum32_sse2 (_mm_unpacklo_epi16 (lo, hi), prev);
+    _mm_storeu_si128 ((__m128i*) out, prev);
+    prev = runningSum32_sse2 (_mm_unpackhi_epi16 (lo, hi), prev);
+    _mm_storeu_si128 ((__m128i*) (out + 16), prev);
+
+    hi = _mm_unpackhi_epi8 (b1, b0);
+    lo = _mm_unpackhi_epi8 (b3, b2);
+
+    prev = runningSum32_sse2 (_mm_unpacklo_epi16 (lo, hi), prev);
+    _mm_storeu_si128 ((__m128i*) (out + 32), prev);
+    prev = runningSum32_sse2 (_mm_unpackhi_epi16 (lo, hi), prev);
+    _mm_storeu_si128 ((__m128i*) (out + 48), prev);
+    return prev;
+}
+
+#elif defined(IMF_HAVE_NEON_AARCH64)
+
+inline uint32x4_t
+floatToFloat24_neon (uint32x4_t u)
+{
+    uint32x4_t a, t, r, i, nan;
+
+    a = vandq_u32 (u, vdupq_n_u32 (0x7fffffff));
+    t = vshrq_n_u32 (a, 8);
+    r = vandq_u32 (a, vdupq_n_u32 (0x80));
+    r = vshrq_n_u32 (vaddq_u32 (a, r), 8);
+
+    i = vbslq_u32 (vcgtq_u32 (r, vdupq_n_u32 (0x7f7fff)), t, r);
+
+    nan = vandq_u32 (
+        vcgtq_u32 (a, vdupq_n_u32 (0x7f800000)),
+        vceqq_u32 (t, vdupq_n_u32 (0x7f8000)));
+    i = vorrq_u32 (i, vshrq_n_u32 (nan, 31));
+
+    return vorrq_u32 (
+        i, vandq_u32 (vshrq_n_u32 (u, 8), vdupq_n_u32 (0x800000)));
+}
+
+inline uint32x4_t
+load32_neon (const unsigned char* in)
+{
+    return vreinterpretq_u32_u8 (vld1q_u8 (in));
+}
+
+inline uint8x16_t
+bytePlane32_neon (const uint32x4_t d[4], int shift)
+{
+    const int32x4_t cnt = vdupq_n_s32 (-shift);
+    uint16x8_t      lo, hi;
+
+    lo = vcombine_u16 (
+        vmovn_u32 (vshlq_u32 (d[0], cnt)), vmovn_u32 (vshlq_u32 (d[1], cnt)));
+    hi = vcombine_u16 (
+        vmovn_u32 (vshlq_u32 (d[2], cnt)), vmovn_u32 (vshlq_u32 (d[3], cnt)));
+    return vcombine_u8 (vmovn_u16 (lo), vmovn_u16 (hi));
+}
+
+inline uint32x4_t
+runningSum32_neon (uint32x4_t d, uint32x4_t prev)
+{
+    const uint32x4_t zero = vdupq_n_u32 (0);
+
+    d = vaddq_u32 (d, vextq_u32 (zero, d, 3));
+    d = vaddq_u32 (d, vextq_u32 (zero, d, 2));
+    return vaddq_u32 (d, vdupq_laneq_u32 (prev, 3));
+}
+
+inline uint16x8_t
+runningSum16_neon (uint16x8_t d, uint16x8_t prev)
+{
+    const uint16x8_t zero = vdupq_n_u16 (0);
+
+    d = vaddq_u16 (d, vextq_u16 (zero, d, 7));
+    d = vaddq_u16 (d, vextq_u16 (zero, d, 6));
+    d = vaddq_u16 (d, vextq_u16 (zero, d, 4));
+    return vaddq_u16 (d, vdupq_laneq_u16 (prev, 7));
+}
+
+inline uint32x4_t
+undoPlanes32_neon (
+    unsigned char* out,
+    uint8x16_t     b0,
+    uint8x16_t     b1,
+    uint8x16_t     b2,
+    uint8x16_t     b3,
+    uint32x4_t     prev)
+{
+    uint8x16x2_t hi = vzipq_u8 (b1, b0);
+    uint8x16x2_t lo = vzipq_u8 (b3, b2);
+    uint16x8x2_t px;
+
+    for (int k = 0; k < 2; ++k)
+    {
+        px = vzipq_u16 (
+            vreinterpretq_u16_u8 (lo.val[k]), vreinterpretq_u16_u8 (hi.val[k]));
+        prev = runningSum32_neon (vreinterpretq_u32_u16 (px.val[0]), prev);
+        vst1q_u8 (out, vreinterpretq_u8_u32 (prev));
+        prev = runningSum32_neon (vreinterpretq_u32_u16 (px.val[1]), prev);
+        vst1q_u8 (out + 16, vreinterpretq_u8_u32 (prev));
+        out += 32;
+    }
+    return prev;
+}
+
+#endif
+
+//
+// The rows of each channel are stored as the differences between
+// neighboring pixels, split in to byte planes, most significant byte
+// first.
+//
+
+void
+compressUint (const unsigned char* in, int w, unsigned char* out)
+{
+    unsigned int previousPixel = 0;
+    int          x             = 0;
+
+#if defined(IMF_HAVE_SSE2)
+    __m128i prev = _mm_setzero_si128 ();
+
+    for (; x + 16 <= w; x += 16)
+    {
+        __m128i p[4], d[4];
+
+        for (int k = 0; k < 4; ++k)
+            p[k] = _mm_loadu_si128 ((const __m128i*) (in + 4 * x + 16 * k));
+
+        d[0] = differences32_sse2 (p[0], prev);
+        d[1] = differences32_sse2 (p[1], p[0]);
+        d[2] = differences32_sse2 (p[2], p[1]);
+        d[3] = differences32_sse2 (p[3], p[2]);
+        prev = p[3];
+
+        _mm_storeu_si128 ((__m128i*) (out + x), bytePlane32_sse2 (d, 24));
+        _mm_storeu_si128 (
+            (__m128i*) (out + w + x), bytePlane32_sse2 (d, 16));
+        _mm_storeu_si128 (
+            (__m128i*) (out + 2 * w + x), bytePlane32_sse2 (d, 8));
+        _mm_storeu_si128 (
+            (__m128i*) (out + 3 * w + x), bytePlane32_sse2 (d, 0));
+    }
+    previousPixel =
+        (unsigned int) _mm_cvtsi128_si32 (_mm_shuffle_epi32 (prev, 0xff));
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    uint32x4_t prev = vdupq_n_u32 (0);
+
+    for (; x + 16 <= w; x += 16)
+    {
+        uint32x4_t p[4], d[4];
+
+        for (int k = 0; k < 4; ++k)
+            p[k] = load32_neon (in + 4 * x + 16 * k);
+
+        d[0] = vsubq_u32 (p[0], vextq_u32 (prev, p[0], 3));
+        d[1] = vsubq_u32 (p[1], vextq_u32 (p[0], p[1], 3));
+        d[2] = vsubq_u32 (p[2], vextq_u32 (p[1], p[2], 3));
+        d[3] = vsubq_u32 (p[3], vextq_u32 (p[2], p[3], 3));
+        prev = p[3];
+
+        vst1q_u8 (out + x, bytePlane32_neon (d, 24));
+        vst1q_u8 (out + w + x, bytePlane32_neon (d, 16));
+        vst1q_u8 (out + 2 * w + x, bytePlane32_neon (d, 8));
+        vst1q_u8 (out + 3 * w + x, bytePlane32_neon (d, 0));
+    }
+    previousPixel = vgetq_lane_u32 (prev, 3);
+#endif
+
+    for (; x < w; ++x)
+    {
+        unsigned int pixel;
+        memcpy (&pixel, in + 4 * x, sizeof (pixel));
+
+        unsigned int diff = pixel - previousPixel;
+        previousPixel     = pixel;
+
+        out[x]         = (unsigned char) (diff >> 24);
+        out[w + x]     = (unsigned char) (diff >> 16);
+        out[2 * w + x] = (unsigned char) (diff >> 8);
+        out[3 * w + x] = (unsigned char) (diff);
+    }
+}
+
+void
+compressHalf (const unsigned char* in, int w, unsigned char* out)
+{
+    unsigned int previousPixel = 0;
+    int          x             = 0;
+
+#if defined(IMF_HAVE_SSE2)
+    const __m128i mask = _mm_set1_epi16 (0xff);
+    __m128i       prev = _mm_setzero_si128 ();
+
+    for (; x + 16 <= w; x += 16)
+    {
+        __m128i p0 = _mm_loadu_si128 ((const __m128i*) (in + 2 * x));
+        __m128i p1 = _mm_loadu_si128 ((const __m128i*) (in + 2 * x + 16));
+        __m128i d0, d1;
+
+        d0 = _mm_or_si128 (_mm_slli_si128 (p0, 2), _mm_srli_si128 (prev, 14));
+        d0 = _mm_sub_epi16 (p0, d0);
+        d1 = _mm_or_si128 (_mm_slli_si128 (p1, 2), _mm_srli_si128 (p0, 14));
+        d1 = _mm_sub_epi16 (p1, d1);
+        prev = p1;
+
+        _mm_storeu_si128 (
+            (__m128i*) (out + x),
+            _mm_packus_epi16 (_mm_srli_epi16 (d0, 8), _mm_srli_epi16 (d1, 8)));
+        _mm_storeu_si128 (
+            (__m128i*) (out + w + x),
+            _mm_packus_epi16 (
+                _mm_and_si128 (d0, mask), _mm_and_si128 (d1, mask)));
+    }
+    previousPixel = (unsigned int) _mm_extract_epi16 (prev, 7);
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    uint16x8_t prev = vdupq_n_u16 (0);
+
+    for (; x + 16 <= w; x += 16)
+    {
+        uint16x8_t p0 = vreinterpretq_u16_u8 (vld1q_u8 (in + 2 * x));
+        uint16x8_t p1 = vreinterpretq_u16_u8 (vld1q_u8 (in + 2 * x + 16));
+        uint16x8_t d0 = vsubq_u16 (p0, vextq_u16 (prev, p0, 7));
+        uint16x8_t d1 = vsubq_u16 (p1, vextq_u16 (p0, p1, 7));
+        prev          = p1;
+
+        vst1q_u8 (
+            out + x, vcombine_u8 (vshrn_n_u16 (d0, 8), vshrn_n_u16 (d1, 8)));
+        vst1q_u8 (out + w + x, vcombine_u8 (vmovn_u16 (d0), vmovn_u16 (d1)));
+    }
+    previousPixel = vgetq_lane_u16 (prev, 7);
+#endif
+
+    for (; x < w; ++x)
+    {
+        unsigned short pixel;
+        memcpy (&pixel, in + 2 * x, sizeof (pixel));
+
+        unsigned int diff = pixel - previousPixel;
+        previousPixel     = pixel;
+
+        out[x]     = (unsigned char) (diff >> 8);
+        out[w + x] = (unsigned char) (diff);
+    }
+}
+
+void
+compressFloat (const unsigned char* in, int w, unsigned char* out)
+{
+    unsigned int previousPixel = 0;
+    int          x             = 0;
+
+#if defined(IMF_HAVE_SSE2)
+    __m128i prev = _mm_setzero_si128 ();
+
+    for (; x + 16 <= w; x += 16)
+    {
+        __m128i p[4], d[4];
+
+        for (int k = 0; k < 4; ++k)
+            p[k] = floatToFloat24_sse2 (
+                _mm_loadu_si128 ((const __m128i*) (in + 4 * x + 16 * k)));
+
+        d[0] = differences32_sse2 (p[0], prev);
+        d[1] = differences32_sse2 (p[1], p[0]);
+        d[2] = differences32_sse2 (p[2], p[1]);
+        d[3] = differences32_sse2 (p[3], p[2]);
+        prev = p[3];
+
+        _mm_storeu_si128 ((__m128i*) (out + x), bytePlane32_sse2 (d, 16));
+        _mm_storeu_si128 ((__m128i*) (out + w + x), bytePlane32_sse2 (d, 8));
+        _mm_storeu_si128 (
+            (__m128i*) (out + 2 * w + x), bytePlane32_sse2 (d, 0));
+    }
+    previousPixel =
+        (unsigned int) _mm_cvtsi128_si32 (_mm_shuffle_epi32 (prev, 0xff));
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    uint32x4_t prev = vdupq_n_u32 (0);
+
+    for (; x + 16 <= w; x += 16)
+    {
+        uint32x4_t p[4], d[4];
+
+        for (int k = 0; k < 4; ++k)
+            p[k] = floatToFloat24_neon (load32_neon (in + 4 * x + 16 * k));
+
+        d[0] = vsubq_u32 (p[0], vextq_u32 (prev, p[0], 3));
+        d[1] = vsubq_u32 (p[1], vextq_u32 (p[0], p[1], 3));
+        d[2] = vsubq_u32 (p[2], vextq_u32 (p[1], p[2], 3));
+        d[3] = vsubq_u32 (p[3], vextq_u32 (p[2], p[3], 3));
+        prev = p[3];
+
+        vst1q_u8 (out + x, bytePlane32_neon (d, 16));
+        vst1q_u8 (out + w + x, bytePlane32_neon (d, 8));
+        vst1q_u8 (out + 2 * w + x, bytePlane32_neon (d, 0));
+    }
+    previousPixel = vgetq_lane_u32 (prev, 3);
+#endif
+
+    for (; x < w; ++x)
+    {
+        float pixel;
+        memcpy (&pixel, in + 4 * x, sizeof (pixel));
+
+        unsigned int pixel24 = floatToFloat24 (pixel);
+        unsigned int diff    = pixel24 - previousPixel;
+        previousPixel        = pixel24;
+
+        out[x]         = (unsigned char) (diff >> 16);
+        out[w + x]     = (unsigned char) (diff >> 8);
+        out[2 * w + x] = (unsigned char) (diff);
+    }
+}
+
+void
+uncompressUint (const unsigned char* in, int w, unsigned char* out)
+{
+    unsigned int pixel = 0;
+    int          x     = 0;
+
+#if defined(IMF_HAVE_SSE2)
+    __m128i prev = _mm_setzero_si128 ();
+
+    for (; x + 16 <= w; x += 16)
+    {
+        prev = undoPlanes32_sse2 (
+            out + 4 * x,
+            _mm_loadu_si128 ((const __m128i*) (in + x)),
+            _mm_loadu_si128 ((const __m128i*) (in + w + x)),
+            _mm_loadu_si128 ((const __m128i*) (in + 2 * w + x)),
+            _mm_loadu_si128 ((const __m128i*) (in + 3 * w + x)),
+            prev);
+    }
+    pixel = (unsigned int) _mm_cvtsi128_si32 (_mm_shuffle_epi32 (prev, 0xff));
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    uint32x4_t prev = vdupq_n_u32 (0);
+
+    for (; x + 16 <= w; x += 16)
+    {
+        prev = undoPlanes32_neon (
+            out + 4 * x,
+            vld1q_u8 (in + x),
+            vld1q_u8 (in + w + x),
+            vld1q_u8 (in + 2 * w + x),
+            vld1q_u8 (in + 3 * w + x),
+            prev);
+    }
+    pixel = vgetq_lane_u32 (prev, 3);
+#endif
+
+    for (; x < w; ++x)
+    {
+        unsigned int diff = (in[x] << 24) | (in[w + x] << 16) |
+                            (in[2 * w + x] << 8) | in[3 * w + x];
+
+        pixel += diff;
+        memcpy (out + 4 * x, &pixel, sizeof (pixel));
+    }
+}
+
+void
+uncompressHalf (const unsigned char* in, int w, unsigned char* out)
+{
+    unsigned int pixel = 0;
+    int          x     = 0;
+
+#if defined(IMF_HAVE_SSE2)
+    __m128i prev = _mm_setzero_si128 ();
+
+    for (; x + 16 <= w; x += 16)
+    {
+        __m128i b0 = _mm_loadu_si128 ((const __m128i*) (in + x));
+        __m128i b1 = _mm_loadu_si128 ((const __m128i*) (in + w + x));
+
+        prev = runningSum16_sse2 (_mm_unpacklo_epi8 (b1, b0), prev);
+        _mm_storeu_si128 ((__m128i*) (out + 2 * x), prev);
+        prev = runningSum16_sse2 (_mm_unpackhi_epi8 (b1, b0), prev);
+        _mm_storeu_si128 ((__m128i*) (out + 2 * x + 16), prev);
+    }
+    pixel = (unsigned int) _mm_extract_epi16 (prev, 7);
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    uint16x8_t prev = vdupq_n_u16 (0);
+
+    for (; x + 16 <= w; x += 16)
+    {
+        uint8x16x2_t px = vzipq_u8 (vld1q_u8 (in + w + x), vld1q_u8 (in + x));
+
+        prev = runningSum16_neon (vreinterpretq_u16_u8 (px.val[0]), prev);
+        vst1q_u8 (out + 2 * x, vreinterpretq_u8_u16 (prev));
+        prev = runningSum16_neon (vreinterpretq_u16_u8 (px.val[1]), prev);
+        vst1q_u8 (out + 2 * x + 16, vreinterpretq_u8_u16 (prev));
+    }
+    pixel = vgetq_lane_u16 (prev, 7);
+#endif
+
+    for (; x < w; ++x)
+    {
+        unsigned int diff = (in[x] << 8) | in[w + x];
+
+        pixel += diff;
+
+        unsigned short bits = pixel;
+        memcpy (out + 2 * x, &bits, sizeof (bits));
+    }
+}
+
+void
+uncompressFloat (const unsigned char* in, int w, unsigned char* out)
+{
+    unsigned int pixel = 0;
+    int          x     = 0;
+
+#if defined(IMF_HAVE_SSE2)
+    __m128i prev = _mm_setzero_si128 ();
+
+    for (; x + 16 <= w; x += 16)
+    {
+        prev = undoPlanes32_sse2 (
+            out + 4 * x,
+            _mm_loadu_si128 ((const __m128i*) (in + x)),
+            _mm_loadu_si128 ((const __m128i*) (in + w + x)),
+            _mm_loadu_si128 ((const __m128i*) (in + 2 * w + x)),
+            _mm_setzero_si128 (),
+            prev);
+    }
+    pixel = (unsigned int) _mm_cvtsi128_si32 (_mm_shuffle_epi32 (prev, 0xff));
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    uint32x4_t prev = vdupq_n_u32 (0);
+
+    for (; x + 16 <= w; x += 16)
+    {
+        prev = undoPlanes32_neon (
+            out + 4 * x,
+            vld1q_u8 (in + x),
+            vld1q_u8 (in + w + x),
+            vld1q_u8 (in + 2 * w + x),
+            vdupq_n_u8 (0),
+            prev);
+    }
+    pixel = vgetq_lane_u32 (prev, 3);
+#endif
+
+    for (; x < w; ++x)
+    {
+        unsigned int diff =
+            (in[x] << 24) | (in[w + x] << 16) | (in[2 * w + x] << 8);
+
+        pixel += diff;
+        memcpy (out + 4 * x, &pixel, sizeof (pixel));
+    }
+}
+
 void
 notEnoughData ()
 {
@@ -255,84 +817,30 @@ Pxr24Compressor::compress (
 
             int n = numSamples (c.xSampling, minX, maxX);
 
-            unsigned char* ptr[4];
-            unsigned int   previousPixel = 0;
-
             switch (c.type)
             {
                 case OPENEXR_IMF_INTERNAL_NAMESPACE::UINT:
 
-                    ptr[0]       = tmpBufferEnd;
-                    ptr[1]       = ptr[0] + n;
-                    ptr[2]       = ptr[1] + n;
-                    ptr[3]       = ptr[2] + n;
-                    tmpBufferEnd = ptr[3] + n;
-
-                    for (int j = 0; j < n; ++j)
-                    {
-                        unsigned int pixel;
-                        char*        pPtr = (char*) &pixel;
-
-                        for (size_t k = 0; k < sizeof (pixel); ++k)
-                            *pPtr++ = *inPtr++;
-
-                        unsigned int diff = pixel - previousPixel;
-                        previousPixel     = pixel;
-
-                        *(ptr[0]++) = diff >> 24;
-                        *(ptr[1]++) = diff >> 16;
-                        *(ptr[2]++) = diff >> 8;
-                        *(ptr[3]++) = diff;
-                    }
-
+                    compressUint (
+                        (const unsigned char*) inPtr, n, tmpBufferEnd);
+                    inPtr += n * sizeof (unsigned int);
+                    tmpBufferEnd += n * sizeof (unsigned int);
                     break;
 
                 case OPENEXR_IMF_INTERNAL_NAMESPACE::HALF:
 
-                    ptr[0]       = tmpBufferEnd;
-                    ptr[1]       = ptr[0] + n;
-                    tmpBufferEnd = ptr[1] + n;
-
-                    for (int j = 0; j < n; ++j)
-                    {
-                        half pixel;
-
-                        pixel = *(const half*) inPtr;
-                        inPtr += sizeof (half);
-
-                        unsigned int diff = pixel.bits () - previousPixel;
-                        previousPixel     = pixel.bits ();
-
-                        *(ptr[0]++) = diff >> 8;
-                        *(ptr[1]++) = diff;
-                    }
-
+                    compressHalf (
+                        (const unsigned char*) inPtr, n, tmpBufferEnd);
+                    inPtr += n * sizeof (half);
+                    tmpBufferEnd += n * sizeof (half);
                     break;
 
                 case OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT:
 
-                    ptr[0]       = tmpBufferEnd;
-                    ptr[1]       = ptr[0] + n;
-                    ptr[2]       = ptr[1] + n;
-                    tmpBufferEnd = ptr[2] + n;
-
-                    for (int j = 0; j < n; ++j)
-                    {
-                        float pixel;
-                        char* pPtr = (char*) &pixel;
-
-                        for (size_t k = 0; k < sizeof (pixel); ++k)
-                            *pPtr++ = *inPtr++;
-
-                        unsigned int pixel24 = floatToFloat24 (pixel);
-                        unsigned int diff    = pixel24 - previousPixel;
-                        previousPixel        = pixel24;
-
-                        *(ptr[0]++) = diff >> 16;
-                        *(ptr[1]++) = diff >> 8;
-                        *(ptr[2]++) = diff;
-                    }
-
+                    compressFloat (
+                        (const unsigned char*) inPtr, n, tmpBufferEnd);
+                    inPtr += n * sizeof (float);
+                    tmpBufferEnd += n * 3;
                     break;
 
                 default: assert (false);
@@ -398,86 +906,44 @@ Pxr24Compressor::uncompress (
 
             int n = numSamples (c.xSampling, minX, maxX);
 
-            const unsigned char* ptr[4];
-            unsigned int         pixel = 0;
+            const unsigned char* ptr = tmpBufferEnd;
 
             switch (c.type)
             {
                 case OPENEXR_IMF_INTERNAL_NAMESPACE::UINT:
 
-                    ptr[0]       = tmpBufferEnd;
-                    ptr[1]       = ptr[0] + n;
-                    ptr[2]       = ptr[1] + n;
-                    ptr[3]       = ptr[2] + n;
-                    tmpBufferEnd = ptr[3] + n;
+                    tmpBufferEnd = ptr + n * sizeof (unsigned int);
 
                     if (static_cast<size_t> (tmpBufferEnd - _tmpBuffer) >
                         tmpSize)
                         notEnoughData ();
 
-                    for (int j = 0; j < n; ++j)
-                    {
-                        unsigned int diff = (*(ptr[0]++) << 24) |
-                                            (*(ptr[1]++) << 16) |
-                                            (*(ptr[2]++) << 8) | *(ptr[3]++);
-
-                        pixel += diff;
-
-                        char* pPtr = (char*) &pixel;
-
-                        for (size_t k = 0; k < sizeof (pixel); ++k)
-                            *writePtr++ = *pPtr++;
-                    }
-
+                    uncompressUint (ptr, n, (unsigned char*) writePtr);
+                    writePtr += n * sizeof (unsigned int);
                     break;
 
                 case OPENEXR_IMF_INTERNAL_NAMESPACE::HALF:
 
-                    ptr[0]       = tmpBufferEnd;
-                    ptr[1]       = ptr[0] + n;
-                    tmpBufferEnd = ptr[1] + n;
+                    tmpBufferEnd = ptr + n * sizeof (half);
 
                     if (static_cast<size_t> (tmpBufferEnd - _tmpBuffer) >
                         tmpSize)
                         notEnoughData ();
 
-                    for (int j = 0; j < n; ++j)
-                    {
-                        unsigned int diff = (*(ptr[0]++) << 8) | *(ptr[1]++);
-
-                        pixel += diff;
-
-                        half* hPtr = (half*) writePtr;
-                        hPtr->setBits ((unsigned short) pixel);
-                        writePtr += sizeof (half);
-                    }
-
+                    uncompressHalf (ptr, n, (unsigned char*) writePtr);
+                    writePtr += n * sizeof (half);
                     break;
 
                 case OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT:
 
-                    ptr[0]       = tmpBufferEnd;
-                    ptr[1]       = ptr[0] + n;
-                    ptr[2]       = ptr[1] + n;
-                    tmpBufferEnd = ptr[2] + n;
+                    tmpBufferEnd = ptr + n * 3;
 
                     if (static_cast<size_t> (tmpBufferEnd - _tmpBuffer) >
                         tmpSize)
                         notEnoughData ();
 
-                    for (int j = 0; j < n; ++j)
-                    {
-                        unsigned int diff = (*(ptr[0]++) << 24) |
-                                            (*(ptr[1]++) << 16) |
-                                            (*(ptr[2]++) << 8);
-                        pixel += diff;
-
-                        char* pPtr = (char*) &pixel;
-
-                        for (size_t k = 0; k < sizeof (pixel); ++k)
-                            *writePtr++ = *pPtr++;
-                    }
-
+                    uncompressFloat (ptr, n, (unsigned char*) writePtr);
+                    writePtr += n * sizeof (float);
                     break;
 
                 default: assert (false);
@@ -5,6 +5,8 @@
 
 #include "ImfRle.h"
 #include "ImfNamespace.h"
+#include "ImfSimd.h"
+#include <cstddef>
 #include <string.h>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
@@ -15,6 +17,91 @@ namespace
 const int MIN_RUN_LENGTH = 3;
 const int MAX_RUN_LENGTH = 127;
 
+//
+// The vector loops below only skip over blocks of 16 bytes which
+// cannot contain the position being looked for, the scalar loops find
+// the exact position, so the output does not depend on the
+// architecture.
+//
+
+//
+// Return the first byte in [p, stop) which differs from v, or stop.
+//
+
+inline const char*
+scanRun (const char* p, const char* stop, char v)
+{
+#if defined(IMF_HAVE_SSE2)
+    const __m128i vv = _mm_set1_epi8 (v);
+
+    while (stop - p >= static_cast<ptrdiff_t> (sizeof (__m128i)))
+    {
+        __m128i in = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (p));
+        if (_mm_movemask_epi8 (_mm_cmpeq_epi8 (in, vv)) != 0xffff) break;
+        p += sizeof (__m128i);
+    }
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    const uint8x16_t vv = vdupq_n_u8 (static_cast<uint8_t> (v));
+
+    while (stop - p >= static_cast<ptrdiff_t> (sizeof (uint8x16_t)))
+    {
+        uint8x16_t in = vld1q_u8 (reinterpret_cast<const uint8_t*> (p));
+        if (vminvq_u8 (vceqq_u8 (in, vv)) != 0xff) break;
+        p += sizeof (uint8x16_t);
+    }
+#endif
+
+    while (p < stop && *p == v)
+        ++p;
+
+    return p;
+}
+
+//
+// Return the first position in [p, stop) starting three equal bytes
+// which all lie before inEnd, or stop.
+//
+
+inline const char*
+scanLiteral (const char* p, const char* stop, const char* inEnd)
+{
+#if defined(IMF_HAVE_SSE2)
+    while (p < stop &&
+           inEnd - p >= static_cast<ptrdiff_t> (sizeof (__m128i) + 2))
+    {
+        __m128i a = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (p));
+        __m128i b = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (p + 1));
+        __m128i c = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (p + 2));
+
+        __m128i eq =
+            _mm_and_si128 (_mm_cmpeq_epi8 (a, b), _mm_cmpeq_epi8 (b, c));
+        if (_mm_movemask_epi8 (eq) != 0) break;
+        p += sizeof (__m128i);
+    }
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    while (p < stop &&
+           inEnd - p >= static_cast<ptrdiff_t> (sizeof (uint8x16_t) + 2))
+    {
+        const uint8_t* in = reinterpret_cast<const uint8_t*> (p);
+
+        uint8x16_t a = vld1q_u8 (in);
+        uint8x16_t b = vld1q_u8 (in + 1);
+        uint8x16_t c = vld1q_u8 (in + 2);
+
+        if (vmaxvq_u8 (vandq_u8 (vceqq_u8 (a, b), vceqq_u8 (b, c))) != 0)
+            break;
+        p += sizeof (uint8x16_t);
+    }
+#endif
+
+    if (p > stop) p = stop;
+
+    while (p < stop && (inEnd - p < 3 || p[0] != p[1] || p[1] != p[2]))
+        ++p;
+
+    return p;
+}
+
 } // namespace
 
 //
@@ -27,16 +114,16 @@ rleCompress (int inLength, const char in[], signed char out[])
 {
     const char*  inEnd    = in + inLength;
     const char*  runStart = in;
-    const char*  runEnd   = in + 1;
     signed char* outWrite = out;
 
     while (runStart < inEnd)
     {
-        while (runEnd < inEnd && *runStart == *runEnd &&
-               runEnd - runStart - 1 < MAX_RUN_LENGTH)
-        {
-            ++runEnd;
-        }
+        const char* runEnd = scanRun (
+            runStart + 1,
+            inEnd - runStart > MAX_RUN_LENGTH + 1
+                ? runStart + MAX_RUN_LENGTH + 1
+                : inEnd,
+            *runStart);
 
         if (runEnd - runStart >= MIN_RUN_LENGTH)
         {
@@ -54,23 +141,18 @@ rleCompress (int inLength, const char in[], signed char out[])
             // Incompressible run
             //
 
-            while (runEnd < inEnd &&
-                   ((runEnd + 1 >= inEnd || *runEnd != *(runEnd + 1)) ||
-                    (runEnd + 2 >= inEnd || *(runEnd + 1) != *(runEnd + 2))) &&
-                   runEnd - runStart < MAX_RUN_LENGTH)
-            {
-                ++runEnd;
-            }
+            runEnd = scanLiteral (
+                runEnd,
+                inEnd - runStart > MAX_RUN_LENGTH ? runStart + MAX_RUN_LENGTH
+                                                  : inEnd,
+                inEnd);
 
             *outWrite++ = runStart - runEnd;
 
-            while (runStart < runEnd)
-            {
-                *outWrite++ = *(signed char*) (runStart++);
-            }
+            memcpy (outWrite, runStart, runEnd - runStart);
+            outWrite += runEnd - runStart;
+            runStart = runEnd;
         }
-
-        ++runEnd;
     }
 
     return outWrite - out;
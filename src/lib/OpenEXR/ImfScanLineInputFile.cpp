@@ -21,6 +21,7 @@
 #include "ImfMisc.h"
 #include "ImfOptimizedPixelReading.h"
 #include "ImfPartType.h"
+#include "ImfPooledTask.h"
 #include "ImfStandardAttributes.h"
 #include "ImfStdIO.h"
 #include "ImfThreading.h"
@@ -447,7 +448,7 @@ readPixelData (
 // scanlines (line buffer) and copying them into the frame buffer.
 //
 
-class LineBufferTask : public Task
+class LineBufferTask : public PooledTask
 {
 public:
     LineBufferTask (
@@ -477,7 +478,7 @@ LineBufferTask::LineBufferTask (
     int                      scanLineMin,
     int                      scanLineMax,
     OptimizationMode         optimizationMode)
-    : Task (group)
+    : PooledTask (group)
     , _ifd (ifd)
     , _lineBuffer (lineBuffer)
     , _scanLineMin (scanLineMin)
@@ -656,7 +657,7 @@ LineBufferTask::execute ()
 // IIF format is more restricted than a perfectly generic one,
 // so it is possible to perform some optimizations.
 //
-class LineBufferTaskIIF : public Task
+class LineBufferTaskIIF : public PooledTask
 {
 public:
     LineBufferTaskIIF (
@@ -702,7 +703,7 @@ LineBufferTaskIIF::LineBufferTaskIIF (
     int                      scanLineMin,
     int                      scanLineMax,
     OptimizationMode         optimizationMode)
-    : Task (group)
+    : PooledTask (group)
     , _ifd (ifd)
     , _lineBuffer (lineBuffer)
     , _scanLineMin (scanLineMin)
@@ -1148,7 +1149,7 @@ ScanLineInputFile::initialize (const Header& header)
 
     Compression comp = _data->header.compression ();
 
-    _data->linesInBuffer = numLinesInBuffer (comp);
+    _data->linesInBuffer = numLinesInBuffer (_data->header);
 
     uint64_t lineOffsetSize = (static_cast<int64_t> (dataWindow.max.y) -
                                static_cast<int64_t> (dataWindow.min.y) +
@@ -1176,7 +1177,7 @@ ScanLineInputFile::initialize (const Header& header)
     size_t maxBytesPerLine =
         bytesPerLineTable (_data->header, _data->bytesPerLine);
 
-    if (maxBytesPerLine * numLinesInBuffer (comp) > INT_MAX)
+    if (maxBytesPerLine * _data->linesInBuffer > INT_MAX)
     {
         throw IEX_NAMESPACE::InputExc (
             "maximum bytes per scanline exceeds maximum permissible size");
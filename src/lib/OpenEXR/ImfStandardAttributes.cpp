@@ -119,5 +119,6 @@ IMF_STD_ATTRIBUTE_IMP (multiView, MultiView, StringVector)
 IMF_STD_ATTRIBUTE_IMP (deepImageState, DeepImageState, DeepImageState)
 IMF_STD_ATTRIBUTE_IMP (dwaCompressionLevel, DwaCompressionLevel, float)
 IMF_STD_ATTRIBUTE_IMP (idManifest, IDManifest, CompressedIDManifest)
+IMF_STD_ATTRIBUTE_IMP (zstdLinesPerChunk, ZstdLinesPerChunk, int)
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
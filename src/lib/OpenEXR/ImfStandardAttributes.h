@@ -724,4 +724,18 @@ IMF_STD_ATTRIBUTE_DEF_DEPRECATED (
 
 IMF_STD_ATTRIBUTE_DEF (idManifest, IDManifest, CompressedIDManifest)
 
+//
+// zstdLinesPerChunk -- the number of scan lines stored in each chunk
+// of a scan line image compressed with ZSTD_COMPRESSION, from 1 to
+// 256.  Images without this attribute store one scan line per chunk,
+// which is what the library writes unless the attribute is set.
+//
+// A value greater than 1 also changes the format of the chunks: they
+// hold plain blosc2 chunks rather than serialized blosc2 frames.
+// Releases of the library that predate the attribute ignore it and
+// cannot read such images.
+//
+
+IMF_STD_ATTRIBUTE_DEF (zstdLinesPerChunk, ZstdLinesPerChunk, int)
+
 #endif
@@ -26,6 +26,7 @@
 #include "ImfMultiPartInputFile.h"
 #include "ImfNamespace.h"
 #include "ImfPartType.h"
+#include "ImfPooledTask.h"
 #include "ImfStdIO.h"
 #include "ImfThreading.h"
 #include "ImfTileDescriptionAttribute.h"
@@ -509,7 +510,7 @@ readNextTileData (
 // a single tile and copying it into the frame buffer.
 //
 
-class TileBufferTask : public Task
+class TileBufferTask : public PooledTask
 {
 public:
     TileBufferTask (
@@ -526,7 +527,7 @@ private:
 
 TileBufferTask::TileBufferTask (
     TaskGroup* group, TiledInputFile::Data* ifd, TileBuffer* tileBuffer)
-    : Task (group), _ifd (ifd), _tileBuffer (tileBuffer)
+    : PooledTask (group), _ifd (ifd), _tileBuffer (tileBuffer)
 {
     // empty
 }
@@ -0,0 +1,929 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+//-----------------------------------------------------------------------------
+//
+//	Generation of the lower resolution levels of tiled files
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfTiledLevels.h"
+
+#include "Iex.h"
+#include "IlmThreadPool.h"
+#include "ImathFun.h"
+#include "ImfChannelList.h"
+#include "ImfFrameBuffer.h"
+#include "ImfHeader.h"
+#include "ImfMisc.h"
+#include "ImfPooledTask.h"
+#include "ImfSimd.h"
+#include "ImfTiledOutputFile.h"
+#include "ImfTiledOutputPart.h"
+#include <half.h>
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+#include "ImfNamespace.h"
+
+#if ILMTHREAD_THREADING_ENABLED
+#    include <mutex>
+#endif
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskGroup;
+using ILMTHREAD_NAMESPACE::ThreadPool;
+using IMATH_NAMESPACE::Box2i;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace
+{
+
+//
+// Number of scan lines of a level that are computed by one task
+//
+
+const int BAND_HEIGHT = 32;
+
+//
+// One channel of a level. Pixel (x, y), relative to the upper
+// left corner of the level, is at base + x * xStride + y * yStride.
+// The storage is empty for the highest resolution level, which
+// lives in the caller's frame buffer.
+//
+
+struct LevelChannel
+{
+    string       name;
+    PixelType    type;
+    bool         filter;
+    char*        base;
+    size_t       xStride;
+    size_t       yStride;
+    vector<char> storage;
+};
+
+struct Level
+{
+    Box2i                dataWindow;
+    int                  width;
+    int                  height;
+    vector<LevelChannel> channels;
+};
+
+void
+allocateLevel (Level& level, const Level& like, const Box2i& dataWindow)
+{
+    level.dataWindow = dataWindow;
+    level.width      = dataWindow.max.x - dataWindow.min.x + 1;
+    level.height     = dataWindow.max.y - dataWindow.min.y + 1;
+    level.channels.resize (like.channels.size ());
+
+    for (size_t i = 0; i < like.channels.size (); ++i)
+    {
+        LevelChannel& c = level.channels[i];
+        size_t        s = pixelTypeSize (like.channels[i].type);
+
+        c.name   = like.channels[i].name;
+        c.type   = like.channels[i].type;
+        c.filter = like.channels[i].filter;
+        c.storage.resize (s * level.width * level.height);
+        c.base    = &c.storage[0];
+        c.xStride = s;
+        c.yStride = s * level.width;
+    }
+}
+
+//
+// The low-pass filter, for one pixel of the shrunk image. The
+// filter has four taps, centered between source pixels, each of
+// which interpolates between two source pixels:
+//
+//   0.125 * (weight[0] * v[0] + weight[1] * v[1]) +
+//   0.375 * (weight[2] * v[2] + weight[3] * v[3]) +
+//   0.375 * (weight[4] * v[4] + weight[5] * v[5]) +
+//   0.125 * (weight[6] * v[6] + weight[7] * v[7])
+//
+// where v[k] is the source pixel at index[k], or 0 if index[k]
+// is -1 (outside of the image, with black extrapolation).
+//
+
+struct Taps
+{
+    int    index[8];
+    double weight[8];
+};
+
+int
+mirror (int x, int w)
+{
+    int d = IMATH_NAMESPACE::divp (x, w);
+    int m = IMATH_NAMESPACE::modp (x, w);
+    return (d & 1) ? w - 1 - m : m;
+}
+
+int
+extrapolate (int x, int w, LevelExtrapolation ext)
+{
+    switch (ext)
+    {
+        case EXTRAPOLATE_BLACK: return (x >= 0 && x < w) ? x : -1;
+        case EXTRAPOLATE_PERIODIC: return IMATH_NAMESPACE::modp (x, w);
+        case EXTRAPOLATE_MIRROR: return mirror (x, w);
+        default: return IMATH_NAMESPACE::clamp (x, 0, w - 1);
+    }
+}
+
+void
+computeTaps (int n0, int n1, LevelExtrapolation ext, vector<Taps>& taps)
+{
+    //
+    // For pixels 0 and n1 - 1 of the shrunk image, the filter
+    // is centered on pixels 0.5 and n0 - 1.5 of the source.
+    //
+
+    double f = (n1 > 1) ? double (n0 - 2) / (n1 - 1) : 1;
+
+    taps.resize (n1);
+
+    for (int i = 0; i < n1; ++i)
+    {
+        double x = i * f;
+
+        for (int k = 0; k < 4; ++k)
+        {
+            double p  = x + (k - 1);
+            int    ps = IMATH_NAMESPACE::floor (p);
+            int    pt = ps + 1;
+            double s  = pt - p;
+
+            taps[i].index[2 * k]      = extrapolate (ps, n0, ext);
+            taps[i].index[2 * k + 1]  = extrapolate (pt, n0, ext);
+            taps[i].weight[2 * k]     = s;
+            taps[i].weight[2 * k + 1] = 1 - s;
+        }
+    }
+}
+
+//
+// The filter is evaluated in double precision, two pixels at a
+// time. The order of the operations is fixed, so the result does
+// not depend on the instruction set.
+//
+
+#if defined IMF_HAVE_SSE2
+
+typedef __m128d Double2;
+
+inline Double2
+set1 (double v)
+{
+    return _mm_set1_pd (v);
+}
+
+inline Double2
+set2 (double v0, double v1)
+{
+    return _mm_set_pd (v1, v0);
+}
+
+inline Double2
+add2 (Double2 a, Double2 b)
+{
+    return _mm_add_pd (a, b);
+}
+
+inline Double2
+mul2 (Double2 a, Double2 b)
+{
+    return _mm_mul_pd (a, b);
+}
+
+inline void
+storeDouble2 (double* p, Double2 v)
+{
+    _mm_storeu_pd (p, v);
+}
+
+#elif defined IMF_HAVE_NEON_AARCH64
+
+typedef float64x2_t Double2;
+
+inline Double2
+set1 (double v)
+{
+    return vdupq_n_f64 (v);
+}
+
+inline Double2
+set2 (double v0, double v1)
+{
+    return vcombine_f64 (vdup_n_f64 (v0), vdup_n_f64 (v1));
+}
+
+inline Double2
+add2 (Double2 a, Double2 b)
+{
+    return vaddq_f64 (a, b);
+}
+
+inline Double2
+mul2 (Double2 a, Double2 b)
+{
+    return vmulq_f64 (a, b);
+}
+
+inline void
+storeDouble2 (double* p, Double2 v)
+{
+    vst1q_f64 (p, v);
+}
+
+#else
+
+struct Double2
+{
+    double v[2];
+};
+
+inline Double2
+set2 (double v0, double v1)
+{
+    Double2 r = {{v0, v1}};
+    return r;
+}
+
+inline Double2
+set1 (double v)
+{
+    return set2 (v, v);
+}
+
+inline Double2
+add2 (Double2 a, Double2 b)
+{
+    return set2 (a.v[0] + b.v[0], a.v[1] + b.v[1]);
+}
+
+inline Double2
+mul2 (Double2 a, Double2 b)
+{
+    return set2 (a.v[0] * b.v[0], a.v[1] * b.v[1]);
+}
+
+inline void
+storeDouble2 (double* p, Double2 v)
+{
+    p[0] = v.v[0];
+    p[1] = v.v[1];
+}
+
+#endif
+
+//
+// Load two adjacent pixels
+//
+
+template <class T>
+inline Double2
+load2 (const T* p)
+{
+    return set2 (double (p[0]), double (p[1]));
+}
+
+#if defined IMF_HAVE_SSE2
+
+template <>
+inline Double2
+load2<float> (const float* p)
+{
+    return _mm_cvtps_pd (
+        _mm_castsi128_ps (_mm_loadl_epi64 ((const __m128i*) p)));
+}
+
+#elif defined IMF_HAVE_NEON_AARCH64
+
+template <>
+inline Double2
+load2<float> (const float* p)
+{
+    return vcvt_f64_f32 (vld1_f32 (p));
+}
+
+#endif
+
+template <class T>
+inline void
+storeLanes (T* p0, T* p1, Double2 v)
+{
+    double d[2];
+    storeDouble2 (d, v);
+    *p0 = T (d[0]);
+    *p1 = T (d[1]);
+}
+
+inline Double2
+filter (const Double2 v[8], const double weight[8])
+{
+    Double2 a = add2 (
+        mul2 (set1 (weight[0]), v[0]), mul2 (set1 (weight[1]), v[1]));
+    Double2 b = add2 (
+        mul2 (set1 (weight[2]), v[2]), mul2 (set1 (weight[3]), v[3]));
+    Double2 c = add2 (
+        mul2 (set1 (weight[4]), v[4]), mul2 (set1 (weight[5]), v[5]));
+    Double2 d = add2 (
+        mul2 (set1 (weight[6]), v[6]), mul2 (set1 (weight[7]), v[7]));
+
+    return add2 (
+        add2 (
+            add2 (mul2 (set1 (0.125), a), mul2 (set1 (0.375), b)),
+            mul2 (set1 (0.375), c)),
+        mul2 (set1 (0.125), d));
+}
+
+//
+// The shrinking of one level in to the next, horizontally,
+// vertically, or both.
+//
+
+struct Reduction
+{
+    const Level* src;
+    Level*       dst;
+
+    bool         inX;
+    bool         inY;
+    vector<Taps> tapsX;
+    vector<Taps> tapsY;
+
+    //
+    // For the channels that are not low-pass filtered, pixel i
+    // of the shrunk image is pixel 2 * i + offset of the source.
+    //
+
+    int offsetX;
+    int offsetY;
+
+#if ILMTHREAD_THREADING_ENABLED
+    std::mutex mutex;
+#endif
+    bool   hasException;
+    string exception;
+};
+
+template <class T>
+inline T
+pixel (const char* row, size_t xStride, int x)
+{
+    return *(const T*) (row + x * xStride);
+}
+
+template <class T>
+inline Double2
+sample2 (const char* row0, const char* row1, size_t xStride, int x)
+{
+    if (x < 0) return set1 (0.0);
+
+    return set2 (
+        double (pixel<T> (row0, xStride, x)),
+        double (pixel<T> (row1, xStride, x)));
+}
+
+//
+// Shrink two rows of a channel horizontally. The rows
+// may be the same, dst1 must then be the same as dst0.
+//
+
+template <class T>
+void
+reduceRowsX (
+    const Reduction&    r,
+    const LevelChannel& c,
+    const char*         src0,
+    const char*         src1,
+    T*                  dst0,
+    T*                  dst1)
+{
+    int    w = r.dst->width;
+    size_t s = c.xStride;
+
+    if (!c.filter)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            dst0[x] = pixel<T> (src0, s, 2 * x + r.offsetX);
+            dst1[x] = pixel<T> (src1, s, 2 * x + r.offsetX);
+        }
+
+        return;
+    }
+
+    for (int x = 0; x < w; ++x)
+    {
+        const Taps& t = r.tapsX[x];
+        Double2     v[8];
+
+        for (int k = 0; k < 8; ++k)
+            v[k] = sample2<T> (src0, src1, s, t.index[k]);
+
+        storeLanes (dst0 + x, dst1 + x, filter (v, t.weight));
+    }
+}
+
+//
+// Compute one row of a channel shrunk vertically, from
+// the eight source rows the filter taps refer to
+//
+
+template <class T>
+void
+filterRowY (T* dst, const T* const src[8], const double weight[8], int w)
+{
+    int     x = 0;
+    Double2 v[8];
+
+    for (; x + 2 <= w; x += 2)
+    {
+        for (int k = 0; k < 8; ++k)
+            v[k] = load2 (src[k] + x);
+
+        storeLanes (dst + x, dst + x + 1, filter (v, weight));
+    }
+
+    for (; x < w; ++x)
+    {
+        for (int k = 0; k < 8; ++k)
+            v[k] = set1 (double (src[k][x]));
+
+        storeLanes (dst + x, dst + x, filter (v, weight));
+    }
+}
+
+//
+// Compute scan lines y0 to y1 - 1 of a channel of the shrunk level
+//
+
+template <class T>
+void
+reduceBand (
+    const Reduction&    r,
+    const LevelChannel& sc,
+    LevelChannel&       dc,
+    int                 y0,
+    int                 y1,
+    vector<char>&       scratch)
+{
+    int w = r.dst->width;
+
+    if (!r.inY)
+    {
+        for (int y = y0; y < y1; y += 2)
+        {
+            int yy = std::min (y + 1, y1 - 1);
+
+            reduceRowsX<T> (
+                r,
+                sc,
+                sc.base + y * sc.yStride,
+                sc.base + yy * sc.yStride,
+                (T*) (dc.base + y * dc.yStride),
+                (T*) (dc.base + yy * dc.yStride));
+        }
+
+        return;
+    }
+
+    //
+    // Find the source rows the band needs, and if the source must
+    // be shrunk horizontally first, or its pixels are not adjacent,
+    // put them in the scratch buffer.
+    //
+
+    vector<int> rows;
+    bool        black = false;
+
+    for (int y = y0; y < y1; ++y)
+    {
+        if (!sc.filter)
+        {
+            rows.push_back (2 * y + r.offsetY);
+            continue;
+        }
+
+        for (int k = 0; k < 8; ++k)
+        {
+            int i = r.tapsY[y].index[k];
+
+            if (i >= 0)
+                rows.push_back (i);
+            else
+                black = true;
+        }
+    }
+
+    std::sort (rows.begin (), rows.end ());
+    rows.erase (std::unique (rows.begin (), rows.end ()), rows.end ());
+
+    int              n = (int) rows.size ();
+    vector<const T*> rowPtrs (n);
+
+    if (r.inX || sc.xStride != sizeof (T))
+    {
+        scratch.resize ((n + 1) * w * sizeof (T));
+        T* buf = (T*) &scratch[0];
+
+        for (int i = 0; i < n; i += 2)
+        {
+            int j = std::min (i + 1, n - 1);
+
+            const char* src0 = sc.base + rows[i] * sc.yStride;
+            const char* src1 = sc.base + rows[j] * sc.yStride;
+
+            if (r.inX)
+            {
+                reduceRowsX<T> (r, sc, src0, src1, buf + i * w, buf + j * w);
+            }
+            else
+            {
+                for (int x = 0; x < w; ++x)
+                {
+                    buf[i * w + x] = pixel<T> (src0, sc.xStride, x);
+                    buf[j * w + x] = pixel<T> (src1, sc.xStride, x);
+                }
+            }
+        }
+
+        for (int i = 0; i < n; ++i)
+            rowPtrs[i] = buf + i * w;
+    }
+    else
+    {
+        for (int i = 0; i < n; ++i)
+            rowPtrs[i] = (const T*) (sc.base + rows[i] * sc.yStride);
+    }
+
+    //
+    // The row after the source rows is all zeros, for
+    // black extrapolation
+    //
+
+    const T* zeros = 0;
+
+    if (black)
+    {
+        if (scratch.size () < (n + 1) * w * sizeof (T))
+            scratch.resize ((n + 1) * w * sizeof (T));
+
+        T* z = (T*) &scratch[0] + n * w;
+
+        for (int x = 0; x < w; ++x)
+            z[x] = T (0);
+
+        zeros = z;
+    }
+
+    for (int y = y0; y < y1; ++y)
+    {
+        T* dst = (T*) (dc.base + y * dc.yStride);
+
+        if (!sc.filter)
+        {
+            int i = int (
+                std::lower_bound (
+                    rows.begin (), rows.end (), 2 * y + r.offsetY) -
+                rows.begin ());
+
+            memcpy (dst, rowPtrs[i], w * sizeof (T));
+            continue;
+        }
+
+        const Taps& t = r.tapsY[y];
+        const T*    src[8];
+
+        for (int k = 0; k < 8; ++k)
+        {
+            if (t.index[k] < 0)
+            {
+                src[k] = zeros;
+            }
+            else
+            {
+                int i = int (
+                    std::lower_bound (rows.begin (), rows.end (), t.index[k]) -
+                    rows.begin ());
+
+                src[k] = rowPtrs[i];
+            }
+        }
+
+        filterRowY (dst, src, t.weight, w);
+    }
+}
+
+class ReduceTask : public PooledTask
+{
+public:
+    ReduceTask (TaskGroup* group, Reduction* reduction, int y0, int y1)
+        : PooledTask (group), _reduction (reduction), _y0 (y0), _y1 (y1)
+    {}
+
+    virtual void execute ();
+
+private:
+    Reduction* _reduction;
+    int        _y0;
+    int        _y1;
+};
+
+void
+ReduceTask::execute ()
+{
+    const Reduction& r = *_reduction;
+
+    try
+    {
+        vector<char> scratch;
+
+        for (size_t i = 0; i < r.src->channels.size (); ++i)
+        {
+            const LevelChannel& sc = r.src->channels[i];
+            LevelChannel&       dc = r.dst->channels[i];
+
+            switch (sc.type)
+            {
+                case HALF:
+                    reduceBand<half> (r, sc, dc, _y0, _y1, scratch);
+                    break;
+
+                case FLOAT:
+                    reduceBand<float> (r, sc, dc, _y0, _y1, scratch);
+                    break;
+
+                case UINT:
+                    reduceBand<unsigned int> (r, sc, dc, _y0, _y1, scratch);
+                    break;
+
+                default: break;
+            }
+        }
+    }
+    catch (std::exception& e)
+    {
+#if ILMTHREAD_THREADING_ENABLED
+        std::lock_guard<std::mutex> lock (_reduction->mutex);
+#endif
+        if (!_reduction->hasException)
+        {
+            _reduction->exception    = e.what ();
+            _reduction->hasException = true;
+        }
+    }
+    catch (...)
+    {
+#if ILMTHREAD_THREADING_ENABLED
+        std::lock_guard<std::mutex> lock (_reduction->mutex);
+#endif
+        if (!_reduction->hasException)
+        {
+            _reduction->exception    = "unrecognized exception";
+            _reduction->hasException = true;
+        }
+    }
+}
+
+//
+// Shrink level src by a factor of two, horizontally if inX
+// is set, and vertically if inY is set, in to level dst.
+//
+
+void
+reduceLevel (
+    const Level&       src,
+    Level&             dst,
+    bool               inX,
+    bool               inY,
+    LevelExtrapolation extX,
+    LevelExtrapolation extY,
+    bool               odd)
+{
+    Reduction r;
+
+    r.src          = &src;
+    r.dst          = &dst;
+    r.inX          = inX;
+    r.inY          = inY;
+    r.offsetX      = 0;
+    r.offsetY      = 0;
+    r.hasException = false;
+
+    //
+    // In order to keep the image from sliding to the right, or
+    // towards the top, if the channel is resampled repeatedly,
+    // the unfiltered channels skip the last pixel of every row or
+    // column on even passes, and the first one on odd passes.
+    //
+
+    if (inX)
+    {
+        computeTaps (src.width, dst.width, extX, r.tapsX);
+        if (odd) r.offsetX = (src.width - 1) - 2 * (dst.width - 1);
+    }
+
+    if (inY)
+    {
+        computeTaps (src.height, dst.height, extY, r.tapsY);
+        if (odd) r.offsetY = (src.height - 1) - 2 * (dst.height - 1);
+    }
+
+    //
+    // The destructor of the task group waits
+    // until all the bands are done.
+    //
+
+    {
+        TaskGroup taskGroup;
+
+        for (int y = 0; y < dst.height; y += BAND_HEIGHT)
+        {
+            ThreadPool::addGlobalTask (new ReduceTask (
+                &taskGroup, &r, y, std::min (y + BAND_HEIGHT, dst.height)));
+        }
+    }
+
+    if (r.hasException) throw IEX_NAMESPACE::BaseExc (r.exception);
+}
+
+template <class TiledOutput>
+void
+writeLevel (TiledOutput& out, const Level& level, int lx, int ly)
+{
+    FrameBuffer fb;
+
+    for (size_t i = 0; i < level.channels.size (); ++i)
+    {
+        const LevelChannel& c = level.channels[i];
+
+        fb.insert (
+            c.name,
+            Slice::Make (
+                c.type, c.base, level.dataWindow, c.xStride, c.yStride));
+    }
+
+    out.setFrameBuffer (fb);
+    out.writeTiles (
+        0, out.numXTiles (lx) - 1, 0, out.numYTiles (ly) - 1, lx, ly);
+}
+
+template <class TiledOutput>
+void
+writeLevels (
+    TiledOutput&       out,
+    const FrameBuffer& frameBuffer,
+    LevelExtrapolation extX,
+    LevelExtrapolation extY,
+    const set<string>& doNotFilter)
+{
+    //
+    // The highest resolution level is in the frame buffer
+    //
+
+    Level level0;
+
+    level0.dataWindow = out.dataWindowForLevel (0, 0);
+    level0.width      = out.levelWidth (0);
+    level0.height     = out.levelHeight (0);
+
+    const ChannelList& channels = out.header ().channels ();
+
+    for (ChannelList::ConstIterator i = channels.begin ();
+         i != channels.end ();
+         ++i)
+    {
+        const Slice* slice = frameBuffer.findSlice (i.name ());
+
+        if (!slice) continue;
+
+        if (slice->xSampling != 1 || slice->ySampling != 1 ||
+            slice->xTileCoords || slice->yTileCoords)
+        {
+            THROW (
+                IEX_NAMESPACE::ArgExc,
+                "Cannot generate the levels of image channel \""
+                    << i.name ()
+                    << "\". The frame buffer slice is sub-sampled, "
+                       "or uses tile coordinates.");
+        }
+
+        LevelChannel c;
+
+        c.name    = i.name ();
+        c.type    = slice->type;
+        c.filter  = doNotFilter.find (c.name) == doNotFilter.end ();
+        c.xStride = slice->xStride;
+        c.yStride = slice->yStride;
+        c.base    = (char*) ((intptr_t) slice->base +
+                          (intptr_t) level0.dataWindow.min.x *
+                              (intptr_t) slice->xStride +
+                          (intptr_t) level0.dataWindow.min.y *
+                              (intptr_t) slice->yStride);
+
+        level0.channels.push_back (c);
+    }
+
+    out.setFrameBuffer (frameBuffer);
+    out.writeTiles (0, out.numXTiles (0) - 1, 0, out.numYTiles (0) - 1, 0);
+
+    if (out.levelMode () == MIPMAP_LEVELS)
+    {
+        Level        levels[2];
+        const Level* src = &level0;
+
+        for (int l = 1; l < out.numLevels (); ++l)
+        {
+            Level& dst = levels[l & 1];
+
+            allocateLevel (dst, level0, out.dataWindowForLevel (l, l));
+            reduceLevel (*src, dst, true, true, extX, extY, l & 1);
+            writeLevel (out, dst, l, l);
+
+            src = &dst;
+        }
+    }
+    else if (out.levelMode () == RIPMAP_LEVELS)
+    {
+        //
+        // For each row of levels, shrink the first level vertically
+        // to get the first level of the next row, and horizontally
+        // to get the rest of the row.
+        //
+
+        Level        columnLevels[2];
+        Level        rowLevels[2];
+        const Level* first = &level0;
+
+        for (int ly = 0; ly < out.numYLevels (); ++ly)
+        {
+            if (ly > 0) writeLevel (out, *first, 0, ly);
+
+            const Level* src = first;
+
+            for (int lx = 1; lx < out.numXLevels (); ++lx)
+            {
+                Level& dst = rowLevels[lx & 1];
+
+                allocateLevel (dst, level0, out.dataWindowForLevel (lx, ly));
+                reduceLevel (*src, dst, true, false, extX, extY, (lx - 1) & 1);
+                writeLevel (out, dst, lx, ly);
+
+                src = &dst;
+            }
+
+            if (ly < out.numYLevels () - 1)
+            {
+                Level& next = columnLevels[ly & 1];
+
+                allocateLevel (
+                    next, level0, out.dataWindowForLevel (0, ly + 1));
+                reduceLevel (*first, next, false, true, extX, extY, ly & 1);
+
+                first = &next;
+            }
+        }
+    }
+
+    out.setFrameBuffer (frameBuffer);
+}
+
+} // namespace
+
+void
+writeTiledLevels (
+    TiledOutputFile&   out,
+    const FrameBuffer& frameBuffer,
+    LevelExtrapolation extX,
+    LevelExtrapolation extY,
+    const set<string>& doNotFilter)
+{
+    writeLevels (out, frameBuffer, extX, extY, doNotFilter);
+}
+
+void
+writeTiledLevels (
+    TiledOutputPart&   out,
+    const FrameBuffer& frameBuffer,
+    LevelExtrapolation extX,
+    LevelExtrapolation extY,
+    const set<string>& doNotFilter)
+{
+    writeLevels (out, frameBuffer, extX, extY, doNotFilter);
+}
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
@@ -0,0 +1,79 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_TILED_LEVELS_H
+#define INCLUDED_IMF_TILED_LEVELS_H
+
+//-----------------------------------------------------------------------------
+//
+//	Generation of the lower resolution levels of MIPMAP_LEVELS
+//	and RIPMAP_LEVELS tiled files.
+//
+//	writeTiledLevels() takes the highest resolution level of an
+//	image in a frame buffer, and writes it, as well as all the
+//	lower resolution levels of the file, which it computes by
+//	repeatedly shrinking the image by a factor of two:
+//
+//	    TiledOutputFile out (fileName, header);
+//	    writeTiledLevels (out, frameBuffer);
+//
+//	Each level is low-pass filtered with a four-tap filter from
+//	the one above it. The filter takes samples outside the image,
+//	extX and extY specify how the image is extrapolated
+//	horizontally and vertically to provide those.
+//
+//	The channels named in doNotFilter are resampled without
+//	low-pass filtering, by skipping every other pixel. This is
+//	useful for channels which must not be blended, such as
+//	object ids.
+//
+//	The filtering is done in the pixel type of the frame buffer
+//	slices, and is split in bands of scan lines that are processed
+//	in parallel by the global thread pool (see ImfThreading.h).
+//	Apart from the frame buffer holding the highest resolution
+//	level, no more than two levels of the image (or for ripmaps,
+//	four) are held in memory at once.
+//
+//	The output file's frame buffer is set to frameBuffer on return.
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfExport.h"
+#include "ImfForward.h"
+
+#include <set>
+#include <string>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+enum IMF_EXPORT_ENUM LevelExtrapolation
+{
+    EXTRAPOLATE_BLACK    = 0, // pixels outside the image are 0
+    EXTRAPOLATE_CLAMP    = 1, // repeat the pixels at the edges
+    EXTRAPOLATE_PERIODIC = 2, // the image wraps around
+    EXTRAPOLATE_MIRROR   = 3, // the image is mirrored at the edges
+
+    NUM_EXTRAPOLATIONS // number of different extrapolations
+};
+
+IMF_EXPORT
+void writeTiledLevels (
+    TiledOutputFile&             out,
+    const FrameBuffer&           frameBuffer,
+    LevelExtrapolation           extX        = EXTRAPOLATE_CLAMP,
+    LevelExtrapolation           extY        = EXTRAPOLATE_CLAMP,
+    const std::set<std::string>& doNotFilter = std::set<std::string> ());
+
+IMF_EXPORT
+void writeTiledLevels (
+    TiledOutputPart&             out,
+    const FrameBuffer&           frameBuffer,
+    LevelExtrapolation           extX        = EXTRAPOLATE_CLAMP,
+    LevelExtrapolation           extY        = EXTRAPOLATE_CLAMP,
+    const std::set<std::string>& doNotFilter = std::set<std::string> ());
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
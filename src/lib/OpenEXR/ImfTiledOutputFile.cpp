@@ -24,6 +24,7 @@
 #include <ImfInputPart.h>
 #include <ImfMisc.h>
 #include <ImfPartType.h>
+#include <ImfPooledTask.h>
 #include <ImfPreviewImageAttribute.h>
 #include <ImfStdIO.h>
 #include <ImfThreading.h>
@@ -38,7 +39,7 @@
 #include <algorithm>
 #include <assert.h>
 #include <fstream>
-#include <map>
+#include <stdio.h>
 #include <string>
 #include <vector>
 
@@ -56,7 +57,6 @@ using ILMTHREAD_NAMESPACE::TaskGroup;
 using ILMTHREAD_NAMESPACE::ThreadPool;
 using IMATH_NAMESPACE::Box2i;
 using IMATH_NAMESPACE::V2i;
-using std::map;
 using std::max;
 using std::min;
 using std::string;
@@ -112,13 +112,6 @@ struct TileCoord
         // empty
     }
 
-    bool operator< (const TileCoord& other) const
-    {
-        return (ly < other.ly) || (ly == other.ly && lx < other.lx) ||
-               ((ly == other.ly && lx == other.lx) &&
-                ((dy < other.dy) || (dy == other.dy && dx < other.dx)));
-    }
-
     bool operator== (const TileCoord& other) const
     {
         return lx == other.lx && ly == other.ly && dx == other.dx &&
@@ -126,28 +119,23 @@ struct TileCoord
     }
 };
 
+//
+// A tile that was written before its turn, kept either in memory
+// or, when the memory budget is exhausted, in the spill file.
+// BufferedTiles are recycled, and pixelData keeps its capacity
+// while that fits in the budget.
+//
+
 struct BufferedTile
 {
-    char* pixelData;
-    int   pixelDataSize;
-
-    BufferedTile (const char* data, int size)
-        : pixelData (0), pixelDataSize (size)
-    {
-        pixelData = new char[pixelDataSize];
-        memcpy (pixelData, data, pixelDataSize);
-    }
-
-    ~BufferedTile () { delete[] pixelData; }
+    vector<char> pixelData;
+    int          pixelDataSize;
+    bool         spilled;
+    uint64_t     spillOffset; // position in the spill file
 
-    BufferedTile (const BufferedTile& other)            = delete;
-    BufferedTile& operator= (const BufferedTile& other) = delete;
-    BufferedTile (BufferedTile&& other)                 = delete;
-    BufferedTile& operator= (BufferedTile&& other)      = delete;
+    BufferedTile () : pixelDataSize (0), spilled (false), spillOffset (0) {}
 };
 
-typedef map<TileCoord, BufferedTile*> TileMap;
-
 struct TileBuffer
 {
     Array<char> buffer;
@@ -219,8 +207,27 @@ struct TiledOutputFile::Data
 
     uint64_t tileOffsetsPosition; // position of the tile index
 
-    TileMap   tileMap;
-    TileCoord nextTileToWrite;
+    //
+    // Unless the line order is RANDOM_Y, tiles that are written
+    // before nextTileToWrite are buffered in bufferedTiles, which
+    // has a slot for every tile in the file (see tileIndex()).
+    // Buffered tiles are taken from, and returned to, tilePool.
+    //
+
+    vector<BufferedTile*> bufferedTiles;
+    vector<BufferedTile*> tilePool;
+    vector<int>           levelFirstTile; // slot of the first tile of
+                                          // each level
+    TileCoord             nextTileToWrite;
+
+    size_t       tileBufferBudget;  // max. bytes of buffered tiles
+                                    // in memory, 0 for no limit
+    size_t       bufferedTileBytes; // capacity of buffered tiles
+    size_t       pooledTileBytes;   // capacity of tiles in tilePool
+    FILE*        spillFile;         // holds tiles beyond the budget
+    uint64_t     spillFileSize;
+    int          numSpilledTiles;
+    vector<char> spillBuffer; // to read spilled tiles back
 
     int partNumber; // the output part number
 
@@ -238,6 +245,10 @@ struct TiledOutputFile::Data
     // vector of tile buffers
 
     TileCoord nextTileCoord (const TileCoord& a);
+
+    int tileIndex (const TileCoord& a) const;
+    // slot of a tile in bufferedTiles,
+    // or -1 for a tile past the last one
 };
 
 TiledOutputFile::Data::Data (int numThreads)
@@ -245,6 +256,12 @@ TiledOutputFile::Data::Data (int numThreads)
     , numXTiles (0)
     , numYTiles (0)
     , tileOffsetsPosition (0)
+    , tileBufferBudget (0)
+    , bufferedTileBytes (0)
+    , pooledTileBytes (0)
+    , spillFile (0)
+    , spillFileSize (0)
+    , numSpilledTiles (0)
     , partNumber (-1)
 {
     //
@@ -264,8 +281,13 @@ TiledOutputFile::Data::~Data ()
     // Delete all the tile buffers, if any still happen to exist
     //
 
-    for (TileMap::iterator i = tileMap.begin (); i != tileMap.end (); ++i)
-        delete i->second;
+    for (size_t i = 0; i < bufferedTiles.size (); i++)
+        delete bufferedTiles[i];
+
+    for (size_t i = 0; i < tilePool.size (); i++)
+        delete tilePool[i];
+
+    if (spillFile) fclose (spillFile);
 
     for (size_t i = 0; i < tileBuffers.size (); i++)
         delete tileBuffers[i];
@@ -277,6 +299,15 @@ TiledOutputFile::Data::getTileBuffer (int number)
     return tileBuffers[number % tileBuffers.size ()];
 }
 
+int
+TiledOutputFile::Data::tileIndex (const TileCoord& a) const
+{
+    if (a.lx >= numXLevels || a.ly >= numYLevels) return -1;
+
+    return levelFirstTile[a.ly * numXLevels + a.lx] + a.dy * numXTiles[a.lx] +
+           a.dx;
+}
+
 TileCoord
 TiledOutputFile::Data::nextTileCoord (const TileCoord& a)
 {
@@ -438,6 +469,191 @@ writeTileData (
     if (ofd->multipart) { streamData->currentPosition += Xdr::size<int> (); }
 }
 
+bool
+seekSpillFile (FILE* file, uint64_t position)
+{
+#ifdef _WIN32
+    return _fseeki64 (file, (__int64) position, SEEK_SET) == 0;
+#else
+    return fseeko (file, (off_t) position, SEEK_SET) == 0;
+#endif
+}
+
+void
+releasePixelData (BufferedTile* tile)
+{
+    vector<char> ().swap (tile->pixelData);
+}
+
+void
+returnToTilePool (TiledOutputFile::Data* ofd, BufferedTile* tile)
+{
+    //
+    // Keep the tile's memory for re-use only while everything held
+    // in memory stays within the budget.
+    //
+
+    if (ofd->tileBufferBudget > 0 &&
+        ofd->bufferedTileBytes + ofd->pooledTileBytes +
+                tile->pixelData.capacity () >
+            ofd->tileBufferBudget)
+    {
+        releasePixelData (tile);
+    }
+
+    ofd->pooledTileBytes += tile->pixelData.capacity ();
+    ofd->tilePool.push_back (tile);
+}
+
+void
+releaseTilePool (TiledOutputFile::Data* ofd)
+{
+    for (size_t i = 0; i < ofd->tilePool.size (); i++)
+        releasePixelData (ofd->tilePool[i]);
+
+    ofd->pooledTileBytes = 0;
+}
+
+void
+bufferTile (
+    TiledOutputFile::Data* ofd,
+    int                    index,
+    const char             pixelData[],
+    int                    pixelDataSize)
+{
+    //
+    // Copy the pixel data of a tile that cannot be written yet into
+    // a BufferedTile from the pool, or if that would exceed the memory
+    // budget, append it to the spill file.  The budget covers the
+    // capacity of the buffers, including those idle in the pool.
+    //
+
+    BufferedTile* tile;
+
+    if (ofd->tilePool.empty ()) { tile = new BufferedTile; }
+    else
+    {
+        tile = ofd->tilePool.back ();
+        ofd->tilePool.pop_back ();
+        ofd->pooledTileBytes -= tile->pixelData.capacity ();
+    }
+
+    tile->pixelDataSize = pixelDataSize;
+    tile->spilled       = false;
+
+    if (ofd->tileBufferBudget > 0)
+    {
+        size_t budget = ofd->tileBufferBudget;
+        size_t needed =
+            max (tile->pixelData.capacity (), size_t (pixelDataSize));
+
+        if (ofd->bufferedTileBytes + ofd->pooledTileBytes + needed > budget)
+            releaseTilePool (ofd);
+
+        if (ofd->bufferedTileBytes + needed > budget)
+        {
+            releasePixelData (tile);
+            tile->spilled =
+                ofd->bufferedTileBytes + size_t (pixelDataSize) > budget;
+        }
+    }
+
+    try
+    {
+        if (tile->spilled)
+        {
+            if (!ofd->spillFile)
+            {
+                ofd->spillFile = tmpfile ();
+                if (!ofd->spillFile) IEX_NAMESPACE::throwErrnoExc ();
+            }
+
+            if (!seekSpillFile (ofd->spillFile, ofd->spillFileSize) ||
+                fwrite (pixelData, 1, pixelDataSize, ofd->spillFile) !=
+                    size_t (pixelDataSize))
+            {
+                IEX_NAMESPACE::throwErrnoExc ();
+            }
+
+            tile->spillOffset = ofd->spillFileSize;
+            ofd->spillFileSize += pixelDataSize;
+            ofd->numSpilledTiles++;
+        }
+        else
+        {
+            tile->pixelData.assign (pixelData, pixelData + pixelDataSize);
+            ofd->bufferedTileBytes += tile->pixelData.capacity ();
+        }
+    }
+    catch (...)
+    {
+        returnToTilePool (ofd, tile);
+        throw;
+    }
+
+    ofd->bufferedTiles[index] = tile;
+}
+
+void
+writeBufferedTile (
+    OutputStreamMutex*     streamData,
+    TiledOutputFile::Data* ofd,
+    const TileCoord&       coord,
+    int                    index)
+{
+    //
+    // Write a buffered tile to the file, and return its BufferedTile
+    // to the pool.
+    //
+
+    BufferedTile* tile = ofd->bufferedTiles[index];
+    const char*   data = tile->pixelData.data ();
+
+    if (tile->spilled)
+    {
+        ofd->spillBuffer.resize (tile->pixelDataSize);
+        data = ofd->spillBuffer.data ();
+
+        if (!seekSpillFile (ofd->spillFile, tile->spillOffset) ||
+            fread (
+                ofd->spillBuffer.data (),
+                1,
+                tile->pixelDataSize,
+                ofd->spillFile) != size_t (tile->pixelDataSize))
+        {
+            IEX_NAMESPACE::throwErrnoExc ();
+        }
+    }
+
+    writeTileData (
+        streamData,
+        ofd,
+        coord.dx,
+        coord.dy,
+        coord.lx,
+        coord.ly,
+        data,
+        tile->pixelDataSize);
+
+    ofd->bufferedTiles[index] = 0;
+
+    if (!tile->spilled)
+    {
+        ofd->bufferedTileBytes -= tile->pixelData.capacity ();
+    }
+    else if (--ofd->numSpilledTiles == 0)
+    {
+        //
+        // All spilled tiles have been written, the space in the
+        // spill file can be reused.
+        //
+
+        ofd->spillFileSize = 0;
+    }
+
+    returnToTilePool (ofd, tile);
+}
+
 void
 bufferedTileWrite (
     OutputStreamMutex*     streamData,
@@ -481,8 +697,9 @@ bufferedTileWrite (
     //
 
     TileCoord currentTile = TileCoord (dx, dy, lx, ly);
+    int       index       = ofd->tileIndex (currentTile);
 
-    if (ofd->tileMap.find (currentTile) != ofd->tileMap.end ())
+    if (ofd->bufferedTiles[index])
     {
         THROW (
             IEX_NAMESPACE::ArgExc,
@@ -507,49 +724,27 @@ bufferedTileWrite (
             streamData, ofd, dx, dy, lx, ly, pixelData, pixelDataSize);
         ofd->nextTileToWrite = ofd->nextTileCoord (ofd->nextTileToWrite);
 
-        TileMap::iterator i = ofd->tileMap.find (ofd->nextTileToWrite);
-
         //
         // Step through the tiles and write all successive buffered tiles after
         // the current one.
         //
 
-        while (i != ofd->tileMap.end ())
+        for (int i = ofd->tileIndex (ofd->nextTileToWrite);
+             i >= 0 && ofd->bufferedTiles[i];
+             i = ofd->tileIndex (ofd->nextTileToWrite))
         {
-            //
-            // Write the tile, and then delete the tile's buffered data
-            //
-
-            writeTileData (
-                streamData,
-                ofd,
-                i->first.dx,
-                i->first.dy,
-                i->first.lx,
-                i->first.ly,
-                i->second->pixelData,
-                i->second->pixelDataSize);
-
-            delete i->second;
-            ofd->tileMap.erase (i);
+            writeBufferedTile (streamData, ofd, ofd->nextTileToWrite, i);
 
             //
             // Proceed to the next tile
             //
 
             ofd->nextTileToWrite = ofd->nextTileCoord (ofd->nextTileToWrite);
-            i                    = ofd->tileMap.find (ofd->nextTileToWrite);
         }
     }
     else
     {
-        //
-        // Create a new BufferedTile, copy the pixelData into it, and
-        // insert it into the tileMap.
-        //
-
-        ofd->tileMap[currentTile] =
-            new BufferedTile ((const char*) pixelData, pixelDataSize);
+        bufferTile (ofd, index, pixelData, pixelDataSize);
     }
 }
 
@@ -617,7 +812,7 @@ convertToXdr (
 // if necessary.
 //
 
-class TileBufferTask : public Task
+class TileBufferTask : public PooledTask
 {
 public:
     TileBufferTask (
@@ -646,7 +841,7 @@ TileBufferTask::TileBufferTask (
     int                    dy,
     int                    lx,
     int                    ly)
-    : Task (group), _ofd (ofd), _tileBuffer (_ofd->getTileBuffer (number))
+    : PooledTask (group), _ofd (ofd), _tileBuffer (_ofd->getTileBuffer (number))
 {
     //
     // Wait for the tileBuffer to become available
@@ -993,6 +1188,31 @@ TiledOutputFile::initialize (const Header& header)
                                  ? TileCoord (0, 0, 0, 0)
                                  : TileCoord (0, _data->numYTiles[0] - 1, 0, 0);
 
+    //
+    // Set up the slots for tiles that arrive before their turn, the
+    // tiles of each level follow the tiles of the previous level.
+    //
+
+    if (_data->lineOrder != RANDOM_Y)
+    {
+        int numSlots = 0;
+
+        _data->levelFirstTile.resize (_data->numXLevels * _data->numYLevels);
+
+        for (int ly = 0; ly < _data->numYLevels; ++ly)
+        {
+            for (int lx = 0; lx < _data->numXLevels; ++lx)
+            {
+                if (!isValidLevel (lx, ly)) continue;
+
+                _data->levelFirstTile[ly * _data->numXLevels + lx] = numSlots;
+                numSlots += _data->numXTiles[lx] * _data->numYTiles[ly];
+            }
+        }
+
+        _data->bufferedTiles.resize (numSlots, 0);
+    }
+
     _data->maxBytesPerTileLine =
         calculateBytesPerPixel (_data->header) * _data->tileDesc.xSize;
 
@@ -1871,6 +2091,22 @@ TiledOutputFile::updatePreviewImage (const PreviewRgba newPixels[])
     }
 }
 
+void
+TiledOutputFile::setTileBufferBudget (size_t maxBytes)
+{
+#if ILMTHREAD_THREADING_ENABLED
+    std::lock_guard<std::mutex> lock (*_streamData);
+#endif
+    _data->tileBufferBudget = maxBytes;
+    if (maxBytes > 0) releaseTilePool (_data);
+}
+
+size_t
+TiledOutputFile::tileBufferBudget () const
+{
+    return _data->tileBufferBudget;
+}
+
 void
 TiledOutputFile::breakTile (
     int dx, int dy, int lx, int ly, int offset, int length, char c)
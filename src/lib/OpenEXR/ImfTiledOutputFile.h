@@ -417,6 +417,25 @@ public:
     IMF_EXPORT
     void updatePreviewImage (const PreviewRgba newPixels[]);
 
+    //------------------------------------------------------------------
+    // Limiting the memory used for out-of-order tiles:
+    //
+    // Unless the file's line order is RANDOM_Y, a tile that is written
+    // before all the tiles that precede it in the file is held back
+    // until those have been written.  setTileBufferBudget(n) limits
+    // the tiles held in memory to n bytes of (compressed) pixel data;
+    // tiles beyond that are held in a temporary file instead.  The
+    // default, 0, means no limit.
+    //
+    // Writing the tiles in the order of the line order attribute, or
+    // using RANDOM_Y, avoids holding back any tiles.
+    //------------------------------------------------------------------
+
+    IMF_EXPORT
+    void setTileBufferBudget (size_t maxBytes);
+    IMF_EXPORT
+    size_t tileBufferBudget () const;
+
     //-------------------------------------------------------------
     // Break a tile -- for testing and debugging only:
     //
@@ -190,6 +190,18 @@ TiledOutputPart::updatePreviewImage (const PreviewRgba newPixels[])
     file->updatePreviewImage (newPixels);
 }
 
+void
+TiledOutputPart::setTileBufferBudget (size_t maxBytes)
+{
+    file->setTileBufferBudget (maxBytes);
+}
+
+size_t
+TiledOutputPart::tileBufferBudget () const
+{
+    return file->tileBufferBudget ();
+}
+
 void
 TiledOutputPart::breakTile (
     int dx, int dy, int lx, int ly, int offset, int length, char c)
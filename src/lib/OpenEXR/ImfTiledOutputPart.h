@@ -86,6 +86,10 @@ public:
     IMF_EXPORT
     void updatePreviewImage (const PreviewRgba newPixels[]);
     IMF_EXPORT
+    void setTileBufferBudget (size_t maxBytes);
+    IMF_EXPORT
+    size_t tileBufferBudget () const;
+    IMF_EXPORT
     void
     breakTile (int dx, int dy, int lx, int ly, int offset, int length, char c);
 
@@ -14,6 +14,7 @@
 //-----------------------------------------------------------------------------
 
 #include "ImfNamespace.h"
+#include "ImfSimd.h"
 #include <ImfWav.h>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
@@ -97,25 +98,283 @@ wdec16 (
     a      = aa;
 }
 
-} // namespace
+//
+// Both transforms are done a level at a time on pairs of rows. For
+// each 2x2 block, the 2D transform is a 1D transform along the two
+// rows and one between them; the blocks do not depend on each other,
+// so each of those can be done over the whole row pair in turn. At
+// the finest level, which has three quarters of the work, the values
+// are then contiguous (between the rows) or interleaved (along them),
+// and the vector versions below do 8 of them at once.
+//
+
+#if defined(IMF_HAVE_SSE2)
+
+typedef __m128i WavVec;
+
+inline WavVec
+load (const unsigned short* p)
+{
+    return _mm_loadu_si128 (reinterpret_cast<const __m128i*> (p));
+}
+
+inline void
+store (unsigned short* p, WavVec v)
+{
+    _mm_storeu_si128 (reinterpret_cast<__m128i*> (p), v);
+}
 
 //
-// 2D Wavelet encoding:
+// Split the 8 pairs at p in to the first and second of each pair
+//
+
+inline void
+loadPairs (const unsigned short* p, WavVec& a, WavVec& b)
+{
+    WavVec v0 = load (p);
+    WavVec v1 = load (p + 8);
+
+    // the sign extension keeps packs from saturating
+    a = _mm_packs_epi32 (
+        _mm_srai_epi32 (_mm_slli_epi32 (v0, 16), 16),
+        _mm_srai_epi32 (_mm_slli_epi32 (v1, 16), 16));
+    b = _mm_packs_epi32 (_mm_srai_epi32 (v0, 16), _mm_srai_epi32 (v1, 16));
+}
+
+inline void
+storePairs (unsigned short* p, WavVec a, WavVec b)
+{
+    store (p, _mm_unpacklo_epi16 (a, b));
+    store (p + 8, _mm_unpackhi_epi16 (a, b));
+}
+
+inline void
+wenc14 (WavVec& a, WavVec& b)
+{
+    // (a + b) >> 1 without overflowing 16 bits
+    WavVec m = _mm_add_epi16 (
+        _mm_add_epi16 (_mm_srai_epi16 (a, 1), _mm_srai_epi16 (b, 1)),
+        _mm_and_si128 (_mm_and_si128 (a, b), _mm_set1_epi16 (1)));
+
+    b = _mm_sub_epi16 (a, b);
+    a = m;
+}
+
+inline void
+wdec14 (WavVec& l, WavVec& h)
+{
+    WavVec a = _mm_add_epi16 (
+        _mm_add_epi16 (l, _mm_and_si128 (h, _mm_set1_epi16 (1))),
+        _mm_srai_epi16 (h, 1));
+
+    h = _mm_sub_epi16 (a, h);
+    l = a;
+}
+
+inline void
+wenc16 (WavVec& a, WavVec& b)
+{
+    const WavVec off = _mm_set1_epi16 (short (A_OFFSET));
+    WavVec       ao  = _mm_xor_si128 (a, off);
+
+    // unsigned (ao + b) >> 1, avg rounds up
+    WavVec m = _mm_sub_epi16 (
+        _mm_avg_epu16 (ao, b),
+        _mm_and_si128 (_mm_xor_si128 (ao, b), _mm_set1_epi16 (1)));
+
+    // ao < b unsigned, i.e. d < 0
+    WavVec neg = _mm_cmplt_epi16 (a, _mm_xor_si128 (b, off));
+
+    b = _mm_sub_epi16 (ao, b);
+    a = _mm_xor_si128 (m, _mm_and_si128 (neg, off));
+}
+
+inline void
+wdec16 (WavVec& l, WavVec& h)
+{
+    WavVec bb = _mm_sub_epi16 (l, _mm_srli_epi16 (h, 1));
+
+    l = _mm_xor_si128 (
+        _mm_add_epi16 (h, bb), _mm_set1_epi16 (short (A_OFFSET)));
+    h = bb;
+}
+
+#    define IMF_HAVE_WAV_VEC 1
+
+#elif defined(IMF_HAVE_NEON_AARCH64)
+
+typedef uint16x8_t WavVec;
+
+inline WavVec
+load (const unsigned short* p)
+{
+    return vld1q_u16 (p);
+}
+
+inline void
+store (unsigned short* p, WavVec v)
+{
+    vst1q_u16 (p, v);
+}
+
+inline void
+loadPairs (const unsigned short* p, WavVec& a, WavVec& b)
+{
+    uint16x8x2_t v = vld2q_u16 (p);
+
+    a = v.val[0];
+    b = v.val[1];
+}
+
+inline void
+storePairs (unsigned short* p, WavVec a, WavVec b)
+{
+    uint16x8x2_t v;
+
+    v.val[0] = a;
+    v.val[1] = b;
+    vst2q_u16 (p, v);
+}
+
+inline void
+wenc14 (WavVec& a, WavVec& b)
+{
+    int16x8_t as = vreinterpretq_s16_u16 (a);
+    int16x8_t bs = vreinterpretq_s16_u16 (b);
+
+    a = vreinterpretq_u16_s16 (vhaddq_s16 (as, bs));
+    b = vreinterpretq_u16_s16 (vsubq_s16 (as, bs));
+}
+
+inline void
+wdec14 (WavVec& l, WavVec& h)
+{
+    int16x8_t hs = vreinterpretq_s16_u16 (h);
+    int16x8_t a  = vaddq_s16 (
+        vaddq_s16 (vreinterpretq_s16_u16 (l), vandq_s16 (hs, vdupq_n_s16 (1))),
+        vshrq_n_s16 (hs, 1));
+
+    l = vreinterpretq_u16_s16 (a);
+    h = vreinterpretq_u16_s16 (vsubq_s16 (a, hs));
+}
+
+inline void
+wenc16 (WavVec& a, WavVec& b)
+{
+    const uint16x8_t off = vdupq_n_u16 (A_OFFSET);
+    uint16x8_t       ao  = veorq_u16 (a, off);
+    uint16x8_t       m   = vhaddq_u16 (ao, b);
+    uint16x8_t       neg = vcltq_u16 (ao, b);
+
+    b = vsubq_u16 (ao, b);
+    a = veorq_u16 (m, vandq_u16 (neg, off));
+}
+
+inline void
+wdec16 (WavVec& l, WavVec& h)
+{
+    uint16x8_t bb = vsubq_u16 (l, vshrq_n_u16 (h, 1));
+
+    l = veorq_u16 (vaddq_u16 (h, bb), vdupq_n_u16 (A_OFFSET));
+    h = bb;
+}
+
+#    define IMF_HAVE_WAV_VEC 1
+
+#endif
+
+struct Enc14
+{
+    static void op (unsigned short& a, unsigned short& b)
+    {
+        wenc14 (a, b, a, b);
+    }
+#ifdef IMF_HAVE_WAV_VEC
+    static void op (WavVec& a, WavVec& b) { wenc14 (a, b); }
+#endif
+};
+
+struct Dec14
+{
+    static void op (unsigned short& a, unsigned short& b)
+    {
+        wdec14 (a, b, a, b);
+    }
+#ifdef IMF_HAVE_WAV_VEC
+    static void op (WavVec& a, WavVec& b) { wdec14 (a, b); }
+#endif
+};
+
+struct Enc16
+{
+    static void op (unsigned short& a, unsigned short& b)
+    {
+        wenc16 (a, b, a, b);
+    }
+#ifdef IMF_HAVE_WAV_VEC
+    static void op (WavVec& a, WavVec& b) { wenc16 (a, b); }
+#endif
+};
+
+struct Dec16
+{
+    static void op (unsigned short& a, unsigned short& b)
+    {
+        wdec16 (a, b, a, b);
+    }
+#ifdef IMF_HAVE_WAV_VEC
+    static void op (WavVec& a, WavVec& b) { wdec16 (a, b); }
+#endif
+};
+
+//
+// Transform the first and second of n pairs, stride apart, in place;
+// the pairs are adjacent values when b is a + 1
 //
 
+template <class T>
 void
-wav2Encode (
-    unsigned short* in, // io: values are transformed in place
-    int             nx, // i : x size
-    int             ox, // i : x offset
-    int             ny, // i : y size
-    int             oy, // i : y offset
-    unsigned short  mx)  // i : maximum in[x][y] value
+wavPairs (unsigned short* a, unsigned short* b, int n, int stride)
 {
-    bool w14 = (mx < (1 << 14));
-    int  n   = (nx > ny) ? ny : nx;
-    int  p   = 1; // == 1 <<  level
-    int  p2  = 2; // == 1 << (level+1)
+    int i = 0;
+
+#ifdef IMF_HAVE_WAV_VEC
+    if (stride == 1)
+    {
+        for (; i + 8 <= n; i += 8)
+        {
+            WavVec va = load (a + i);
+            WavVec vb = load (b + i);
+            T::op (va, vb);
+            store (a + i, va);
+            store (b + i, vb);
+        }
+    }
+    else if (stride == 2 && b == a + 1)
+    {
+        for (; i + 8 <= n; i += 8)
+        {
+            WavVec va, vb;
+            loadPairs (a + 2 * i, va, vb);
+            T::op (va, vb);
+            storePairs (a + 2 * i, va, vb);
+        }
+    }
+#endif
+
+    a += i * stride;
+    b += i * stride;
+    for (; i < n; ++i, a += stride, b += stride)
+        T::op (*a, *b);
+}
+
+template <class T>
+void
+wav2EncodeImpl (unsigned short* in, int nx, int ox, int ny, int oy)
+{
+    int n  = (nx > ny) ? ny : nx;
+    int p  = 1; // == 1 <<  level
+    int p2 = 2; // == 1 << (level+1)
 
     //
     // Hierarchical loop on smaller dimension n
@@ -129,85 +388,26 @@ wav2Encode (
         int             oy2 = oy * p2;
         int             ox1 = ox * p;
         int             ox2 = ox * p2;
-        unsigned short  i00, i01, i10, i11;
+        int             nb  = nx / p2; // 2x2 blocks in a row pair
+        int             nc  = nx / p;  // columns, including an odd one
 
         //
-        // Y loop
+        // Y loop: 2D wavelet encoding along both rows, then between
+        // them, which also encodes (1D) the odd column
         //
 
         for (; py <= ey; py += oy2)
         {
-            unsigned short* px = py;
-            unsigned short* ex = py + ox * (nx - p2);
-
-            //
-            // X loop
-            //
-
-            for (; px <= ex; px += ox2)
-            {
-                unsigned short* p01 = px + ox1;
-                unsigned short* p10 = px + oy1;
-                unsigned short* p11 = p10 + ox1;
-
-                //
-                // 2D wavelet encoding
-                //
-
-                if (w14)
-                {
-                    wenc14 (*px, *p01, i00, i01);
-                    wenc14 (*p10, *p11, i10, i11);
-                    wenc14 (i00, i10, *px, *p10);
-                    wenc14 (i01, i11, *p01, *p11);
-                }
-                else
-                {
-                    wenc16 (*px, *p01, i00, i01);
-                    wenc16 (*p10, *p11, i10, i11);
-                    wenc16 (i00, i10, *px, *p10);
-                    wenc16 (i01, i11, *p01, *p11);
-                }
-            }
-
-            //
-            // Encode (1D) odd column (still in Y loop)
-            //
-
-            if (nx & p)
-            {
-                unsigned short* p10 = px + oy1;
-
-                if (w14)
-                    wenc14 (*px, *p10, i00, *p10);
-                else
-                    wenc16 (*px, *p10, i00, *p10);
-
-                *px = i00;
-            }
+            wavPairs<T> (py, py + ox1, nb, ox2);
+            wavPairs<T> (py + oy1, py + oy1 + ox1, nb, ox2);
+            wavPairs<T> (py, py + oy1, nc, ox1);
         }
 
         //
-        // Encode (1D) odd line (must loop in X)
+        // Encode (1D) odd line
         //
 
-        if (ny & p)
-        {
-            unsigned short* px = py;
-            unsigned short* ex = py + ox * (nx - p2);
-
-            for (; px <= ex; px += ox2)
-            {
-                unsigned short* p01 = px + ox1;
-
-                if (w14)
-                    wenc14 (*px, *p01, i00, *p01);
-                else
-                    wenc16 (*px, *p01, i00, *p01);
-
-                *px = i00;
-            }
-        }
+        if (ny & p) wavPairs<T> (py, py + ox1, nb, ox2);
 
         //
         // Next level
@@ -218,23 +418,13 @@ wav2Encode (
     }
 }
 
-//
-// 2D Wavelet decoding:
-//
-
+template <class T>
 void
-wav2Decode (
-    unsigned short* in, // io: values are transformed in place
-    int             nx, // i : x size
-    int             ox, // i : x offset
-    int             ny, // i : y size
-    int             oy, // i : y offset
-    unsigned short  mx)  // i : maximum in[x][y] value
+wav2DecodeImpl (unsigned short* in, int nx, int ox, int ny, int oy)
 {
-    bool w14 = (mx < (1 << 14));
-    int  n   = (nx > ny) ? ny : nx;
-    int  p   = 1;
-    int  p2;
+    int n = (nx > ny) ? ny : nx;
+    int p = 1;
+    int p2;
 
     //
     // Search max level
@@ -259,85 +449,26 @@ wav2Decode (
         int             oy2 = oy * p2;
         int             ox1 = ox * p;
         int             ox2 = ox * p2;
-        unsigned short  i00, i01, i10, i11;
+        int             nb  = nx / p2; // 2x2 blocks in a row pair
+        int             nc  = nx / p;  // columns, including an odd one
 
         //
-        // Y loop
+        // Y loop: 2D wavelet decoding between the rows, which also
+        // decodes (1D) the odd column, then along both rows
         //
 
         for (; py <= ey; py += oy2)
         {
-            unsigned short* px = py;
-            unsigned short* ex = py + ox * (nx - p2);
-
-            //
-            // X loop
-            //
-
-            for (; px <= ex; px += ox2)
-            {
-                unsigned short* p01 = px + ox1;
-                unsigned short* p10 = px + oy1;
-                unsigned short* p11 = p10 + ox1;
-
-                //
-                // 2D wavelet decoding
-                //
-
-                if (w14)
-                {
-                    wdec14 (*px, *p10, i00, i10);
-                    wdec14 (*p01, *p11, i01, i11);
-                    wdec14 (i00, i01, *px, *p01);
-                    wdec14 (i10, i11, *p10, *p11);
-                }
-                else
-                {
-                    wdec16 (*px, *p10, i00, i10);
-                    wdec16 (*p01, *p11, i01, i11);
-                    wdec16 (i00, i01, *px, *p01);
-                    wdec16 (i10, i11, *p10, *p11);
-                }
-            }
-
-            //
-            // Decode (1D) odd column (still in Y loop)
-            //
-
-            if (nx & p)
-            {
-                unsigned short* p10 = px + oy1;
-
-                if (w14)
-                    wdec14 (*px, *p10, i00, *p10);
-                else
-                    wdec16 (*px, *p10, i00, *p10);
-
-                *px = i00;
-            }
+            wavPairs<T> (py, py + oy1, nc, ox1);
+            wavPairs<T> (py, py + ox1, nb, ox2);
+            wavPairs<T> (py + oy1, py + oy1 + ox1, nb, ox2);
         }
 
         //
-        // Decode (1D) odd line (must loop in X)
+        // Decode (1D) odd line
         //
 
-        if (ny & p)
-        {
-            unsigned short* px = py;
-            unsigned short* ex = py + ox * (nx - p2);
-
-            for (; px <= ex; px += ox2)
-            {
-                unsigned short* p01 = px + ox1;
-
-                if (w14)
-                    wdec14 (*px, *p01, i00, *p01);
-                else
-                    wdec16 (*px, *p01, i00, *p01);
-
-                *px = i00;
-            }
-        }
+        if (ny & p) wavPairs<T> (py, py + ox1, nb, ox2);
 
         //
         // Next level
@@ -348,4 +479,44 @@ wav2Decode (
     }
 }
 
+} // namespace
+
+//
+// 2D Wavelet encoding:
+//
+
+void
+wav2Encode (
+    unsigned short* in, // io: values are transformed in place
+    int             nx, // i : x size
+    int             ox, // i : x offset
+    int             ny, // i : y size
+    int             oy, // i : y offset
+    unsigned short  mx)  // i : maximum in[x][y] value
+{
+    if (mx < (1 << 14))
+        wav2EncodeImpl<Enc14> (in, nx, ox, ny, oy);
+    else
+        wav2EncodeImpl<Enc16> (in, nx, ox, ny, oy);
+}
+
+//
+// 2D Wavelet decoding:
+//
+
+void
+wav2Decode (
+    unsigned short* in, // io: values are transformed in place
+    int             nx, // i : x size
+    int             ox, // i : x offset
+    int             ny, // i : y size
+    int             oy, // i : y offset
+    unsigned short  mx)  // i : maximum in[x][y] value
+{
+    if (mx < (1 << 14))
+        wav2DecodeImpl<Dec14> (in, nx, ox, ny, oy);
+    else
+        wav2DecodeImpl<Dec16> (in, nx, ox, ny, oy);
+}
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
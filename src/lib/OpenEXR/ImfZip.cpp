@@ -12,6 +12,8 @@
 
 #include <openexr_compression.h>
 
+#include <cstddef>
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
 Zip::Zip (size_t maxRawSize, int level)
@@ -48,45 +50,10 @@ int
 Zip::compress (const char* raw, int rawSize, char* compressed)
 {
     //
-    // Reorder the pixel data.
-    //
-
-    {
-        char*       t1   = _tmpBuffer;
-        char*       t2   = _tmpBuffer + (rawSize + 1) / 2;
-        const char* stop = raw + rawSize;
-
-        while (true)
-        {
-            if (raw < stop)
-                *(t1++) = *(raw++);
-            else
-                break;
-
-            if (raw < stop)
-                *(t2++) = *(raw++);
-            else
-                break;
-        }
-    }
-
-    //
-    // Predictor.
+    // Reorder the pixel data, and apply the predictor.
     //
 
-    {
-        unsigned char* t    = (unsigned char*) _tmpBuffer + 1;
-        unsigned char* stop = (unsigned char*) _tmpBuffer + rawSize;
-        int            p    = t[-1];
-
-        while (t < stop)
-        {
-            int d = int (t[0]) - p + (128 + 256);
-            p     = t[0];
-            t[0]  = d;
-            ++t;
-        }
-    }
+    deconstructBytes (raw, rawSize, _tmpBuffer);
 
     //
     // Compress the data using zlib
@@ -157,6 +124,53 @@ reconstruct_sse41 (char* buf, size_t outSize)
 
 #endif
 
+#ifdef IMF_HAVE_SSE2
+
+//
+// The same as reconstruct_sse41(), but broadcasting the last byte with
+// sse2 only, as that is what most x86_64 builds are compiled for.
+//
+
+void
+reconstruct_sse2 (char* buf, size_t outSize)
+{
+    static const size_t bytesPerChunk = sizeof (__m128i);
+    const size_t        vOutSize      = outSize / bytesPerChunk;
+
+    const __m128i c = _mm_set1_epi8 (-128);
+
+    buf[0] += -128;
+
+    __m128i* vBuf  = reinterpret_cast<__m128i*> (buf);
+    __m128i  vPrev = _mm_setzero_si128 ();
+    for (size_t i = 0; i < vOutSize; ++i)
+    {
+        __m128i d = _mm_add_epi8 (_mm_loadu_si128 (vBuf), c);
+
+        d = _mm_add_epi8 (d, _mm_slli_si128 (d, 1));
+        d = _mm_add_epi8 (d, _mm_slli_si128 (d, 2));
+        d = _mm_add_epi8 (d, _mm_slli_si128 (d, 4));
+        d = _mm_add_epi8 (d, _mm_slli_si128 (d, 8));
+        d = _mm_add_epi8 (d, vPrev);
+
+        _mm_storeu_si128 (vBuf++, d);
+
+        vPrev = _mm_unpackhi_epi8 (d, d);
+        vPrev = _mm_shufflehi_epi16 (vPrev, 0xff);
+        vPrev = _mm_unpackhi_epi64 (vPrev, vPrev);
+    }
+
+    unsigned char prev = _mm_cvtsi128_si32 (vPrev);
+    for (size_t i = vOutSize * bytesPerChunk; i < outSize; ++i)
+    {
+        unsigned char d = prev + buf[i] - 128;
+        buf[i]          = d;
+        prev            = d;
+    }
+}
+
+#endif
+
 #ifdef IMF_HAVE_NEON_AARCH64
 
 void
@@ -322,8 +336,172 @@ interleave_scalar (const char* source, size_t outSize, char* out)
     }
 }
 
-auto reconstruct = reconstruct_scalar;
-auto interleave  = interleave_scalar;
+#ifdef IMF_HAVE_SSE2
+
+void
+deinterleave_sse2 (const char* source, size_t inSize, char* out)
+{
+    static const size_t bytesPerChunk = 2 * sizeof (__m128i);
+
+    const size_t vInSize = inSize / bytesPerChunk;
+
+    const __m128i  lowMask = _mm_set1_epi16 (0xff);
+    const __m128i* vIn     = reinterpret_cast<const __m128i*> (source);
+    __m128i*       v1      = reinterpret_cast<__m128i*> (out);
+    __m128i* v2 = reinterpret_cast<__m128i*> (out + (inSize + 1) / 2);
+
+    for (size_t i = 0; i < vInSize; ++i)
+    {
+        __m128i a = _mm_loadu_si128 (vIn++);
+        __m128i b = _mm_loadu_si128 (vIn++);
+
+        // Even bytes are the low half of each 16 bit lane, odd the high.
+        __m128i even = _mm_packus_epi16 (
+            _mm_and_si128 (a, lowMask), _mm_and_si128 (b, lowMask));
+        __m128i odd =
+            _mm_packus_epi16 (_mm_srli_epi16 (a, 8), _mm_srli_epi16 (b, 8));
+
+        _mm_storeu_si128 (v1++, even);
+        _mm_storeu_si128 (v2++, odd);
+    }
+
+    const char* sIn = reinterpret_cast<const char*> (vIn);
+    char*       t1  = reinterpret_cast<char*> (v1);
+    char*       t2  = reinterpret_cast<char*> (v2);
+
+    for (size_t i = vInSize * bytesPerChunk; i < inSize; ++i)
+    {
+        *((i % 2 == 0) ? t1++ : t2++) = *(sIn++);
+    }
+}
+
+void
+predict_sse2 (char* buf, size_t size)
+{
+    const __m128i c = _mm_set1_epi8 (-128);
+    char*         t = buf + size;
+
+    // Go back to front, so the previous byte of each lane is still the
+    // original value when it is loaded.
+    while (t - buf > static_cast<ptrdiff_t> (sizeof (__m128i)))
+    {
+        t -= sizeof (__m128i);
+
+        __m128i cur  = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (t));
+        __m128i prev =
+            _mm_loadu_si128 (reinterpret_cast<const __m128i*> (t - 1));
+
+        _mm_storeu_si128 (
+            reinterpret_cast<__m128i*> (t),
+            _mm_add_epi8 (_mm_sub_epi8 (cur, prev), c));
+    }
+
+    unsigned char* u = reinterpret_cast<unsigned char*> (t);
+    while (u - reinterpret_cast<unsigned char*> (buf) > 1)
+    {
+        --u;
+        u[0] = int (u[0]) - int (u[-1]) + (128 + 256);
+    }
+}
+
+#endif
+
+#ifdef IMF_HAVE_NEON_AARCH64
+
+void
+deinterleave_neon (const char* source, size_t inSize, char* out)
+{
+    static const size_t bytesPerChunk = 2 * sizeof (uint8x16_t);
+
+    const size_t vInSize = inSize / bytesPerChunk;
+
+    const unsigned char* vIn = reinterpret_cast<const unsigned char*> (source);
+    unsigned char*       v1  = reinterpret_cast<unsigned char*> (out);
+    unsigned char*       v2 =
+        reinterpret_cast<unsigned char*> (out + (inSize + 1) / 2);
+
+    for (size_t i = 0; i < vInSize; ++i)
+    {
+        uint8x16x2_t ab = vld2q_u8 (vIn);
+        vIn += bytesPerChunk;
+
+        vst1q_u8 (v1, ab.val[0]);
+        v1 += sizeof (uint8x16_t);
+        vst1q_u8 (v2, ab.val[1]);
+        v2 += sizeof (uint8x16_t);
+    }
+
+    for (size_t i = vInSize * bytesPerChunk; i < inSize; ++i)
+    {
+        *((i % 2 == 0) ? v1++ : v2++) = *(vIn++);
+    }
+}
+
+void
+predict_neon (char* buf, size_t size)
+{
+    const uint8x16_t c = vdupq_n_u8 (128);
+    unsigned char*   b = reinterpret_cast<unsigned char*> (buf);
+    unsigned char*   t = b + size;
+
+    // Go back to front, so the previous byte of each lane is still the
+    // original value when it is loaded.
+    while (t - b > static_cast<ptrdiff_t> (sizeof (uint8x16_t)))
+    {
+        t -= sizeof (uint8x16_t);
+        vst1q_u8 (t, vaddq_u8 (vsubq_u8 (vld1q_u8 (t), vld1q_u8 (t - 1)), c));
+    }
+
+    while (t - b > 1)
+    {
+        --t;
+        t[0] = int (t[0]) - int (t[-1]) + (128 + 256);
+    }
+}
+
+#endif
+
+void
+deinterleave_scalar (const char* source, size_t inSize, char* out)
+{
+    char*       t1   = out;
+    char*       t2   = out + (inSize + 1) / 2;
+    const char* stop = source + inSize;
+
+    while (true)
+    {
+        if (source < stop)
+            *(t1++) = *(source++);
+        else
+            break;
+
+        if (source < stop)
+            *(t2++) = *(source++);
+        else
+            break;
+    }
+}
+
+void
+predict_scalar (char* buf, size_t size)
+{
+    unsigned char* t    = (unsigned char*) buf + 1;
+    unsigned char* stop = (unsigned char*) buf + size;
+    int            p    = t[-1];
+
+    while (t < stop)
+    {
+        int d = int (t[0]) - p + (128 + 256);
+        p     = t[0];
+        t[0]  = d;
+        ++t;
+    }
+}
+
+auto reconstruct  = reconstruct_scalar;
+auto interleave   = interleave_scalar;
+auto deinterleave = deinterleave_scalar;
+auto predict      = predict_scalar;
 
 } // namespace
 
@@ -345,34 +523,55 @@ Zip::uncompress (const char* compressed, int compressedSize, char* raw)
     if (outSize == 0) { return static_cast<int> (outSize); }
 
     //
-    // Predictor.
-    //
-    reconstruct (_tmpBuffer, outSize);
-
-    //
-    // Reorder the pixel data.
+    // Predictor, and reorder the pixel data.
     //
-    interleave (_tmpBuffer, outSize, raw);
+    reconstructBytes (_tmpBuffer, outSize, raw);
 
     return outSize;
 }
 
+void
+Zip::deconstructBytes (const char* raw, size_t rawSize, char* tmp)
+{
+    if (rawSize == 0) return;
+
+    deinterleave (raw, rawSize, tmp);
+    predict (tmp, rawSize);
+}
+
+void
+Zip::reconstructBytes (char* tmp, size_t rawSize, char* raw)
+{
+    if (rawSize == 0) return;
+
+    reconstruct (tmp, rawSize);
+    interleave (tmp, rawSize, raw);
+}
+
 void
 Zip::initializeFuncs ()
 {
     CpuId cpuId;
 
-#ifdef IMF_HAVE_SSE4_1
-    if (cpuId.sse4_1) { reconstruct = reconstruct_sse41; }
+#ifdef IMF_HAVE_SSE2
+    if (cpuId.sse2)
+    {
+        reconstruct  = reconstruct_sse2;
+        interleave   = interleave_sse2;
+        deinterleave = deinterleave_sse2;
+        predict      = predict_sse2;
+    }
 #endif
 
-#ifdef IMF_HAVE_SSE2
-    if (cpuId.sse2) { interleave = interleave_sse2; }
+#ifdef IMF_HAVE_SSE4_1
+    if (cpuId.sse4_1) { reconstruct = reconstruct_sse41; }
 #endif
 
 #ifdef IMF_HAVE_NEON_AARCH64
-    reconstruct = reconstruct_neon;
-    interleave  = interleave_neon;
+    reconstruct  = reconstruct_neon;
+    interleave   = interleave_neon;
+    deinterleave = deinterleave_neon;
+    predict      = predict_neon;
 #endif
 }
 
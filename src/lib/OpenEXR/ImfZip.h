@@ -40,6 +40,15 @@ public:
     //
     int uncompress (const char* compressed, int compressedSize, char* raw);
 
+    //
+    // The byte reordering and predictor applied to the data before it
+    // is compressed, shared with the RLE compressor.  deconstructBytes
+    // splits raw in to tmp, reconstructBytes undoes that in to raw,
+    // overwriting tmp.
+    //
+    static void deconstructBytes (const char* raw, size_t rawSize, char* tmp);
+    static void reconstructBytes (char* tmp, size_t rawSize, char* raw);
+
     static void initializeFuncs ();
 
 private:
@@ -3,60 +3,109 @@
 // Copyright (c) Contributors to the OpenEXR Project.
 //
 
-#include <cstring>
-#include <mutex>
+//-----------------------------------------------------------------------------
+//
+//	class ZstdCompressor
+//
+//-----------------------------------------------------------------------------
+
 #include "openexr_compression.h"
 #include "ImfZstdCompressor.h"
 
-#include "IlmThreadPool.h"
-#include "ImfChannelList.h"
-#include "ImfMisc.h"
+#include "Iex.h"
+#include "ImfCheckedArithmetic.h"
+#include "ImfNamespace.h"
 
-namespace
-{
-std::mutex g_mutex;
-}
+#include <limits>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
-ZstdCompressor::ZstdCompressor (const Header& hdr)
-    : Compressor (hdr), _outBuffer ()
-{}
+ZstdCompressor::ZstdCompressor (
+    const Header& hdr,
+    size_t        maxScanLineSize,
+    size_t        numScanLines,
+    bool          bareChunks)
+    : Compressor (hdr)
+    , _numScanLines (static_cast<int> (numScanLines))
+    , _bareChunks (bareChunks)
+    , _outBufferSize (0)
+    , _outBuffer (0)
+{
+    //
+    // The codec stores incompressible data raw, so the output
+    // never needs more room than one full chunk of input.
+    //
+
+    size_t bufSize = uiMult (maxScanLineSize, numScanLines);
+
+    if (bufSize > static_cast<size_t> (std::numeric_limits<int>::max ()))
+    {
+        throw IEX_NAMESPACE::OverflowExc (
+            "Chunk size too large for ZstdCompressor");
+    }
+
+    _outBufferSize = static_cast<int> (bufSize);
+    _outBuffer     = new char[bufSize];
+}
+
+ZstdCompressor::~ZstdCompressor ()
+{
+    delete[] _outBuffer;
+}
 
 int
 ZstdCompressor::numScanLines () const
 {
-    // Needs to be in sync with ImfCompressor::numLinesInBuffer
-    return (int) exr_get_zstd_lines_per_chunk ();
+    return _numScanLines;
 }
 
 int
 ZstdCompressor::compress (
     const char* inPtr, int inSize, int minY, const char*& outPtr)
 {
-    outPtr = (char*) malloc (inSize);
-    {
-        std::lock_guard<std::mutex> lock (g_mutex);
-        _outBuffer.push_back (raw_ptr ((char*) outPtr, &free));
-    }
-    auto fullSize =
-        exr_compress_zstd ((char*) (inPtr), inSize, (void*) outPtr, inSize);
-    return fullSize;
+    outPtr = _outBuffer;
+
+    //
+    // Special case - empty input buffer
+    //
+
+    if (inSize == 0) return 0;
+
+    char* in = const_cast<char*> (inPtr);
+    long  outSize =
+        _bareChunks
+            ? exr_compress_zstd_chunk (in, inSize, _outBuffer, _outBufferSize)
+            : exr_compress_zstd (in, inSize, _outBuffer, _outBufferSize);
+
+    if (outSize < 0)
+        throw IEX_NAMESPACE::BaseExc ("Data compression (zstd) failed.");
+
+    return static_cast<int> (outSize);
 }
 
 int
 ZstdCompressor::uncompress (
     const char* inPtr, int inSize, int minY, const char*& outPtr)
 {
-    auto  read  = (const char*) inPtr;
-    void* write = nullptr;
-    auto  ret   = exr_uncompress_zstd (read, inSize, &write, 0);
-    {
-        std::lock_guard<std::mutex> lock (g_mutex);
-        _outBuffer.push_back (raw_ptr ((char*) write, &free));
-    }
-    outPtr = (const char*) write;
-    return ret;
+    outPtr = _outBuffer;
+
+    //
+    // Special case - empty input buffer
+    //
+
+    if (inSize == 0) return 0;
+
+    void* write   = _outBuffer;
+    long  outSize = exr_uncompress_zstd (
+        inPtr,
+        static_cast<uint64_t> (inSize),
+        &write,
+        static_cast<uint64_t> (_outBufferSize));
+
+    if (outSize < 0)
+        throw IEX_NAMESPACE::InputExc ("Data decompression (zstd) failed.");
+
+    return static_cast<int> (outSize);
 }
 
-OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
\ No newline at end of file
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
@@ -5,28 +5,50 @@
 
 #pragma once
 
-#include <memory>
+//-----------------------------------------------------------------------------
+//
+//	class ZstdCompressor -- performs blosc zstd compression
+//
+//-----------------------------------------------------------------------------
+
 #include "ImfNamespace.h"
+
 #include "ImfCompressor.h"
-#include "ImfHeader.h"
-#include "blosc2.h"
-#include "vector"
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
 
 class ZstdCompressor : public Compressor
 {
 public:
-    explicit ZstdCompressor (const Header& hdr);
+    //
+    // bareChunks selects the layout of scan line images with a
+    // zstdLinesPerChunk attribute greater than 1, which stores plain
+    // blosc2 chunks instead of serialized blosc2 frames.
+    //
+
+    ZstdCompressor (
+        const Header& hdr,
+        size_t        maxScanLineSize,
+        size_t        numScanLines,
+        bool          bareChunks);
+    ~ZstdCompressor () override;
+
+    ZstdCompressor (const ZstdCompressor& other)            = delete;
+    ZstdCompressor& operator= (const ZstdCompressor& other) = delete;
+    ZstdCompressor (ZstdCompressor&& other)                 = delete;
+    ZstdCompressor& operator= (ZstdCompressor&& other)      = delete;
 
 private:
-    using raw_ptr = std::unique_ptr<char, decltype (&free)>;
-    std::vector<raw_ptr> _outBuffer;
-    int                  numScanLines () const override; // max
-    int                  compress (
-                         const char* inPtr, int inSize, int minY, const char*& outPtr) override;
+    int   _numScanLines;
+    bool  _bareChunks;
+    int   _outBufferSize;
+    char* _outBuffer;
+
+    int numScanLines () const override; // max
+    int compress (
+        const char* inPtr, int inSize, int minY, const char*& outPtr) override;
     int uncompress (
         const char* inPtr, int inSize, int minY, const char*& outPtr) override;
 };
 
-OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
\ No newline at end of file
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
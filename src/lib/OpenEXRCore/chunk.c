@@ -11,6 +11,7 @@
 #include "internal_xdr.h"
 
 #include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 
 /**************************************/
@@ -725,20 +726,23 @@ compute_chunk_unpack_size (
 
 /**************************************/
 
-exr_result_t
-exr_read_scanline_chunk_info (
-    exr_const_context_t ctxt, int part_index, int y, exr_chunk_info_t* cinfo)
+/* fill in the parts of the chunk info for the scanline chunk
+ * containing y which do not need the chunk leader, and find the
+ * file offset of the leader */
+static exr_result_t
+prepare_scanline_chunk_info (
+    exr_const_context_t   ctxt,
+    exr_const_priv_part_t part,
+    int                   y,
+    exr_chunk_info_t*     cinfo,
+    uint64_t**            ctable,
+    uint64_t*             leaderoff)
 {
     exr_result_t     rv;
-    int              miny, cidx, rdcnt, lpc;
-    int32_t          data[3];
-    int64_t          ddata[3];
+    int              miny, cidx, lpc;
     int64_t          fsize;
     uint64_t         chunkmin, dataoff;
     exr_attr_box2i_t dw;
-    uint64_t*        ctable;
-
-    EXR_READONLY_AND_DEFINE_PART (part_index);
 
     if (!cinfo) return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
 
@@ -797,12 +801,12 @@ exr_read_scanline_chunk_info (
     cinfo->level_y = 0;
 
     /* need to read from the file to get the packed chunk size */
-    rv = extract_chunk_table (ctxt, part, &ctable, &chunkmin);
+    rv = extract_chunk_table (ctxt, part, ctable, &chunkmin);
     if (rv != EXR_ERR_SUCCESS) return rv;
 
     fsize = ctxt->file_size;
 
-    dataoff = ctable[cidx];
+    dataoff = (*ctable)[cidx];
     if (dataoff < chunkmin || (fsize > 0 && dataoff > (uint64_t) fsize))
     {
         return ctxt->print_error (
@@ -814,26 +818,24 @@ exr_read_scanline_chunk_info (
             dataoff);
     }
 
-    /* TODO: Look at collapsing this into extract_chunk_leader, only
-     * issue is more concrete error messages */
-    /* multi part files have the part for validation */
-    rdcnt = (ctxt->is_multipart) ? 2 : 1;
-    /* deep has 64-bit data, so be variable about what we read */
-    if (part->storage_mode != EXR_STORAGE_DEEP_SCANLINE) ++rdcnt;
-
-    rv = ctxt->do_read (
-        ctxt,
-        data,
-        (size_t) (rdcnt) * sizeof (int32_t),
-        &dataoff,
-        NULL,
-        EXR_MUST_READ_ALL);
-
-    if (rv != EXR_ERR_SUCCESS) return rv;
+    *leaderoff = dataoff;
+    return EXR_ERR_SUCCESS;
+}
 
-    priv_to_native32 (data, rdcnt);
+/* check the part number and scanline in a (native order) scanline
+ * chunk leader, returning how many entries those took */
+static exr_result_t
+check_scanline_leader (
+    exr_const_context_t     ctxt,
+    int                     part_index,
+    int                     y,
+    const exr_chunk_info_t* cinfo,
+    int                     miny,
+    const int32_t*          data,
+    int*                    used)
+{
+    int rdcnt = 0;
 
-    rdcnt = 0;
     if (ctxt->is_multipart)
     {
         if (data[rdcnt] != part_index)
@@ -843,7 +845,7 @@ exr_read_scanline_chunk_info (
                 EXR_ERR_BAD_CHUNK_LEADER,
                 "Preparing read scanline %d (chunk %d), found corrupt leader: part says %d, expected %d",
                 y,
-                cidx,
+                cinfo->idx,
                 data[rdcnt],
                 part_index);
         }
@@ -856,117 +858,179 @@ exr_read_scanline_chunk_info (
             EXR_ERR_BAD_CHUNK_LEADER,
             "Preparing to read scanline %d (chunk %d), found corrupt leader: scanline says %d, expected %d",
             y,
-            cidx,
+            cinfo->idx,
             data[rdcnt],
             miny);
     }
+    *used = rdcnt + 1;
+    return EXR_ERR_SUCCESS;
+}
 
-    if (part->storage_mode == EXR_STORAGE_DEEP_SCANLINE)
+/* validate the packed size from the leader of a (non-deep) scanline
+ * chunk whose data starts at dataoff and finish the chunk info */
+static exr_result_t
+set_scanline_packed_size (
+    exr_const_context_t   ctxt,
+    exr_const_priv_part_t part,
+    int                   y,
+    exr_chunk_info_t*     cinfo,
+    int32_t               packed,
+    uint64_t              dataoff)
+{
+    int64_t  fsize = ctxt->file_size;
+    uint64_t unpacksize =
+        compute_chunk_unpack_size (
+            y, cinfo->width, cinfo->height, part->lines_per_chunk, part);
+
+    if (packed < 0 || (uint64_t) packed > part->unpacked_size_per_chunk)
     {
-        rv = ctxt->do_read (
+        return ctxt->print_error (
             ctxt,
-            ddata,
-            3 * sizeof (int64_t),
-            &dataoff,
-            NULL,
-            EXR_MUST_READ_ALL);
-        if (rv != EXR_ERR_SUCCESS) { return rv; }
-        priv_to_native64 (ddata, 3);
+            EXR_ERR_BAD_CHUNK_LEADER,
+            "Preparing to read scanline %d (chunk %d), found corrupt leader: packed data size says %" PRIu64
+            ", must be between 0 and %" PRIu64,
+            y,
+            cinfo->idx,
+            (uint64_t) packed,
+            part->unpacked_size_per_chunk);
+    }
 
-        if (ddata[0] < 0)
-        {
-            return ctxt->print_error (
-                ctxt,
-                EXR_ERR_BAD_CHUNK_LEADER,
-                "Preparing to read scanline %d (chunk %d), found corrupt leader: invalid sample table size %" PRId64,
-                y,
-                cidx,
-                ddata[0]);
-        }
-        if (ddata[1] < 0 || ddata[1] > (int64_t) INT_MAX)
-        {
-            return ctxt->print_error (
-                ctxt,
-                EXR_ERR_BAD_CHUNK_LEADER,
-                "Preparing to read scanline %d (chunk %d), found corrupt leader: invalid packed data size %" PRId64,
-                y,
-                cidx,
-                ddata[1]);
-        }
-        if (ddata[2] < 0 || ddata[2] > (int64_t) INT_MAX)
-        {
-            return ctxt->print_error (
-                ctxt,
-                EXR_ERR_BAD_CHUNK_LEADER,
-                "Preparing to scanline %d (chunk %d), found corrupt leader: unsupported unpacked data size %" PRId64,
-                y,
-                cidx,
-                ddata[2]);
-        }
+    cinfo->data_offset              = dataoff;
+    cinfo->packed_size              = (uint64_t) packed;
+    cinfo->unpacked_size            = unpacksize;
+    cinfo->sample_count_data_offset = 0;
+    cinfo->sample_count_table_size  = 0;
 
-        cinfo->sample_count_data_offset = dataoff;
-        cinfo->sample_count_table_size  = (uint64_t) ddata[0];
-        cinfo->data_offset              = dataoff + (uint64_t) ddata[0];
-        cinfo->packed_size              = (uint64_t) ddata[1];
-        cinfo->unpacked_size            = (uint64_t) ddata[2];
+    if (fsize > 0 &&
+        (cinfo->data_offset + cinfo->packed_size) > ((uint64_t) fsize))
+    {
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_BAD_CHUNK_LEADER,
+            "Preparing to read scanline %d (chunk %d), found corrupt leader: packed size %" PRIu64
+            ", file offset %" PRIu64 ", size %" PRId64,
+            y,
+            cinfo->idx,
+            cinfo->packed_size,
+            cinfo->data_offset,
+            fsize);
+    }
 
-        if (fsize > 0 &&
-            ((cinfo->sample_count_data_offset +
-              cinfo->sample_count_table_size) > ((uint64_t) fsize) ||
-             (cinfo->data_offset + cinfo->packed_size) > ((uint64_t) fsize)))
-        {
-            return ctxt->print_error (
-                ctxt,
-                EXR_ERR_BAD_CHUNK_LEADER,
-                "Preparing to scanline %d (chunk %d), found corrupt leader: sample table and data result in access past end of the file: sample table size %" PRId64
-                " + data size %" PRId64 " larger than file %" PRId64,
-                y,
-                cidx,
-                ddata[0],
-                ddata[1],
-                fsize);
-        }
+    if (cinfo->packed_size == 0 && cinfo->unpacked_size > 0)
+        return ctxt->report_error (
+            ctxt, EXR_ERR_INVALID_ARGUMENT, "Invalid packed size of 0");
+    return EXR_ERR_SUCCESS;
+}
+
+exr_result_t
+exr_read_scanline_chunk_info (
+    exr_const_context_t ctxt, int part_index, int y, exr_chunk_info_t* cinfo)
+{
+    exr_result_t rv;
+    int          rdcnt;
+    int32_t      data[3];
+    int64_t      ddata[3];
+    int64_t      fsize;
+    uint64_t     dataoff;
+    uint64_t*    ctable;
+
+    EXR_READONLY_AND_DEFINE_PART (part_index);
+
+    rv = prepare_scanline_chunk_info (ctxt, part, y, cinfo, &ctable, &dataoff);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    /* TODO: Look at collapsing this into extract_chunk_leader, only
+     * issue is more concrete error messages */
+    /* multi part files have the part for validation */
+    rdcnt = (ctxt->is_multipart) ? 2 : 1;
+    /* deep has 64-bit data, so be variable about what we read */
+    if (part->storage_mode != EXR_STORAGE_DEEP_SCANLINE) ++rdcnt;
+
+    rv = ctxt->do_read (
+        ctxt,
+        data,
+        (size_t) (rdcnt) * sizeof (int32_t),
+        &dataoff,
+        NULL,
+        EXR_MUST_READ_ALL);
+
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    priv_to_native32 (data, rdcnt);
+
+    rv = check_scanline_leader (
+        ctxt,
+        part_index,
+        y,
+        cinfo,
+        part->data_window.min.y + cinfo->idx * part->lines_per_chunk,
+        data,
+        &rdcnt);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    if (part->storage_mode != EXR_STORAGE_DEEP_SCANLINE)
+        return set_scanline_packed_size (
+            ctxt, part, y, cinfo, data[rdcnt], dataoff);
+
+    fsize = ctxt->file_size;
+
+    rv = ctxt->do_read (
+        ctxt, ddata, 3 * sizeof (int64_t), &dataoff, NULL, EXR_MUST_READ_ALL);
+    if (rv != EXR_ERR_SUCCESS) { return rv; }
+    priv_to_native64 (ddata, 3);
+
+    if (ddata[0] < 0)
+    {
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_BAD_CHUNK_LEADER,
+            "Preparing to read scanline %d (chunk %d), found corrupt leader: invalid sample table size %" PRId64,
+            y,
+            cinfo->idx,
+            ddata[0]);
     }
-    else
+    if (ddata[1] < 0 || ddata[1] > (int64_t) INT_MAX)
     {
-        uint64_t unpacksize = compute_chunk_unpack_size (
-            y, cinfo->width, cinfo->height, lpc, part);
-
-        ++rdcnt;
-        if (data[rdcnt] < 0 ||
-            (uint64_t) data[rdcnt] > part->unpacked_size_per_chunk)
-        {
-            return ctxt->print_error (
-                ctxt,
-                EXR_ERR_BAD_CHUNK_LEADER,
-                "Preparing to read scanline %d (chunk %d), found corrupt leader: packed data size says %" PRIu64
-                ", must be between 0 and %" PRIu64,
-                y,
-                cidx,
-                (uint64_t) data[rdcnt],
-                part->unpacked_size_per_chunk);
-        }
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_BAD_CHUNK_LEADER,
+            "Preparing to read scanline %d (chunk %d), found corrupt leader: invalid packed data size %" PRId64,
+            y,
+            cinfo->idx,
+            ddata[1]);
+    }
+    if (ddata[2] < 0 || ddata[2] > (int64_t) INT_MAX)
+    {
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_BAD_CHUNK_LEADER,
+            "Preparing to scanline %d (chunk %d), found corrupt leader: unsupported unpacked data size %" PRId64,
+            y,
+            cinfo->idx,
+            ddata[2]);
+    }
 
-        cinfo->data_offset              = dataoff;
-        cinfo->packed_size              = (uint64_t) data[rdcnt];
-        cinfo->unpacked_size            = unpacksize;
-        cinfo->sample_count_data_offset = 0;
-        cinfo->sample_count_table_size  = 0;
+    cinfo->sample_count_data_offset = dataoff;
+    cinfo->sample_count_table_size  = (uint64_t) ddata[0];
+    cinfo->data_offset              = dataoff + (uint64_t) ddata[0];
+    cinfo->packed_size              = (uint64_t) ddata[1];
+    cinfo->unpacked_size            = (uint64_t) ddata[2];
 
-        if (fsize > 0 &&
-            (cinfo->data_offset + cinfo->packed_size) > ((uint64_t) fsize))
-        {
-            return ctxt->print_error (
-                ctxt,
-                EXR_ERR_BAD_CHUNK_LEADER,
-                "Preparing to read scanline %d (chunk %d), found corrupt leader: packed size %" PRIu64
-                ", file offset %" PRIu64 ", size %" PRId64,
-                y,
-                cidx,
-                cinfo->packed_size,
-                cinfo->data_offset,
-                fsize);
-        }
+    if (fsize > 0 &&
+        ((cinfo->sample_count_data_offset + cinfo->sample_count_table_size) >
+             ((uint64_t) fsize) ||
+         (cinfo->data_offset + cinfo->packed_size) > ((uint64_t) fsize)))
+    {
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_BAD_CHUNK_LEADER,
+            "Preparing to scanline %d (chunk %d), found corrupt leader: sample table and data result in access past end of the file: sample table size %" PRId64
+            " + data size %" PRId64 " larger than file %" PRId64,
+            y,
+            cinfo->idx,
+            ddata[0],
+            ddata[1],
+            fsize);
     }
 
     if (cinfo->packed_size == 0 && cinfo->unpacked_size > 0)
@@ -977,28 +1041,28 @@ exr_read_scanline_chunk_info (
 
 /**************************************/
 
-exr_result_t
-exr_read_tile_chunk_info (
-    exr_const_context_t ctxt,
-    int                 part_index,
-    int                 tilex,
-    int                 tiley,
-    int                 levelx,
-    int                 levely,
-    exr_chunk_info_t*   cinfo)
+/* fill in the parts of the chunk info for a tile which do not need
+ * the chunk leader, and find the file offset of the leader */
+static exr_result_t
+prepare_tile_chunk_info (
+    exr_const_context_t   ctxt,
+    exr_const_priv_part_t part,
+    int                   tilex,
+    int                   tiley,
+    int                   levelx,
+    int                   levely,
+    exr_chunk_info_t*     cinfo,
+    uint64_t**            ctable,
+    uint64_t*             leaderoff)
 {
     exr_result_t               rv;
-    int32_t                    data[6];
-    int32_t*                   tdata;
-    int32_t                    cidx, ntoread;
+    int32_t                    cidx;
     uint64_t                   chunkmin, dataoff;
-    int64_t                    nread, fsize, tend, dend;
+    int64_t                    fsize, tend, dend;
     const exr_attr_chlist_t*   chanlist;
     const exr_attr_tiledesc_t* tiledesc;
     int                        tilew, tileh;
     uint64_t                   texels, unpacksize = 0;
-    uint64_t*                  ctable;
-    EXR_READONLY_AND_DEFINE_PART (part_index);
 
     if (!cinfo) return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
 
@@ -1059,27 +1123,15 @@ exr_read_tile_chunk_info (
         unpacksize +=
             texels * (uint64_t) ((curc->pixel_type == EXR_PIXEL_HALF) ? 2 : 4);
     }
+    /* the leader gives the real sizes for deep tiles */
+    cinfo->unpacked_size = unpacksize;
 
-    rv = extract_chunk_table (ctxt, part, &ctable, &chunkmin);
+    rv = extract_chunk_table (ctxt, part, ctable, &chunkmin);
     if (rv != EXR_ERR_SUCCESS) return rv;
 
-    /* TODO: Look at collapsing this into extract_chunk_leader, only
-     * issue is more concrete error messages */
-    if (part->storage_mode == EXR_STORAGE_DEEP_TILED)
-    {
-        if (ctxt->is_multipart)
-            ntoread = 5;
-        else
-            ntoread = 4;
-    }
-    else if (ctxt->is_multipart)
-        ntoread = 6;
-    else
-        ntoread = 5;
-
     fsize = ctxt->file_size;
 
-    dataoff = ctable[cidx];
+    dataoff = (*ctable)[cidx];
     if (dataoff < chunkmin || (fsize > 0 && dataoff > (uint64_t) fsize))
     {
         return ctxt->print_error (
@@ -1094,32 +1146,25 @@ exr_read_tile_chunk_info (
             dataoff);
     }
 
-    rv = ctxt->do_read (
-        ctxt,
-        data,
-        (uint64_t) (ntoread) * sizeof (int32_t),
-        &dataoff,
-        &nread,
-        EXR_MUST_READ_ALL);
-    if (rv != EXR_ERR_SUCCESS)
-    {
-        return ctxt->print_error (
-            ctxt,
-            rv,
-            "Unable to read information block for tile (%d, %d), level (%d, %d): request %" PRIu64
-            " bytes from offset %" PRIu64 ", got %" PRIu64 " bytes",
-            tilex,
-            tiley,
-            levelx,
-            levely,
-            (uint64_t) (ntoread) * sizeof (int32_t),
-            ctable[cidx],
-            (uint64_t) nread);
-    }
-    priv_to_native32 (data, ntoread);
-
-    tdata = data;
-    if (ctxt->is_multipart)
+    *leaderoff = dataoff;
+    return EXR_ERR_SUCCESS;
+}
+
+/* check the part number, tile and level in a (native order) tile
+ * chunk leader, returning how many entries those took */
+static exr_result_t
+check_tile_leader (
+    exr_const_context_t     ctxt,
+    int                     part_index,
+    const exr_chunk_info_t* cinfo,
+    const int32_t*          data,
+    int*                    used)
+{
+    const int32_t* tdata  = data;
+    int             tilex = cinfo->start_x, tiley = cinfo->start_y;
+    int             levelx = cinfo->level_x, levely = cinfo->level_y;
+
+    if (ctxt->is_multipart)
     {
         if (part_index != data[0])
         {
@@ -1131,7 +1176,7 @@ exr_read_tile_chunk_info (
                 tiley,
                 levelx,
                 levely,
-                cidx,
+                cinfo->idx,
                 data[0],
                 part_index);
         }
@@ -1147,7 +1192,7 @@ exr_read_tile_chunk_info (
             tiley,
             levelx,
             levely,
-            cidx,
+            cinfo->idx,
             tdata[0],
             tilex);
     }
@@ -1161,7 +1206,7 @@ exr_read_tile_chunk_info (
             tiley,
             levelx,
             levely,
-            cidx,
+            cinfo->idx,
             tdata[1],
             tiley);
     }
@@ -1175,7 +1220,7 @@ exr_read_tile_chunk_info (
             tiley,
             levelx,
             levely,
-            cidx,
+            cinfo->idx,
             tdata[2],
             levelx);
     }
@@ -1189,12 +1234,144 @@ exr_read_tile_chunk_info (
             tiley,
             levelx,
             levely,
-            cidx,
+            cinfo->idx,
             tdata[3],
             levely);
     }
+    *used = (int) (tdata - data) + 4;
+    return EXR_ERR_SUCCESS;
+}
+
+/* validate the packed size from the leader of a (non-deep) tile chunk
+ * whose data starts at dataoff and finish the chunk info */
+static exr_result_t
+set_tile_packed_size (
+    exr_const_context_t ctxt,
+    exr_chunk_info_t*   cinfo,
+    int32_t             packed,
+    uint64_t            dataoff)
+{
+    int64_t  fsize      = ctxt->file_size;
+    uint64_t unpacksize = cinfo->unpacked_size;
+
+    if (packed < 0 || ((uint64_t) packed) > unpacksize ||
+        (packed == 0 && unpacksize != 0))
+    {
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_BAD_CHUNK_LEADER,
+            "Corrupt tile (%d, %d), level (%d, %d) (chunk %d): invalid packed size %d vs unpacked size %" PRIu64,
+            cinfo->start_x,
+            cinfo->start_y,
+            (int) cinfo->level_x,
+            (int) cinfo->level_y,
+            cinfo->idx,
+            (int) packed,
+            unpacksize);
+    }
+    else if (fsize > 0)
+    {
+        uint64_t finpos = dataoff + (uint64_t) packed;
+        if (finpos > (uint64_t) fsize)
+        {
+            return ctxt->print_error (
+                ctxt,
+                EXR_ERR_BAD_CHUNK_LEADER,
+                "Corrupt tile (%d, %d), level (%d, %d) (chunk %d): access past end of file: packed size (%d) at offset %" PRIu64
+                " vs size of file %" PRId64,
+                cinfo->start_x,
+                cinfo->start_y,
+                (int) cinfo->level_x,
+                (int) cinfo->level_y,
+                cinfo->idx,
+                (int) packed,
+                dataoff,
+                fsize);
+        }
+    }
 
+    cinfo->packed_size              = (uint64_t) packed;
+    cinfo->unpacked_size            = unpacksize;
+    cinfo->data_offset              = dataoff;
+    cinfo->sample_count_data_offset = 0;
+    cinfo->sample_count_table_size  = 0;
+
+    if (cinfo->packed_size == 0 && cinfo->unpacked_size > 0)
+        return ctxt->report_error (
+            ctxt, EXR_ERR_INVALID_ARGUMENT, "Invalid packed size of 0");
+
+    return EXR_ERR_SUCCESS;
+}
+
+exr_result_t
+exr_read_tile_chunk_info (
+    exr_const_context_t ctxt,
+    int                 part_index,
+    int                 tilex,
+    int                 tiley,
+    int                 levelx,
+    int                 levely,
+    exr_chunk_info_t*   cinfo)
+{
+    exr_result_t rv;
+    int32_t      data[6];
+    int32_t      ntoread;
+    int          used;
+    uint64_t     dataoff;
+    int64_t      nread, fsize;
+    uint64_t*    ctable;
+    EXR_READONLY_AND_DEFINE_PART (part_index);
+
+    rv = prepare_tile_chunk_info (
+        ctxt, part, tilex, tiley, levelx, levely, cinfo, &ctable, &dataoff);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    /* TODO: Look at collapsing this into extract_chunk_leader, only
+     * issue is more concrete error messages */
     if (part->storage_mode == EXR_STORAGE_DEEP_TILED)
+    {
+        if (ctxt->is_multipart)
+            ntoread = 5;
+        else
+            ntoread = 4;
+    }
+    else if (ctxt->is_multipart)
+        ntoread = 6;
+    else
+        ntoread = 5;
+
+    fsize = ctxt->file_size;
+
+    rv = ctxt->do_read (
+        ctxt,
+        data,
+        (uint64_t) (ntoread) * sizeof (int32_t),
+        &dataoff,
+        &nread,
+        EXR_MUST_READ_ALL);
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        return ctxt->print_error (
+            ctxt,
+            rv,
+            "Unable to read information block for tile (%d, %d), level (%d, %d): request %" PRIu64
+            " bytes from offset %" PRIu64 ", got %" PRIu64 " bytes",
+            tilex,
+            tiley,
+            levelx,
+            levely,
+            (uint64_t) (ntoread) * sizeof (int32_t),
+            ctable[cinfo->idx],
+            (uint64_t) nread);
+    }
+    priv_to_native32 (data, ntoread);
+
+    rv = check_tile_leader (ctxt, part_index, cinfo, data, &used);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    if (part->storage_mode != EXR_STORAGE_DEEP_TILED)
+        return set_tile_packed_size (ctxt, cinfo, data[used], dataoff);
+
     {
         int64_t ddata[3];
         rv = ctxt->do_read (
@@ -1217,7 +1394,7 @@ exr_read_tile_chunk_info (
                 tiley,
                 levelx,
                 levely,
-                cidx,
+                cinfo->idx,
                 ddata[0]);
         }
 
@@ -1233,7 +1410,7 @@ exr_read_tile_chunk_info (
                 tiley,
                 levelx,
                 levely,
-                cidx,
+                cinfo->idx,
                 ddata[1]);
         }
 
@@ -1248,7 +1425,7 @@ exr_read_tile_chunk_info (
                 tiley,
                 levelx,
                 levely,
-                cidx,
+                cinfo->idx,
                 ddata[1]);
         }
         cinfo->sample_count_data_offset = dataoff;
@@ -1264,135 +1441,918 @@ exr_read_tile_chunk_info (
         {
             return ctxt->print_error (
                 ctxt,
-                EXR_ERR_BAD_CHUNK_LEADER,
-                "Corrupt deep tile (%d, %d), level (%d, %d) (chunk %d): access past end of the file: sample table size %" PRId64
-                " + data size %" PRId64 " larger than file %" PRId64,
-                tilex,
-                tiley,
-                levelx,
-                levely,
-                cidx,
-                ddata[0],
-                ddata[1],
-                fsize);
-        }
+                EXR_ERR_BAD_CHUNK_LEADER,
+                "Corrupt deep tile (%d, %d), level (%d, %d) (chunk %d): access past end of the file: sample table size %" PRId64
+                " + data size %" PRId64 " larger than file %" PRId64,
+                tilex,
+                tiley,
+                levelx,
+                levely,
+                cinfo->idx,
+                ddata[0],
+                ddata[1],
+                fsize);
+        }
+    }
+
+    if (cinfo->packed_size == 0 && cinfo->unpacked_size > 0)
+        return ctxt->report_error (
+            ctxt, EXR_ERR_INVALID_ARGUMENT, "Invalid packed size of 0");
+
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
+static int
+chunk_offset_cmp (const void* a, const void* b)
+{
+    uint64_t oa = *((const uint64_t*) a);
+    uint64_t ob = *((const uint64_t*) b);
+    return (oa < ob) ? -1 : ((oa > ob) ? 1 : 0);
+}
+
+/* the offset of the first chunk (of any part) starting after off,
+ * or the end of the file, or 0 if not known */
+static uint64_t
+find_chunk_end (
+    exr_const_context_t ctxt, const uint64_t* sorted, int count, uint64_t off)
+{
+    int lo = 0, hi = count;
+
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (sorted[mid] <= off)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo < count) return sorted[lo];
+    return (ctxt->file_size > 0) ? (uint64_t) ctxt->file_size : 0;
+}
+
+/* gather the chunk offsets of all the parts in the file, sorted, so
+ * the chunk following any other can be found */
+static exr_result_t
+gather_sorted_chunk_offsets (
+    exr_const_context_t ctxt, uint64_t** sortedout, int* countout)
+{
+    exr_result_t rv;
+    uint64_t*    sorted;
+    uint64_t*    ctable;
+    uint64_t     chunkmin;
+    int64_t      total = 0;
+    int          count = 0;
+
+    for (int p = 0; p < ctxt->num_parts; ++p)
+        total += ctxt->parts[p]->chunk_count;
+    if (total <= 0 || total > INT_MAX)
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Invalid total chunk count %" PRId64,
+            total);
+
+    sorted = ctxt->alloc_fn (sizeof (uint64_t) * (size_t) total);
+    if (!sorted) return ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
+
+    for (int p = 0; p < ctxt->num_parts; ++p)
+    {
+        exr_const_priv_part_t cpart = ctxt->parts[p];
+
+        if (cpart->chunk_count <= 0) continue;
+        rv = extract_chunk_table (ctxt, cpart, &ctable, &chunkmin);
+        if (rv != EXR_ERR_SUCCESS)
+        {
+            ctxt->free_fn (sorted);
+            return rv;
+        }
+        memcpy (
+            sorted + count,
+            ctable,
+            sizeof (uint64_t) * (size_t) cpart->chunk_count);
+        count += cpart->chunk_count;
+    }
+    qsort (sorted, (size_t) count, sizeof (uint64_t), &chunk_offset_cmp);
+
+    *sortedout = sorted;
+    *countout  = count;
+    return EXR_ERR_SUCCESS;
+}
+
+/* fill in the data offset and size of an index entry from the
+ * extent of the chunk, without reading the leader */
+static void
+set_chunk_index_extent (
+    exr_const_context_t   ctxt,
+    exr_const_priv_part_t part,
+    exr_chunk_info_t*     cinfo,
+    uint64_t              leaderoff,
+    uint64_t              end)
+{
+    uint64_t leadersz = 0;
+    int      isdeep   = (part->storage_mode == EXR_STORAGE_DEEP_SCANLINE ||
+                   part->storage_mode == EXR_STORAGE_DEEP_TILED);
+    uint64_t extent;
+
+    if (ctxt->is_multipart) leadersz += sizeof (int32_t);
+    if (part->storage_mode == EXR_STORAGE_TILED ||
+        part->storage_mode == EXR_STORAGE_DEEP_TILED)
+        leadersz += 4 * sizeof (int32_t);
+    else
+        leadersz += sizeof (int32_t);
+    if (isdeep)
+        leadersz += 3 * sizeof (int64_t);
+    else
+        leadersz += sizeof (int32_t);
+
+    cinfo->data_offset = leaderoff + leadersz;
+    extent = (end > cinfo->data_offset) ? (end - cinfo->data_offset) : 0;
+
+    if (isdeep)
+    {
+        /* the split between the sample table and the data, and the
+         * unpacked size, are only in the leader */
+        cinfo->sample_count_data_offset = cinfo->data_offset;
+        cinfo->sample_count_table_size  = 0;
+        cinfo->packed_size              = extent;
+        cinfo->unpacked_size            = 0;
+    }
+    else
+    {
+        /* the packed data can never be larger than the unpacked */
+        if (end == 0 || extent > cinfo->unpacked_size)
+            extent = cinfo->unpacked_size;
+        cinfo->packed_size              = extent;
+        cinfo->sample_count_data_offset = 0;
+        cinfo->sample_count_table_size  = 0;
+    }
+}
+
+exr_result_t
+exr_get_chunk_index (
+    exr_const_context_t ctxt,
+    int                 part_index,
+    int32_t*            count,
+    exr_chunk_info_t*   cinfos)
+{
+    exr_result_t rv = EXR_ERR_SUCCESS;
+    uint64_t*    ctable;
+    uint64_t*    sorted  = NULL;
+    int          nsorted = 0;
+    EXR_READONLY_AND_DEFINE_PART (part_index);
+
+    if (!count) return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+
+    if (!cinfos)
+    {
+        *count = part->chunk_count;
+        return EXR_ERR_SUCCESS;
+    }
+
+    if (*count < part->chunk_count)
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Chunk index for part %d needs %d entries, only %d provided",
+            part_index,
+            part->chunk_count,
+            *count);
+    *count = part->chunk_count;
+    if (part->chunk_count <= 0) return EXR_ERR_SUCCESS;
+
+    rv = gather_sorted_chunk_offsets (ctxt, &sorted, &nsorted);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    if (part->storage_mode == EXR_STORAGE_SCANLINE ||
+        part->storage_mode == EXR_STORAGE_DEEP_SCANLINE)
+    {
+        int lpc  = part->lines_per_chunk;
+        int miny = part->data_window.min.y;
+
+        for (int c = 0; rv == EXR_ERR_SUCCESS && c < part->chunk_count; ++c)
+        {
+            exr_chunk_info_t* cinfo = cinfos + c;
+            uint64_t          leaderoff;
+
+            rv = prepare_scanline_chunk_info (
+                ctxt, part, miny + c * lpc, cinfo, &ctable, &leaderoff);
+            if (rv != EXR_ERR_SUCCESS) break;
+
+            cinfo->unpacked_size = compute_chunk_unpack_size (
+                cinfo->start_y, cinfo->width, cinfo->height, lpc, part);
+            set_chunk_index_extent (
+                ctxt,
+                part,
+                cinfo,
+                leaderoff,
+                find_chunk_end (ctxt, sorted, nsorted, leaderoff));
+        }
+    }
+    else
+    {
+        const exr_attr_tiledesc_t* tiledesc = part->tiles->tiledesc;
+        int ripmap = (EXR_GET_TILE_LEVEL_MODE ((*tiledesc)) ==
+                      EXR_TILE_RIPMAP_LEVELS);
+
+        for (int ly = 0; ly < part->num_tile_levels_y; ++ly)
+        {
+            for (int lx = 0; lx < part->num_tile_levels_x; ++lx)
+            {
+                if (!ripmap && lx != ly) continue;
+
+                for (int ty = 0; ty < part->tile_level_tile_count_y[ly]; ++ty)
+                {
+                    for (int tx = 0;
+                         rv == EXR_ERR_SUCCESS &&
+                         tx < part->tile_level_tile_count_x[lx];
+                         ++tx)
+                    {
+                        exr_chunk_info_t cinfo;
+                        uint64_t         leaderoff;
+
+                        rv = prepare_tile_chunk_info (
+                            ctxt,
+                            part,
+                            tx,
+                            ty,
+                            lx,
+                            ly,
+                            &cinfo,
+                            &ctable,
+                            &leaderoff);
+                        if (rv != EXR_ERR_SUCCESS) break;
+
+                        set_chunk_index_extent (
+                            ctxt,
+                            part,
+                            &cinfo,
+                            leaderoff,
+                            find_chunk_end (ctxt, sorted, nsorted, leaderoff));
+                        cinfos[cinfo.idx] = cinfo;
+                    }
+                }
+            }
+        }
+    }
+
+    ctxt->free_fn (sorted);
+    return rv;
+}
+
+static exr_result_t
+validate_chunk_read (
+    exr_const_context_t     ctxt,
+    exr_const_priv_part_t   part,
+    const exr_chunk_info_t* cinfo,
+    const void*             packed_data)
+{
+    if (!cinfo) return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+    if (cinfo->packed_size > 0 && !packed_data)
+        return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+
+    if (cinfo->idx < 0 || cinfo->idx >= part->chunk_count)
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "invalid chunk index (%d) vs part chunk count %d",
+            cinfo->idx,
+            part->chunk_count);
+    if (cinfo->type != (uint8_t) part->storage_mode)
+        return ctxt->report_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "mismatched storage type for chunk block info");
+    if (cinfo->compression != (uint8_t) part->comp_type)
+        return ctxt->report_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "mismatched compression type for chunk block info");
+
+    if (ctxt->file_size > 0 && cinfo->data_offset > (uint64_t) ctxt->file_size)
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "chunk block info data offset (%" PRIu64
+            ") past end of file (%" PRId64 ")",
+            cinfo->data_offset,
+            ctxt->file_size);
+
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
+exr_result_t
+exr_read_chunk (
+    exr_const_context_t     ctxt,
+    int                     part_index,
+    const exr_chunk_info_t* cinfo,
+    void*                   packed_data)
+{
+    exr_result_t                 rv;
+    uint64_t                     dataoffset, toread;
+    int64_t                      nread;
+    enum _INTERNAL_EXR_READ_MODE rmode = EXR_MUST_READ_ALL;
+    EXR_READONLY_AND_DEFINE_PART (part_index);
+
+    rv = validate_chunk_read (ctxt, part, cinfo, packed_data);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    dataoffset = cinfo->data_offset;
+
+    /* allow a short read if uncompressed */
+    if (part->comp_type == EXR_COMPRESSION_NONE) rmode = EXR_ALLOW_SHORT_READ;
+
+    toread = cinfo->packed_size;
+    if (toread > 0)
+    {
+        nread = 0;
+        rv    = ctxt->do_read (
+            ctxt, packed_data, toread, &dataoffset, &nread, rmode);
+
+        if (rmode == EXR_ALLOW_SHORT_READ && nread < (int64_t) toread)
+            memset (
+                ((uint8_t*) packed_data) + nread,
+                0,
+                toread - (uint64_t) (nread));
+    }
+    else
+        rv = EXR_ERR_SUCCESS;
+
+    return rv;
+}
+
+/**************************************/
+
+/* how many bytes of packed data are expected to follow the leader of
+ * a chunk, from the offset of the chunk written after it in the file
+ * (or the end of the file for the last one), or 0 if that does not
+ * look like a plausible neighbour */
+static uint64_t
+estimate_chunk_packed_size (
+    exr_const_context_t   ctxt,
+    exr_const_priv_part_t part,
+    const uint64_t*       ctable,
+    int                   cidx,
+    uint64_t              dataoff)
+{
+    uint64_t next = 0;
+    int      nidx = cidx + 1;
+
+    /* scanlines are written bottom to top in decreasing y files, but
+     * tiles still go left to right in each row */
+    if (part->storage_mode == EXR_STORAGE_SCANLINE &&
+        part->lineorder == EXR_LINEORDER_DECREASING_Y)
+        nidx = cidx - 1;
+
+    if (nidx >= 0 && nidx < part->chunk_count)
+        next = ctable[nidx];
+    else if (ctxt->file_size > 0)
+        next = (uint64_t) ctxt->file_size;
+
+    /* written out of order, or the last chunk of a part followed by
+     * others, better to do a second read than a long useless one */
+    if (next <= dataoff || (next - dataoff) > part->unpacked_size_per_chunk)
+        return 0;
+    return next - dataoff;
+}
+
+/* read the leader of nleader ints at leaderoff along with up to
+ * estimate bytes of packed data in one request, returning the number
+ * of packed data bytes now at the start of packed_data */
+static exr_result_t
+read_leader_and_data (
+    exr_const_context_t ctxt,
+    uint64_t            leaderoff,
+    int32_t*            leader,
+    int                 nleader,
+    uint64_t            estimate,
+    uint8_t*            packed_data,
+    uint64_t            packed_alloc_size,
+    uint64_t*           got)
+{
+    exr_result_t rv;
+    uint64_t     leadersz = (uint64_t) nleader * sizeof (int32_t);
+    uint64_t     dataoff  = leaderoff;
+    int64_t      nread    = 0;
+
+    *got = 0;
+    if (estimate > packed_alloc_size) estimate = packed_alloc_size;
+
+    if (estimate > 0 && ctxt->read_scatter_fn)
+    {
+        void*    bufs[2];
+        uint64_t sizes[2];
+
+        bufs[0]  = leader;
+        sizes[0] = leadersz;
+        bufs[1]  = packed_data;
+        sizes[1] = estimate;
+
+        nread = ctxt->read_scatter_fn (
+            ctxt, ctxt->user_data, 2, bufs, sizes, leaderoff);
+        if (nread >= 0 && (uint64_t) nread >= leadersz)
+        {
+            *got = (uint64_t) nread - leadersz;
+            return EXR_ERR_SUCCESS;
+        }
+    }
+    else if (estimate > 0 && packed_alloc_size >= leadersz)
+    {
+        /* read in to the data buffer and slide the data down over
+         * the leader afterwards */
+        if (estimate > packed_alloc_size - leadersz)
+            estimate = packed_alloc_size - leadersz;
+
+        rv = ctxt->do_read (
+            ctxt,
+            packed_data,
+            leadersz + estimate,
+            &dataoff,
+            &nread,
+            EXR_ALLOW_SHORT_READ);
+        if (rv == EXR_ERR_SUCCESS && (uint64_t) nread >= leadersz)
+        {
+            memcpy (leader, packed_data, leadersz);
+            *got = (uint64_t) nread - leadersz;
+            if (*got > 0) memmove (packed_data, packed_data + leadersz, *got);
+            return EXR_ERR_SUCCESS;
+        }
+    }
+    else
+    {
+        rv = ctxt->do_read (
+            ctxt, leader, leadersz, &dataoff, &nread, EXR_MUST_READ_ALL);
+        if (rv == EXR_ERR_SUCCESS) return rv;
+    }
+
+    return ctxt->print_error (
+        ctxt,
+        EXR_ERR_READ_IO,
+        "Unable to read chunk leader: request %" PRIu64
+        " bytes from offset %" PRIu64 ", got %" PRId64 " bytes",
+        leadersz,
+        leaderoff,
+        nread);
+}
+
+/* read whatever of the packed data the leader read did not get */
+static exr_result_t
+finish_chunk_with_info (
+    exr_const_context_t     ctxt,
+    exr_const_priv_part_t   part,
+    const exr_chunk_info_t* cinfo,
+    uint8_t*                packed_data,
+    uint64_t                packed_alloc_size,
+    uint64_t                got)
+{
+    exr_result_t                 rv;
+    uint64_t                     dataoffset;
+    int64_t                      nread;
+    enum _INTERNAL_EXR_READ_MODE rmode = EXR_MUST_READ_ALL;
+
+    if (cinfo->packed_size > packed_alloc_size)
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Packed data for chunk %d needs %" PRIu64
+            " bytes, buffer only holds %" PRIu64,
+            cinfo->idx,
+            cinfo->packed_size,
+            packed_alloc_size);
+
+    if (got >= cinfo->packed_size) return EXR_ERR_SUCCESS;
+
+    /* allow a short read if uncompressed */
+    if (part->comp_type == EXR_COMPRESSION_NONE) rmode = EXR_ALLOW_SHORT_READ;
+
+    dataoffset = cinfo->data_offset + got;
+    nread      = 0;
+    rv         = ctxt->do_read (
+        ctxt,
+        packed_data + got,
+        cinfo->packed_size - got,
+        &dataoffset,
+        &nread,
+        rmode);
+
+    if (rmode == EXR_ALLOW_SHORT_READ &&
+        nread < (int64_t) (cinfo->packed_size - got))
+    {
+        if (nread < 0) nread = 0;
+        memset (
+            packed_data + got + nread,
+            0,
+            cinfo->packed_size - got - (uint64_t) nread);
+    }
+    return rv;
+}
+
+exr_result_t
+exr_read_scanline_chunk_with_info (
+    exr_const_context_t ctxt,
+    int                 part_index,
+    int                 y,
+    exr_chunk_info_t*   cinfo,
+    void*               packed_data,
+    uint64_t            packed_alloc_size)
+{
+    exr_result_t rv;
+    int          rdcnt, used;
+    int32_t      data[3];
+    uint64_t     leaderoff, estimate, got;
+    uint64_t*    ctable;
+    EXR_READONLY_AND_DEFINE_PART (part_index);
+
+    if (packed_alloc_size > 0 && !packed_data)
+        return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+    if (part->storage_mode == EXR_STORAGE_DEEP_SCANLINE)
+        return ctxt->report_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Reading the chunk with its info is not supported for deep data");
+
+    rv = prepare_scanline_chunk_info (
+        ctxt, part, y, cinfo, &ctable, &leaderoff);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    rdcnt    = (ctxt->is_multipart) ? 3 : 2;
+    estimate = estimate_chunk_packed_size (
+        ctxt,
+        part,
+        ctable,
+        cinfo->idx,
+        leaderoff + (uint64_t) rdcnt * sizeof (int32_t));
+
+    rv = read_leader_and_data (
+        ctxt,
+        leaderoff,
+        data,
+        rdcnt,
+        estimate,
+        packed_data,
+        packed_alloc_size,
+        &got);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    priv_to_native32 (data, rdcnt);
+
+    rv = check_scanline_leader (
+        ctxt,
+        part_index,
+        y,
+        cinfo,
+        part->data_window.min.y + cinfo->idx * part->lines_per_chunk,
+        data,
+        &used);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    rv = set_scanline_packed_size (
+        ctxt,
+        part,
+        y,
+        cinfo,
+        data[used],
+        leaderoff + (uint64_t) rdcnt * sizeof (int32_t));
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    return finish_chunk_with_info (
+        ctxt, part, cinfo, packed_data, packed_alloc_size, got);
+}
+
+exr_result_t
+exr_read_tile_chunk_with_info (
+    exr_const_context_t ctxt,
+    int                 part_index,
+    int                 tilex,
+    int                 tiley,
+    int                 levelx,
+    int                 levely,
+    exr_chunk_info_t*   cinfo,
+    void*               packed_data,
+    uint64_t            packed_alloc_size)
+{
+    exr_result_t rv;
+    int          rdcnt, used;
+    int32_t      data[6];
+    uint64_t     leaderoff, estimate, got;
+    uint64_t*    ctable;
+    EXR_READONLY_AND_DEFINE_PART (part_index);
+
+    if (packed_alloc_size > 0 && !packed_data)
+        return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+    if (part->storage_mode == EXR_STORAGE_DEEP_TILED)
+        return ctxt->report_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Reading the chunk with its info is not supported for deep data");
+
+    rv = prepare_tile_chunk_info (
+        ctxt, part, tilex, tiley, levelx, levely, cinfo, &ctable, &leaderoff);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    rdcnt    = (ctxt->is_multipart) ? 6 : 5;
+    estimate = estimate_chunk_packed_size (
+        ctxt,
+        part,
+        ctable,
+        cinfo->idx,
+        leaderoff + (uint64_t) rdcnt * sizeof (int32_t));
+
+    rv = read_leader_and_data (
+        ctxt,
+        leaderoff,
+        data,
+        rdcnt,
+        estimate,
+        packed_data,
+        packed_alloc_size,
+        &got);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    priv_to_native32 (data, rdcnt);
+
+    rv = check_tile_leader (ctxt, part_index, cinfo, data, &used);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    rv = set_tile_packed_size (
+        ctxt,
+        cinfo,
+        data[used],
+        leaderoff + (uint64_t) rdcnt * sizeof (int32_t));
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    return finish_chunk_with_info (
+        ctxt, part, cinfo, packed_data, packed_alloc_size, got);
+}
+
+/**************************************/
+
+/* neighbouring chunks with less than this many bytes between them
+ * (i.e. the chunk leaders) are merged into a single read request */
+#define EXR_CHUNK_READ_MERGE_GAP 4096
+/* without a vectored read, merged chunks go through a temporary
+ * buffer, so limit how large that can get */
+#define EXR_CHUNK_READ_MAX_SPAN (16 * 1024 * 1024)
+
+typedef struct
+{
+    uint64_t offset;
+    int      idx;
+} chunk_read_order_t;
+
+static int
+chunk_read_order_cmp (const void* a, const void* b)
+{
+    const chunk_read_order_t* ca = (const chunk_read_order_t*) a;
+    const chunk_read_order_t* cb = (const chunk_read_order_t*) b;
+    if (ca->offset < cb->offset) return -1;
+    if (ca->offset > cb->offset) return 1;
+    return (ca->idx < cb->idx) ? -1 : ((ca->idx > cb->idx) ? 1 : 0);
+}
+
+/* after a merged read of nread bytes starting at spanstart, check the
+ * chunk got all of its data, zero filling short uncompressed reads
+ * the same as exr_read_chunk */
+static exr_result_t
+finish_merged_chunk (
+    exr_const_context_t     ctxt,
+    exr_const_priv_part_t   part,
+    const exr_chunk_info_t* cinfo,
+    void*                   packed_data,
+    uint64_t                spanstart,
+    int64_t                 nread)
+{
+    uint64_t rel = cinfo->data_offset - spanstart;
+    uint64_t got = 0;
+
+    if (nread > 0 && (uint64_t) nread > rel)
+    {
+        got = (uint64_t) nread - rel;
+        if (got > cinfo->packed_size) got = cinfo->packed_size;
+    }
+
+    if (got == cinfo->packed_size) return EXR_ERR_SUCCESS;
+
+    if (part->comp_type == EXR_COMPRESSION_NONE)
+    {
+        memset (((uint8_t*) packed_data) + got, 0, cinfo->packed_size - got);
+        return EXR_ERR_SUCCESS;
+    }
+
+    return ctxt->print_error (
+        ctxt,
+        EXR_ERR_READ_IO,
+        "Unable to read %" PRIu64 " bytes for chunk %d, got %" PRIu64,
+        cinfo->packed_size,
+        cinfo->idx,
+        got);
+}
+
+static exr_result_t
+read_merged_span (
+    exr_const_context_t       ctxt,
+    exr_const_priv_part_t     part,
+    const exr_chunk_info_t*   cinfos,
+    void* const*              packed_data,
+    const chunk_read_order_t* order,
+    int                       nchunks,
+    uint64_t                  spanend,
+    void**                    iobufs,
+    uint64_t*                 iosizes,
+    uint8_t*                  gapbuf)
+{
+    exr_result_t rv        = EXR_ERR_SUCCESS;
+    uint64_t     spanstart = order[0].offset;
+    int64_t      nread     = -1;
+
+    if (ctxt->read_scatter_fn)
+    {
+        int      nbufs = 0;
+        uint64_t pos   = spanstart;
+
+        for (int c = 0; c < nchunks; ++c)
+        {
+            const exr_chunk_info_t* cinfo = cinfos + order[c].idx;
+
+            if (cinfo->data_offset > pos)
+            {
+                iobufs[nbufs]  = gapbuf;
+                iosizes[nbufs] = cinfo->data_offset - pos;
+                ++nbufs;
+            }
+            iobufs[nbufs]  = packed_data[order[c].idx];
+            iosizes[nbufs] = cinfo->packed_size;
+            ++nbufs;
+            pos = cinfo->data_offset + cinfo->packed_size;
+        }
+
+        nread = ctxt->read_scatter_fn (
+            ctxt, ctxt->user_data, nbufs, iobufs, iosizes, spanstart);
+        if (nread < 0)
+            return ctxt->print_error (
+                ctxt,
+                EXR_ERR_READ_IO,
+                "Unable to read %" PRIu64 " bytes at offset %" PRIu64,
+                spanend - spanstart,
+                spanstart);
     }
     else
     {
-        if (tdata[4] < 0 || ((uint64_t) tdata[4]) > unpacksize ||
-            (tdata[4] == 0 && unpacksize != 0))
-        {
-            return ctxt->print_error (
-                ctxt,
-                EXR_ERR_BAD_CHUNK_LEADER,
-                "Corrupt tile (%d, %d), level (%d, %d) (chunk %d): invalid packed size %d vs unpacked size %" PRIu64,
-                tilex,
-                tiley,
-                levelx,
-                levely,
-                cidx,
-                (int) tdata[4],
-                unpacksize);
-        }
-        else if (fsize > 0)
+        uint64_t dataoffset = spanstart;
+        uint8_t* spanbuf;
+
+        spanbuf = ctxt->alloc_fn (spanend - spanstart);
+        if (!spanbuf) return ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
+
+        rv = ctxt->do_read (
+            ctxt,
+            spanbuf,
+            spanend - spanstart,
+            &dataoffset,
+            &nread,
+            EXR_ALLOW_SHORT_READ);
+        if (rv == EXR_ERR_SUCCESS)
         {
-            uint64_t finpos = dataoff + (uint64_t) tdata[4];
-            if (finpos > (uint64_t) fsize)
+            for (int c = 0; c < nchunks; ++c)
             {
-                return ctxt->print_error (
-                    ctxt,
-                    EXR_ERR_BAD_CHUNK_LEADER,
-                    "Corrupt tile (%d, %d), level (%d, %d) (chunk %d): access past end of file: packed size (%d) at offset %" PRIu64
-                    " vs size of file %" PRId64,
-                    tilex,
-                    tiley,
-                    levelx,
-                    levely,
-                    cidx,
-                    (int) tdata[4],
-                    dataoff,
-                    fsize);
+                const exr_chunk_info_t* cinfo = cinfos + order[c].idx;
+                uint64_t                rel   = cinfo->data_offset - spanstart;
+                uint64_t                avail = 0;
+
+                if ((uint64_t) nread > rel) avail = (uint64_t) nread - rel;
+                if (avail > cinfo->packed_size) avail = cinfo->packed_size;
+                if (avail > 0)
+                    memcpy (packed_data[order[c].idx], spanbuf + rel, avail);
             }
         }
-
-        cinfo->packed_size              = (uint64_t) tdata[4];
-        cinfo->unpacked_size            = unpacksize;
-        cinfo->data_offset              = dataoff;
-        cinfo->sample_count_data_offset = 0;
-        cinfo->sample_count_table_size  = 0;
+        ctxt->free_fn (spanbuf);
+        if (rv != EXR_ERR_SUCCESS) return rv;
     }
 
-    if (cinfo->packed_size == 0 && cinfo->unpacked_size > 0)
-        return ctxt->report_error (
-            ctxt, EXR_ERR_INVALID_ARGUMENT, "Invalid packed size of 0");
-
-    return EXR_ERR_SUCCESS;
+    for (int c = 0; rv == EXR_ERR_SUCCESS && c < nchunks; ++c)
+        rv = finish_merged_chunk (
+            ctxt,
+            part,
+            cinfos + order[c].idx,
+            packed_data[order[c].idx],
+            spanstart,
+            nread);
+    return rv;
 }
 
 exr_result_t
-exr_read_chunk (
+exr_read_chunks (
     exr_const_context_t     ctxt,
     int                     part_index,
-    const exr_chunk_info_t* cinfo,
-    void*                   packed_data)
+    int                     count,
+    const exr_chunk_info_t* cinfos,
+    void* const*            packed_data)
 {
-    exr_result_t                 rv;
-    uint64_t                     dataoffset, toread;
-    int64_t                      nread;
-    enum _INTERNAL_EXR_READ_MODE rmode = EXR_MUST_READ_ALL;
+    exr_result_t        rv;
+    chunk_read_order_t* order;
+    void**              iobufs  = NULL;
+    uint64_t*           iosizes = NULL;
+    uint8_t             gapbuf[EXR_CHUNK_READ_MERGE_GAP];
+    int                 nread   = 0;
+    uint64_t            maxspan = EXR_CHUNK_READ_MAX_SPAN;
     EXR_READONLY_AND_DEFINE_PART (part_index);
 
-    if (!cinfo) return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
-    if (cinfo->packed_size > 0 && !packed_data)
+    if (count < 0 || (count > 0 && (!cinfos || !packed_data)))
         return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+    if (count == 0) return EXR_ERR_SUCCESS;
 
-    if (cinfo->idx < 0 || cinfo->idx >= part->chunk_count)
-        return ctxt->print_error (
-            ctxt,
-            EXR_ERR_INVALID_ARGUMENT,
-            "invalid chunk index (%d) vs part chunk count %d",
-            cinfo->idx,
-            part->chunk_count);
-    if (cinfo->type != (uint8_t) part->storage_mode)
-        return ctxt->report_error (
-            ctxt,
-            EXR_ERR_INVALID_ARGUMENT,
-            "mismatched storage type for chunk block info");
-    if (cinfo->compression != (uint8_t) part->comp_type)
-        return ctxt->report_error (
-            ctxt,
-            EXR_ERR_INVALID_ARGUMENT,
-            "mismatched compression type for chunk block info");
+    for (int c = 0; c < count; ++c)
+    {
+        rv = validate_chunk_read (ctxt, part, cinfos + c, packed_data[c]);
+        if (rv != EXR_ERR_SUCCESS) return rv;
+    }
 
-    dataoffset = cinfo->data_offset;
-    if (ctxt->file_size > 0 && dataoffset > (uint64_t) ctxt->file_size)
-        return ctxt->print_error (
-            ctxt,
-            EXR_ERR_INVALID_ARGUMENT,
-            "chunk block info data offset (%" PRIu64
-            ") past end of file (%" PRId64 ")",
-            dataoffset,
-            ctxt->file_size);
+    /* the mapping makes each read a simple copy, nothing to merge */
+    if (ctxt->mapped_data || count == 1)
+    {
+        for (int c = 0; c < count; ++c)
+        {
+            rv = exr_read_chunk (ctxt, part_index, cinfos + c, packed_data[c]);
+            if (rv != EXR_ERR_SUCCESS) return rv;
+        }
+        return EXR_ERR_SUCCESS;
+    }
 
-    /* allow a short read if uncompressed */
-    if (part->comp_type == EXR_COMPRESSION_NONE) rmode = EXR_ALLOW_SHORT_READ;
+    order = ctxt->alloc_fn (sizeof (chunk_read_order_t) * (size_t) count);
+    if (!order) return ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
 
-    toread = cinfo->packed_size;
-    if (toread > 0)
+    for (int c = 0; c < count; ++c)
     {
-        nread = 0;
-        rv    = ctxt->do_read (
-            ctxt, packed_data, toread, &dataoffset, &nread, rmode);
+        if (cinfos[c].packed_size == 0) continue;
+        order[nread].offset = cinfos[c].data_offset;
+        order[nread].idx    = c;
+        ++nread;
+    }
+    qsort (order, (size_t) nread, sizeof (chunk_read_order_t), &chunk_read_order_cmp);
 
-        if (rmode == EXR_ALLOW_SHORT_READ && nread < (int64_t) toread)
-            memset (
-                ((uint8_t*) packed_data) + nread,
-                0,
-                toread - (uint64_t) (nread));
+    if (ctxt->read_scatter_fn)
+    {
+        /* each chunk may need a gap entry in front of it */
+        iobufs  = ctxt->alloc_fn (sizeof (void*) * (size_t) nread * 2);
+        iosizes = ctxt->alloc_fn (sizeof (uint64_t) * (size_t) nread * 2);
+        if (!iobufs || !iosizes)
+        {
+            ctxt->free_fn (order);
+            if (iobufs) ctxt->free_fn (iobufs);
+            if (iosizes) ctxt->free_fn (iosizes);
+            return ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
+        }
+        maxspan = UINT64_MAX;
     }
-    else
-        rv = EXR_ERR_SUCCESS;
 
+    rv = EXR_ERR_SUCCESS;
+    for (int s = 0; rv == EXR_ERR_SUCCESS && s < nread;)
+    {
+        const exr_chunk_info_t* first   = cinfos + order[s].idx;
+        uint64_t                spanend = first->data_offset + first->packed_size;
+        int                     e       = s + 1;
+
+        if (spanend >= first->data_offset)
+        {
+            while (e < nread)
+            {
+                const exr_chunk_info_t* next = cinfos + order[e].idx;
+                uint64_t nextend = next->data_offset + next->packed_size;
+
+                if (next->data_offset < spanend ||
+                    (next->data_offset - spanend) > EXR_CHUNK_READ_MERGE_GAP ||
+                    nextend < next->data_offset ||
+                    (nextend - first->data_offset) > maxspan)
+                    break;
+                spanend = nextend;
+                ++e;
+            }
+        }
+
+        if (e - s == 1)
+            rv = exr_read_chunk (
+                ctxt, part_index, first, packed_data[order[s].idx]);
+        else
+            rv = read_merged_span (
+                ctxt,
+                part,
+                cinfos,
+                packed_data,
+                order + s,
+                e - s,
+                spanend,
+                iobufs,
+                iosizes,
+                gapbuf);
+        s = e;
+    }
+
+    ctxt->free_fn (order);
+    if (iobufs) ctxt->free_fn (iobufs);
+    if (iosizes) ctxt->free_fn (iosizes);
     return rv;
 }
 
@@ -1477,6 +2437,118 @@ exr_read_deep_chunk (
 
 /**************************************/
 
+static exr_result_t
+write_chunk_table (
+    exr_context_t ctxt, exr_const_priv_part_t part, uint64_t* ctable)
+{
+    exr_result_t rv;
+    uint64_t     chunkoff = part->chunk_table_offset;
+
+    priv_from_native64 (ctable, part->chunk_count);
+    rv = ctxt->do_write (
+        ctxt,
+        ctable,
+        sizeof (uint64_t) * (uint64_t) (part->chunk_count),
+        &chunkoff);
+    /* just in case we look at it again? */
+    priv_to_native64 (ctable, part->chunk_count);
+    return rv;
+}
+
+/**************************************/
+
+/* the part of writing a chunk shared by scanlines and tiles: reserves
+ * space for the chunk at the current end of the file, writes the
+ * leader and the data there, and once the whole part is written, its
+ * chunk table. The chunks of different parts may be interleaved.
+ * Called with the context locked; when writing chunks in any order,
+ * the lock is released while the data is written so that several
+ * threads can write their chunks at the same time */
+static exr_result_t
+write_chunk (
+    exr_context_t   ctxt,
+    exr_priv_part_t part,
+    int             cidx,
+    const int32_t*  leader,
+    int             leadercount,
+    const void*     packed_data,
+    uint64_t        packed_size,
+    uint64_t        unpacked_size,
+    const void*     sample_data,
+    uint64_t        sample_data_size)
+{
+    exr_result_t rv;
+    uint64_t*    ctable = NULL;
+    uint64_t     chunkoff, chunkbytes;
+    int64_t      ddata[3];
+    int          isdeep;
+
+    isdeep = (part->storage_mode == EXR_STORAGE_DEEP_SCANLINE ||
+              part->storage_mode == EXR_STORAGE_DEEP_TILED);
+
+    rv = alloc_chunk_table (ctxt, part, &ctable);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    if (ctxt->unordered_write && ctable[cidx] != 0)
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_INCORRECT_CHUNK,
+            "Chunk %d has already been written",
+            cidx);
+
+    chunkbytes = (uint64_t) (leadercount) * sizeof (int32_t) + packed_size;
+    if (isdeep) chunkbytes += sizeof (ddata) + sample_data_size;
+
+    chunkoff     = ctxt->output_file_offset;
+    ctable[cidx] = chunkoff;
+    ctxt->output_file_offset += chunkbytes;
+
+    if (ctxt->unordered_write) internal_exr_unlock (ctxt);
+
+    rv = ctxt->do_write (
+        ctxt, leader, (uint64_t) (leadercount) * sizeof (int32_t), &chunkoff);
+    if (rv == EXR_ERR_SUCCESS && isdeep)
+    {
+        ddata[0] = (int64_t) sample_data_size;
+        ddata[1] = (int64_t) packed_size;
+        ddata[2] = (int64_t) unpacked_size;
+
+        priv_from_native64 (ddata, 3);
+
+        rv = ctxt->do_write (ctxt, ddata, sizeof (ddata), &chunkoff);
+
+        if (rv == EXR_ERR_SUCCESS)
+            rv = ctxt->do_write (
+                ctxt, sample_data, sample_data_size, &chunkoff);
+    }
+    if (rv == EXR_ERR_SUCCESS && packed_size > 0)
+        rv = ctxt->do_write (ctxt, packed_data, packed_size, &chunkoff);
+
+    if (ctxt->unordered_write) internal_exr_lock (ctxt);
+
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        /* the space stays reserved, but the chunk can be written again */
+        ctable[cidx] = 0;
+        return rv;
+    }
+
+    part->last_output_chunk = cidx;
+    ++(part->output_chunk_count);
+    if (part->output_chunk_count == part->chunk_count)
+    {
+        ++(ctxt->output_parts_done);
+        if (ctxt->output_parts_done == ctxt->num_parts)
+            ctxt->mode = EXR_CONTEXT_WRITE_FINISHED;
+
+        rv = write_chunk_table (ctxt, part, ctable);
+    }
+
+    return rv;
+}
+
+/**************************************/
+
 /* pull most of the logic to here to avoid having to unlock at every
  * error exit point and re-use mostly shared logic */
 static exr_result_t
@@ -1491,11 +2563,9 @@ write_scan_chunk (
     const void*     sample_data,
     uint64_t        sample_data_size)
 {
-    exr_result_t rv;
-    int32_t      data[3];
-    int32_t      psize;
-    int          cidx, lpc, miny, wrcnt;
-    uint64_t*    ctable;
+    int32_t data[3];
+    int32_t psize;
+    int     cidx, lpc, miny, wrcnt;
 
     if (ctxt->mode != EXR_CONTEXT_WRITING_DATA)
     {
@@ -1510,8 +2580,12 @@ write_scan_chunk (
         return ctxt->standard_error (ctxt, EXR_ERR_SCAN_TILE_MIXEDAPI);
     }
 
-    if (ctxt->cur_output_part != part_index)
-        return ctxt->standard_error (ctxt, EXR_ERR_INCORRECT_PART);
+    if (part->output_chunk_count == part->chunk_count)
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_INCORRECT_PART,
+            "All chunks of part %d have already been written",
+            part_index);
 
     if (packed_size > 0 && !packed_data)
         return ctxt->print_error (
@@ -1582,8 +2656,8 @@ write_scan_chunk (
             part->chunk_count);
     }
 
-    if (part->lineorder != EXR_LINEORDER_RANDOM_Y &&
-        ctxt->last_output_chunk != (cidx - 1))
+    if (part->lineorder != EXR_LINEORDER_RANDOM_Y && !ctxt->unordered_write &&
+        part->last_output_chunk != (cidx - 1))
     {
         return ctxt->standard_error (ctxt, EXR_ERR_INCORRECT_CHUNK);
     }
@@ -1613,62 +2687,17 @@ write_scan_chunk (
     }
     priv_from_native32 (data, wrcnt);
 
-    rv = alloc_chunk_table (ctxt, part, &ctable);
-    if (rv != EXR_ERR_SUCCESS) return rv;
-
-    ctable[cidx] = ctxt->output_file_offset;
-    rv           = ctxt->do_write (
+    return write_chunk (
         ctxt,
+        part,
+        cidx,
         data,
-        (uint64_t) (wrcnt) * sizeof (int32_t),
-        &(ctxt->output_file_offset));
-    if (rv == EXR_ERR_SUCCESS &&
-        part->storage_mode == EXR_STORAGE_DEEP_SCANLINE)
-    {
-        int64_t ddata[3];
-        ddata[0] = (int64_t) sample_data_size;
-        ddata[1] = (int64_t) packed_size;
-        ddata[2] = (int64_t) unpacked_size;
-        rv       = ctxt->do_write (
-            ctxt, ddata, 3 * sizeof (uint64_t), &(ctxt->output_file_offset));
-
-        if (rv == EXR_ERR_SUCCESS)
-            rv = ctxt->do_write (
-                ctxt,
-                sample_data,
-                sample_data_size,
-                &(ctxt->output_file_offset));
-    }
-    if (rv == EXR_ERR_SUCCESS && packed_size > 0)
-        rv = ctxt->do_write (
-            ctxt, packed_data, packed_size, &(ctxt->output_file_offset));
-
-    if (rv == EXR_ERR_SUCCESS)
-    {
-        ++(ctxt->output_chunk_count);
-        if (ctxt->output_chunk_count == part->chunk_count)
-        {
-            uint64_t chunkoff = part->chunk_table_offset;
-
-            ++(ctxt->cur_output_part);
-            if (ctxt->cur_output_part == ctxt->num_parts)
-                ctxt->mode = EXR_CONTEXT_WRITE_FINISHED;
-            ctxt->last_output_chunk  = -1;
-            ctxt->output_chunk_count = 0;
-
-            priv_from_native64 (ctable, part->chunk_count);
-            rv = ctxt->do_write (
-                ctxt,
-                ctable,
-                sizeof (uint64_t) * (uint64_t) (part->chunk_count),
-                &chunkoff);
-            /* just in case we look at it again? */
-            priv_to_native64 (ctable, part->chunk_count);
-        }
-        else { ctxt->last_output_chunk = cidx; }
-    }
-
-    return rv;
+        wrcnt,
+        packed_data,
+        packed_size,
+        unpacked_size,
+        sample_data,
+        sample_data_size);
 }
 
 /**************************************/
@@ -1946,7 +2975,6 @@ write_tile_chunk (
     int32_t      data[6];
     int32_t      psize;
     int          cidx, wrcnt;
-    uint64_t*    ctable;
 
     if (ctxt->mode != EXR_CONTEXT_WRITING_DATA)
     {
@@ -1961,8 +2989,12 @@ write_tile_chunk (
         return ctxt->standard_error (ctxt, EXR_ERR_TILE_SCAN_MIXEDAPI);
     }
 
-    if (ctxt->cur_output_part != part_index)
-        return ctxt->standard_error (ctxt, EXR_ERR_INCORRECT_PART);
+    if (part->output_chunk_count == part->chunk_count)
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_INCORRECT_PART,
+            "All chunks of part %d have already been written",
+            part_index);
 
     if (!packed_data || packed_size == 0)
         return ctxt->print_error (
@@ -2010,15 +3042,15 @@ write_tile_chunk (
             part->chunk_count);
     }
 
-    if (part->lineorder != EXR_LINEORDER_RANDOM_Y &&
-        ctxt->last_output_chunk != (cidx - 1))
+    if (part->lineorder != EXR_LINEORDER_RANDOM_Y && !ctxt->unordered_write &&
+        part->last_output_chunk != (cidx - 1))
     {
         return ctxt->print_error (
             ctxt,
             EXR_ERR_INCORRECT_CHUNK,
             "Chunk index %d is not the next chunk to be written (last %d)",
             cidx,
-            ctxt->last_output_chunk);
+            part->last_output_chunk);
     }
 
     wrcnt = 0;
@@ -2031,64 +3063,17 @@ write_tile_chunk (
 
     priv_from_native32 (data, wrcnt);
 
-    rv = alloc_chunk_table (ctxt, part, &ctable);
-    if (rv != EXR_ERR_SUCCESS) return rv;
-
-    ctable[cidx] = ctxt->output_file_offset;
-    rv           = ctxt->do_write (
+    return write_chunk (
         ctxt,
+        part,
+        cidx,
         data,
-        (uint64_t) (wrcnt) * sizeof (int32_t),
-        &(ctxt->output_file_offset));
-    if (rv == EXR_ERR_SUCCESS && part->storage_mode == EXR_STORAGE_DEEP_TILED)
-    {
-        int64_t ddata[3];
-        ddata[0] = (int64_t) sample_data_size;
-        ddata[1] = (int64_t) packed_size;
-        ddata[2] = (int64_t) unpacked_size;
-
-        priv_from_native64 (ddata, 3);
-
-        rv = ctxt->do_write (
-            ctxt, ddata, 3 * sizeof (uint64_t), &(ctxt->output_file_offset));
-
-        if (rv == EXR_ERR_SUCCESS)
-            rv = ctxt->do_write (
-                ctxt,
-                sample_data,
-                sample_data_size,
-                &(ctxt->output_file_offset));
-    }
-    if (rv == EXR_ERR_SUCCESS)
-        rv = ctxt->do_write (
-            ctxt, packed_data, packed_size, &(ctxt->output_file_offset));
-
-    if (rv == EXR_ERR_SUCCESS)
-    {
-        ++(ctxt->output_chunk_count);
-        if (ctxt->output_chunk_count == part->chunk_count)
-        {
-            uint64_t chunkoff = part->chunk_table_offset;
-
-            ++(ctxt->cur_output_part);
-            if (ctxt->cur_output_part == ctxt->num_parts)
-                ctxt->mode = EXR_CONTEXT_WRITE_FINISHED;
-            ctxt->last_output_chunk  = -1;
-            ctxt->output_chunk_count = 0;
-
-            priv_from_native64 (ctable, part->chunk_count);
-            rv = ctxt->do_write (
-                ctxt,
-                ctable,
-                sizeof (uint64_t) * (uint64_t) (part->chunk_count),
-                &chunkoff);
-            /* just in case we look at it again? */
-            priv_to_native64 (ctable, part->chunk_count);
-        }
-        else { ctxt->last_output_chunk = cidx; }
-    }
-
-    return rv;
+        wrcnt,
+        packed_data,
+        packed_size,
+        unpacked_size,
+        sample_data,
+        sample_data_size);
 }
 
 /**************************************/
@@ -2177,8 +3162,12 @@ internal_validate_next_chunk (
     exr_result_t rv = EXR_ERR_SUCCESS;
     int          cidx, lpc;
 
-    if (ctxt->cur_output_part != encode->part_index)
-        return ctxt->standard_error (ctxt, EXR_ERR_INCORRECT_PART);
+    if (part->output_chunk_count == part->chunk_count)
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_INCORRECT_PART,
+            "All chunks of part %d have already been written",
+            encode->part_index);
 
     cidx = -1;
 
@@ -2220,14 +3209,14 @@ internal_validate_next_chunk (
         }
         else if (
             part->lineorder != EXR_LINEORDER_RANDOM_Y &&
-            ctxt->last_output_chunk != (cidx - 1))
+            !ctxt->unordered_write && part->last_output_chunk != (cidx - 1))
         {
             rv = ctxt->print_error (
                 ctxt,
                 EXR_ERR_INCORRECT_CHUNK,
                 "Attempt to write chunk %d, but last output chunk is %d",
                 cidx,
-                ctxt->last_output_chunk);
+                part->last_output_chunk);
         }
     }
     return rv;
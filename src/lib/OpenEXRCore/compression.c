@@ -9,6 +9,8 @@
 #include "internal_structs.h"
 
 #include <libdeflate.h>
+#include <stdlib.h>
+#include <string.h>
 
 #if (                                                                          \
     LIBDEFLATE_VERSION_MAJOR > 1 ||                                            \
@@ -50,6 +52,279 @@ exr_compress_max_buffer_size (size_t in_bytes)
 
 /**************************************/
 
+/* used when no context is provided (i.e. the C++ library) */
+static struct _internal_exr_codec_pool sGlobalCodecPool = {
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    .lock = SRWLOCK_INIT,
+#    else
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+#    endif
+#endif
+    .hits = 0};
+
+static void free_global_codec_pool (void);
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+static INIT_ONCE sGlobalCodecPoolOnce = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK
+register_global_codec_pool_fn (PINIT_ONCE once, PVOID param, PVOID* context)
+{
+    (void) once;
+    (void) param;
+    (void) context;
+    atexit (&free_global_codec_pool);
+    return TRUE;
+}
+#    else
+static pthread_once_t sGlobalCodecPoolOnce = PTHREAD_ONCE_INIT;
+
+static void
+register_global_codec_pool_fn (void)
+{
+    atexit (&free_global_codec_pool);
+}
+#    endif
+#endif
+
+/* the objects in the global pool are freed when the library is
+ * unloaded (atexit handlers registered by a shared library run then)
+ * or the process exits */
+static void
+register_global_codec_pool (void)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    InitOnceExecuteOnce (
+        &sGlobalCodecPoolOnce, &register_global_codec_pool_fn, NULL, NULL);
+#    else
+    pthread_once (&sGlobalCodecPoolOnce, &register_global_codec_pool_fn);
+#    endif
+#else
+    static int registered = 0;
+    if (!registered)
+    {
+        atexit (&free_global_codec_pool);
+        registered = 1;
+    }
+#endif
+}
+
+static inline struct _internal_exr_codec_pool*
+get_codec_pool (exr_const_context_t ctxt)
+{
+    if (ctxt)
+        return &(EXR_CONST_CAST (exr_context_t, ctxt)->codec_pool);
+    return &sGlobalCodecPool;
+}
+
+static inline void
+lock_codec_pool (struct _internal_exr_codec_pool* pool)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    AcquireSRWLockExclusive (&(pool->lock));
+#    else
+    pthread_mutex_lock (&(pool->lock));
+#    endif
+#else
+    (void) pool;
+#endif
+}
+
+static inline void
+unlock_codec_pool (struct _internal_exr_codec_pool* pool)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    ReleaseSRWLockExclusive (&(pool->lock));
+#    else
+    pthread_mutex_unlock (&(pool->lock));
+#    endif
+#else
+    (void) pool;
+#endif
+}
+
+static void
+free_pooled_obj (exr_const_context_t ctxt, int kind, void* obj)
+{
+    switch (kind)
+    {
+        case EXR_POOL_DEFLATE_COMPRESSOR:
+        case EXR_POOL_DEFLATE_DECOMPRESSOR:
+#ifndef EXR_USE_CONFIG_DEFLATE_STRUCT
+            libdeflate_set_memory_allocator (
+                ctxt ? ctxt->alloc_fn : internal_exr_alloc,
+                ctxt ? ctxt->free_fn : internal_exr_free);
+#endif
+            if (kind == EXR_POOL_DEFLATE_DECOMPRESSOR)
+                libdeflate_free_decompressor (
+                    (struct libdeflate_decompressor*) obj);
+            else
+                libdeflate_free_compressor (
+                    (struct libdeflate_compressor*) obj);
+            break;
+        case EXR_POOL_ZSTD_COMPRESSOR:
+        case EXR_POOL_ZSTD_DECOMPRESSOR:
+            internal_exr_free_zstd_context (obj);
+            break;
+        default: break;
+    }
+    (void) ctxt;
+}
+
+void*
+internal_exr_pool_acquire (exr_const_context_t ctxt, int kind, int64_t key)
+{
+    struct _internal_exr_codec_pool* pool = get_codec_pool (ctxt);
+    void*                            obj  = NULL;
+
+    lock_codec_pool (pool);
+    {
+        int n = pool->kinds[kind].count;
+        for (int i = n - 1; i >= 0; --i)
+        {
+            if (pool->kinds[kind].entries[i].key == key)
+            {
+                obj = pool->kinds[kind].entries[i].obj;
+                memmove (
+                    pool->kinds[kind].entries + i,
+                    pool->kinds[kind].entries + i + 1,
+                    (size_t) (n - i - 1) *
+                        sizeof (pool->kinds[kind].entries[0]));
+                pool->kinds[kind].count = n - 1;
+                break;
+            }
+        }
+    }
+    if (obj)
+        ++(pool->hits);
+    else
+        ++(pool->misses);
+    unlock_codec_pool (pool);
+    return obj;
+}
+
+void
+internal_exr_pool_release (
+    exr_const_context_t ctxt, int kind, int64_t key, void* obj)
+{
+    struct _internal_exr_codec_pool* pool    = get_codec_pool (ctxt);
+    void*                            evicted = NULL;
+
+    if (!obj) return;
+
+    if (!ctxt) register_global_codec_pool ();
+
+    lock_codec_pool (pool);
+    {
+        int n = pool->kinds[kind].count;
+
+        /* evict the least recently used object, so objects for keys
+         * that are no longer requested (odd chunk sizes, other
+         * levels) age out instead of filling the pool */
+        if (n >= (ctxt ? EXR_CODEC_POOL_SIZE : EXR_GLOBAL_CODEC_POOL_SIZE))
+        {
+            evicted = pool->kinds[kind].entries[0].obj;
+            memmove (
+                pool->kinds[kind].entries,
+                pool->kinds[kind].entries + 1,
+                (size_t) (n - 1) * sizeof (pool->kinds[kind].entries[0]));
+            n -= 1;
+        }
+
+        pool->kinds[kind].entries[n].obj = obj;
+        pool->kinds[kind].entries[n].key = key;
+        pool->kinds[kind].count          = n + 1;
+    }
+    unlock_codec_pool (pool);
+
+    if (evicted) free_pooled_obj (ctxt, kind, evicted);
+}
+
+exr_result_t
+internal_exr_init_codec_pool (struct _internal_exr_codec_pool* pool)
+{
+    memset (pool, 0, sizeof (*pool));
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    InitializeSRWLock (&(pool->lock));
+#    else
+    if (pthread_mutex_init (&(pool->lock), NULL) != 0)
+        return EXR_ERR_OUT_OF_MEMORY;
+#    endif
+#endif
+    return EXR_ERR_SUCCESS;
+}
+
+static void
+free_pooled_objs (
+    exr_const_context_t ctxt, struct _internal_exr_codec_pool* pool)
+{
+    for (int k = 0; k < EXR_POOL_KIND_COUNT; ++k)
+    {
+        for (int i = 0; i < pool->kinds[k].count; ++i)
+            free_pooled_obj (ctxt, k, pool->kinds[k].entries[i].obj);
+        pool->kinds[k].count = 0;
+    }
+}
+
+static void
+free_global_codec_pool (void)
+{
+    struct _internal_exr_codec_pool objs;
+
+    /* the lock stays usable, a thread still compressing just puts its
+     * object back into an empty pool */
+    lock_codec_pool (&sGlobalCodecPool);
+    memcpy (objs.kinds, sGlobalCodecPool.kinds, sizeof (objs.kinds));
+    for (int k = 0; k < EXR_POOL_KIND_COUNT; ++k)
+        sGlobalCodecPool.kinds[k].count = 0;
+    unlock_codec_pool (&sGlobalCodecPool);
+
+    free_pooled_objs (NULL, &objs);
+}
+
+void
+internal_exr_destroy_codec_pool (exr_context_t ctxt)
+{
+    struct _internal_exr_codec_pool* pool = &(ctxt->codec_pool);
+
+    free_pooled_objs (ctxt, pool);
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifndef _WIN32
+    pthread_mutex_destroy (&(pool->lock));
+#    endif
+#endif
+}
+
+/**************************************/
+
+exr_result_t
+exr_get_compression_cache_stats (
+    exr_const_context_t ctxt, uint64_t* hits, uint64_t* misses)
+{
+    struct _internal_exr_codec_pool* pool = get_codec_pool (ctxt);
+
+    if (!hits && !misses)
+    {
+        if (ctxt)
+            return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+        return EXR_ERR_INVALID_ARGUMENT;
+    }
+
+    lock_codec_pool (pool);
+    if (hits) *hits = pool->hits;
+    if (misses) *misses = pool->misses;
+    unlock_codec_pool (pool);
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
 exr_result_t
 exr_compress_buffer (
     exr_const_context_t ctxt,
@@ -61,18 +336,7 @@ exr_compress_buffer (
     size_t*             actual_out)
 {
     struct libdeflate_compressor* comp;
-
-#ifdef EXR_USE_CONFIG_DEFLATE_STRUCT
-    struct libdeflate_options opt = {
-        .sizeof_options = sizeof (struct libdeflate_options),
-        .malloc_func    = ctxt ? ctxt->alloc_fn : internal_exr_alloc,
-        .free_func      = ctxt ? ctxt->free_fn : internal_exr_free};
-
-#else
-    libdeflate_set_memory_allocator (
-        ctxt ? ctxt->alloc_fn : internal_exr_alloc,
-        ctxt ? ctxt->free_fn : internal_exr_free);
-#endif
+    size_t                        outsz;
 
     if (level < 0)
     {
@@ -81,25 +345,35 @@ exr_compress_buffer (
         if (level < 0) level = EXR_DEFAULT_ZLIB_COMPRESS_LEVEL;
     }
 
+    comp = internal_exr_pool_acquire (
+        ctxt, EXR_POOL_DEFLATE_COMPRESSOR, level);
+    if (!comp)
+    {
 #ifdef EXR_USE_CONFIG_DEFLATE_STRUCT
-    comp = libdeflate_alloc_compressor_ex (level, &opt);
+        struct libdeflate_options opt = {
+            .sizeof_options = sizeof (struct libdeflate_options),
+            .malloc_func    = ctxt ? ctxt->alloc_fn : internal_exr_alloc,
+            .free_func      = ctxt ? ctxt->free_fn : internal_exr_free};
+
+        comp = libdeflate_alloc_compressor_ex (level, &opt);
 #else
-    comp = libdeflate_alloc_compressor (level);
+        libdeflate_set_memory_allocator (
+            ctxt ? ctxt->alloc_fn : internal_exr_alloc,
+            ctxt ? ctxt->free_fn : internal_exr_free);
+        comp = libdeflate_alloc_compressor (level);
 #endif
-    if (comp)
-    {
-        size_t outsz;
-        outsz =
-            libdeflate_zlib_compress (comp, in, in_bytes, out, out_bytes_avail);
+        if (!comp) return EXR_ERR_OUT_OF_MEMORY;
+    }
 
-        libdeflate_free_compressor (comp);
+    outsz = libdeflate_zlib_compress (comp, in, in_bytes, out, out_bytes_avail);
 
-        if (outsz != 0)
-        {
-            if (actual_out) *actual_out = outsz;
-            return EXR_ERR_SUCCESS;
-        }
-        return EXR_ERR_OUT_OF_MEMORY;
+    internal_exr_pool_release (
+        ctxt, EXR_POOL_DEFLATE_COMPRESSOR, level, comp);
+
+    if (outsz != 0)
+    {
+        if (actual_out) *actual_out = outsz;
+        return EXR_ERR_SUCCESS;
     }
     return EXR_ERR_OUT_OF_MEMORY;
 }
@@ -118,39 +392,43 @@ exr_uncompress_buffer (
     struct libdeflate_decompressor* decomp;
     enum libdeflate_result          res;
     size_t                          actual_in_bytes;
+
+    decomp = internal_exr_pool_acquire (
+        ctxt, EXR_POOL_DEFLATE_DECOMPRESSOR, 0);
+    if (!decomp)
+    {
 #ifdef EXR_USE_CONFIG_DEFLATE_STRUCT
-    struct libdeflate_options opt = {
-        .sizeof_options = sizeof (struct libdeflate_options),
-        .malloc_func    = ctxt ? ctxt->alloc_fn : internal_exr_alloc,
-        .free_func      = ctxt ? ctxt->free_fn : internal_exr_free};
+        struct libdeflate_options opt = {
+            .sizeof_options = sizeof (struct libdeflate_options),
+            .malloc_func    = ctxt ? ctxt->alloc_fn : internal_exr_alloc,
+            .free_func      = ctxt ? ctxt->free_fn : internal_exr_free};
 
-    decomp = libdeflate_alloc_decompressor_ex (&opt);
+        decomp = libdeflate_alloc_decompressor_ex (&opt);
 #else
-    libdeflate_set_memory_allocator (
-        ctxt ? ctxt->alloc_fn : internal_exr_alloc,
-        ctxt ? ctxt->free_fn : internal_exr_free);
-    decomp = libdeflate_alloc_decompressor ();
+        libdeflate_set_memory_allocator (
+            ctxt ? ctxt->alloc_fn : internal_exr_alloc,
+            ctxt ? ctxt->free_fn : internal_exr_free);
+        decomp = libdeflate_alloc_decompressor ();
 #endif
+        if (!decomp) return EXR_ERR_OUT_OF_MEMORY;
+    }
+
+    res = libdeflate_zlib_decompress_ex (
+        decomp,
+        in,
+        in_bytes,
+        out,
+        out_bytes_avail,
+        &actual_in_bytes,
+        actual_out);
+
+    internal_exr_pool_release (
+        ctxt, EXR_POOL_DEFLATE_DECOMPRESSOR, 0, decomp);
 
-    if (decomp)
+    if (res == LIBDEFLATE_SUCCESS)
     {
-        res = libdeflate_zlib_decompress_ex (
-            decomp,
-            in,
-            in_bytes,
-            out,
-            out_bytes_avail,
-            &actual_in_bytes,
-            actual_out);
-
-        libdeflate_free_decompressor (decomp);
-
-        if (res == LIBDEFLATE_SUCCESS)
-        {
-            if (in_bytes == actual_in_bytes) return EXR_ERR_SUCCESS;
-            /* it's an error to not consume the full buffer, right? */
-        }
-        return EXR_ERR_CORRUPT_CHUNK;
+        if (in_bytes == actual_in_bytes) return EXR_ERR_SUCCESS;
+        /* it's an error to not consume the full buffer, right? */
     }
-    return EXR_ERR_OUT_OF_MEMORY;
+    return EXR_ERR_CORRUPT_CHUNK;
 }
@@ -634,6 +634,16 @@ exr_write_header (exr_context_t ctxt)
         if (rv != EXR_ERR_SUCCESS) break;
 
         ccount = internal_exr_compute_chunk_offset_size (curp);
+        if (ccount < 0)
+        {
+            rv = ctxt->print_error (
+                ctxt,
+                EXR_ERR_INVALID_ATTR,
+                "Invalid chunk count (%d) for part %d",
+                ccount,
+                p);
+            break;
+        }
 
         curp->chunk_count = ccount;
 
@@ -654,14 +664,14 @@ exr_write_header (exr_context_t ctxt)
 
     if (rv == EXR_ERR_SUCCESS)
     {
-        ctxt->mode               = EXR_CONTEXT_WRITING_DATA;
-        ctxt->cur_output_part    = 0;
-        ctxt->last_output_chunk  = -1;
-        ctxt->output_chunk_count = 0;
+        ctxt->mode              = EXR_CONTEXT_WRITING_DATA;
+        ctxt->output_parts_done = 0;
         for (int p = 0; rv == EXR_ERR_SUCCESS && p < ctxt->num_parts; ++p)
         {
             exr_priv_part_t curp = ctxt->parts[p];
 
+            curp->last_output_chunk  = -1;
+            curp->output_chunk_count = 0;
             curp->chunk_table_offset = ctxt->output_file_offset;
             ctxt->output_file_offset +=
                 (uint64_t) (curp->chunk_count) * sizeof (uint64_t);
@@ -57,7 +57,13 @@ update_pack_unpack_ptrs (exr_decode_pipeline_t* decode)
             return rv;
     }
 
-    if (decode->chunk.packed_size == decode->chunk.unpacked_size)
+    /* B44 is the one decompressor that may need to operate in place
+     * when the sizes match, which can't happen when the packed buffer
+     * is not ours (i.e. pointing into a read-only file mapping) */
+    if (decode->chunk.packed_size == decode->chunk.unpacked_size &&
+        !(decode->packed_alloc_size == 0 &&
+          (decode->chunk.compression == EXR_COMPRESSION_B44 ||
+           decode->chunk.compression == EXR_COMPRESSION_B44A)))
     {
         internal_decode_free_buffer (
             decode,
@@ -81,6 +87,43 @@ update_pack_unpack_ptrs (exr_decode_pipeline_t* decode)
     return rv;
 }
 
+/* the channel buffers are laid out exactly like the chunk in the
+ * file (the channels of a line one after the other, the lines one
+ * after the other), so the whole chunk can be read in one go */
+static uint8_t*
+packed_layout_base (const exr_decode_pipeline_t* decode)
+{
+    uint8_t* base;
+    uint64_t linebytes = 0;
+
+    if (decode->channel_count <= 0) return NULL;
+
+    base = decode->channels[0].decode_to_ptr;
+    for (int c = 0; c < decode->channel_count; ++c)
+    {
+        const exr_coding_channel_info_t* decc = (decode->channels + c);
+
+        if (!decc->decode_to_ptr || decc->x_samples != 1 ||
+            decc->y_samples != 1 || decc->decode_to_ptr != base + linebytes)
+            return NULL;
+        linebytes +=
+            (uint64_t) decc->width * (uint64_t) decc->bytes_per_element;
+    }
+
+    for (int c = 0; c < decode->channel_count; ++c)
+    {
+        if (decode->channels[c].user_line_stride < 0 ||
+            (uint64_t) decode->channels[c].user_line_stride != linebytes)
+            return NULL;
+    }
+
+    if (linebytes * (uint64_t) decode->chunk.height !=
+        decode->chunk.packed_size)
+        return NULL;
+
+    return base;
+}
+
 static exr_result_t
 read_uncompressed_direct (exr_decode_pipeline_t* decode)
 {
@@ -104,6 +147,36 @@ read_uncompressed_direct (exr_decode_pipeline_t* decode)
 
     height  = decode->chunk.height;
     start_y = decode->chunk.start_y;
+
+    cdata = packed_layout_base (decode);
+    if (cdata)
+    {
+        rv = ctxt->do_read (
+            ctxt,
+            cdata,
+            decode->chunk.packed_size,
+            &dataoffset,
+            NULL,
+            EXR_MUST_READ_ALL);
+        if (rv != EXR_ERR_SUCCESS) return rv;
+
+        for (int y = 0; y < height; ++y)
+        {
+            for (int c = 0; c < decode->channel_count; ++c)
+            {
+                exr_coding_channel_info_t* decc = (decode->channels + c);
+
+                cdata = decc->decode_to_ptr +
+                        (uint64_t) y * (uint64_t) decc->user_line_stride;
+                if (decc->bytes_per_element == 2)
+                    priv_to_native16 (cdata, decc->width);
+                else
+                    priv_to_native32 (cdata, decc->width);
+            }
+        }
+        return EXR_ERR_SUCCESS;
+    }
+
     for (int y = 0; y < height; ++y)
     {
         for (int c = 0; c < decode->channel_count; ++c)
@@ -119,10 +192,21 @@ read_uncompressed_direct (exr_decode_pipeline_t* decode)
             if (decc->y_samples > 1)
             {
                 if (((start_y + y) % decc->y_samples) != 0) continue;
+                if (!cdata)
+                {
+                    dataoffset += toread;
+                    continue;
+                }
                 cdata +=
                     ((uint64_t) (y / decc->y_samples) *
                      (uint64_t) decc->user_line_stride);
             }
+            else if (!cdata)
+            {
+                /* a channel the caller does not want, skip over it */
+                dataoffset += toread;
+                continue;
+            }
             else { cdata += (uint64_t) y * (uint64_t) decc->user_line_stride; }
 
             /* actual read into the output pointer */
@@ -141,6 +225,26 @@ read_uncompressed_direct (exr_decode_pipeline_t* decode)
     return EXR_ERR_SUCCESS;
 }
 
+static int
+can_use_mapped_chunk (
+    exr_const_context_t    ctxt,
+    exr_const_priv_part_t  part,
+    exr_decode_pipeline_t* decode)
+{
+    const exr_chunk_info_t* cinfo = &(decode->chunk);
+
+    /* anything odd, let the normal read path report the error */
+    if (!ctxt->mapped_data || cinfo->packed_size == 0) return 0;
+    if (cinfo->idx < 0 || cinfo->idx >= part->chunk_count) return 0;
+    if (cinfo->type != (uint8_t) part->storage_mode ||
+        cinfo->compression != (uint8_t) part->comp_type)
+        return 0;
+    if (cinfo->data_offset >= ctxt->mapped_size ||
+        cinfo->packed_size > (ctxt->mapped_size - cinfo->data_offset))
+        return 0;
+    return 1;
+}
+
 static exr_result_t
 default_read_chunk (exr_decode_pipeline_t* decode)
 {
@@ -152,6 +256,13 @@ default_read_chunk (exr_decode_pipeline_t* decode)
         decode->unpacked_alloc_size == 0)
         decode->unpacked_buffer = NULL;
 
+    if ((decode->decode_flags & EXR_DECODE_PACKED_DATA_PRELOADED))
+    {
+        decode->decode_flags &=
+            (uint16_t) ~EXR_DECODE_PACKED_DATA_PRELOADED;
+        return EXR_ERR_SUCCESS;
+    }
+
     if (part->storage_mode == EXR_STORAGE_DEEP_SCANLINE ||
         part->storage_mode == EXR_STORAGE_DEEP_TILED)
     {
@@ -190,6 +301,19 @@ default_read_chunk (exr_decode_pipeline_t* decode)
                 decode->packed_sample_count_table);
         }
     }
+    else if (can_use_mapped_chunk (ctxt, part, decode))
+    {
+        /* point straight into the file mapping, the zero alloc size
+         * flags the buffer as one we do not own and must not free */
+        internal_decode_free_buffer (
+            decode,
+            EXR_TRANSCODE_BUFFER_PACKED,
+            &(decode->packed_buffer),
+            &(decode->packed_alloc_size));
+        decode->packed_buffer = EXR_CONST_CAST (
+            void*, ctxt->mapped_data + decode->chunk.data_offset);
+        rv = EXR_ERR_SUCCESS;
+    }
     else
     {
         rv = internal_decode_alloc_buffer (
@@ -566,10 +690,9 @@ exr_decoding_choose_default_routines (
         simpinterleaverev = -1;
 
     /* special case, uncompressed and reading planar data straight in
-     * to all the channels */
+     * to the channels, skipping over any the caller does not want */
     if (!isdeep && part->comp_type == EXR_COMPRESSION_NONE &&
-        chanstounpack == 0 && hastypechange == 0 && chanstofill > 0 &&
-        chanstofill == decode->channel_count)
+        chanstounpack == 0 && hastypechange == 0 && chanstofill > 0)
     {
         decode->read_fn               = &read_uncompressed_direct;
         decode->decompress_fn         = NULL;
@@ -628,12 +751,240 @@ exr_decoding_update (
     rv = internal_coding_update_channel_info (
         decode->channels, decode->channel_count, cinfo, ctxt, part);
     decode->chunk = *cinfo;
+    decode->decode_flags &= (uint16_t) ~EXR_DECODE_PACKED_DATA_PRELOADED;
 
     return rv;
 }
 
 /**************************************/
 
+static int
+is_batch_readable (const exr_decode_pipeline_t* decode)
+{
+    return decode->read_fn == &default_read_chunk &&
+           decode->chunk.packed_size > 0;
+}
+
+exr_result_t
+exr_decoding_read_batch (
+    exr_const_context_t     ctxt,
+    int                     part_index,
+    int                     count,
+    exr_decode_pipeline_t** decodes)
+{
+    exr_result_t      rv = EXR_ERR_SUCCESS;
+    exr_chunk_info_t* cinfos;
+    void**            bufs;
+    int               nbatch = 0;
+    EXR_READONLY_AND_DEFINE_PART (part_index);
+
+    if (count < 0 || (count > 0 && !decodes))
+        return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+
+    for (int d = 0; d < count; ++d)
+    {
+        if (!decodes[d])
+            return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+        if (decodes[d]->context != ctxt || decodes[d]->part_index != part_index)
+            return ctxt->report_error (
+                ctxt,
+                EXR_ERR_INVALID_ARGUMENT,
+                "Invalid request for batch read from different context / part");
+    }
+
+    /* deep reads the sample tables alongside, and a mapped file
+     * does not need any reads at all */
+    if (count == 0 || ctxt->mapped_data ||
+        part->storage_mode == EXR_STORAGE_DEEP_SCANLINE ||
+        part->storage_mode == EXR_STORAGE_DEEP_TILED)
+        return EXR_ERR_SUCCESS;
+
+    cinfos = ctxt->alloc_fn (sizeof (exr_chunk_info_t) * (size_t) count);
+    if (!cinfos) return ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
+    bufs = ctxt->alloc_fn (sizeof (void*) * (size_t) count);
+    if (!bufs)
+    {
+        ctxt->free_fn (cinfos);
+        return ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
+    }
+
+    for (int d = 0; rv == EXR_ERR_SUCCESS && d < count; ++d)
+    {
+        exr_decode_pipeline_t* decode = decodes[d];
+
+        if (!is_batch_readable (decode)) continue;
+
+        if (decode->unpacked_buffer == decode->packed_buffer &&
+            decode->unpacked_alloc_size == 0)
+            decode->unpacked_buffer = NULL;
+
+        rv = internal_decode_alloc_buffer (
+            decode,
+            EXR_TRANSCODE_BUFFER_PACKED,
+            &(decode->packed_buffer),
+            &(decode->packed_alloc_size),
+            decode->chunk.packed_size);
+
+        cinfos[nbatch] = decode->chunk;
+        bufs[nbatch]   = decode->packed_buffer;
+        ++nbatch;
+    }
+
+    if (rv == EXR_ERR_SUCCESS)
+        rv = exr_read_chunks (ctxt, part_index, nbatch, cinfos, bufs);
+
+    if (rv == EXR_ERR_SUCCESS)
+    {
+        for (int d = 0; d < count; ++d)
+        {
+            if (is_batch_readable (decodes[d]))
+                decodes[d]->decode_flags |= EXR_DECODE_PACKED_DATA_PRELOADED;
+        }
+    }
+
+    ctxt->free_fn (bufs);
+    ctxt->free_fn (cinfos);
+    return rv;
+}
+
+/**************************************/
+
+static int
+is_fused_readable (
+    exr_const_context_t          ctxt,
+    exr_const_priv_part_t        part,
+    const exr_decode_pipeline_t* decode)
+{
+    return decode->read_fn == &default_read_chunk && !ctxt->mapped_data &&
+           part->storage_mode != EXR_STORAGE_DEEP_SCANLINE &&
+           part->storage_mode != EXR_STORAGE_DEEP_TILED;
+}
+
+/* make sure the packed buffer can hold any chunk of the part, along
+ * with its leader (at most 6 ints) when reading without the
+ * vectored read */
+static exr_result_t
+alloc_fused_read_buffer (
+    exr_const_priv_part_t part, exr_decode_pipeline_t* decode)
+{
+    if (decode->unpacked_buffer == decode->packed_buffer &&
+        decode->unpacked_alloc_size == 0)
+        decode->unpacked_buffer = NULL;
+
+    return internal_decode_alloc_buffer (
+        decode,
+        EXR_TRANSCODE_BUFFER_PACKED,
+        &(decode->packed_buffer),
+        &(decode->packed_alloc_size),
+        part->unpacked_size_per_chunk + 6 * sizeof (int32_t));
+}
+
+static exr_result_t
+finish_fused_read (
+    exr_const_context_t     ctxt,
+    exr_const_priv_part_t   part,
+    const exr_chunk_info_t* cinfo,
+    exr_decode_pipeline_t*  decode,
+    int                     preloaded)
+{
+    exr_result_t rv;
+
+    rv = internal_coding_update_channel_info (
+        decode->channels, decode->channel_count, cinfo, ctxt, part);
+    decode->chunk = *cinfo;
+    decode->decode_flags &= (uint16_t) ~EXR_DECODE_PACKED_DATA_PRELOADED;
+    if (rv == EXR_ERR_SUCCESS && preloaded && cinfo->packed_size > 0)
+        decode->decode_flags |= EXR_DECODE_PACKED_DATA_PRELOADED;
+    return rv;
+}
+
+exr_result_t
+exr_decoding_read_scanline_chunk (
+    exr_const_context_t    ctxt,
+    int                    part_index,
+    int                    y,
+    exr_decode_pipeline_t* decode)
+{
+    exr_result_t     rv;
+    exr_chunk_info_t cinfo;
+    int              fused;
+    EXR_READONLY_AND_DEFINE_PART (part_index);
+
+    if (!decode) return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+    if (decode->context != ctxt || decode->part_index != part_index)
+        return ctxt->report_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Invalid request for decoding read from different context / part");
+
+    fused = is_fused_readable (ctxt, part, decode);
+    if (fused)
+    {
+        rv = alloc_fused_read_buffer (part, decode);
+        if (rv == EXR_ERR_SUCCESS)
+            rv = exr_read_scanline_chunk_with_info (
+                ctxt,
+                part_index,
+                y,
+                &cinfo,
+                decode->packed_buffer,
+                decode->packed_alloc_size);
+    }
+    else
+        rv = exr_read_scanline_chunk_info (ctxt, part_index, y, &cinfo);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    return finish_fused_read (ctxt, part, &cinfo, decode, fused);
+}
+
+exr_result_t
+exr_decoding_read_tile_chunk (
+    exr_const_context_t    ctxt,
+    int                    part_index,
+    int                    tilex,
+    int                    tiley,
+    int                    levelx,
+    int                    levely,
+    exr_decode_pipeline_t* decode)
+{
+    exr_result_t     rv;
+    exr_chunk_info_t cinfo;
+    int              fused;
+    EXR_READONLY_AND_DEFINE_PART (part_index);
+
+    if (!decode) return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+    if (decode->context != ctxt || decode->part_index != part_index)
+        return ctxt->report_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Invalid request for decoding read from different context / part");
+
+    fused = is_fused_readable (ctxt, part, decode);
+    if (fused)
+    {
+        rv = alloc_fused_read_buffer (part, decode);
+        if (rv == EXR_ERR_SUCCESS)
+            rv = exr_read_tile_chunk_with_info (
+                ctxt,
+                part_index,
+                tilex,
+                tiley,
+                levelx,
+                levely,
+                &cinfo,
+                decode->packed_buffer,
+                decode->packed_alloc_size);
+    }
+    else
+        rv = exr_read_tile_chunk_info (
+            ctxt, part_index, tilex, tiley, levelx, levely, &cinfo);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    return finish_fused_read (ctxt, part, &cinfo, decode, fused);
+}
+
+/**************************************/
+
 exr_result_t
 exr_decoding_run (
     exr_const_context_t ctxt, int part_index, exr_decode_pipeline_t* decode)
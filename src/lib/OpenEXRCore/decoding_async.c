@@ -0,0 +1,549 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#include "openexr_decode.h"
+
+#include "internal_structs.h"
+
+#include <string.h>
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifndef _WIN32
+#        include <unistd.h>
+#    endif
+#endif
+
+/* number of pipelines the I/O stage reads in one request */
+#define ASYNC_READ_GROUP_SIZE 4
+/* upper bound on the threads of the internal pool */
+#define ASYNC_MAX_THREADS 8
+/* initial number of tasks the queue of the internal pool can hold,
+ * it grows when more are pending */
+#define ASYNC_QUEUE_SIZE 64
+
+/**************************************/
+
+typedef struct
+{
+    exr_decode_task_fn_t fn;
+    void*                data;
+} async_task_t;
+
+typedef struct
+{
+    exr_decode_batch_t batch;
+    int                index;
+} async_decode_task_t;
+
+/* the internal pool, run by the batches of a context that are not
+ * given an executor. It is started by the first such batch and kept
+ * until the context is destroyed */
+struct _internal_exr_decode_pool
+{
+    exr_const_context_t ctxt;
+
+    /* ring of pending tasks */
+    async_task_t* queue;
+    int           queue_size;
+    int           queue_head;
+    int           queue_count;
+    int           shutdown;
+    int           num_threads;
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    SRWLOCK            lock;
+    CONDITION_VARIABLE queue_cond;
+    HANDLE             threads[ASYNC_MAX_THREADS];
+#    else
+    pthread_mutex_t lock;
+    pthread_cond_t  queue_cond;
+    pthread_t       threads[ASYNC_MAX_THREADS];
+#    endif
+#endif
+};
+
+typedef struct _internal_exr_decode_pool* async_pool_t;
+
+struct _exr_decode_batch
+{
+    exr_const_context_t      ctxt;
+    int                      part_index;
+    int                      count;
+    exr_decode_pipeline_t**  decodes;
+    exr_decode_executor_t    executor;
+    exr_decode_complete_fn_t complete_fn;
+    void*                    userdata;
+
+    async_decode_task_t* decode_tasks;
+
+    /* pipelines still to finish, and the first failure */
+    int          remaining;
+    exr_result_t result;
+
+    /* the internal pool of the context, when no executor was given */
+    async_pool_t pool;
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    SRWLOCK            lock;
+    CONDITION_VARIABLE done_cond;
+#    else
+    pthread_mutex_t lock;
+    pthread_cond_t  done_cond;
+#    endif
+#endif
+};
+
+/**************************************/
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+#        define async_lock(b) AcquireSRWLockExclusive (&((b)->lock))
+#        define async_unlock(b) ReleaseSRWLockExclusive (&((b)->lock))
+#        define async_wait(b, c)                                               \
+            SleepConditionVariableSRW (&((b)->c), &((b)->lock), INFINITE, 0)
+#        define async_signal(b, c) WakeConditionVariable (&((b)->c))
+#        define async_broadcast(b, c) WakeAllConditionVariable (&((b)->c))
+#    else
+#        define async_lock(b) pthread_mutex_lock (&((b)->lock))
+#        define async_unlock(b) pthread_mutex_unlock (&((b)->lock))
+#        define async_wait(b, c) pthread_cond_wait (&((b)->c), &((b)->lock))
+#        define async_signal(b, c) pthread_cond_signal (&((b)->c))
+#        define async_broadcast(b, c) pthread_cond_broadcast (&((b)->c))
+#    endif
+#else
+#    define async_lock(b) ((void) (b))
+#    define async_unlock(b) ((void) (b))
+#    define async_wait(b, c) ((void) (b))
+#    define async_signal(b, c) ((void) (b))
+#    define async_broadcast(b, c) ((void) (b))
+#endif
+
+/**************************************/
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+
+static void
+pool_worker (async_pool_t p)
+{
+    for (;;)
+    {
+        async_task_t t;
+
+        async_lock (p);
+        while (p->queue_count == 0 && !p->shutdown)
+            async_wait (p, queue_cond);
+        if (p->queue_count == 0)
+        {
+            async_unlock (p);
+            break;
+        }
+        t             = p->queue[p->queue_head];
+        p->queue_head = (p->queue_head + 1) % p->queue_size;
+        --p->queue_count;
+        async_unlock (p);
+
+        t.fn (t.data);
+    }
+}
+
+#    ifdef _WIN32
+static DWORD WINAPI
+pool_thread (LPVOID arg)
+{
+    pool_worker ((async_pool_t) arg);
+    return 0;
+}
+#    else
+static void*
+pool_thread (void* arg)
+{
+    pool_worker ((async_pool_t) arg);
+    return NULL;
+}
+#    endif
+
+static int
+default_thread_count (void)
+{
+    long n;
+
+#    ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo (&si);
+    n = (long) si.dwNumberOfProcessors;
+#    else
+    n = sysconf (_SC_NPROCESSORS_ONLN);
+#    endif
+    /* the I/O stage spends most of its time blocked, so have a
+     * second thread to decode alongside even on a single core */
+    if (n < 2) n = 2;
+    if (n > ASYNC_MAX_THREADS) n = ASYNC_MAX_THREADS;
+    return (int) n;
+}
+
+static async_pool_t
+pool_start (exr_const_context_t ctxt)
+{
+    async_pool_t p = ctxt->alloc_fn (sizeof (struct _internal_exr_decode_pool));
+    int          nthreads;
+
+    if (!p) return NULL;
+    memset (p, 0, sizeof (struct _internal_exr_decode_pool));
+    p->ctxt = ctxt;
+
+    p->queue_size = ASYNC_QUEUE_SIZE;
+    p->queue = ctxt->alloc_fn (sizeof (*p->queue) * (size_t) p->queue_size);
+    if (!p->queue)
+    {
+        ctxt->free_fn (p);
+        return NULL;
+    }
+
+#    ifdef _WIN32
+    InitializeSRWLock (&(p->lock));
+    InitializeConditionVariable (&(p->queue_cond));
+#    else
+    if (pthread_mutex_init (&(p->lock), NULL) != 0)
+    {
+        ctxt->free_fn (p->queue);
+        ctxt->free_fn (p);
+        return NULL;
+    }
+    if (pthread_cond_init (&(p->queue_cond), NULL) != 0)
+    {
+        pthread_mutex_destroy (&(p->lock));
+        ctxt->free_fn (p->queue);
+        ctxt->free_fn (p);
+        return NULL;
+    }
+#    endif
+
+    /* run with however many threads could be started; with none,
+     * the tasks are run inline */
+    nthreads = default_thread_count ();
+    for (int t = 0; t < nthreads; ++t)
+    {
+#    ifdef _WIN32
+        p->threads[t] = CreateThread (NULL, 0, &pool_thread, p, 0, NULL);
+        if (!p->threads[t]) break;
+#    else
+        if (pthread_create (&(p->threads[t]), NULL, &pool_thread, p) != 0)
+            break;
+#    endif
+        ++p->num_threads;
+    }
+    return p;
+}
+
+#endif /* ILMTHREAD_THREADING_ENABLED */
+
+/* the pool of the context, started on first use. NULL when the tasks
+ * have to be run inline */
+static async_pool_t
+get_pool (exr_const_context_t ctxt)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+    exr_context_t nonc = EXR_CONST_CAST (exr_context_t, ctxt);
+    async_pool_t  p;
+
+    internal_exr_lock (ctxt);
+    p = nonc->decode_pool;
+    if (!p)
+    {
+        p                 = pool_start (ctxt);
+        nonc->decode_pool = p;
+    }
+    internal_exr_unlock (ctxt);
+    return p;
+#else
+    (void) ctxt;
+    return NULL;
+#endif
+}
+
+void
+internal_exr_destroy_decode_pool (exr_context_t ctxt)
+{
+    async_pool_t p = ctxt->decode_pool;
+
+    if (!p) return;
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+    async_lock (p);
+    p->shutdown = 1;
+    async_broadcast (p, queue_cond);
+    async_unlock (p);
+
+    for (int t = 0; t < p->num_threads; ++t)
+    {
+#    ifdef _WIN32
+        WaitForSingleObject (p->threads[t], INFINITE);
+        CloseHandle (p->threads[t]);
+#    else
+        pthread_join (p->threads[t], NULL);
+#    endif
+    }
+
+#    ifndef _WIN32
+    pthread_cond_destroy (&(p->queue_cond));
+    pthread_mutex_destroy (&(p->lock));
+#    endif
+#endif
+    ctxt->free_fn (p->queue);
+    ctxt->free_fn (p);
+    ctxt->decode_pool = NULL;
+}
+
+/* double the size of the queue, called with the pool locked */
+static int
+pool_grow (async_pool_t p)
+{
+    int           size = p->queue_size * 2;
+    async_task_t* queue;
+
+    queue = p->ctxt->alloc_fn (sizeof (*queue) * (size_t) size);
+    if (!queue) return 0;
+
+    for (int i = 0; i < p->queue_count; ++i)
+        queue[i] = p->queue[(p->queue_head + i) % p->queue_size];
+    p->ctxt->free_fn (p->queue);
+    p->queue      = queue;
+    p->queue_size = size;
+    p->queue_head = 0;
+    return 1;
+}
+
+static int
+pool_submit (async_pool_t p, exr_decode_task_fn_t fn, void* data)
+{
+    int tail;
+
+    if (!p || p->num_threads == 0) return 0;
+
+    async_lock (p);
+    if (p->queue_count == p->queue_size && !pool_grow (p))
+    {
+        async_unlock (p);
+        return 0;
+    }
+    tail                = (p->queue_head + p->queue_count) % p->queue_size;
+    p->queue[tail].fn   = fn;
+    p->queue[tail].data = data;
+    ++p->queue_count;
+    async_signal (p, queue_cond);
+    async_unlock (p);
+    return 1;
+}
+
+/**************************************/
+
+static void
+run_task (exr_decode_batch_t b, exr_decode_task_fn_t fn, void* data)
+{
+    if (b->executor.submit_fn)
+    {
+        if (b->executor.submit_fn (b->executor.executor_data, fn, data) == 0)
+            return;
+    }
+    else if (pool_submit (b->pool, fn, data))
+        return;
+
+    fn (data);
+}
+
+static void
+complete_decode (exr_decode_batch_t b, int index, exr_result_t rv)
+{
+    if (b->complete_fn)
+        b->complete_fn (
+            b->ctxt, b->part_index, index, b->decodes[index], rv, b->userdata);
+
+    /* the batch may be gone as soon as the last one is counted */
+    async_lock (b);
+    if (rv != EXR_ERR_SUCCESS && b->result == EXR_ERR_SUCCESS) b->result = rv;
+    if (--b->remaining == 0) async_broadcast (b, done_cond);
+    async_unlock (b);
+}
+
+static void
+decode_task (void* data)
+{
+    async_decode_task_t* t = data;
+    exr_decode_batch_t   b = t->batch;
+
+    complete_decode (
+        b,
+        t->index,
+        exr_decoding_run (b->ctxt, b->part_index, b->decodes[t->index]));
+}
+
+static void
+read_task (void* data)
+{
+    exr_decode_batch_t b     = data;
+    int                count = b->count;
+
+    /* once the last pipeline has been handed on, the batch may be
+     * released at any time, so only the local count is used to stop */
+    for (int d = 0; d < count; d += ASYNC_READ_GROUP_SIZE)
+    {
+        int          n = count - d;
+        exr_result_t rv;
+
+        if (n > ASYNC_READ_GROUP_SIZE) n = ASYNC_READ_GROUP_SIZE;
+
+        rv = exr_decoding_read_batch (
+            b->ctxt, b->part_index, n, b->decodes + d);
+
+        for (int i = d; i < d + n; ++i)
+        {
+            if (rv == EXR_ERR_SUCCESS)
+                run_task (b, &decode_task, b->decode_tasks + i);
+            else
+                complete_decode (b, i, rv);
+        }
+    }
+}
+
+/**************************************/
+
+static void
+free_batch (exr_decode_batch_t b)
+{
+    exr_const_context_t ctxt = b->ctxt;
+
+#if defined(ILMTHREAD_THREADING_ENABLED) && !defined(_WIN32)
+    pthread_cond_destroy (&(b->done_cond));
+    pthread_mutex_destroy (&(b->lock));
+#endif
+    if (b->decode_tasks) ctxt->free_fn (b->decode_tasks);
+    if (b->decodes) ctxt->free_fn (b->decodes);
+    ctxt->free_fn (b);
+}
+
+static exr_result_t
+init_batch_sync (exr_decode_batch_t b)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    InitializeSRWLock (&(b->lock));
+    InitializeConditionVariable (&(b->done_cond));
+#    else
+    if (pthread_mutex_init (&(b->lock), NULL) != 0)
+        return EXR_ERR_OUT_OF_MEMORY;
+    if (pthread_cond_init (&(b->done_cond), NULL) != 0)
+    {
+        pthread_mutex_destroy (&(b->lock));
+        return EXR_ERR_OUT_OF_MEMORY;
+    }
+#    endif
+#else
+    (void) b;
+#endif
+    return EXR_ERR_SUCCESS;
+}
+
+exr_result_t
+exr_decoding_submit (
+    exr_const_context_t          ctxt,
+    int                          part_index,
+    int                          count,
+    exr_decode_pipeline_t**      decodes,
+    const exr_decode_executor_t* executor,
+    exr_decode_complete_fn_t     complete_fn,
+    void*                        userdata,
+    exr_decode_batch_t*          batch)
+{
+    exr_decode_batch_t b;
+    EXR_READONLY_AND_DEFINE_PART (part_index);
+    (void) part;
+
+    if (!batch) return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+    *batch = NULL;
+
+    if (count < 0 || (count > 0 && !decodes) ||
+        (executor && !executor->submit_fn))
+        return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+
+    for (int d = 0; d < count; ++d)
+    {
+        if (!decodes[d])
+            return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+        if (decodes[d]->context != ctxt || decodes[d]->part_index != part_index)
+            return ctxt->report_error (
+                ctxt,
+                EXR_ERR_INVALID_ARGUMENT,
+                "Invalid async decode request from different context / part");
+    }
+
+    b = ctxt->alloc_fn (sizeof (struct _exr_decode_batch));
+    if (!b) return ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
+    memset (b, 0, sizeof (struct _exr_decode_batch));
+
+    b->ctxt        = ctxt;
+    b->part_index  = part_index;
+    b->count       = count;
+    b->complete_fn = complete_fn;
+    b->userdata    = userdata;
+    b->remaining   = count;
+    b->result      = EXR_ERR_SUCCESS;
+    if (executor) b->executor = *executor;
+
+    if (init_batch_sync (b) != EXR_ERR_SUCCESS)
+    {
+        ctxt->free_fn (b);
+        return ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
+    }
+
+    if (count > 0)
+    {
+        b->decodes = ctxt->alloc_fn (sizeof (*b->decodes) * (size_t) count);
+        b->decode_tasks =
+            ctxt->alloc_fn (sizeof (*b->decode_tasks) * (size_t) count);
+        if (!b->decodes || !b->decode_tasks)
+        {
+            free_batch (b);
+            return ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
+        }
+
+        for (int d = 0; d < count; ++d)
+        {
+            b->decodes[d]            = decodes[d];
+            b->decode_tasks[d].batch = b;
+            b->decode_tasks[d].index = d;
+        }
+
+        if (!executor) b->pool = get_pool (ctxt);
+
+        run_task (b, &read_task, b);
+    }
+
+    *batch = b;
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
+exr_result_t
+exr_decoding_wait (exr_decode_batch_t* batch)
+{
+    exr_decode_batch_t b;
+    exr_result_t       rv;
+
+    if (!batch || !*batch) return EXR_ERR_INVALID_ARGUMENT;
+    b = *batch;
+
+    async_lock (b);
+    while (b->remaining > 0)
+        async_wait (b, done_cond);
+    rv = b->result;
+    async_unlock (b);
+
+    free_batch (b);
+    *batch = NULL;
+    return rv;
+}
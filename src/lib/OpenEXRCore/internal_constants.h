@@ -25,6 +25,11 @@
  * #define REQ_MSS_COUNT_STR "maxSamplesPerPixel"
  */
 
+/* scanlines per chunk of a zstd compressed scanline part, files
+ * written before this attribute existed have no attribute and use 1 */
+#define EXR_ZSTD_LINES_PER_CHUNK_STR "zstdLinesPerChunk"
+#define EXR_ZSTD_MAX_LINES_PER_CHUNK 256
+
 #define EXR_SHORTNAME_MAXLEN 31
 #define EXR_LONGNAME_MAXLEN 255
 
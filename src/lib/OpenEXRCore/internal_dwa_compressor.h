@@ -905,7 +905,8 @@ DwaCompressor_uncompress (
                     (uint16_t*) me->_packedAcBuffer,
                     totalAcUncompressedCount,
                     me->_decode->scratch_buffer_1,
-                    me->_decode->scratch_alloc_size_1);
+                    me->_decode->scratch_alloc_size_1,
+                    0);
                 if (rv != EXR_ERR_SUCCESS) { return rv; }
                 break;
 
@@ -218,82 +218,6 @@ LossyDctEncoderCsc_construct (
 
 /**************************************/
 
-//
-// Reorder from zig-zag order to normal ordering
-//
-static void
-toZigZag (uint16_t* dst, uint16_t* src)
-{
-    static const int remap[] = {
-        0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,
-        12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6,  7,  14, 21, 28,
-        35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
-        58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
-
-    for (int i = 0; i < 64; ++i)
-        dst[i] = src[remap[i]];
-}
-
-//
-// Precomputing the bit count runs faster than using
-// the builtin instruction, at least in one case..
-//
-// Precomputing 8-bits is no slower than 16-bits,
-// and saves a fair bit of overhead..
-//
-static inline int
-countSetBits (uint16_t src)
-{
-    static const uint16_t numBitsSet[256] = {
-        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 1, 2, 2, 3, 2, 3, 3, 4,
-        2, 3, 3, 4, 3, 4, 4, 5, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 1, 2, 2, 3, 2, 3, 3, 4,
-        2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6,
-        4, 5, 5, 6, 5, 6, 6, 7, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 2, 3, 3, 4, 3, 4, 4, 5,
-        3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6,
-        4, 5, 5, 6, 5, 6, 6, 7, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-        4, 5, 5, 6, 5, 6, 6, 7, 5, 6, 6, 7, 6, 7, 7, 8};
-
-    return numBitsSet[src & 0xff] + numBitsSet[src >> 8];
-}
-
-//
-// Take a DCT coefficient, as well as an acceptable error. Search
-// nearby values within the error tolerance, that have fewer
-// bits set.
-//
-// The list of candidates has been pre-computed and sorted
-// in order of increasing numbers of bits set. This way, we
-// can stop searching as soon as we find a candidate that
-// is within the error tolerance.
-//
-static inline uint16_t
-quantize (float dctval, float errorTolerance)
-{
-    uint16_t tmp;
-    // pre-quantize float -> half and back
-    uint16_t src      = float_to_half (dctval);
-    float    srcFloat = half_to_float (src);
-
-    int             numSetBits = countSetBits (src);
-    const uint16_t* closest    = closestData + closestDataOffset[src];
-
-    for (int targetNumSetBits = numSetBits - 1; targetNumSetBits >= 0;
-         --targetNumSetBits)
-    {
-        tmp = *closest;
-
-        if (fabsf (half_to_float (tmp) - srcFloat) < errorTolerance) return tmp;
-
-        closest++;
-    }
-
-    return src;
-}
-
 /**************************************/
 
 //
@@ -314,7 +238,6 @@ LossyDctEncoder_execute (
     int numBlocksY = (int) (ceilf ((float) e->_height / 8.0f));
 
     uint16_t halfZigCoef[64];
-    uint16_t halfCoef[64];
 
     uint16_t* currAcComp            = (uint16_t*) e->_packedAc;
     int       tmpHalfBufferElements = 0;
@@ -410,6 +333,37 @@ LossyDctEncoder_execute (
                 // we'll need to explicitly do it.
                 //
 
+                if (8 * blockx + 8 <= e->_width &&
+                    8 * blocky + 8 <= e->_height)
+                {
+                    //
+                    // Interior blocks don't need any mirroring
+                    //
+
+                    for (int y = 0; y < 8; ++y)
+                    {
+                        int             vy  = 8 * blocky + y;
+                        const uint16_t* row =
+                            (const uint16_t*) chanData[chan]->_rows[vy] +
+                            8 * blockx;
+                        float* dctRow = chanData[chan]->_dctData + y * 8;
+
+                        if (e->_toNonlinear)
+                        {
+                            for (int x = 0; x < 8; ++x)
+                                dctRow[x] =
+                                    half_to_float (e->_toNonlinear[row[x]]);
+                        }
+                        else
+                        {
+                            for (int x = 0; x < 8; ++x)
+                                dctRow[x] =
+                                    half_to_float (one_to_native16 (row[x]));
+                        }
+                    }
+                    continue;
+                }
+
                 for (int y = 0; y < 8; ++y)
                 {
                     for (int x = 0; x < 8; ++x)
@@ -461,13 +415,8 @@ LossyDctEncoder_execute (
                 // Quantize to half, and zigzag
                 //
 
-                for (int i = 0; i < 64; ++i)
-                {
-                    halfCoef[i] =
-                        quantize (chanData[chan]->_dctData[i], quantTable[i]);
-                }
-
-                toZigZag (halfZigCoef, halfCoef);
+                quantizeCoeffs64 (
+                    halfZigCoef, chanData[chan]->_dctData, quantTable);
 
                 //
                 // Convert from NATIVE back to XDR, before we write out
@@ -523,24 +472,31 @@ LossyDctEncoder_execute (
 void
 LossyDctEncoder_rleAc (LossyDctEncoder* e, uint16_t* block, uint16_t** acPtr)
 {
-    int       dctComp   = 1;
-    uint16_t  rleSymbol = 0x0;
-    uint16_t* curAC     = *acPtr;
+    int       dctComp = 1;
+    uint16_t* curAC   = *acPtr;
+
+    //
+    // Bit i is set when block[i] is not 0, so the length of
+    // a run of 0's is just the distance to the next set bit.
+    //
+
+    uint64_t nonZero = ~zeroMask64 (block);
 
     while (dctComp < 64)
     {
-        uint16_t runLen = 1;
+        uint64_t rest = nonZero >> dctComp;
+        int      runLen;
 
         //
         // If we don't have a 0, output verbatim
         //
 
-        if (block[dctComp] != rleSymbol)
+        if (rest & 1)
         {
             *curAC++ = block[dctComp];
             e->_numAcComp++;
 
-            dctComp += runLen;
+            dctComp++;
             continue;
         }
 
@@ -548,11 +504,7 @@ LossyDctEncoder_rleAc (LossyDctEncoder* e, uint16_t* block, uint16_t** acPtr)
         // We're sitting on a 0, so see how big the run is.
         //
 
-        while ((dctComp + runLen < 64) &&
-               (block[dctComp + runLen] == rleSymbol))
-        {
-            runLen++;
-        }
+        runLen = rest ? countTrailingZeros64 (rest) : 64 - dctComp;
 
         //
         // If the run len is too small, just output verbatim
@@ -566,13 +518,8 @@ LossyDctEncoder_rleAc (LossyDctEncoder* e, uint16_t* block, uint16_t** acPtr)
 
         if (runLen == 1)
         {
-            runLen   = 1;
             *curAC++ = block[dctComp];
             e->_numAcComp++;
-
-            //
-            // Using 0xff00 for "end of block"
-            //
         }
         else if (runLen + dctComp == 64)
         {
@@ -589,7 +536,7 @@ LossyDctEncoder_rleAc (LossyDctEncoder* e, uint16_t* block, uint16_t** acPtr)
             // Signal normal run
             //
 
-            *curAC++ = (uint16_t) 0xff00 | runLen;
+            *curAC++ = (uint16_t) (0xff00 | runLen);
             e->_numAcComp++;
         }
 
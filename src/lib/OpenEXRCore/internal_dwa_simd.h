@@ -43,6 +43,26 @@
 #    endif /* __LP64__ */
 #endif     /* OPENEXR_IMF_HAVE_GCC_INLINE_ASM_AVX */
 
+//
+// With GCC and clang, the F16C code can be built with intrinsics
+// by enabling the instructions for just those functions.
+//
+
+#if defined(IMF_HAVE_GCC_INLINEASM_X86_64) &&                                  \
+    (defined(__GNUC__) || defined(__clang__))
+#    define IMF_HAVE_F16C_TARGET 1
+#    include <immintrin.h>
+#    if defined(__AVX__) && defined(__F16C__)
+#        define IMF_F16C_TARGET
+#    else
+#        define IMF_F16C_TARGET __attribute__ ((target ("avx,f16c")))
+#    endif
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#    include <intrin.h>
+#endif
+
 #define _SSE_ALIGNMENT 32
 #define _SSE_ALIGNMENT_MASK 0x0F
 #define _AVX_ALIGNMENT_MASK 0x1F
@@ -2268,6 +2288,336 @@ dctForward8x8 (float* data)
 
 /**************************************/
 
+//
+// Precomputing the bit count runs faster than using
+// the builtin instruction, at least in one case..
+//
+// Precomputing 8-bits is no slower than 16-bits,
+// and saves a fair bit of overhead..
+//
+static inline int
+countSetBits (uint16_t src)
+{
+    static const uint16_t numBitsSet[256] = {
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 1, 2, 2, 3, 2, 3, 3, 4,
+        2, 3, 3, 4, 3, 4, 4, 5, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
+        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 1, 2, 2, 3, 2, 3, 3, 4,
+        2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
+        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6,
+        4, 5, 5, 6, 5, 6, 6, 7, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
+        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 2, 3, 3, 4, 3, 4, 4, 5,
+        3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
+        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6,
+        4, 5, 5, 6, 5, 6, 6, 7, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
+        4, 5, 5, 6, 5, 6, 6, 7, 5, 6, 6, 7, 6, 7, 7, 8};
+
+    return numBitsSet[src & 0xff] + numBitsSet[src >> 8];
+}
+
+//
+// Take a DCT coefficient, as well as an acceptable error. Search
+// nearby values within the error tolerance, that have fewer
+// bits set.
+//
+// The list of candidates has been pre-computed and sorted
+// in order of increasing numbers of bits set. This way, we
+// can stop searching as soon as we find a candidate that
+// is within the error tolerance.
+//
+static inline uint16_t
+quantize (float dctval, float errorTolerance)
+{
+    uint16_t tmp;
+    // pre-quantize float -> half and back
+    uint16_t src      = float_to_half (dctval);
+    float    srcFloat = half_to_float (src);
+
+    int             numSetBits = countSetBits (src);
+    const uint16_t* closest    = closestData + closestDataOffset[src];
+
+    for (int targetNumSetBits = numSetBits - 1; targetNumSetBits >= 0;
+         --targetNumSetBits)
+    {
+        tmp = *closest;
+
+        if (fabsf (half_to_float (tmp) - srcFloat) < errorTolerance) return tmp;
+
+        closest++;
+    }
+
+    return src;
+}
+
+//
+// Zig-zag order of the coefficients of an 8x8 block, dst[i] is
+// taken from src[zigZagOrder[i]].
+//
+
+static const int zigZagOrder[64] = {
+    0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6,  7,  14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+#define CLOSEST_DATA_SIZE (sizeof (closestData) / sizeof (closestData[0]))
+
+static inline int
+countTrailingZeros64 (uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll (v);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long idx;
+    _BitScanForward64 (&idx, v);
+    return (int) idx;
+#else
+    int n = 0;
+    while (!(v & 1))
+    {
+        v >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+//
+// Quantize an 8x8 block of DCT coefficients to half, with the
+// acceptable error of each coefficient given in tolerance, and
+// write them out in zig-zag order.
+//
+
+static void
+quantizeCoeffs64_scalar (
+    uint16_t* dst, const float* src, const float* tolerance)
+{
+    for (int i = 0; i < 64; ++i)
+    {
+        int z  = zigZagOrder[i];
+        dst[i] = quantize (src[z], tolerance[z]);
+    }
+}
+
+#ifdef IMF_HAVE_F16C_TARGET
+
+//
+// The same, but testing 8 candidates at a time. The candidate
+// lists are sorted by the number of bits set, so the first
+// lane within the tolerance is the value the scalar search
+// would return.
+//
+
+IMF_F16C_TARGET static void
+quantizeCoeffs64_f16c (
+    uint16_t* dst, const float* src, const float* tolerance)
+{
+    uint16_t halfCoef[64];
+    float    halfCoefFloat[64];
+    __m256   absMask = _mm256_castsi256_ps (_mm256_set1_epi32 (0x7fffffff));
+
+    //
+    // Pre-quantize float -> half and back. The hardware quiets
+    // signalling NaNs where float_to_half keeps the payload as
+    // is, so leave any NaN to the latter.
+    //
+
+    for (int i = 0; i < 64; i += 8)
+    {
+        __m256  v = _mm256_loadu_ps (src + i);
+        __m128i h;
+
+        if (_mm256_movemask_ps (_mm256_cmp_ps (v, v, _CMP_UNORD_Q)) == 0)
+        {
+            h = _mm256_cvtps_ph (v, _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128 ((__m128i*) (halfCoef + i), h);
+        }
+        else
+        {
+            for (int j = 0; j < 8; ++j)
+                halfCoef[i + j] = float_to_half (src[i + j]);
+            h = _mm_loadu_si128 ((const __m128i*) (halfCoef + i));
+        }
+
+        _mm256_storeu_ps (halfCoefFloat + i, _mm256_cvtph_ps (h));
+    }
+
+    for (int i = 0; i < 64; ++i)
+    {
+        int      z          = zigZagOrder[i];
+        uint16_t srcHalf    = halfCoef[z];
+        int      numSetBits = countSetBits (srcHalf);
+        size_t   offset     = closestDataOffset[srcHalf];
+
+        dst[i] = srcHalf;
+        if (numSetBits == 0) continue;
+
+        //
+        // Don't read past the end of the candidate table
+        //
+
+        if (offset + (size_t) ((numSetBits + 7) & ~7) > CLOSEST_DATA_SIZE)
+        {
+            dst[i] = quantize (src[z], tolerance[z]);
+            continue;
+        }
+
+        {
+            __m256 srcFloat = _mm256_set1_ps (halfCoefFloat[z]);
+            __m256 tol      = _mm256_set1_ps (tolerance[z]);
+
+            for (int k = 0; k < numSetBits; k += 8)
+            {
+                __m256 cand = _mm256_cvtph_ps (_mm_loadu_si128 (
+                    (const __m128i*) (closestData + offset + k)));
+                __m256 err =
+                    _mm256_and_ps (_mm256_sub_ps (cand, srcFloat), absMask);
+                int hit =
+                    _mm256_movemask_ps (_mm256_cmp_ps (err, tol, _CMP_LT_OQ));
+
+                if (numSetBits - k < 8) hit &= (1 << (numSetBits - k)) - 1;
+
+                if (hit)
+                {
+                    dst[i] = closestData
+                        [offset + k + countTrailingZeros64 ((uint64_t) hit)];
+                    break;
+                }
+            }
+        }
+    }
+}
+
+#endif /* IMF_HAVE_F16C_TARGET */
+
+#ifdef IMF_HAVE_NEON_AARCH64
+
+static void
+quantizeCoeffs64_neon (
+    uint16_t* dst, const float* src, const float* tolerance)
+{
+    uint16_t halfCoef[64];
+    float    halfCoefFloat[64];
+
+    for (int i = 0; i < 64; i += 4)
+    {
+        float32x4_t v = vld1q_f32 (src + i);
+        uint16x4_t  h;
+
+        if (vminvq_u32 (vceqq_f32 (v, v)) != 0)
+        {
+            h = vreinterpret_u16_f16 (vcvt_f16_f32 (v));
+            vst1_u16 (halfCoef + i, h);
+        }
+        else
+        {
+            for (int j = 0; j < 4; ++j)
+                halfCoef[i + j] = float_to_half (src[i + j]);
+            h = vld1_u16 (halfCoef + i);
+        }
+
+        vst1q_f32 (halfCoefFloat + i, vcvt_f32_f16 (vreinterpret_f16_u16 (h)));
+    }
+
+    for (int i = 0; i < 64; ++i)
+    {
+        int      z          = zigZagOrder[i];
+        uint16_t srcHalf    = halfCoef[z];
+        int      numSetBits = countSetBits (srcHalf);
+        size_t   offset     = closestDataOffset[srcHalf];
+
+        dst[i] = srcHalf;
+        if (numSetBits == 0) continue;
+
+        if (offset + (size_t) ((numSetBits + 7) & ~7) > CLOSEST_DATA_SIZE)
+        {
+            dst[i] = quantize (src[z], tolerance[z]);
+            continue;
+        }
+
+        {
+            float32x4_t srcFloat = vdupq_n_f32 (halfCoefFloat[z]);
+            float32x4_t tol      = vdupq_n_f32 (tolerance[z]);
+
+            for (int k = 0; k < numSetBits; k += 8)
+            {
+                float16x8_t cand = vreinterpretq_f16_u16 (
+                    vld1q_u16 (closestData + offset + k));
+                uint32x4_t lo = vcltq_f32 (
+                    vabsq_f32 (vsubq_f32 (
+                        vcvt_f32_f16 (vget_low_f16 (cand)), srcFloat)),
+                    tol);
+                uint32x4_t hi = vcltq_f32 (
+                    vabsq_f32 (vsubq_f32 (vcvt_high_f32_f16 (cand), srcFloat)),
+                    tol);
+                uint64_t hit = vget_lane_u64 (
+                    vreinterpret_u64_u8 (vmovn_u16 (vcombine_u16 (
+                        vmovn_u32 (lo), vmovn_u32 (hi)))),
+                    0);
+
+                if (numSetBits - k < 8)
+                    hit &= ((uint64_t) 1 << (8 * (numSetBits - k))) - 1;
+
+                if (hit)
+                {
+                    dst[i] = closestData
+                        [offset + k + countTrailingZeros64 (hit) / 8];
+                    break;
+                }
+            }
+        }
+    }
+}
+
+#endif /* IMF_HAVE_NEON_AARCH64 */
+
+//
+// Build a mask with bit i set if the i'th of 64 halfs is zero,
+// so that runs of zeros can be measured without scanning
+//
+
+static inline uint64_t
+zeroMask64 (const uint16_t* block)
+{
+    uint64_t mask = 0;
+
+#if defined IMF_HAVE_SSE2
+    __m128i zero = _mm_setzero_si128 ();
+
+    for (int i = 0; i < 64; i += 16)
+    {
+        __m128i a = _mm_cmpeq_epi16 (
+            _mm_loadu_si128 ((const __m128i*) (block + i)), zero);
+        __m128i b = _mm_cmpeq_epi16 (
+            _mm_loadu_si128 ((const __m128i*) (block + i + 8)), zero);
+
+        mask |= (uint64_t) (uint32_t) _mm_movemask_epi8 (_mm_packs_epi16 (a, b))
+                << i;
+    }
+#elif defined IMF_HAVE_NEON_AARCH64
+    static const uint8_t bit[16] = {
+        1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t bits = vld1q_u8 (bit);
+
+    for (int i = 0; i < 64; i += 16)
+    {
+        uint8x16_t z = vcombine_u8 (
+            vmovn_u16 (vceqzq_u16 (vld1q_u16 (block + i))),
+            vmovn_u16 (vceqzq_u16 (vld1q_u16 (block + i + 8))));
+        uint8x16_t b = vandq_u8 (z, bits);
+
+        mask |= (uint64_t) vaddv_u8 (vget_low_u8 (b)) << i;
+        mask |= (uint64_t) vaddv_u8 (vget_high_u8 (b)) << (i + 8);
+    }
+#else
+    for (int i = 0; i < 64; ++i)
+        if (block[i] == 0) mask |= (uint64_t) 1 << i;
+#endif
+
+    return mask;
+}
+
+/**************************************/
+
 //
 // Function pointer to dispatch to an appropriate
 // convertFloatToHalf64_* impl, based on runtime cpu checking.
@@ -2296,6 +2646,12 @@ static void (*dctInverse8x8_5) (float*) = dctInverse8x8_scalar_5;
 static void (*dctInverse8x8_6) (float*) = dctInverse8x8_scalar_6;
 static void (*dctInverse8x8_7) (float*) = dctInverse8x8_scalar_7;
 
+//
+// Dispatch the quantization of a block of DCT coefficients
+//
+static void (*quantizeCoeffs64) (uint16_t*, const float*, const float*) =
+    quantizeCoeffs64_scalar;
+
 static void
 initializeFuncs (void)
 {
@@ -2308,10 +2664,12 @@ initializeFuncs (void)
     {
         convertFloatToHalf64 = convertFloatToHalf64_neon;
         fromHalfZigZag       = fromHalfZigZag_neon;
+        quantizeCoeffs64     = quantizeCoeffs64_neon;
     }
 #else
     convertFloatToHalf64 = convertFloatToHalf64_scalar;
     fromHalfZigZag       = fromHalfZigZag_scalar;
+    quantizeCoeffs64     = quantizeCoeffs64_scalar;
 
     check_for_x86_simd (&f16c, &avx, &sse2);
 
@@ -2323,6 +2681,9 @@ initializeFuncs (void)
     {
         convertFloatToHalf64 = convertFloatToHalf64_f16c;
         fromHalfZigZag       = fromHalfZigZag_f16c;
+#ifdef IMF_HAVE_F16C_TARGET
+        quantizeCoeffs64 = quantizeCoeffs64_f16c;
+#endif
     }
 
     dctInverse8x8_0 = dctInverse8x8_scalar_0;
@@ -1003,6 +1003,20 @@ readUInt (const uint8_t* b)
 // codes up to TABLE_LOOKUP_BITS in length.
 #define TABLE_LOOKUP_BITS 14
 
+// Number of bits in the multi symbol acceleration table, which
+// decodes as many whole codes as fit in that many bits, up to
+// MULTI_LOOKUP_SYMBOLS of them. Kept smaller than the other, so it
+// stays in cache (and is quick to build) even when most codes are
+// too long for it.
+#define MULTI_LOOKUP_BITS 12
+#define MULTI_LOOKUP_SYMBOLS 3
+
+// Fewest symbols to decode for building the multi symbol table.
+#define MULTI_LOOKUP_MIN_SYMBOLS (16 << MULTI_LOOKUP_BITS)
+
+// Largest packed code length table, 6 bits for each symbol at worst.
+#define MAX_PACKED_TABLE_BYTES ((6 * HUF_ENCSIZE + 7) / 8)
+
 #include <inttypes.h>
 
 #ifdef __APPLE__
@@ -1076,9 +1090,134 @@ typedef struct FastHufDecoder
     int _lookupSymbol
         [1 << TABLE_LOOKUP_BITS]; /* value = (codeLen << 24) | symbol */
 
+    //
+    // A similar lookup on the top MULTI_LOOKUP_BITS, but decoding as
+    // many whole codes as fit in those, so a run of short codes only
+    // costs one lookup. A count of 0 means the first code is either
+    // longer or the RLE symbol, and needs the lookup above.
+    //
+    // Building it costs about what it saves decoding some 16 times
+    // as many symbols as it has entries, so it is only built (once
+    // for each set of tables) when decoding at least that many.
+    //
+    uint64_t _lookupMulti
+        [1 << MULTI_LOOKUP_BITS]; /* value = (count << 56) |
+                                   *         (totalCodeLen << 48) |
+                                   *         symbols, first one lowest */
+    int _multiBuilt;
+
     uint64_t _tableMin;
+
+    //
+    // The packed code length table these tables were built from. The
+    // chunks of a file often share one (flat areas, mattes, alpha), so
+    // when the caller passes the same decoder back for the next chunk,
+    // an identical table can skip rebuilding them. A size of 0 means
+    // nothing usable is cached.
+    //
+    uint32_t _cachedMinSymbol;
+    uint32_t _cachedMaxSymbol;
+    uint64_t _cachedTableBytes;
+    uint8_t  _cachedTable[MAX_PACKED_TABLE_BYTES];
 } FastHufDecoder;
 
+#define MULTI_LOOKUP_MASK ((1 << MULTI_LOOKUP_BITS) - 1)
+
+// The single symbol table entry for a multi symbol table index.
+#define MULTI_LOOKUP_SINGLE(fhd, i)                                            \
+    ((fhd)->_lookupSymbol[(i) << (TABLE_LOOKUP_BITS - MULTI_LOOKUP_BITS)])
+
+#define MULTI_ENTRY(count, bits, symbols)                                      \
+    (((uint64_t) (count) << 56) | ((uint64_t) (bits) << 48) | (symbols))
+#define MULTI_COUNT(entry) ((int) ((entry) >> 56))
+#define MULTI_BITS(entry) ((int) ((entry) >> 48) & 0xff)
+
+//
+// The codes after the first in a multi symbol table entry are looked
+// up with the bits already used shifted out, which leaves zeros at the
+// bottom, so they only count when they end within the
+// MULTI_LOOKUP_BITS, where they are fully known.
+//
+
+// The entry for the code at the top of table index i, along with the
+// one after it, or 0 when the first is not a short code (or is the RLE
+// symbol, which needs a count after it).
+static inline uint64_t
+fasthuf_multi_pair (const FastHufDecoder* fhd, int i)
+{
+    int      tableIdx = MULTI_LOOKUP_SINGLE (fhd, i);
+    int      codeLen  = tableIdx >> 24;
+    int      symbol   = tableIdx & 0xffffff;
+    int      nextLen, nextSymbol;
+    uint64_t entry;
+
+    if (codeLen == 0 || codeLen > MULTI_LOOKUP_BITS ||
+        symbol == fhd->_rleSymbol)
+        return 0;
+
+    entry      = MULTI_ENTRY (1, codeLen, (uint64_t) symbol);
+    tableIdx   = MULTI_LOOKUP_SINGLE (fhd, (i << codeLen) & MULTI_LOOKUP_MASK);
+    nextLen    = tableIdx >> 24;
+    nextSymbol = tableIdx & 0xffffff;
+
+    if (nextLen == 0 || codeLen + nextLen > MULTI_LOOKUP_BITS ||
+        nextSymbol == fhd->_rleSymbol)
+        return entry;
+
+    return MULTI_ENTRY (
+        2,
+        codeLen + nextLen,
+        (uint64_t) symbol | ((uint64_t) nextSymbol << 16));
+}
+
+// Turn the pair at table index i into a triple, when the pair for the
+// bits after its first code fits in after it.
+static inline void
+fasthuf_multi_extend (FastHufDecoder* fhd, int i)
+{
+    uint64_t entry = fhd->_lookupMulti[i];
+    uint64_t next;
+    int      codeLen;
+
+    if (MULTI_COUNT (entry) == 0) return;
+
+    codeLen = MULTI_LOOKUP_SINGLE (fhd, i) >> 24;
+    next    = fhd->_lookupMulti[(i << codeLen) & MULTI_LOOKUP_MASK];
+
+    if (MULTI_COUNT (next) == 2 &&
+        codeLen + MULTI_BITS (next) <= MULTI_LOOKUP_BITS)
+    {
+        fhd->_lookupMulti[i] = MULTI_ENTRY (
+            3,
+            codeLen + MULTI_BITS (next),
+            (entry & 0xffff) | ((next & 0xffffffff) << 16));
+    }
+}
+
+//
+// Build the multi symbol table from the single one, first with pairs
+// of codes, then putting the first code of each entry in front of the
+// pair for the bits after it. That pair comes from an entry with more
+// zeros at the bottom, so going through them in order of how many
+// there are, it has not been replaced by its triple yet.
+//
+
+static void
+FastHufDecoder_buildMultiTable (FastHufDecoder* fhd)
+{
+    for (int i = 0; i < 1 << MULTI_LOOKUP_BITS; ++i)
+        fhd->_lookupMulti[i] = fasthuf_multi_pair (fhd, i);
+
+    for (int zeros = 0; zeros < MULTI_LOOKUP_BITS; ++zeros)
+    {
+        for (int i = 1 << zeros; i < 1 << MULTI_LOOKUP_BITS; i += 2 << zeros)
+            fasthuf_multi_extend (fhd, i);
+    }
+    fasthuf_multi_extend (fhd, 0);
+
+    fhd->_multiBuilt = 1;
+}
+
 static exr_result_t
 FastHufDecoder_buildTables (
     exr_const_context_t pctxt,
@@ -1087,6 +1226,7 @@ FastHufDecoder_buildTables (
     uint64_t*           offset)
 {
     int minIdx = TABLE_LOOKUP_BITS;
+    int codeLen;
 
     //
     // Build the 'left justified' base table, by shifting base left..
@@ -1124,39 +1264,44 @@ FastHufDecoder_buildTables (
     // Build the acceleration tables for the lookups of
     // short codes ( <= TABLE_LOOKUP_BITS long)
     //
+    // The first code length where _ljBase[codeLen] <= value can only
+    // grow as the value drops, so walk down the table and carry on
+    // the search from where the last entry found its length.
+    //
 
-    for (uint64_t i = 0; i < 1 << TABLE_LOOKUP_BITS; ++i)
+    codeLen = fhd->_minCodeLength;
+    for (int i = (1 << TABLE_LOOKUP_BITS) - 1; i >= 0; --i)
     {
-        uint64_t value = i << (64 - TABLE_LOOKUP_BITS);
+        uint64_t value = (uint64_t) i << (64 - TABLE_LOOKUP_BITS);
 
         fhd->_lookupSymbol[i] = 0xffff;
 
-        for (int codeLen = fhd->_minCodeLength; codeLen <= fhd->_maxCodeLength;
-             ++codeLen)
+        while (codeLen <= fhd->_maxCodeLength &&
+               fhd->_ljBase[codeLen] > value)
+            ++codeLen;
+
+        if (codeLen <= fhd->_maxCodeLength)
         {
-            if (fhd->_ljBase[codeLen] <= value)
+            uint64_t id = fhd->_ljOffset[codeLen] + (value >> (64 - codeLen));
+            if (id < (uint64_t) (fhd->_numSymbols))
             {
-                uint64_t id =
-                    fhd->_ljOffset[codeLen] + (value >> (64 - codeLen));
-                if (id < (uint64_t) (fhd->_numSymbols))
-                {
-                    fhd->_lookupSymbol[i] =
-                        (fhd->_idToSymbol[id] | (codeLen << 24));
-                }
-                else
-                {
-                    if (pctxt)
-                        pctxt->print_error (
-                            pctxt,
-                            EXR_ERR_CORRUPT_CHUNK,
-                            "Huffman decode error (Overrun)");
-                    return EXR_ERR_CORRUPT_CHUNK;
-                }
-                break;
+                fhd->_lookupSymbol[i] =
+                    (fhd->_idToSymbol[id] | (codeLen << 24));
+            }
+            else
+            {
+                if (pctxt)
+                    pctxt->print_error (
+                        pctxt,
+                        EXR_ERR_CORRUPT_CHUNK,
+                        "Huffman decode error (Overrun)");
+                return EXR_ERR_CORRUPT_CHUNK;
             }
         }
     }
 
+    fhd->_multiBuilt = 0;
+
     //
     // Store the smallest value in the table that points to real data.
     // This should be the entry for the largest length that has
@@ -1492,6 +1637,29 @@ fasthuf_initialize (
     return FastHufDecoder_buildTables (pctxt, fhd, base, offset);
 }
 
+//
+// Whether the tables in fhd were built from the packed code length
+// table at the start of table, so it can be skipped over instead.
+// That is exactly the case when the bytes the table was parsed from
+// are the same, as parsing it reads no further than those.
+//
+
+static inline int
+fasthuf_is_cached (
+    const FastHufDecoder* fhd,
+    const uint8_t*        table,
+    uint64_t              numBytes,
+    uint32_t              minSymbol,
+    uint32_t              maxSymbol)
+{
+    return fhd->_cachedTableBytes > 0 &&
+           fhd->_cachedTableBytes <= sizeof (fhd->_cachedTable) &&
+           fhd->_cachedTableBytes <= numBytes &&
+           fhd->_cachedMinSymbol == minSymbol &&
+           fhd->_cachedMaxSymbol == maxSymbol &&
+           memcmp (fhd->_cachedTable, table, fhd->_cachedTableBytes) == 0;
+}
+
 static inline int
 fasthuf_decode_enabled (void)
 {
@@ -1544,7 +1712,7 @@ fasthuf_decode (
     // Current position (byte/bit) in the src data stream
     // (after the first buffer fill)
     //
-    uint64_t             buffer, bufferBack, dstIdx;
+    uint64_t             buffer, bufferBack, dstIdx, multiEnd;
     int                  bufferNumBits, bufferBackNumBits;
     const unsigned char* currByte = src + 2 * sizeof (uint64_t);
 
@@ -1565,12 +1733,85 @@ fasthuf_decode (
     bufferBackNumBits = 64;
     dstIdx            = 0;
 
+    //
+    // Build the multi symbol table if there are enough symbols for it
+    // to pay off, and find where to stop using it, leaving room for all
+    // the symbols in an entry
+    //
+
+    if (!fhd->_multiBuilt && numDstElems >= MULTI_LOOKUP_MIN_SYMBOLS)
+        FastHufDecoder_buildMultiTable (fhd);
+
+    multiEnd = 0;
+    if (fhd->_multiBuilt && numDstElems >= MULTI_LOOKUP_SYMBOLS)
+        multiEnd = numDstElems - MULTI_LOOKUP_SYMBOLS + 1;
+
     while (dstIdx < numDstElems)
     {
         int codeLen;
         int symbol;
         int rleCount;
 
+        //
+        // Decode a run of short codes with one lookup. All of the
+        // symbols in the entry are written, but only the ones that
+        // were decoded are kept. The buffer only needs the
+        // TABLE_LOOKUP_BITS for this, so it is not refilled until it
+        // runs below that.
+        //
+
+        if (dstIdx < multiEnd)
+        {
+            uint64_t entry =
+                fhd->_lookupMulti[buffer >> (64 - MULTI_LOOKUP_BITS)];
+            int count = MULTI_COUNT (entry);
+
+            if (count > 0)
+            {
+                codeLen = MULTI_BITS (entry);
+
+                dst[dstIdx]     = (uint16_t) entry;
+                dst[dstIdx + 1] = (uint16_t) (entry >> 16);
+                dst[dstIdx + 2] = (uint16_t) (entry >> 32);
+                dstIdx += (uint64_t) count;
+
+                buffer = buffer << codeLen;
+                bufferNumBits -= codeLen;
+
+                if (bufferNumBits < TABLE_LOOKUP_BITS)
+                {
+                    FastHufDecoder_refill (
+                        &buffer,
+                        64 - bufferNumBits,
+                        &bufferBack,
+                        &bufferBackNumBits,
+                        &currByte,
+                        &numSrcBits);
+
+                    bufferNumBits = 64;
+                }
+                continue;
+            }
+        }
+
+        //
+        // Otherwise, one code at a time, which needs a full buffer
+        // for the longer codes and the RLE counts.
+        //
+
+        if (bufferNumBits < 64)
+        {
+            FastHufDecoder_refill (
+                &buffer,
+                64 - bufferNumBits,
+                &bufferBack,
+                &bufferBackNumBits,
+                &currByte,
+                &numSrcBits);
+
+            bufferNumBits = 64;
+        }
+
         //
         // Test if we can be table accelerated. If so, directly
         // lookup the output symbol. Otherwise, we need to fall
@@ -1718,7 +1959,7 @@ fasthuf_decode (
         // bits needed for a table lookup
         //
 
-        if (bufferNumBits < 64)
+        if (bufferNumBits < TABLE_LOOKUP_BITS)
         {
             FastHufDecoder_refill (
                 &buffer,
@@ -1732,6 +1973,22 @@ fasthuf_decode (
         }
     }
 
+    //
+    // Top the buffer up as the single code path always did, so the
+    // check for unused data sees the same bit stream position.
+    //
+
+    if (bufferNumBits < 64)
+    {
+        FastHufDecoder_refill (
+            &buffer,
+            64 - bufferNumBits,
+            &bufferBack,
+            &bufferBackNumBits,
+            &currByte,
+            &numSrcBits);
+    }
+
     if (numSrcBits != 0)
     {
         if (pctxt)
@@ -1846,7 +2103,8 @@ internal_huf_decompress (
     uint16_t*              raw,
     uint64_t               nRaw,
     void*                  spare,
-    uint64_t               sparebytes)
+    uint64_t               sparebytes,
+    int                    reuse_tables)
 {
     uint32_t            im, iM, nBits;
     uint64_t            nBytes;
@@ -1874,14 +2132,22 @@ internal_huf_decompress (
     nBits = readUInt (compressed + 12);
     // uint32_t future = readUInt (compressed + 16);
 
-    if (im >= HUF_ENCSIZE || iM >= HUF_ENCSIZE) return EXR_ERR_CORRUPT_CHUNK;
+    if (im >= HUF_ENCSIZE || iM >= HUF_ENCSIZE)
+    {
+        internal_huf_decompress_clear_tables (spare);
+        return EXR_ERR_CORRUPT_CHUNK;
+    }
 
     ptr = compressed + hufInfoBlockSize;
 
     nBytes = (((uint64_t) (nBits) + 7)) / 8;
 
     // must be nBytes remaining in buffer
-    if (hufInfoBlockSize + nBytes > nCompressed) return EXR_ERR_OUT_OF_MEMORY;
+    if (hufInfoBlockSize + nBytes > nCompressed)
+    {
+        internal_huf_decompress_clear_tables (spare);
+        return EXR_ERR_OUT_OF_MEMORY;
+    }
 
     //
     // Fast decoder needs at least 2x64-bits of compressed data, and
@@ -1890,10 +2156,29 @@ internal_huf_decompress (
     //
     if (fasthuf_decode_enabled () && nBits > 128)
     {
-        FastHufDecoder* fhd = (FastHufDecoder*) spare;
+        FastHufDecoder* fhd    = (FastHufDecoder*) spare;
+        const uint8_t*  table  = ptr;
+        uint64_t        nTable = nCompressed - hufInfoBlockSize;
+
+        rv = EXR_ERR_SUCCESS;
+        if (reuse_tables && fasthuf_is_cached (fhd, table, nTable, im, iM))
+            ptr += fhd->_cachedTableBytes;
+        else
+        {
+            fhd->_cachedTableBytes = 0;
+
+            rv = fasthuf_initialize (
+                pctxt, fhd, &ptr, nTable, im, iM, (int) iM);
+            if (rv == EXR_ERR_SUCCESS &&
+                (uint64_t) (ptr - table) <= sizeof (fhd->_cachedTable))
+            {
+                fhd->_cachedMinSymbol  = im;
+                fhd->_cachedMaxSymbol  = iM;
+                fhd->_cachedTableBytes = (uint64_t) (ptr - table);
+                memcpy (fhd->_cachedTable, table, fhd->_cachedTableBytes);
+            }
+        }
 
-        rv = fasthuf_initialize (
-            pctxt, fhd, &ptr, nCompressed - hufInfoBlockSize, im, iM, (int) iM);
         if (rv == EXR_ERR_SUCCESS)
         {
             if ((uint64_t) (ptr - compressed) + nBytes > nCompressed)
@@ -1910,13 +2195,24 @@ internal_huf_decompress (
         hufClearDecTable (hdec);
         hufUnpackEncTable (&ptr, &nLeft, im, iM, freq);
 
-        if (nBits > 8 * nLeft) return EXR_ERR_CORRUPT_CHUNK;
+        if (nBits > 8 * nLeft) { rv = EXR_ERR_CORRUPT_CHUNK; }
+        else
+        {
+            rv = hufBuildDecTable (pctxt, freq, im, iM, hdec);
+            if (rv == EXR_ERR_SUCCESS)
+                rv = hufDecode (freq, hdec, ptr, nBits, iM, nRaw, raw);
 
-        rv = hufBuildDecTable (pctxt, freq, im, iM, hdec);
-        if (rv == EXR_ERR_SUCCESS)
-            rv = hufDecode (freq, hdec, ptr, nBits, iM, nRaw, raw);
+            hufFreeDecTable (pctxt, hdec);
+        }
 
-        hufFreeDecTable (pctxt, hdec);
+        /* the tables above went over any cached fast decoder */
+        internal_huf_decompress_clear_tables (spare);
     }
     return rv;
 }
+
+void
+internal_huf_decompress_clear_tables (void* spare)
+{
+    ((FastHufDecoder*) spare)->_cachedTableBytes = 0;
+}
@@ -21,6 +21,9 @@ exr_result_t internal_huf_compress (
     void*           spare,
     uint64_t        sparebytes);
 
+/* the decoding tables are left in spare, and when reuse_tables is
+ * non-zero (spare is untouched since the previous call with it), are
+ * used again if the code length table is the same */
 exr_result_t internal_huf_decompress (
     exr_decode_pipeline_t* decode,
     const uint8_t*         compressed,
@@ -28,6 +31,11 @@ exr_result_t internal_huf_decompress (
     uint16_t*              raw,
     uint64_t               nRaw,
     void*                  spare,
-    uint64_t               sparebytes);
+    uint64_t               sparebytes,
+    int                    reuse_tables);
+
+/* mark a newly allocated spare buffer as holding no decoding tables,
+ * before its first use with reuse_tables */
+void internal_huf_decompress_clear_tables (void* spare);
 
 #endif /* OPENEXR_CORE_HUF_CODING_H */
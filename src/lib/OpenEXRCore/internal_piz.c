@@ -12,6 +12,15 @@
 
 #include <string.h>
 
+#if defined __SSE2__ || (_MSC_VER >= 1300 && (_M_IX86 || _M_X64))
+#    define IMF_HAVE_SSE2 1
+#    include <emmintrin.h>
+#endif
+#if defined(__aarch64__)
+#    define IMF_HAVE_NEON_AARCH64 1
+#    include <arm_neon.h>
+#endif
+
 /**************************************/
 
 #define USHORT_RANGE (1 << 16)
@@ -92,6 +101,15 @@ applyLut (const uint16_t* lut, uint16_t* data, uint64_t nData)
         data[i] = lut[data[i]];
 }
 
+/* applyLut in to the (xdr) output, saving a pass over the data */
+static inline void
+applyLutCopy (
+    const uint16_t* lut, uint8_t* out, const uint16_t* data, uint64_t nData)
+{
+    for (uint64_t i = 0; i < nData; ++i)
+        unaligned_store16 (out + i * 2, lut[data[i]]);
+}
+
 /**************************************/
 //
 // Wavelet basis functions without modulo arithmetic; they produce
@@ -166,15 +184,231 @@ wdec16 (uint16_t l, uint16_t h, uint16_t* a, uint16_t* b)
     *a     = (uint16_t) aa;
 }
 
+/**************************************/
+//
+// Both transforms are done a level at a time on pairs of rows. For
+// each 2x2 block, the 2D transform is a 1D transform along the two
+// rows and one between them; the blocks do not depend on each other,
+// so each of those can be done over the whole row pair in turn. At
+// the finest level, which has three quarters of the work, the values
+// are then contiguous (between the rows) or interleaved (along them),
+// and the vector versions below do 8 of them at once.
+//
+
+#if defined(IMF_HAVE_SSE2)
+
+static inline void
+wenc14_sse2 (__m128i* a, __m128i* b)
+{
+    /* (a + b) >> 1 without overflowing 16 bits */
+    __m128i m = _mm_add_epi16 (
+        _mm_add_epi16 (_mm_srai_epi16 (*a, 1), _mm_srai_epi16 (*b, 1)),
+        _mm_and_si128 (_mm_and_si128 (*a, *b), _mm_set1_epi16 (1)));
+    __m128i d = _mm_sub_epi16 (*a, *b);
+
+    *a = m;
+    *b = d;
+}
+
+static inline void
+wdec14_sse2 (__m128i* l, __m128i* h)
+{
+    __m128i a = _mm_add_epi16 (
+        _mm_add_epi16 (*l, _mm_and_si128 (*h, _mm_set1_epi16 (1))),
+        _mm_srai_epi16 (*h, 1));
+    __m128i b = _mm_sub_epi16 (a, *h);
+
+    *l = a;
+    *h = b;
+}
+
+static inline void
+wenc16_sse2 (__m128i* a, __m128i* b)
+{
+    const __m128i off = _mm_set1_epi16 ((short) A_OFFSET);
+    __m128i       ao  = _mm_xor_si128 (*a, off);
+
+    /* unsigned (ao + b) >> 1, avg rounds up */
+    __m128i m = _mm_sub_epi16 (
+        _mm_avg_epu16 (ao, *b),
+        _mm_and_si128 (_mm_xor_si128 (ao, *b), _mm_set1_epi16 (1)));
+    __m128i d = _mm_sub_epi16 (ao, *b);
+
+    /* ao < b unsigned, i.e. d < 0 */
+    __m128i neg = _mm_cmplt_epi16 (*a, _mm_xor_si128 (*b, off));
+
+    *a = _mm_xor_si128 (m, _mm_and_si128 (neg, off));
+    *b = d;
+}
+
+static inline void
+wdec16_sse2 (__m128i* l, __m128i* h)
+{
+    __m128i bb = _mm_sub_epi16 (*l, _mm_srli_epi16 (*h, 1));
+    __m128i aa = _mm_xor_si128 (
+        _mm_add_epi16 (*h, bb), _mm_set1_epi16 ((short) A_OFFSET));
+
+    *l = aa;
+    *h = bb;
+}
+
+#    define WAV_VEC_T __m128i
+#    define WAV_VEC_LOAD(p) _mm_loadu_si128 ((const __m128i*) (p))
+#    define WAV_VEC_STORE(p, v) _mm_storeu_si128 ((__m128i*) (p), v)
+#    define WAV_VEC_ENC14 wenc14_sse2
+#    define WAV_VEC_DEC14 wdec14_sse2
+#    define WAV_VEC_ENC16 wenc16_sse2
+#    define WAV_VEC_DEC16 wdec16_sse2
+
+/* split the 8 pairs at p in to the first and second of each pair */
+static inline void
+wav_load_pairs (const uint16_t* p, __m128i* a, __m128i* b)
+{
+    __m128i v0 = _mm_loadu_si128 ((const __m128i*) p);
+    __m128i v1 = _mm_loadu_si128 ((const __m128i*) (p + 8));
+
+    /* the sign extension keeps packs from saturating */
+    *a = _mm_packs_epi32 (
+        _mm_srai_epi32 (_mm_slli_epi32 (v0, 16), 16),
+        _mm_srai_epi32 (_mm_slli_epi32 (v1, 16), 16));
+    *b = _mm_packs_epi32 (_mm_srai_epi32 (v0, 16), _mm_srai_epi32 (v1, 16));
+}
+
+static inline void
+wav_store_pairs (uint16_t* p, __m128i a, __m128i b)
+{
+    _mm_storeu_si128 ((__m128i*) p, _mm_unpacklo_epi16 (a, b));
+    _mm_storeu_si128 ((__m128i*) (p + 8), _mm_unpackhi_epi16 (a, b));
+}
+
+#elif defined(IMF_HAVE_NEON_AARCH64)
+
+static inline void
+wenc14_neon (uint16x8_t* a, uint16x8_t* b)
+{
+    int16x8_t as = vreinterpretq_s16_u16 (*a);
+    int16x8_t bs = vreinterpretq_s16_u16 (*b);
+
+    *a = vreinterpretq_u16_s16 (vhaddq_s16 (as, bs));
+    *b = vreinterpretq_u16_s16 (vsubq_s16 (as, bs));
+}
+
+static inline void
+wdec14_neon (uint16x8_t* l, uint16x8_t* h)
+{
+    int16x8_t hs = vreinterpretq_s16_u16 (*h);
+    int16x8_t a  = vaddq_s16 (
+        vaddq_s16 (vreinterpretq_s16_u16 (*l), vandq_s16 (hs, vdupq_n_s16 (1))),
+        vshrq_n_s16 (hs, 1));
+
+    *l = vreinterpretq_u16_s16 (a);
+    *h = vreinterpretq_u16_s16 (vsubq_s16 (a, hs));
+}
+
+static inline void
+wenc16_neon (uint16x8_t* a, uint16x8_t* b)
+{
+    const uint16x8_t off = vdupq_n_u16 (A_OFFSET);
+    uint16x8_t       ao  = veorq_u16 (*a, off);
+    uint16x8_t       m   = vhaddq_u16 (ao, *b);
+    uint16x8_t       neg = vcltq_u16 (ao, *b);
+
+    *b = vsubq_u16 (ao, *b);
+    *a = veorq_u16 (m, vandq_u16 (neg, off));
+}
+
+static inline void
+wdec16_neon (uint16x8_t* l, uint16x8_t* h)
+{
+    uint16x8_t bb = vsubq_u16 (*l, vshrq_n_u16 (*h, 1));
+
+    *l = veorq_u16 (vaddq_u16 (*h, bb), vdupq_n_u16 (A_OFFSET));
+    *h = bb;
+}
+
+#    define WAV_VEC_T uint16x8_t
+#    define WAV_VEC_LOAD(p) vld1q_u16 (p)
+#    define WAV_VEC_STORE(p, v) vst1q_u16 (p, v)
+#    define WAV_VEC_ENC14 wenc14_neon
+#    define WAV_VEC_DEC14 wdec14_neon
+#    define WAV_VEC_ENC16 wenc16_neon
+#    define WAV_VEC_DEC16 wdec16_neon
+
+static inline void
+wav_load_pairs (const uint16_t* p, uint16x8_t* a, uint16x8_t* b)
+{
+    uint16x8x2_t v = vld2q_u16 (p);
+
+    *a = v.val[0];
+    *b = v.val[1];
+}
+
+static inline void
+wav_store_pairs (uint16_t* p, uint16x8_t a, uint16x8_t b)
+{
+    uint16x8x2_t v;
+
+    v.val[0] = a;
+    v.val[1] = b;
+    vst2q_u16 (p, v);
+}
+
+#endif
+
+/* the first and second of n pairs, stride apart, are transformed in
+ * place, with pairs of adjacent values when b is a + 1 */
+#define WAV_PAIRS_FUNC(name, vecop, op)                                        \
+    static void name (uint16_t* a, uint16_t* b, int n, int stride)             \
+    {                                                                          \
+        int i = 0;                                                             \
+        WAV_PAIRS_VEC (vecop)                                                  \
+        for (a += i * stride, b += i * stride; i < n;                          \
+             ++i, a += stride, b += stride)                                    \
+            op (*a, *b, a, b);                                                 \
+    }
+
+#if defined(WAV_VEC_T)
+#    define WAV_PAIRS_VEC(vecop)                                               \
+        if (stride == 1)                                                       \
+        {                                                                      \
+            for (; i + 8 <= n; i += 8)                                         \
+            {                                                                  \
+                WAV_VEC_T va = WAV_VEC_LOAD (a + i);                           \
+                WAV_VEC_T vb = WAV_VEC_LOAD (b + i);                           \
+                vecop (&va, &vb);                                              \
+                WAV_VEC_STORE (a + i, va);                                     \
+                WAV_VEC_STORE (b + i, vb);                                     \
+            }                                                                  \
+        }                                                                      \
+        else if (stride == 2 && b == a + 1)                                    \
+        {                                                                      \
+            for (; i + 8 <= n; i += 8)                                         \
+            {                                                                  \
+                WAV_VEC_T va, vb;                                              \
+                wav_load_pairs (a + 2 * i, &va, &vb);                          \
+                vecop (&va, &vb);                                              \
+                wav_store_pairs (a + 2 * i, va, vb);                           \
+            }                                                                  \
+        }
+#else
+#    define WAV_PAIRS_VEC(vecop)
+#endif
+
+WAV_PAIRS_FUNC (wav_enc14_pairs, WAV_VEC_ENC14, wenc14)
+WAV_PAIRS_FUNC (wav_dec14_pairs, WAV_VEC_DEC14, wdec14)
+WAV_PAIRS_FUNC (wav_enc16_pairs, WAV_VEC_ENC16, wenc16)
+WAV_PAIRS_FUNC (wav_dec16_pairs, WAV_VEC_DEC16, wdec16)
+
 /**************************************/
 
 static void
 wav_2D_encode (uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx)
 {
-    int w14 = (mx < (1 << 14)) ? 1 : 0;
-    int n   = (nx > ny) ? ny : nx;
-    int p   = 1; // == 1 <<  level
-    int p2  = 2; // == 1 << (level+1)
+    void (*enc) (uint16_t*, uint16_t*, int, int) =
+        (mx < (1 << 14)) ? &wav_enc14_pairs : &wav_enc16_pairs;
+    int n  = (nx > ny) ? ny : nx;
+    int p  = 1; // == 1 <<  level
+    int p2 = 2; // == 1 << (level+1)
 
     //
     // Hierarchical loop on smaller dimension n
@@ -188,81 +422,26 @@ wav_2D_encode (uint16_t* in, int nx, int ox, int ny, int oy, uint16_t mx)
         int       oy2 = oy * p2;
         int       ox1 = ox * p;
         int       ox2 = ox * p2;
-        uint16_t  i00, i01, i10, i11;
+        int       nb  = nx / p2; // 2x2 blocks in a row pair
+        int       nc  = nx / p;  // columns, including an odd one
 
         //
-        // Y loop
+        // Y loop: 2D wavelet encoding along both rows, then between
+        // them, which also encodes (1D) the odd column
         //
 
         for (; py <= ey; py += oy2)
         {
-            uint16_t* px = py;
-            uint16_t* ex = py + ox * (nx - p2);
-
-            //
-            // X loop
-            //
-
-            for (; px <= ex; px += ox2)
-            {
-                uint16_t* p01 = px + ox1;
-                uint16_t* p10 = px + oy1;
-                uint16_t* p11 = p10 + ox1;
-
-                //
-                // 2D wavelet encoding
-                //
-
-                if (w14)
-                {
-                    wenc14 (*px, *p01, &i00, &i01);
-                    wenc14 (*p10, *p11, &i10, &i11);
-                    wenc14 (i00, i10, px, p10);
-                    wenc14 (i01, i11, p01, p11);
-                }
-                else
-                {
-                    wenc16 (*px, *p01, &i00, &i01);
-                    wenc16 (*p10, *p11, &i10, &i11);
-                    wenc16 (i00, i10, px, p10);
-                    wenc16 (i01, i11, p01, p11);
-                }
-            }
-
-            //
-            // Encode (1D) odd column (still in Y loop)
-            //
-
-            if (nx & p)
-            {
-                uint16_t* p10 = px + oy1;
-
-                if (w14)
-                    wenc14 (*px, *p10, px, p10);
-                else
-                    wenc16 (*px, *p10, px, p10);
-            }
+            enc (py, py + ox1, nb, ox2);
+            enc (py + oy1, py + oy1 + ox1, nb, ox2);
+            enc (py, py + oy1, nc, ox1);
         }
 
         //
-        // Encode (1D) odd line (must loop in X)
+        // Encode (1D) odd line
         //
 
-        if (ny & p)
-        {
-            uint16_t* px = py;
-            uint16_t* ex = py + ox * (nx - p2);
-
-            for (; px <= ex; px += ox2)
-            {
-                uint16_t* p01 = px + ox1;
-
-                if (w14)
-                    wenc14 (*px, *p01, px, p01);
-                else
-                    wenc16 (*px, *p01, px, p01);
-            }
-        }
+        if (ny & p) enc (py, py + ox1, nb, ox2);
 
         //
         // Next level
@@ -284,9 +463,10 @@ wav_2D_decode (
     int       oy, // i : y offset
     uint16_t  mx)  // i : maximum in[x][y] value
 {
-    int w14 = (mx < (1 << 14)) ? 1 : 0;
-    int n   = (nx > ny) ? ny : nx;
-    int p   = 1;
+    void (*dec) (uint16_t*, uint16_t*, int, int) =
+        (mx < (1 << 14)) ? &wav_dec14_pairs : &wav_dec16_pairs;
+    int n = (nx > ny) ? ny : nx;
+    int p = 1;
     int p2;
 
     //
@@ -312,83 +492,26 @@ wav_2D_decode (
         int       oy2 = oy * p2;
         int       ox1 = ox * p;
         int       ox2 = ox * p2;
-        uint16_t  i00, i01, i10, i11;
+        int       nb  = nx / p2; // 2x2 blocks in a row pair
+        int       nc  = nx / p;  // columns, including an odd one
 
         //
-        // Y loop
+        // Y loop: 2D wavelet decoding between the rows, which also
+        // decodes (1D) the odd column, then along both rows
         //
 
         for (; py <= ey; py += oy2)
         {
-            uint16_t* px = py;
-            uint16_t* ex = py + ox * (nx - p2);
-
-            //
-            // X loop
-            //
-
-            for (; px <= ex; px += ox2)
-            {
-                uint16_t* p01 = px + ox1;
-                uint16_t* p10 = px + oy1;
-                uint16_t* p11 = p10 + ox1;
-
-                //
-                // 2D wavelet decoding
-                //
-
-                if (w14)
-                {
-                    wdec14 (*px, *p10, &i00, &i10);
-                    wdec14 (*p01, *p11, &i01, &i11);
-                    wdec14 (i00, i01, px, p01);
-                    wdec14 (i10, i11, p10, p11);
-                }
-                else
-                {
-                    wdec16 (*px, *p10, &i00, &i10);
-                    wdec16 (*p01, *p11, &i01, &i11);
-                    wdec16 (i00, i01, px, p01);
-                    wdec16 (i10, i11, p10, p11);
-                }
-            }
-
-            //
-            // Decode (1D) odd column (still in Y loop)
-            //
-
-            if (nx & p)
-            {
-                uint16_t* p10 = px + oy1;
-
-                if (w14)
-                    wdec14 (*px, *p10, &i00, p10);
-                else
-                    wdec16 (*px, *p10, &i00, p10);
-                *px = i00;
-            }
+            dec (py, py + oy1, nc, ox1);
+            dec (py, py + ox1, nb, ox2);
+            dec (py + oy1, py + oy1 + ox1, nb, ox2);
         }
 
         //
-        // Decode (1D) odd line (must loop in X)
+        // Decode (1D) odd line
         //
 
-        if (ny & p)
-        {
-            uint16_t* px = py;
-            uint16_t* ex = py + ox * (nx - p2);
-
-            for (; px <= ex; px += ox2)
-            {
-                uint16_t* p01 = px + ox1;
-
-                if (w14)
-                    wdec14 (*px, *p01, &i00, p01);
-                else
-                    wdec16 (*px, *p01, &i00, p01);
-                *px = i00;
-            }
-        }
+        if (ny & p) dec (py, py + ox1, nb, ox2);
 
         //
         // Next level
@@ -572,6 +695,8 @@ internal_exr_undo_piz (
     uint16_t       minNonZero, maxNonZero, maxValue;
     uint16_t*      wavbuf;
     uint32_t       hufbytes;
+    size_t         scratch2Bytes;
+    int            reuseHufTables;
 
     rv = internal_decode_alloc_buffer (
         decode,
@@ -581,19 +706,29 @@ internal_exr_undo_piz (
         outsz);
     if (rv != EXR_ERR_SUCCESS) return rv;
 
+    /* nothing else uses the second scratch buffer, so unless it is
+     * about to be allocated, the huffman spare bytes are as the last
+     * chunk left them */
+    scratch2Bytes = BITMAP_SIZE * sizeof (uint8_t) +
+                    USHORT_RANGE * sizeof (uint16_t) + hufSpareBytes;
+    reuseHufTables = decode->scratch_buffer_2 != NULL &&
+                     decode->scratch_alloc_size_2 >= scratch2Bytes;
+
     rv = internal_decode_alloc_buffer (
         decode,
         EXR_TRANSCODE_BUFFER_SCRATCH2,
         &(decode->scratch_buffer_2),
         &(decode->scratch_alloc_size_2),
-        BITMAP_SIZE * sizeof (uint8_t) + USHORT_RANGE * sizeof (uint16_t) +
-            hufSpareBytes);
+        scratch2Bytes);
     if (rv != EXR_ERR_SUCCESS) return rv;
 
     hufspare = decode->scratch_buffer_2;
     lut      = (uint16_t*) (hufspare + hufSpareBytes);
     bitmap   = (uint8_t*) (lut + USHORT_RANGE);
 
+    /* a new buffer is uninitialised, so holds no tables to re-use */
+    if (!reuseHufTables) internal_huf_decompress_clear_tables (hufspare);
+
     //
     // Read range compression data
     //
@@ -640,7 +775,8 @@ internal_exr_undo_piz (
         wavbuf,
         outsz / 2,
         hufspare,
-        hufSpareBytes);
+        hufSpareBytes,
+        reuseHufTables);
     if (rv != EXR_ERR_SUCCESS) return rv;
 
     //
@@ -663,14 +799,8 @@ internal_exr_undo_piz (
     }
 
     //
-    // Expand the pixel data to their original range
-    //
-
-    wavbuf = decode->scratch_buffer_1;
-    applyLut (lut, wavbuf, outsz / 2);
-
-    //
-    // Rearrange the pixel data into the format expected by the caller.
+    // Rearrange the pixel data into the format expected by the caller,
+    // expanding them to their original range.
     //
 
     for (int y = 0; y < decode->chunk.height; ++y)
@@ -700,8 +830,11 @@ internal_exr_undo_piz (
             else
                 tmp += ((uint64_t) y) * nBytes;
 
-            memcpy (out, tmp, nBytes);
-            priv_from_native16 (out, nx * (curc->bytes_per_element / 2));
+            applyLutCopy (
+                lut,
+                out,
+                (const uint16_t*) tmp,
+                (uint64_t) nx * (curc->bytes_per_element / 2));
             out += nBytes;
             nOut += nBytes;
         }
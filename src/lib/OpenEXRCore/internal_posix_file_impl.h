@@ -9,6 +9,7 @@
 #include <errno.h>
 
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -28,15 +29,27 @@
 #    define CAN_USE_PREAD 0
 #endif
 
+#if CAN_USE_PREAD && (defined(__linux__) || defined(__FreeBSD__) ||           \
+                      defined(__NetBSD__) || defined(__OpenBSD__))
+#    include <sys/uio.h>
+#    define CAN_USE_PREADV 1
+#else
+#    define CAN_USE_PREADV 0
+#endif
+
 #if CAN_USE_PREAD
 struct _internal_exr_filehandle
 {
-    int fd;
+    int      fd;
+    void*    map_base;
+    uint64_t map_size;
 };
 #else
 struct _internal_exr_filehandle
 {
-    int fd;
+    int      fd;
+    void*    map_base;
+    uint64_t map_size;
 #    ifdef ILMTHREAD_THREADING_ENABLED
     pthread_mutex_t mutex;
 #    endif
@@ -52,6 +65,9 @@ default_shutdown (exr_const_context_t c, void* userdata, int failed)
     struct _internal_exr_filehandle* fh = userdata;
     if (fh)
     {
+        if (fh->map_base) munmap (fh->map_base, (size_t) fh->map_size);
+        fh->map_base = NULL;
+        fh->map_size = 0;
         if (fh->fd >= 0) close (fh->fd);
 #if !CAN_USE_PREAD
 #    ifdef ILMTHREAD_THREADING_ENABLED
@@ -131,6 +147,16 @@ default_read_func (
         return retsz;
     }
 
+    if (fh->map_base)
+    {
+        /* file is mapped, no need to go to the kernel, just copy
+         * out of the mapping (short read at end of file) */
+        if (offset >= fh->map_size) return 0;
+        if (readsz > (fh->map_size - offset)) readsz = fh->map_size - offset;
+        memcpy (curbuf, ((const uint8_t*) fh->map_base) + offset, readsz);
+        return (int64_t) readsz;
+    }
+
     fd = fh->fd;
     if (fd < 0)
     {
@@ -209,6 +235,74 @@ default_read_func (
 
 /**************************************/
 
+#if CAN_USE_PREADV
+/* keep the stack usage reasonable, well below any IOV_MAX */
+#    define EXR_SCATTER_IOV_BATCH 64
+
+static int64_t
+default_read_scatter_func (
+    exr_const_context_t ctxt,
+    void*               userdata,
+    int                 nbufs,
+    void* const*        bufs,
+    const uint64_t*     sizes,
+    uint64_t            offset)
+{
+    struct _internal_exr_filehandle* fh = userdata;
+    struct iovec                     iov[EXR_SCATTER_IOV_BATCH];
+    int64_t                          retsz = 0;
+    uint64_t                         skip  = 0;
+    int                              cur   = 0;
+
+    (void) ctxt;
+    if (!fh || fh->fd < 0) return -1;
+
+    while (cur < nbufs)
+    {
+        ssize_t rv;
+        int     niov = 0;
+
+        for (int b = cur; b < nbufs && niov < EXR_SCATTER_IOV_BATCH; ++b)
+        {
+            uint64_t boff = (b == cur) ? skip : 0;
+
+            iov[niov].iov_base = ((uint8_t*) bufs[b]) + boff;
+            iov[niov].iov_len  = (size_t) (sizes[b] - boff);
+            ++niov;
+        }
+
+        rv = preadv (fh->fd, iov, niov, (off_t) offset);
+        if (rv < 0)
+        {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) continue;
+            return -1;
+        }
+        if (rv == 0) break;
+
+        retsz += rv;
+        offset += (uint64_t) rv;
+
+        /* step over what was filled, handling partial reads */
+        while (cur < nbufs)
+        {
+            uint64_t left = sizes[cur] - skip;
+            if ((uint64_t) rv < left)
+            {
+                skip += (uint64_t) rv;
+                break;
+            }
+            rv -= (ssize_t) left;
+            skip = 0;
+            ++cur;
+        }
+    }
+    return retsz;
+}
+#endif
+
+/**************************************/
+
 static int64_t
 default_write_func (
     exr_const_context_t         ctxt,
@@ -330,7 +424,9 @@ default_init_read_file (exr_context_t file)
     int                              fd;
     struct _internal_exr_filehandle* fh = file->user_data;
 
-    fh->fd = -1;
+    fh->fd       = -1;
+    fh->map_base = NULL;
+    fh->map_size = 0;
 #if !CAN_USE_PREAD
 #    ifdef ILMTHREAD_THREADING_ENABLED
     fd = pthread_mutex_init (&(fh->mutex), NULL);
@@ -345,6 +441,9 @@ default_init_read_file (exr_context_t file)
 
     file->destroy_fn = &default_shutdown;
     file->read_fn    = &default_read_func;
+#if CAN_USE_PREADV
+    file->read_scatter_fn = &default_read_scatter_func;
+#endif
 
     fd = open (file->filename.str, O_RDONLY | O_CLOEXEC);
     if (fd < 0)
@@ -355,6 +454,28 @@ default_init_read_file (exr_context_t file)
             strerror (errno));
 
     fh->fd = fd;
+
+    if (file->use_mmap)
+    {
+        struct stat sbuf;
+
+        /* any failure here just leaves us using the normal read path */
+        if (fstat (fd, &sbuf) == 0 && sbuf.st_size > 0 &&
+            (uint64_t) sbuf.st_size <= (uint64_t) SIZE_MAX)
+        {
+            void* mapped = mmap (
+                NULL, (size_t) sbuf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (mapped != MAP_FAILED)
+            {
+                fh->map_base      = mapped;
+                fh->map_size      = (uint64_t) sbuf.st_size;
+                file->mapped_data = (const uint8_t*) mapped;
+                file->mapped_size = fh->map_size;
+                /* plain copies out of the mapping are cheaper */
+                file->read_scatter_fn = NULL;
+            }
+        }
+    }
     return EXR_ERR_SUCCESS;
 }
 
@@ -381,6 +502,8 @@ default_init_write_file (exr_context_t file)
 #endif
 
     fh->fd           = -1;
+    fh->map_base     = NULL;
+    fh->map_size     = 0;
     file->destroy_fn = &default_shutdown;
     file->write_fn   = &default_write_func;
 
@@ -12,6 +12,15 @@
 #include <string.h>
 #include "openexr_compression.h"
 
+#if defined __SSE2__ || (_MSC_VER >= 1300 && (_M_IX86 || _M_X64))
+#    define IMF_HAVE_SSE2 1
+#    include <emmintrin.h>
+#endif
+#if defined(__aarch64__)
+#    define IMF_HAVE_NEON_AARCH64 1
+#    include <arm_neon.h>
+#endif
+
 /**************************************/
 
 static inline uint32_t
@@ -84,6 +93,404 @@ float_to_float24 (float f)
     return (s >> 8) | i;
 }
 
+/**************************************/
+/*
+ * The rows of each channel are stored as the differences between
+ * neighbouring pixels, split in to byte planes, most significant byte
+ * first. The vector loops below do 16 pixels at a time, leaving the
+ * rest of the row to the scalar loops, which carry on from the last
+ * pixel of the vector loop.
+ */
+
+#if defined(IMF_HAVE_SSE2)
+
+/* float_to_float24 without the branches, 4 at a time */
+static inline __m128i
+float_to_float24_sse2 (__m128i u)
+{
+    __m128i a, t, r, i, nan;
+
+    a = _mm_and_si128 (u, _mm_set1_epi32 (0x7fffffff));
+    t = _mm_srli_epi32 (a, 8);
+    r = _mm_and_si128 (a, _mm_set1_epi32 (0x80));
+    r = _mm_srli_epi32 (_mm_add_epi32 (a, r), 8);
+
+    /* truncate rather than round in to the exponent of infinity, which
+     * also leaves infinities and nans as they are (a < 2^31, so the
+     * signed compares are fine) */
+    i = _mm_cmpgt_epi32 (r, _mm_set1_epi32 (0x7f7fff));
+    i = _mm_or_si128 (_mm_and_si128 (i, t), _mm_andnot_si128 (i, r));
+
+    /* a nan which would turn in to an infinity keeps one bit set */
+    nan = _mm_and_si128 (
+        _mm_cmpgt_epi32 (a, _mm_set1_epi32 (0x7f800000)),
+        _mm_cmpeq_epi32 (t, _mm_set1_epi32 (0x7f8000)));
+    i = _mm_or_si128 (i, _mm_srli_epi32 (nan, 31));
+
+    return _mm_or_si128 (
+        i, _mm_and_si128 (_mm_srli_epi32 (u, 8), _mm_set1_epi32 (0x800000)));
+}
+
+/* the differences of the 4 values in p from their left neighbours,
+ * the one left of the first being the last of prev */
+static inline __m128i
+differences32_sse2 (__m128i p, __m128i prev)
+{
+    return _mm_sub_epi32 (
+        p, _mm_or_si128 (_mm_slli_si128 (p, 4), _mm_srli_si128 (prev, 12)));
+}
+
+/* byte shift / 8 of each of the 16 values in d */
+static inline __m128i
+byte_plane32_sse2 (const __m128i d[4], int shift)
+{
+    const __m128i mask = _mm_set1_epi32 (0xff);
+    const __m128i cnt  = _mm_cvtsi32_si128 (shift);
+    __m128i       lo, hi;
+
+    lo = _mm_packs_epi32 (
+        _mm_and_si128 (_mm_srl_epi32 (d[0], cnt), mask),
+        _mm_and_si128 (_mm_srl_epi32 (d[1], cnt), mask));
+    hi = _mm_packs_epi32 (
+        _mm_and_si128 (_mm_srl_epi32 (d[2], cnt), mask),
+        _mm_and_si128 (_mm_srl_epi32 (d[3], cnt), mask));
+    return _mm_packus_epi16 (lo, hi);
+}
+
+/* the running sum of the 4 differences in d, carrying on from the
+ * last of prev */
+static inline __m128i
+running_sum32_sse2 (__m128i d, __m128i prev)
+{
+    d = _mm_add_epi32 (d, _mm_slli_si128 (d, 4));
+    d = _mm_add_epi32 (d, _mm_slli_si128 (d, 8));
+    return _mm_add_epi32 (d, _mm_shuffle_epi32 (prev, 0xff));
+}
+
+/* the same for 8 16-bit differences */
+static inline __m128i
+running_sum16_sse2 (__m128i d, __m128i prev)
+{
+    d    = _mm_add_epi16 (d, _mm_slli_si128 (d, 2));
+    d    = _mm_add_epi16 (d, _mm_slli_si128 (d, 4));
+    d    = _mm_add_epi16 (d, _mm_slli_si128 (d, 8));
+    prev = _mm_shufflehi_epi16 (prev, 0xff);
+    return _mm_add_epi16 (d, _mm_unpackhi_epi64 (prev, prev));
+}
+
+/* rebuild 16 32-bit pixels from the byte planes b0 (most significant)
+ * to b3, storing them to out and returning the last 4 */
+static inline __m128i
+undo_planes32_sse2 (
+    uint8_t* out, __m128i b0, __m128i b1, __m128i b2, __m128i b3, __m128i prev)
+{
+    __m128i hi = _mm_unpacklo_epi8 (b1, b0);
+    __m128i lo = _mm_unpacklo_epi8 (b3, b2);
+
+    prev = running_sum32_sse2 (_mm_unpacklo_epi16 (lo, hi), prev);
+    _mm_storeu_si128 ((__m128i*) out, prev);
+    prev = running_sum32_sse2 (_mm_unpackhi_epi16 (lo, hi), prev);
+    _mm_storeu_si128 ((__m128i*) (out + 16), prev);
+
+    hi = _mm_unpackhi_epi8 (b1, b0);
+    lo = _mm_unpackhi_epi8 (b3, b2);
+
+    prev = running_sum32_sse2 (_mm_unpacklo_epi16 (lo, hi), prev);
+    _mm_storeu_si128 ((__m128i*) (out + 32), prev);
+    prev = running_sum32_sse2 (_mm_unpackhi_epi16 (lo, hi), prev);
+    _mm_storeu_si128 ((__m128i*) (out + 48), prev);
+    return prev;
+}
+
+#elif defined(IMF_HAVE_NEON_AARCH64)
+
+static inline uint32x4_t
+float_to_float24_neon (uint32x4_t u)
+{
+    uint32x4_t a, t, r, i, nan;
+
+    a = vandq_u32 (u, vdupq_n_u32 (0x7fffffff));
+    t = vshrq_n_u32 (a, 8);
+    r = vandq_u32 (a, vdupq_n_u32 (0x80));
+    r = vshrq_n_u32 (vaddq_u32 (a, r), 8);
+
+    i = vbslq_u32 (vcgtq_u32 (r, vdupq_n_u32 (0x7f7fff)), t, r);
+
+    nan = vandq_u32 (
+        vcgtq_u32 (a, vdupq_n_u32 (0x7f800000)),
+        vceqq_u32 (t, vdupq_n_u32 (0x7f8000)));
+    i = vorrq_u32 (i, vshrq_n_u32 (nan, 31));
+
+    return vorrq_u32 (
+        i, vandq_u32 (vshrq_n_u32 (u, 8), vdupq_n_u32 (0x800000)));
+}
+
+static inline uint32x4_t
+load32_neon (const uint8_t* in)
+{
+    return vreinterpretq_u32_u8 (vld1q_u8 (in));
+}
+
+static inline uint8x16_t
+byte_plane32_neon (const uint32x4_t d[4], int shift)
+{
+    const int32x4_t cnt = vdupq_n_s32 (-shift);
+    uint16x8_t      lo, hi;
+
+    lo = vcombine_u16 (
+        vmovn_u32 (vshlq_u32 (d[0], cnt)), vmovn_u32 (vshlq_u32 (d[1], cnt)));
+    hi = vcombine_u16 (
+        vmovn_u32 (vshlq_u32 (d[2], cnt)), vmovn_u32 (vshlq_u32 (d[3], cnt)));
+    return vcombine_u8 (vmovn_u16 (lo), vmovn_u16 (hi));
+}
+
+static inline uint32x4_t
+running_sum32_neon (uint32x4_t d, uint32x4_t prev)
+{
+    const uint32x4_t zero = vdupq_n_u32 (0);
+
+    d = vaddq_u32 (d, vextq_u32 (zero, d, 3));
+    d = vaddq_u32 (d, vextq_u32 (zero, d, 2));
+    return vaddq_u32 (d, vdupq_laneq_u32 (prev, 3));
+}
+
+static inline uint16x8_t
+running_sum16_neon (uint16x8_t d, uint16x8_t prev)
+{
+    const uint16x8_t zero = vdupq_n_u16 (0);
+
+    d = vaddq_u16 (d, vextq_u16 (zero, d, 7));
+    d = vaddq_u16 (d, vextq_u16 (zero, d, 6));
+    d = vaddq_u16 (d, vextq_u16 (zero, d, 4));
+    return vaddq_u16 (d, vdupq_laneq_u16 (prev, 7));
+}
+
+static inline uint32x4_t
+undo_planes32_neon (
+    uint8_t*   out,
+    uint8x16_t b0,
+    uint8x16_t b1,
+    uint8x16_t b2,
+    uint8x16_t b3,
+    uint32x4_t prev)
+{
+    uint8x16x2_t hi = vzipq_u8 (b1, b0);
+    uint8x16x2_t lo = vzipq_u8 (b3, b2);
+    uint16x8x2_t px;
+
+    for (int k = 0; k < 2; ++k)
+    {
+        px = vzipq_u16 (
+            vreinterpretq_u16_u8 (lo.val[k]), vreinterpretq_u16_u8 (hi.val[k]));
+        prev = running_sum32_neon (vreinterpretq_u32_u16 (px.val[0]), prev);
+        vst1q_u8 (out, vreinterpretq_u8_u32 (prev));
+        prev = running_sum32_neon (vreinterpretq_u32_u16 (px.val[1]), prev);
+        vst1q_u8 (out + 16, vreinterpretq_u8_u32 (prev));
+        out += 32;
+    }
+    return prev;
+}
+
+#endif
+
+static void
+apply_pxr24_uint (const uint8_t* in, int w, uint8_t* out)
+{
+    uint32_t prevPixel = 0;
+    int      x         = 0;
+
+#if defined(IMF_HAVE_SSE2)
+    __m128i prev = _mm_setzero_si128 ();
+
+    for (; x + 16 <= w; x += 16)
+    {
+        __m128i p[4], d[4];
+
+        for (int k = 0; k < 4; ++k)
+            p[k] = _mm_loadu_si128 ((const __m128i*) (in + 4 * x + 16 * k));
+
+        d[0] = differences32_sse2 (p[0], prev);
+        d[1] = differences32_sse2 (p[1], p[0]);
+        d[2] = differences32_sse2 (p[2], p[1]);
+        d[3] = differences32_sse2 (p[3], p[2]);
+        prev = p[3];
+
+        _mm_storeu_si128 ((__m128i*) (out + x), byte_plane32_sse2 (d, 24));
+        _mm_storeu_si128 ((__m128i*) (out + w + x), byte_plane32_sse2 (d, 16));
+        _mm_storeu_si128 (
+            (__m128i*) (out + 2 * w + x), byte_plane32_sse2 (d, 8));
+        _mm_storeu_si128 (
+            (__m128i*) (out + 3 * w + x), byte_plane32_sse2 (d, 0));
+    }
+    prevPixel = (uint32_t) _mm_cvtsi128_si32 (_mm_shuffle_epi32 (prev, 0xff));
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    uint32x4_t prev = vdupq_n_u32 (0);
+
+    for (; x + 16 <= w; x += 16)
+    {
+        uint32x4_t p[4], d[4];
+
+        for (int k = 0; k < 4; ++k)
+            p[k] = load32_neon (in + 4 * x + 16 * k);
+
+        d[0] = vsubq_u32 (p[0], vextq_u32 (prev, p[0], 3));
+        d[1] = vsubq_u32 (p[1], vextq_u32 (p[0], p[1], 3));
+        d[2] = vsubq_u32 (p[2], vextq_u32 (p[1], p[2], 3));
+        d[3] = vsubq_u32 (p[3], vextq_u32 (p[2], p[3], 3));
+        prev = p[3];
+
+        vst1q_u8 (out + x, byte_plane32_neon (d, 24));
+        vst1q_u8 (out + w + x, byte_plane32_neon (d, 16));
+        vst1q_u8 (out + 2 * w + x, byte_plane32_neon (d, 8));
+        vst1q_u8 (out + 3 * w + x, byte_plane32_neon (d, 0));
+    }
+    prevPixel = vgetq_lane_u32 (prev, 3);
+#endif
+
+    for (; x < w; ++x)
+    {
+        uint32_t pixel = unaligned_load32 (in + 4 * x);
+        uint32_t diff  = pixel - prevPixel;
+        prevPixel      = pixel;
+
+        out[x]         = (uint8_t) (diff >> 24);
+        out[w + x]     = (uint8_t) (diff >> 16);
+        out[2 * w + x] = (uint8_t) (diff >> 8);
+        out[3 * w + x] = (uint8_t) (diff);
+    }
+}
+
+static void
+apply_pxr24_half (const uint8_t* in, int w, uint8_t* out)
+{
+    uint32_t prevPixel = 0;
+    int      x         = 0;
+
+#if defined(IMF_HAVE_SSE2)
+    const __m128i mask = _mm_set1_epi16 (0xff);
+    __m128i       prev = _mm_setzero_si128 ();
+
+    for (; x + 16 <= w; x += 16)
+    {
+        __m128i p0 = _mm_loadu_si128 ((const __m128i*) (in + 2 * x));
+        __m128i p1 = _mm_loadu_si128 ((const __m128i*) (in + 2 * x + 16));
+        __m128i d0, d1;
+
+        d0 = _mm_or_si128 (_mm_slli_si128 (p0, 2), _mm_srli_si128 (prev, 14));
+        d0 = _mm_sub_epi16 (p0, d0);
+        d1 = _mm_or_si128 (_mm_slli_si128 (p1, 2), _mm_srli_si128 (p0, 14));
+        d1 = _mm_sub_epi16 (p1, d1);
+        prev = p1;
+
+        _mm_storeu_si128 (
+            (__m128i*) (out + x),
+            _mm_packus_epi16 (_mm_srli_epi16 (d0, 8), _mm_srli_epi16 (d1, 8)));
+        _mm_storeu_si128 (
+            (__m128i*) (out + w + x),
+            _mm_packus_epi16 (
+                _mm_and_si128 (d0, mask), _mm_and_si128 (d1, mask)));
+    }
+    prevPixel = (uint32_t) _mm_extract_epi16 (prev, 7);
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    uint16x8_t prev = vdupq_n_u16 (0);
+
+    for (; x + 16 <= w; x += 16)
+    {
+        uint16x8_t p0 = vreinterpretq_u16_u8 (vld1q_u8 (in + 2 * x));
+        uint16x8_t p1 = vreinterpretq_u16_u8 (vld1q_u8 (in + 2 * x + 16));
+        uint16x8_t d0 = vsubq_u16 (p0, vextq_u16 (prev, p0, 7));
+        uint16x8_t d1 = vsubq_u16 (p1, vextq_u16 (p0, p1, 7));
+        prev          = p1;
+
+        vst1q_u8 (
+            out + x, vcombine_u8 (vshrn_n_u16 (d0, 8), vshrn_n_u16 (d1, 8)));
+        vst1q_u8 (out + w + x, vcombine_u8 (vmovn_u16 (d0), vmovn_u16 (d1)));
+    }
+    prevPixel = vgetq_lane_u16 (prev, 7);
+#endif
+
+    for (; x < w; ++x)
+    {
+        uint32_t pixel = (uint32_t) unaligned_load16 (in + 2 * x);
+        uint32_t diff  = pixel - prevPixel;
+        prevPixel      = pixel;
+
+        out[x]     = (uint8_t) (diff >> 8);
+        out[w + x] = (uint8_t) (diff);
+    }
+}
+
+static void
+apply_pxr24_float (const uint8_t* in, int w, uint8_t* out)
+{
+    uint32_t prevPixel = 0;
+    int      x         = 0;
+
+#if defined(IMF_HAVE_SSE2)
+    __m128i prev = _mm_setzero_si128 ();
+
+    for (; x + 16 <= w; x += 16)
+    {
+        __m128i p[4], d[4];
+
+        for (int k = 0; k < 4; ++k)
+            p[k] = float_to_float24_sse2 (
+                _mm_loadu_si128 ((const __m128i*) (in + 4 * x + 16 * k)));
+
+        d[0] = differences32_sse2 (p[0], prev);
+        d[1] = differences32_sse2 (p[1], p[0]);
+        d[2] = differences32_sse2 (p[2], p[1]);
+        d[3] = differences32_sse2 (p[3], p[2]);
+        prev = p[3];
+
+        _mm_storeu_si128 ((__m128i*) (out + x), byte_plane32_sse2 (d, 16));
+        _mm_storeu_si128 ((__m128i*) (out + w + x), byte_plane32_sse2 (d, 8));
+        _mm_storeu_si128 (
+            (__m128i*) (out + 2 * w + x), byte_plane32_sse2 (d, 0));
+    }
+    prevPixel = (uint32_t) _mm_cvtsi128_si32 (_mm_shuffle_epi32 (prev, 0xff));
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    uint32x4_t prev = vdupq_n_u32 (0);
+
+    for (; x + 16 <= w; x += 16)
+    {
+        uint32x4_t p[4], d[4];
+
+        for (int k = 0; k < 4; ++k)
+            p[k] = float_to_float24_neon (load32_neon (in + 4 * x + 16 * k));
+
+        d[0] = vsubq_u32 (p[0], vextq_u32 (prev, p[0], 3));
+        d[1] = vsubq_u32 (p[1], vextq_u32 (p[0], p[1], 3));
+        d[2] = vsubq_u32 (p[2], vextq_u32 (p[1], p[2], 3));
+        d[3] = vsubq_u32 (p[3], vextq_u32 (p[2], p[3], 3));
+        prev = p[3];
+
+        vst1q_u8 (out + x, byte_plane32_neon (d, 16));
+        vst1q_u8 (out + w + x, byte_plane32_neon (d, 8));
+        vst1q_u8 (out + 2 * w + x, byte_plane32_neon (d, 0));
+    }
+    prevPixel = vgetq_lane_u32 (prev, 3);
+#endif
+
+    for (; x < w; ++x)
+    {
+        union
+        {
+            uint32_t i;
+            float    f;
+        } v;
+        uint32_t pixel24, diff;
+        v.i       = unaligned_load32 (in + 4 * x);
+        pixel24   = float_to_float24 (v.f);
+        diff      = pixel24 - prevPixel;
+        prevPixel = pixel24;
+
+        out[x]         = (uint8_t) (diff >> 16);
+        out[w + x]     = (uint8_t) (diff >> 8);
+        out[2 * w + x] = (uint8_t) (diff);
+    }
+}
+
 /**************************************/
 
 static exr_result_t
@@ -111,106 +518,33 @@ apply_pxr24_impl (exr_encode_pipeline_t* encode)
 
             switch (curc->data_type)
             {
-                case EXR_PIXEL_UINT: {
-                    uint8_t*        ptr[4];
-                    uint32_t        prevPixel = 0;
-                    const uint32_t* din       = (const uint32_t*) (lastIn);
-
+                case EXR_PIXEL_UINT:
                     nBytes *= sizeof (uint32_t);
                     if (nOut + nBytes > encode->scratch_alloc_size_1)
                         return EXR_ERR_OUT_OF_MEMORY;
+                    apply_pxr24_uint (lastIn, w, out);
                     nOut += nBytes;
                     lastIn += nBytes;
-
-                    ptr[0] = out;
-                    out += w;
-                    ptr[1] = out;
-                    out += w;
-                    ptr[2] = out;
-                    out += w;
-                    ptr[3] = out;
-                    out += w;
-
-                    for (int x = 0; x < w; ++x)
-                    {
-                        uint32_t pixel = unaligned_load32 (din);
-                        uint32_t diff  = pixel - prevPixel;
-                        prevPixel      = pixel;
-
-                        ++din;
-                        *(ptr[0]++) = (uint8_t) (diff >> 24);
-                        *(ptr[1]++) = (uint8_t) (diff >> 16);
-                        *(ptr[2]++) = (uint8_t) (diff >> 8);
-                        *(ptr[3]++) = (uint8_t) (diff);
-                    }
+                    out += nBytes;
                     break;
-                }
-                case EXR_PIXEL_HALF: {
-                    uint8_t*        ptr[2];
-                    uint32_t        prevPixel = 0;
-                    const uint16_t* din       = (const uint16_t*) (lastIn);
-
+                case EXR_PIXEL_HALF:
                     nBytes *= sizeof (uint16_t);
                     if (nOut + nBytes > encode->scratch_alloc_size_1)
                         return EXR_ERR_OUT_OF_MEMORY;
+                    apply_pxr24_half (lastIn, w, out);
                     nOut += nBytes;
                     lastIn += nBytes;
-
-                    ptr[0] = out;
-                    out += w;
-                    ptr[1] = out;
-                    out += w;
-
-                    for (int x = 0; x < w; ++x)
-                    {
-                        uint32_t pixel = (uint32_t) unaligned_load16 (din);
-                        uint32_t diff  = pixel - prevPixel;
-                        prevPixel      = pixel;
-
-                        ++din;
-                        *(ptr[0]++) = (uint8_t) (diff >> 8);
-                        *(ptr[1]++) = (uint8_t) (diff);
-                    }
+                    out += nBytes;
                     break;
-                }
-                case EXR_PIXEL_FLOAT: {
-                    uint8_t*     ptr[3];
-                    uint32_t     prevPixel = 0;
-                    const float* din       = (const float*) (lastIn);
-
+                case EXR_PIXEL_FLOAT:
                     nBytes *= 3;
                     if (nOut + nBytes > encode->scratch_alloc_size_1)
                         return EXR_ERR_OUT_OF_MEMORY;
+                    apply_pxr24_float (lastIn, w, out);
                     nOut += nBytes;
                     lastIn += w * 4;
-
-                    ptr[0] = out;
-                    out += w;
-                    ptr[1] = out;
-                    out += w;
-                    ptr[2] = out;
-                    out += w;
-
-                    for (int x = 0; x < w; ++x)
-                    {
-                        union
-                        {
-                            uint32_t i;
-                            float    f;
-                        } v;
-                        uint32_t pixel24, diff;
-                        v.i       = unaligned_load32 (din);
-                        pixel24   = float_to_float24 (v.f);
-                        diff      = pixel24 - prevPixel;
-                        prevPixel = pixel24;
-
-                        ++din;
-                        *(ptr[0]++) = (uint8_t) (diff >> 16);
-                        *(ptr[1]++) = (uint8_t) (diff >> 8);
-                        *(ptr[2]++) = (uint8_t) (diff);
-                    }
+                    out += nBytes;
                     break;
-                }
                 default: return EXR_ERR_INVALID_ARGUMENT;
             }
         }
@@ -257,6 +591,142 @@ internal_exr_apply_pxr24 (exr_encode_pipeline_t* encode)
 
 /**************************************/
 
+static void
+undo_pxr24_uint (const uint8_t* in, int w, uint8_t* out)
+{
+    uint32_t pixel = 0;
+    int      x     = 0;
+
+#if defined(IMF_HAVE_SSE2)
+    __m128i prev = _mm_setzero_si128 ();
+
+    for (; x + 16 <= w; x += 16)
+    {
+        prev = undo_planes32_sse2 (
+            out + 4 * x,
+            _mm_loadu_si128 ((const __m128i*) (in + x)),
+            _mm_loadu_si128 ((const __m128i*) (in + w + x)),
+            _mm_loadu_si128 ((const __m128i*) (in + 2 * w + x)),
+            _mm_loadu_si128 ((const __m128i*) (in + 3 * w + x)),
+            prev);
+    }
+    pixel = (uint32_t) _mm_cvtsi128_si32 (_mm_shuffle_epi32 (prev, 0xff));
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    uint32x4_t prev = vdupq_n_u32 (0);
+
+    for (; x + 16 <= w; x += 16)
+    {
+        prev = undo_planes32_neon (
+            out + 4 * x,
+            vld1q_u8 (in + x),
+            vld1q_u8 (in + w + x),
+            vld1q_u8 (in + 2 * w + x),
+            vld1q_u8 (in + 3 * w + x),
+            prev);
+    }
+    pixel = vgetq_lane_u32 (prev, 3);
+#endif
+
+    for (; x < w; ++x)
+    {
+        uint32_t diff =
+            (((uint32_t) (in[x]) << 24) | ((uint32_t) (in[w + x]) << 16) |
+             ((uint32_t) (in[2 * w + x]) << 8) | ((uint32_t) (in[3 * w + x])));
+        pixel += diff;
+        unaligned_store32 (out + 4 * x, pixel);
+    }
+}
+
+static void
+undo_pxr24_half (const uint8_t* in, int w, uint8_t* out)
+{
+    uint32_t pixel = 0;
+    int      x     = 0;
+
+#if defined(IMF_HAVE_SSE2)
+    __m128i prev = _mm_setzero_si128 ();
+
+    for (; x + 16 <= w; x += 16)
+    {
+        __m128i b0 = _mm_loadu_si128 ((const __m128i*) (in + x));
+        __m128i b1 = _mm_loadu_si128 ((const __m128i*) (in + w + x));
+
+        prev = running_sum16_sse2 (_mm_unpacklo_epi8 (b1, b0), prev);
+        _mm_storeu_si128 ((__m128i*) (out + 2 * x), prev);
+        prev = running_sum16_sse2 (_mm_unpackhi_epi8 (b1, b0), prev);
+        _mm_storeu_si128 ((__m128i*) (out + 2 * x + 16), prev);
+    }
+    pixel = (uint32_t) _mm_extract_epi16 (prev, 7);
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    uint16x8_t prev = vdupq_n_u16 (0);
+
+    for (; x + 16 <= w; x += 16)
+    {
+        uint8x16x2_t px = vzipq_u8 (vld1q_u8 (in + w + x), vld1q_u8 (in + x));
+
+        prev = running_sum16_neon (vreinterpretq_u16_u8 (px.val[0]), prev);
+        vst1q_u8 (out + 2 * x, vreinterpretq_u8_u16 (prev));
+        prev = running_sum16_neon (vreinterpretq_u16_u8 (px.val[1]), prev);
+        vst1q_u8 (out + 2 * x + 16, vreinterpretq_u8_u16 (prev));
+    }
+    pixel = vgetq_lane_u16 (prev, 7);
+#endif
+
+    for (; x < w; ++x)
+    {
+        uint32_t diff =
+            (((uint32_t) (in[x]) << 8) | ((uint32_t) (in[w + x])));
+        pixel += diff;
+        unaligned_store16 (out + 2 * x, (uint16_t) pixel);
+    }
+}
+
+static void
+undo_pxr24_float (const uint8_t* in, int w, uint8_t* out)
+{
+    uint32_t pixel = 0;
+    int      x     = 0;
+
+#if defined(IMF_HAVE_SSE2)
+    __m128i prev = _mm_setzero_si128 ();
+
+    for (; x + 16 <= w; x += 16)
+    {
+        prev = undo_planes32_sse2 (
+            out + 4 * x,
+            _mm_loadu_si128 ((const __m128i*) (in + x)),
+            _mm_loadu_si128 ((const __m128i*) (in + w + x)),
+            _mm_loadu_si128 ((const __m128i*) (in + 2 * w + x)),
+            _mm_setzero_si128 (),
+            prev);
+    }
+    pixel = (uint32_t) _mm_cvtsi128_si32 (_mm_shuffle_epi32 (prev, 0xff));
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    uint32x4_t prev = vdupq_n_u32 (0);
+
+    for (; x + 16 <= w; x += 16)
+    {
+        prev = undo_planes32_neon (
+            out + 4 * x,
+            vld1q_u8 (in + x),
+            vld1q_u8 (in + w + x),
+            vld1q_u8 (in + 2 * w + x),
+            vdupq_n_u8 (0),
+            prev);
+    }
+    pixel = vgetq_lane_u32 (prev, 3);
+#endif
+
+    for (; x < w; ++x)
+    {
+        uint32_t diff =
+            (((uint32_t) (in[x]) << 24) | ((uint32_t) (in[w + x]) << 16) |
+             ((uint32_t) (in[2 * w + x]) << 8));
+        pixel += diff;
+        unaligned_store32 (out + 4 * x, pixel);
+    }
+}
+
 static exr_result_t
 undo_pxr24_impl (
     exr_decode_pipeline_t* decode,
@@ -305,88 +775,25 @@ undo_pxr24_impl (
 
             switch (curc->data_type)
             {
-                case EXR_PIXEL_UINT: {
-                    const uint8_t* ptr[4];
-                    uint32_t       pixel = 0;
-                    uint32_t*      dout  = (uint32_t*) (out);
-
-                    ptr[0] = lastIn;
-                    lastIn += w;
-                    ptr[1] = lastIn;
-                    lastIn += w;
-                    ptr[2] = lastIn;
-                    lastIn += w;
-                    ptr[3] = lastIn;
-                    lastIn += w;
-
+                case EXR_PIXEL_UINT:
                     if (nDec + nBytes > outSize) return EXR_ERR_CORRUPT_CHUNK;
-
-                    for (int x = 0; x < w; ++x)
-                    {
-                        uint32_t diff =
-                            (((uint32_t) (*(ptr[0]++)) << 24) |
-                             ((uint32_t) (*(ptr[1]++)) << 16) |
-                             ((uint32_t) (*(ptr[2]++)) << 8) |
-                             ((uint32_t) (*(ptr[3]++))));
-                        pixel += diff;
-                        unaligned_store32 (dout, pixel);
-                        ++dout;
-                    }
+                    undo_pxr24_uint (lastIn, w, out);
+                    lastIn += 4 * w;
                     nDec += nBytes;
                     break;
-                }
-                case EXR_PIXEL_HALF: {
-                    const uint8_t* ptr[2];
-                    uint32_t       pixel = 0;
-                    uint16_t*      dout  = (uint16_t*) (out);
-
-                    ptr[0] = lastIn;
-                    lastIn += w;
-                    ptr[1] = lastIn;
-                    lastIn += w;
-
+                case EXR_PIXEL_HALF:
                     if (nDec + nBytes > outSize) return EXR_ERR_CORRUPT_CHUNK;
-
-                    for (int x = 0; x < w; ++x)
-                    {
-                        uint32_t diff =
-                            (((uint32_t) (*(ptr[0]++)) << 8) |
-                             ((uint32_t) (*(ptr[1]++))));
-                        pixel += diff;
-                        unaligned_store16 (dout, (uint16_t) pixel);
-                        ++dout;
-                    }
+                    undo_pxr24_half (lastIn, w, out);
+                    lastIn += 2 * w;
                     nDec += nBytes;
                     break;
-                }
-                case EXR_PIXEL_FLOAT: {
-                    const uint8_t* ptr[3];
-                    uint32_t       pixel = 0;
-                    uint32_t*      dout  = (uint32_t*) (out);
-
-                    ptr[0] = lastIn;
-                    lastIn += w;
-                    ptr[1] = lastIn;
-                    lastIn += w;
-                    ptr[2] = lastIn;
-                    lastIn += w;
-
+                case EXR_PIXEL_FLOAT:
                     if (nDec + (uint64_t) (w * 3) > outSize)
                         return EXR_ERR_CORRUPT_CHUNK;
-
-                    for (int x = 0; x < w; ++x)
-                    {
-                        uint32_t diff =
-                            (((uint32_t) (*(ptr[0]++)) << 24) |
-                             ((uint32_t) (*(ptr[1]++)) << 16) |
-                             ((uint32_t) (*(ptr[2]++)) << 8));
-                        pixel += diff;
-                        unaligned_store32 (dout, pixel);
-                        ++dout;
-                    }
+                    undo_pxr24_float (lastIn, w, out);
+                    lastIn += 3 * w;
                     nDec += (uint64_t) (w * 3);
                     break;
-                }
                 default: return EXR_ERR_INVALID_ARGUMENT;
             }
             out += nBytes;
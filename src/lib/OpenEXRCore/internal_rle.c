@@ -8,55 +8,133 @@
 
 #include "internal_coding.h"
 
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 
+#if defined __SSE2__ || (_MSC_VER >= 1300 && (_M_IX86 || _M_X64))
+#    define IMF_HAVE_SSE2 1
+#    include <emmintrin.h>
+#endif
+#if defined(__aarch64__)
+#    define IMF_HAVE_NEON_AARCH64 1
+#    include <arm_neon.h>
+#endif
+
 #define MIN_RUN_LENGTH 3
 #define MAX_RUN_LENGTH 127
 
+/**************************************/
+
+/*
+ * The vector loops below only decide whether a block of 16 bytes is
+ * entirely uninteresting and can be skipped, leaving the exact
+ * position to the scalar loop, so the packets produced are the same
+ * on every architecture.
+ */
+
+/* first byte in [p, stop) not equal to v, or stop */
+static inline const uint8_t*
+scan_run (const uint8_t* p, const uint8_t* stop, uint8_t v)
+{
+#if defined(IMF_HAVE_SSE2)
+    const __m128i vv = _mm_set1_epi8 ((char) v);
+
+    while (stop - p >= (ptrdiff_t) sizeof (__m128i))
+    {
+        __m128i eq = _mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i*) p), vv);
+        if (_mm_movemask_epi8 (eq) != 0xffff) break;
+        p += sizeof (__m128i);
+    }
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    const uint8x16_t vv = vdupq_n_u8 (v);
+
+    while (stop - p >= (ptrdiff_t) sizeof (uint8x16_t))
+    {
+        if (vminvq_u8 (vceqq_u8 (vld1q_u8 (p), vv)) != 0xff) break;
+        p += sizeof (uint8x16_t);
+    }
+#endif
+    while (p < stop && *p == v)
+        ++p;
+    return p;
+}
+
+/* first position in [p, stop) starting 3 equal bytes which all lie
+ * before end, or stop */
+static inline const uint8_t*
+scan_literal (const uint8_t* p, const uint8_t* stop, const uint8_t* end)
+{
+#if defined(IMF_HAVE_SSE2)
+    while (p < stop && end - p >= (ptrdiff_t) (sizeof (__m128i) + 2))
+    {
+        __m128i a = _mm_loadu_si128 ((const __m128i*) p);
+        __m128i b = _mm_loadu_si128 ((const __m128i*) (p + 1));
+        __m128i c = _mm_loadu_si128 ((const __m128i*) (p + 2));
+        __m128i eq =
+            _mm_and_si128 (_mm_cmpeq_epi8 (a, b), _mm_cmpeq_epi8 (b, c));
+        if (_mm_movemask_epi8 (eq) != 0) break;
+        p += sizeof (__m128i);
+    }
+#elif defined(IMF_HAVE_NEON_AARCH64)
+    while (p < stop && end - p >= (ptrdiff_t) (sizeof (uint8x16_t) + 2))
+    {
+        uint8x16_t a = vld1q_u8 (p);
+        uint8x16_t b = vld1q_u8 (p + 1);
+        uint8x16_t c = vld1q_u8 (p + 2);
+        if (vmaxvq_u8 (vandq_u8 (vceqq_u8 (a, b), vceqq_u8 (b, c))) != 0)
+            break;
+        p += sizeof (uint8x16_t);
+    }
+#endif
+    if (p > stop) p = stop;
+    while (p < stop && (end - p < 3 || p[0] != p[1] || p[1] != p[2]))
+        ++p;
+    return p;
+}
+
 uint64_t
 internal_rle_compress (
     void* out, uint64_t outbytes, const void* src, uint64_t srcbytes)
 {
-    int8_t*       cbuf = out;
-    const int8_t* runs = src;
-    const int8_t* end  = runs + srcbytes;
-    const int8_t* rune = runs + 1;
-    uint64_t      outb = 0;
+    int8_t*        cbuf = out;
+    const uint8_t* runs = src;
+    const uint8_t* end  = runs + srcbytes;
+    const uint8_t* rune;
+    const uint8_t* stop;
+    uint64_t       outb = 0;
 
     while (runs < end)
     {
-        uint8_t curcount = 0;
-        while (rune < end && *runs == *rune && curcount < MAX_RUN_LENGTH)
-        {
-            ++rune;
-            ++curcount;
-        }
+        uint64_t curcount;
+
+        /* a run covers the byte and up to MAX_RUN_LENGTH repeats */
+        stop = (end - runs > MAX_RUN_LENGTH + 1) ? runs + MAX_RUN_LENGTH + 1
+                                                 : end;
+
+        rune     = scan_run (runs + 1, stop, *runs);
+        curcount = (uint64_t) (rune - runs) - 1;
 
         if (curcount >= (MIN_RUN_LENGTH - 1))
         {
             cbuf[outb++] = (int8_t) curcount;
-            cbuf[outb++] = *runs;
+            cbuf[outb++] = (int8_t) *runs;
 
             runs = rune;
         }
         else
         {
-            /* incompressible */
-            ++curcount;
-            while (rune < end &&
-                   ((rune + 1 >= end || *rune != *(rune + 1)) ||
-                    (rune + 2 >= end || *(rune + 1) != *(rune + 2))) &&
-                   curcount < MAX_RUN_LENGTH)
-            {
-                ++curcount;
-                ++rune;
-            }
+            /* incompressible, up to the start of the next run */
+            stop = (end - runs > MAX_RUN_LENGTH) ? runs + MAX_RUN_LENGTH : end;
+
+            rune     = scan_literal (rune, stop, end);
+            curcount = (uint64_t) (rune - runs);
+
             cbuf[outb++] = (int8_t) (-((int) curcount));
-            while (runs < rune)
-                cbuf[outb++] = *runs++;
+            memcpy (cbuf + outb, runs, curcount);
+            outb += curcount;
+            runs = rune;
         }
-        ++rune;
         if (outb >= outbytes) break;
     }
     return outb;
@@ -64,32 +142,6 @@ internal_rle_compress (
 
 /**************************************/
 
-static void
-reorder_and_predict (void* scratch, const void* packed, uint64_t packedbytes)
-{
-    int8_t*       t1   = scratch;
-    int8_t*       t2   = t1 + (packedbytes + 1) / 2;
-    const int8_t* in   = packed;
-    const int8_t* stop = in + packedbytes;
-    int           d, p;
-
-    while (in < stop)
-    {
-        *(t1++) = *(in++);
-        if (in < stop) *(t2++) = *(in++);
-    }
-
-    t1   = scratch;
-    stop = t1 + packedbytes;
-    p    = *(t1++);
-    while (t1 < stop)
-    {
-        d     = (int) (*t1) - p + (128 + 256);
-        p     = *t1;
-        *t1++ = (int8_t) (d);
-    }
-}
-
 exr_result_t
 internal_exr_apply_rle (exr_encode_pipeline_t* encode)
 {
@@ -106,7 +158,9 @@ internal_exr_apply_rle (exr_encode_pipeline_t* encode)
         srcb);
     if (rv != EXR_ERR_SUCCESS) return rv;
 
-    reorder_and_predict (encode->scratch_buffer_1, encode->packed_buffer, srcb);
+    /* same byte reorder and predictor as zip */
+    internal_zip_deconstruct_bytes (
+        encode->scratch_buffer_1, encode->packed_buffer, srcb);
 
     outb = internal_rle_compress (
         encode->compressed_buffer,
@@ -167,31 +221,6 @@ internal_rle_decompress (
     return outbytes;
 }
 
-static void
-unpredict_and_reorder (void* out, void* scratch, uint64_t packedbytes)
-{
-    int8_t*       t1   = scratch;
-    int8_t*       t2   = t1 + (packedbytes + 1) / 2;
-    int8_t*       s    = out;
-    const int8_t* stop = t1 + packedbytes;
-
-    ++t1;
-    while (t1 < stop)
-    {
-        int d = (int) (t1[-1]) + (int) (t1[0]) - 128;
-        t1[0] = (int8_t) d;
-        ++t1;
-    }
-
-    t1   = scratch;
-    stop = s + packedbytes;
-    while (s < stop)
-    {
-        *(s++) = *(t1++);
-        if (s < stop) *(s++) = *(t2++);
-    }
-}
-
 exr_result_t
 internal_exr_undo_rle (
     exr_decode_pipeline_t* decode,
@@ -214,6 +243,6 @@ internal_exr_undo_rle (
         internal_rle_decompress (decode->scratch_buffer_1, outsz, src, packsz);
     if (unpackb != outsz) return EXR_ERR_CORRUPT_CHUNK;
 
-    unpredict_and_reorder (out, decode->scratch_buffer_1, outsz);
+    internal_zip_reconstruct_bytes (out, decode->scratch_buffer_1, outsz);
     return EXR_ERR_SUCCESS;
 }
@@ -395,6 +395,16 @@ internal_exr_alloc_context (
              EXR_CONTEXT_FLAG_DISABLE_CHUNK_RECONSTRUCTION);
         ret->legacy_header =
             (initializers->flags & EXR_CONTEXT_FLAG_WRITE_LEGACY_HEADER);
+        ret->use_mmap =
+            (mode == EXR_CONTEXT_READ &&
+             (initializers->flags & EXR_CONTEXT_FLAG_USE_MMAP))
+                ? 1
+                : 0;
+        ret->unordered_write =
+            (mode == EXR_CONTEXT_WRITE &&
+             (initializers->flags & EXR_CONTEXT_FLAG_WRITE_UNORDERED_CHUNKS))
+                ? 1
+                : 0;
 
         ret->file_size       = -1;
         ret->max_name_length = EXR_SHORTNAME_MAXLEN;
@@ -417,6 +427,20 @@ internal_exr_alloc_context (
         }
 #    endif
 #endif
+        rv = internal_exr_init_codec_pool (&(ret->codec_pool));
+        if (rv != EXR_ERR_SUCCESS)
+        {
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+            DeleteCriticalSection (&(ret->mutex));
+#    else
+            pthread_mutex_destroy (&(ret->mutex));
+#    endif
+#endif
+            (initializers->free_fn) (memptr);
+            *out = NULL;
+            return rv;
+        }
 
         *out = ret;
         rv   = EXR_ERR_SUCCESS;
@@ -456,10 +480,12 @@ internal_exr_destroy_context (exr_context_t ctxt)
 {
     exr_memory_free_func_t dofree = ctxt->free_fn;
 
+    internal_exr_destroy_decode_pool (ctxt);
     exr_attr_string_destroy (ctxt, &(ctxt->filename));
     exr_attr_string_destroy (ctxt, &(ctxt->tmp_filename));
     exr_attr_list_destroy (ctxt, &(ctxt->custom_handlers));
     internal_exr_destroy_parts (ctxt);
+    internal_exr_destroy_codec_pool (ctxt);
 #ifdef ILMTHREAD_THREADING_ENABLED
 #    ifdef _WIN32
     DeleteCriticalSection (&(ctxt->mutex));
@@ -114,11 +114,55 @@ struct _priv_exr_part_t
     int32_t          chunk_count;
     uint64_t         chunk_table_offset;
     atomic_uintptr_t chunk_table;
+
+    /* when writing, parts may be written interleaved, so each part
+     * tracks its own progress */
+    int32_t last_output_chunk;
+    int32_t output_chunk_count;
 };
 
 typedef struct _priv_exr_part_t*       exr_priv_part_t;
 typedef const struct _priv_exr_part_t* exr_const_priv_part_t;
 
+/* number of compressor / decompressor objects of each kind kept
+ * around for re-use, see compression.c */
+#define EXR_CODEC_POOL_SIZE 16
+/* the same for the process wide pool used without a context, which
+ * lives as long as the library, so keeps fewer */
+#define EXR_GLOBAL_CODEC_POOL_SIZE 4
+
+enum _INTERNAL_EXR_CODEC_POOL_KIND
+{
+    EXR_POOL_DEFLATE_COMPRESSOR   = 0,
+    EXR_POOL_DEFLATE_DECOMPRESSOR = 1,
+    EXR_POOL_ZSTD_COMPRESSOR      = 2,
+    EXR_POOL_ZSTD_DECOMPRESSOR    = 3,
+    EXR_POOL_KIND_COUNT
+};
+
+struct _internal_exr_codec_pool
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    SRWLOCK lock;
+#    else
+    pthread_mutex_t lock;
+#    endif
+#endif
+    /* one list per kind, least recently released first */
+    struct
+    {
+        struct
+        {
+            void*   obj;
+            int64_t key; /* i.e. compression level */
+        } entries[EXR_CODEC_POOL_SIZE];
+        int count;
+    } kinds[EXR_POOL_KIND_COUNT];
+    uint64_t hits;
+    uint64_t misses;
+};
+
 enum _INTERNAL_EXR_READ_MODE
 {
     EXR_MUST_READ_ALL    = 0,
@@ -188,12 +232,25 @@ struct _priv_exr_context_t
     int64_t             file_size;
     exr_read_func_ptr_t read_fn;
 
+    /* when the default reader has mapped the file, a read-only view
+     * of the entire file, otherwise NULL */
+    const uint8_t* mapped_data;
+    uint64_t       mapped_size;
+
+    /* when available from the default reader, fills the buffers in
+     * order from consecutive bytes of the file in one request */
+    int64_t (*read_scatter_fn) (
+        exr_const_context_t ctxt,
+        void*               userdata,
+        int                 nbufs,
+        void* const*        bufs,
+        const uint64_t*     sizes,
+        uint64_t            offset);
+
     exr_write_func_ptr_t write_fn;
     /* used when writing under a mutex, is there a better way? */
     uint64_t output_file_offset;
-    int      cur_output_part;
-    int      last_output_chunk;
-    int      output_chunk_count;
+    int      output_parts_done;
 
     /** all files have at least one part */
     int num_parts;
@@ -214,9 +271,14 @@ struct _priv_exr_context_t
     pthread_mutex_t mutex;
 #    endif
 #endif
+    struct _internal_exr_codec_pool codec_pool;
+    /* threads for exr_decoding_submit, see decoding_async.c */
+    struct _internal_exr_decode_pool* decode_pool;
+
     uint8_t disable_chunk_reconstruct;
     uint8_t legacy_header;
-    uint8_t _pad[2];
+    uint8_t use_mmap;
+    uint8_t unordered_write;
     uint32_t orig_version_and_flags;
 };
 
@@ -323,4 +385,26 @@ exr_result_t internal_exr_alloc_context (
     size_t                           extra_data);
 void internal_exr_destroy_context (exr_context_t ctxt);
 
+/* implemented in compression.c */
+exr_result_t
+internal_exr_init_codec_pool (struct _internal_exr_codec_pool* pool);
+void internal_exr_destroy_codec_pool (exr_context_t ctxt);
+
+/* take a previously used object of the kind / key out of the pool of
+ * the context (or the global pool when ctxt is NULL), returns NULL if
+ * the caller needs to create a new one */
+void*
+internal_exr_pool_acquire (exr_const_context_t ctxt, int kind, int64_t key);
+/* hand an object back for re-use, when the list for the kind is full
+ * the least recently released object is freed to make room */
+void internal_exr_pool_release (
+    exr_const_context_t ctxt, int kind, int64_t key, void* obj);
+
+/* implemented in decoding_async.c, stops the threads started for
+ * asynchronous decodes, if any */
+void internal_exr_destroy_decode_pool (exr_context_t ctxt);
+
+/* implemented in internal_zstd.c */
+void internal_exr_free_zstd_context (void* obj);
+
 #endif /* OPENEXR_PRIVATE_STRUCTS_H */
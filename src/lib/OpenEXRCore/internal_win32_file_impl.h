@@ -7,6 +7,7 @@
 
 #include <fileapi.h>
 #include <inttypes.h>
+#include <string.h>
 #include <strsafe.h>
 #include <windows.h>
 
@@ -95,7 +96,10 @@ widen_filename (exr_context_t file, const char* fn)
 
 struct _internal_exr_filehandle
 {
-    HANDLE fd;
+    HANDLE   fd;
+    HANDLE   map_handle;
+    void*    map_base;
+    uint64_t map_size;
 };
 
 /**************************************/
@@ -107,6 +111,11 @@ default_shutdown (exr_const_context_t c, void* userdata, int failed)
     struct _internal_exr_filehandle* fh = userdata;
     if (fh)
     {
+        if (fh->map_base) UnmapViewOfFile (fh->map_base);
+        if (fh->map_handle) CloseHandle (fh->map_handle);
+        fh->map_base   = NULL;
+        fh->map_handle = NULL;
+        fh->map_size   = 0;
         if (fh->fd != INVALID_HANDLE_VALUE) CloseHandle (fh->fd);
         fh->fd = INVALID_HANDLE_VALUE;
     }
@@ -178,6 +187,16 @@ default_read_func (
         return retsz;
     }
 
+    if (fh->map_base)
+    {
+        /* file is mapped, just copy out of the view (short read at
+         * end of file) */
+        if (offset >= fh->map_size) return 0;
+        if (sz > (fh->map_size - offset)) sz = fh->map_size - offset;
+        memcpy (buffer, ((const uint8_t*) fh->map_base) + offset, sz);
+        return (int64_t) sz;
+    }
+
     fd = fh->fd;
     if (fd == INVALID_HANDLE_VALUE)
     {
@@ -295,6 +314,9 @@ default_init_read_file (exr_context_t file)
     struct _internal_exr_filehandle* fh = file->user_data;
 
     fh->fd           = INVALID_HANDLE_VALUE;
+    fh->map_handle   = NULL;
+    fh->map_base     = NULL;
+    fh->map_size     = 0;
     file->destroy_fn = &default_shutdown;
     file->read_fn    = &default_read_func;
 
@@ -326,6 +348,35 @@ default_init_read_file (exr_context_t file)
 
     fh->fd = fd;
 
+    if (file->use_mmap)
+    {
+        LARGE_INTEGER lint;
+
+        /* any failure here just leaves us using the normal read path */
+        if (GetFileSizeEx (fd, &lint) && lint.QuadPart > 0 &&
+            (uint64_t) lint.QuadPart <= (uint64_t) SIZE_MAX)
+        {
+            fh->map_handle =
+                CreateFileMappingW (fd, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (fh->map_handle)
+            {
+                fh->map_base =
+                    MapViewOfFile (fh->map_handle, FILE_MAP_READ, 0, 0, 0);
+                if (fh->map_base)
+                {
+                    fh->map_size      = (uint64_t) lint.QuadPart;
+                    file->mapped_data = (const uint8_t*) fh->map_base;
+                    file->mapped_size = fh->map_size;
+                }
+                else
+                {
+                    CloseHandle (fh->map_handle);
+                    fh->map_handle = NULL;
+                }
+            }
+        }
+    }
+
     return EXR_ERR_SUCCESS;
 }
 
@@ -342,6 +393,9 @@ default_init_write_file (exr_context_t file)
     if (outfn == NULL) outfn = file->filename.str;
 
     fh->fd           = INVALID_HANDLE_VALUE;
+    fh->map_handle   = NULL;
+    fh->map_base     = NULL;
+    fh->map_size     = 0;
     file->destroy_fn = &default_shutdown;
     file->write_fn   = &default_write_func;
 
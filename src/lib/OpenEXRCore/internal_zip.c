@@ -10,6 +10,7 @@
 #include "internal_structs.h"
 
 #include <limits.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -20,10 +21,6 @@
 #    include <emmintrin.h>
 #    include <mmintrin.h>
 #endif
-#if defined __SSE4_1__
-#    define IMF_HAVE_SSE4_1 1
-#    include <smmintrin.h>
-#endif
 #if defined(__aarch64__)
 #    define IMF_HAVE_NEON_AARCH64 1
 #    include <arm_neon.h>
@@ -31,14 +28,13 @@
 
 /**************************************/
 
-#ifdef IMF_HAVE_SSE4_1
+#ifdef IMF_HAVE_SSE2
 static void
 reconstruct (uint8_t* buf, uint64_t outSize)
 {
     static const uint64_t bytesPerChunk = sizeof (__m128i);
     const uint64_t        vOutSize      = outSize / bytesPerChunk;
     const __m128i         c             = _mm_set1_epi8 (-128);
-    const __m128i         shuffleMask   = _mm_set1_epi8 (15);
     __m128i *             vBuf, vPrev;
     uint8_t               prev;
 
@@ -65,11 +61,14 @@ reconstruct (uint8_t* buf, uint64_t outSize)
         _mm_storeu_si128 (vBuf++, d);
 
         // Broadcast the high byte in our result to all lanes of the prev
-        // value for the next iteration.
-        vPrev = _mm_shuffle_epi8 (d, shuffleMask);
+        // value for the next iteration (without the sse4.1 / ssse3
+        // byte shuffles, so this is available to every x86_64 build).
+        vPrev = _mm_unpackhi_epi8 (d, d);
+        vPrev = _mm_shufflehi_epi16 (vPrev, 0xff);
+        vPrev = _mm_unpackhi_epi64 (vPrev, vPrev);
     }
 
-    prev = _mm_extract_epi8 (vPrev, 15);
+    prev = (uint8_t) _mm_cvtsi128_si32 (vPrev);
     for (uint64_t i = vOutSize * bytesPerChunk; i < outSize; ++i)
     {
         uint8_t d = prev + buf[i] - 128;
@@ -239,28 +238,140 @@ internal_zip_reconstruct_bytes (uint8_t* out, uint8_t* source, uint64_t count)
 
 /**************************************/
 
-void
-internal_zip_deconstruct_bytes (
-    uint8_t* scratch, const uint8_t* source, uint64_t count)
+#ifdef IMF_HAVE_SSE2
+static void
+deinterleave (uint8_t* scratch, const uint8_t* source, uint64_t count)
+{
+    static const uint64_t bytesPerChunk = 2 * sizeof (__m128i);
+    const uint64_t        vCount        = count / bytesPerChunk;
+    const __m128i         lowMask       = _mm_set1_epi16 (0xff);
+    __m128i*              v1            = (__m128i*) scratch;
+    __m128i*              v2   = (__m128i*) (scratch + (count + 1) / 2);
+    const __m128i*        vIn  = (const __m128i*) source;
+    uint8_t *             t1, *t2;
+
+    for (uint64_t i = 0; i < vCount; ++i)
+    {
+        __m128i a = _mm_loadu_si128 (vIn++);
+        __m128i b = _mm_loadu_si128 (vIn++);
+
+        /* even bytes are the low half of each 16 bit lane, odd the high */
+        _mm_storeu_si128 (
+            v1++,
+            _mm_packus_epi16 (
+                _mm_and_si128 (a, lowMask), _mm_and_si128 (b, lowMask)));
+        _mm_storeu_si128 (
+            v2++,
+            _mm_packus_epi16 (_mm_srli_epi16 (a, 8), _mm_srli_epi16 (b, 8)));
+    }
+
+    t1     = (uint8_t*) v1;
+    t2     = (uint8_t*) v2;
+    source = (const uint8_t*) vIn;
+
+    for (uint64_t i = vCount * bytesPerChunk; i < count; ++i)
+        *((i % 2 == 0) ? t1++ : t2++) = *(source++);
+}
+
+static void
+predict (uint8_t* buf, uint64_t count)
+{
+    const __m128i c = _mm_set1_epi8 (-128);
+    uint8_t*      t = buf + count;
+
+    /*
+     * Go back to front, so the previous byte of each lane is still the
+     * original value when it is loaded.
+     */
+    while (t - buf > (ptrdiff_t) sizeof (__m128i))
+    {
+        __m128i cur, prev;
+
+        t -= sizeof (__m128i);
+        cur  = _mm_loadu_si128 ((const __m128i*) t);
+        prev = _mm_loadu_si128 ((const __m128i*) (t - 1));
+        _mm_storeu_si128 (
+            (__m128i*) t, _mm_add_epi8 (_mm_sub_epi8 (cur, prev), c));
+    }
+
+    while (t - buf > 1)
+    {
+        --t;
+        t[0] = (uint8_t) ((int) (t[0]) - (int) (t[-1]) + (128 + 256));
+    }
+}
+
+#elif defined(IMF_HAVE_NEON_AARCH64)
+static void
+deinterleave (uint8_t* scratch, const uint8_t* source, uint64_t count)
+{
+    static const uint64_t bytesPerChunk = 2 * sizeof (uint8x16_t);
+    const uint64_t        vCount        = count / bytesPerChunk;
+    uint8_t*              t1            = scratch;
+    uint8_t*              t2            = scratch + (count + 1) / 2;
+
+    for (uint64_t i = 0; i < vCount; ++i)
+    {
+        uint8x16x2_t ab = vld2q_u8 (source);
+        source += bytesPerChunk;
+
+        vst1q_u8 (t1, ab.val[0]);
+        t1 += sizeof (uint8x16_t);
+        vst1q_u8 (t2, ab.val[1]);
+        t2 += sizeof (uint8x16_t);
+    }
+
+    for (uint64_t i = vCount * bytesPerChunk; i < count; ++i)
+        *((i % 2 == 0) ? t1++ : t2++) = *(source++);
+}
+
+static void
+predict (uint8_t* buf, uint64_t count)
+{
+    const uint8x16_t c = vdupq_n_u8 (128);
+    uint8_t*         t = buf + count;
+
+    /*
+     * Go back to front, so the previous byte of each lane is still the
+     * original value when it is loaded.
+     */
+    while (t - buf > (ptrdiff_t) sizeof (uint8x16_t))
+    {
+        t -= sizeof (uint8x16_t);
+        vst1q_u8 (t, vaddq_u8 (vsubq_u8 (vld1q_u8 (t), vld1q_u8 (t - 1)), c));
+    }
+
+    while (t - buf > 1)
+    {
+        --t;
+        t[0] = (uint8_t) ((int) (t[0]) - (int) (t[-1]) + (128 + 256));
+    }
+}
+
+#else
+
+static void
+deinterleave (uint8_t* scratch, const uint8_t* source, uint64_t count)
 {
-    int            p;
     uint8_t*       t1   = scratch;
     uint8_t*       t2   = t1 + (count + 1) / 2;
     const uint8_t* raw  = source;
     const uint8_t* stop = raw + count;
 
-    /* reorder */
     while (raw < stop)
     {
         *(t1++) = *(raw++);
         if (raw < stop) *(t2++) = *(raw++);
     }
+}
+
+static void
+predict (uint8_t* buf, uint64_t count)
+{
+    uint8_t* t1 = buf + 1;
+    uint8_t* t2 = buf + count;
+    int      p  = (int) buf[0];
 
-    /* reorder */
-    t1 = scratch;
-    t2 = t1 + count;
-    t1++;
-    p = (int) t1[-1];
     while (t1 < t2)
     {
         int d = (int) (t1[0]) - p + (128 + 256);
@@ -270,6 +381,18 @@ internal_zip_deconstruct_bytes (
     }
 }
 
+#endif
+
+void
+internal_zip_deconstruct_bytes (
+    uint8_t* scratch, const uint8_t* source, uint64_t count)
+{
+    if (count == 0) return;
+
+    deinterleave (scratch, source, count);
+    predict (scratch, count);
+}
+
 /**************************************/
 
 static exr_result_t
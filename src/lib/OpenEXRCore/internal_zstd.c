@@ -6,67 +6,211 @@
 #include <openexr_compression.h>
 #include "internal_compress.h"
 #include "internal_decompress.h"
+#include "internal_structs.h"
 #include "blosc2.h"
 
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
 size_t
 exr_get_zstd_lines_per_chunk ()
 {
     return 1;
 }
 
-long
-exr_compress_zstd (char* inPtr, int inSize, void* outPtr, int outPtrSize)
+/**************************************/
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+static INIT_ONCE zstd_init_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK
+zstd_init_fn (PINIT_ONCE once, PVOID param, PVOID* context)
 {
-    if (inSize == 0) // Weird input data when subsampling
+    (void) once;
+    (void) param;
+    (void) context;
+    blosc2_init ();
+    return TRUE;
+}
+#    else
+static pthread_once_t zstd_init_once = PTHREAD_ONCE_INIT;
+
+static void
+zstd_init_fn (void)
+{
+    blosc2_init ();
+}
+#    endif
+#endif
+
+/* the super-chunk (frame) functions of blosc2 only work once the
+ * library has been initialized */
+static void
+zstd_init (void)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    InitOnceExecuteOnce (&zstd_init_once, &zstd_init_fn, NULL, NULL);
+#    else
+    pthread_once (&zstd_init_once, &zstd_init_fn);
+#    endif
+#else
+    static int initialized = 0;
+    if (!initialized)
     {
-        outPtr = NULL;
-        return 0;
+        blosc2_init ();
+        initialized = 1;
     }
+#endif
+}
+
+void
+internal_exr_free_zstd_context (void* obj)
+{
+    blosc2_free_ctx ((blosc2_context*) obj);
+}
+
+static int
+zstd_typesize (int inSize)
+{
+    return inSize % 4 == 0 ? 4 : 2;
+}
 
+/* the layout every release reads: the chunk is wrapped in a
+ * serialized blosc2 super-chunk (a frame) */
+static long
+zstd_compress_frame (
+    const char* inPtr, int inSize, void* outPtr, int outPtrSize)
+{
     blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
-    int typeSize     = inSize % 4 == 0 ? 4 : 2;
-    cparams.typesize = typeSize;
-    // clevel 9 is about a 20% increase in compression compared to 5.
-    // Decompression speed is unchanged.
-    int zstd_level;
+    blosc2_storage storage = BLOSC2_STORAGE_DEFAULTS;
+    blosc2_schunk* _schunk;
+    uint8_t*       buffer;
+    bool           shouldFree = true;
+    int            zstd_level;
+    int64_t        size;
+
+    if (inSize == 0) // Weird input data when subsampling
+        return 0;
+
+    zstd_init ();
+
     exr_get_default_zstd_compression_level (&zstd_level);
+    cparams.typesize = zstd_typesize (inSize);
     cparams.clevel   = zstd_level;
     cparams.nthreads = 1;
     cparams.compcode = BLOSC_ZSTD; // Codec
     cparams.splitmode =
         BLOSC_NEVER_SPLIT; // Split => multithreading, not split better compression
 
-    blosc2_storage storage = BLOSC2_STORAGE_DEFAULTS;
-    storage.contiguous     = true;
-    storage.cparams        = &cparams;
+    storage.contiguous = true;
+    storage.cparams    = &cparams;
 
-    blosc2_schunk* _schunk = blosc2_schunk_new (&storage);
+    _schunk = blosc2_schunk_new (&storage);
+    if (!_schunk) return -1;
 
-    blosc2_schunk_append_buffer (_schunk, inPtr, inSize);
-
-    uint8_t* buffer;
-    bool     shouldFree = true;
-    int64_t  size = blosc2_schunk_to_buffer (_schunk, &buffer, &shouldFree);
+    if (blosc2_schunk_append_buffer (_schunk, inPtr, inSize) < 0)
+    {
+        blosc2_schunk_free (_schunk);
+        return -1;
+    }
+    size = blosc2_schunk_to_buffer (_schunk, &buffer, &shouldFree);
 
     if (size <= inSize && size <= outPtrSize && size > 0)
-    { memcpy (outPtr, buffer, size); }
-    else
+    { memcpy (outPtr, buffer, (size_t) size); }
+    if (shouldFree && size > 0) { free (buffer); }
+
+    if (size > inSize || size > outPtrSize || size <= 0)
     {
-        memcpy (outPtr, inPtr, inSize);
-        size = inSize; // We increased compression size
+        size = -1;
+        if (inSize <= outPtrSize)
+        {
+            memcpy (outPtr, inPtr, (size_t) inSize);
+            size = inSize; // We increased compression size
+        }
     }
 
-    if (shouldFree) { free (buffer); }
-
     blosc2_schunk_free (_schunk);
+    return (long) size;
+}
+
+/* a bare blosc2 chunk, only written to parts with more than one
+ * scanline per chunk, which released readers cannot read anyway */
+static long
+zstd_compress_chunk (
+    exr_const_context_t ctxt,
+    const char*         inPtr,
+    int                 inSize,
+    void*               outPtr,
+    int                 outPtrSize)
+{
+    blosc2_context* cctx;
+    int             zstd_level, typesize, size;
+    int64_t         key;
+
+    if (inSize == 0) // Weird input data when subsampling
+        return 0;
+
+    // clevel 9 is about a 20% increase in compression compared to 5.
+    // Decompression speed is unchanged.
+    exr_get_default_zstd_compression_level (&zstd_level);
+    typesize = zstd_typesize (inSize);
+    /* blosc2 carries the block size chosen for one buffer over to the
+     * next call on the same context, so only hand back a context that
+     * last saw a buffer of the same size, which keeps the output
+     * identical to that of a fresh context */
+    key = ((int64_t) inSize << 16) | ((zstd_level & 0xff) << 8) | typesize;
+
+    cctx = internal_exr_pool_acquire (ctxt, EXR_POOL_ZSTD_COMPRESSOR, key);
+    if (!cctx)
+    {
+        blosc2_cparams cparams = BLOSC2_CPARAMS_DEFAULTS;
+        cparams.typesize       = typesize;
+        cparams.clevel         = zstd_level;
+        cparams.nthreads       = 1;
+        cparams.compcode       = BLOSC_ZSTD; // Codec
+        cparams.splitmode =
+            BLOSC_NEVER_SPLIT; // Split => multithreading, not split better compression
+
+        cctx = blosc2_create_cctx (cparams);
+        if (!cctx) return -1;
+    }
+
+    /* compress straight into the output, anything not smaller than
+     * the input is stored raw, which the decoder detects by size */
+    size = blosc2_compress_ctx (
+        cctx, inPtr, inSize, outPtr, outPtrSize < inSize ? outPtrSize : inSize);
+
+    internal_exr_pool_release (ctxt, EXR_POOL_ZSTD_COMPRESSOR, key, cctx);
+
+    if (size <= 0 || size >= inSize)
+    {
+        if (inSize > outPtrSize) return -1;
+        memcpy (outPtr, inPtr, (size_t) inSize);
+        size = inSize;
+    }
     return size;
 }
 
-long
-exr_uncompress_zstd (
+/* files written before the codec was reworked hold a serialized
+ * blosc2 super-chunk (a frame) instead of a bare chunk, those start
+ * with a msgpack string "b2frame" */
+static int
+is_blosc2_frame (const uint8_t* data, uint64_t size)
+{
+    return size > 9 && memcmp (data + 2, "b2frame", 7) == 0;
+}
+
+static long
+zstd_uncompress_frame (
     const char* inPtr, uint64_t inSize, void** outPtr, uint64_t outPtrSize)
 {
-    blosc2_schunk* _schunk = blosc2_schunk_from_buffer ((uint8_t *)inPtr, inSize, true);
+    blosc2_schunk* _schunk;
+
+    zstd_init ();
+    _schunk = blosc2_schunk_from_buffer ((uint8_t*) inPtr, inSize, true);
 
     if (_schunk == NULL) { return -1; }
 
@@ -76,23 +220,110 @@ exr_uncompress_zstd (
         outPtrSize = _schunk->nbytes;
     }
 
-    int size = blosc2_schunk_decompress_chunk (_schunk, 0, *outPtr, outPtrSize);
+    int size = blosc2_schunk_decompress_chunk (
+        _schunk, 0, *outPtr, (int32_t) outPtrSize);
     blosc2_schunk_free (_schunk);
 
     return size;
 }
 
+static long
+zstd_uncompress (
+    exr_const_context_t ctxt,
+    const char*         inPtr,
+    uint64_t            inSize,
+    void**              outPtr,
+    uint64_t            outPtrSize)
+{
+    blosc2_context* dctx;
+    int32_t         nbytes;
+    int             size;
+
+    if (inSize < BLOSC_MIN_HEADER_LENGTH || inSize > (uint64_t) INT_MAX)
+        return -1;
+    if (is_blosc2_frame ((const uint8_t*) inPtr, inSize))
+        return zstd_uncompress_frame (inPtr, inSize, outPtr, outPtrSize);
+
+    if (blosc2_cbuffer_sizes (inPtr, &nbytes, NULL, NULL) < 0) return -1;
+
+    if (outPtrSize == 0) // we don't have any storage allocated
+    {
+        *outPtr    = malloc ((size_t) nbytes);
+        outPtrSize = (uint64_t) nbytes;
+        if (!*outPtr) return -1;
+    }
+    if (outPtrSize > (uint64_t) INT_MAX) outPtrSize = (uint64_t) INT_MAX;
+
+    dctx = internal_exr_pool_acquire (ctxt, EXR_POOL_ZSTD_DECOMPRESSOR, 0);
+    if (!dctx)
+    {
+        blosc2_dparams dparams = BLOSC2_DPARAMS_DEFAULTS;
+        dparams.nthreads       = 1;
+
+        dctx = blosc2_create_dctx (dparams);
+        if (!dctx) return -1;
+    }
+
+    size = blosc2_decompress_ctx (
+        dctx, inPtr, (int32_t) inSize, *outPtr, (int32_t) outPtrSize);
+
+    internal_exr_pool_release (ctxt, EXR_POOL_ZSTD_DECOMPRESSOR, 0, dctx);
+    return size;
+}
+
+/**************************************/
+
+long
+exr_compress_zstd (char* inPtr, int inSize, void* outPtr, int outPtrSize)
+{
+    return zstd_compress_frame (inPtr, inSize, outPtr, outPtrSize);
+}
+
+long
+exr_compress_zstd_chunk (char* inPtr, int inSize, void* outPtr, int outPtrSize)
+{
+    return zstd_compress_chunk (NULL, inPtr, inSize, outPtr, outPtrSize);
+}
+
+long
+exr_uncompress_zstd (
+    const char* inPtr, uint64_t inSize, void** outPtr, uint64_t outPtrSize)
+{
+    return zstd_uncompress (NULL, inPtr, inSize, outPtr, outPtrSize);
+}
+
 exr_result_t
 internal_exr_apply_zstd (exr_encode_pipeline_t* encode)
 {
-    long compressedSize = exr_compress_zstd (
-        encode->packed_buffer,
-        encode->packed_bytes,
-        encode->compressed_buffer,
-        encode->compressed_alloc_size);
+    exr_const_priv_part_t part;
+    long                  compressedSize;
+    int                   outSize;
+
+    if (encode->packed_bytes > (uint64_t) INT_MAX)
+        return EXR_ERR_ARGUMENT_OUT_OF_RANGE;
+
+    part    = encode->context->parts[encode->part_index];
+    outSize = encode->compressed_alloc_size > (size_t) INT_MAX
+                  ? INT_MAX
+                  : (int) encode->compressed_alloc_size;
+
+    /* bare chunks only for parts that opted in to taller chunks */
+    if (!part->tiles && part->lines_per_chunk > 1)
+        compressedSize = zstd_compress_chunk (
+            encode->context,
+            encode->packed_buffer,
+            (int) encode->packed_bytes,
+            encode->compressed_buffer,
+            outSize);
+    else
+        compressedSize = zstd_compress_frame (
+            encode->packed_buffer,
+            (int) encode->packed_bytes,
+            encode->compressed_buffer,
+            outSize);
     if (compressedSize < 0) { return EXR_ERR_UNKNOWN; }
 
-    encode->compressed_bytes = compressedSize;
+    encode->compressed_bytes = (uint64_t) compressedSize;
     return EXR_ERR_SUCCESS;
 }
 
@@ -104,12 +335,16 @@ internal_exr_undo_zstd (
     void*                  uncompressed_data,
     uint64_t               uncompressed_size)
 {
-
-    long uncompressedSize = exr_uncompress_zstd (
+    long uncompressedSize = zstd_uncompress (
+        decode->context,
         (const char*) compressed_data,
         comp_buf_size,
         &uncompressed_data,
         uncompressed_size);
-    if (uncompressed_size != uncompressedSize) { return EXR_ERR_CORRUPT_CHUNK; }
+    if (uncompressedSize < 0 ||
+        uncompressed_size != (uint64_t) uncompressedSize)
+    {
+        return EXR_ERR_CORRUPT_CHUNK;
+    }
     return EXR_ERR_SUCCESS;
-}
\ No newline at end of file
+}
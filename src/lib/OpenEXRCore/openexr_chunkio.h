@@ -67,6 +67,38 @@ exr_result_t exr_read_tile_chunk_info (
     int                 levely,
     exr_chunk_info_t*   cinfo);
 
+/** Query the chunk block info of every chunk in a part at once.
+ *
+ * This fills in the chunk block info for all the chunks of the part
+ * using just the chunk offset table, without reading any of the chunk
+ * leaders, so the I/O for a whole part can be planned up front.
+ *
+ * As the leaders are not read, the sizes are inferred from the
+ * offsets: the data offset is just past the leader, and the packed
+ * size is the distance from there to the chunk which follows in the
+ * file (across all the parts), or the end of the file, limited to the
+ * unpacked size. For files written in one go that is the exact size,
+ * but the leader is only validated when the chunk is read, either with
+ * exr_read_scanline_chunk_info() / exr_read_tile_chunk_info() (giving
+ * the chunk start_y, or tile and level from the index), or their
+ * _with_info() counterparts. Use the infos returned by those for
+ * decoding.
+ *
+ * For deep parts, the packed size covers the sample count table and
+ * the packed data together, and the unpacked size is 0.
+ *
+ * If @p cinfos is `NULL`, this only fills in @p count with the number
+ * of chunks in the part. Otherwise @p count gives the number of
+ * entries in @p cinfos, which must be at least the number of chunks,
+ * indexed by the chunk index.
+ */
+EXR_EXPORT
+exr_result_t exr_get_chunk_index (
+    exr_const_context_t ctxt,
+    int                 part_index,
+    int32_t*            count,
+    exr_chunk_info_t*   cinfos);
+
 /** Read the packed data block for a chunk.
  *
  * This assumes that the buffer pointed to by @p packed_data is
@@ -79,6 +111,71 @@ exr_result_t exr_read_chunk (
     const exr_chunk_info_t* cinfo,
     void*                   packed_data);
 
+/** Read the packed data blocks for a list of chunks at once.
+ *
+ * This is equivalent to calling exr_read_chunk() for each entry in
+ * @p cinfos, filling the matching buffer in @p packed_data, but
+ * chunks which are (nearly) adjacent in the file are merged into a
+ * single read request. When using the default file routines, the
+ * merged request is issued as one vectored read where the platform
+ * supports it, avoiding the cost of many small reads on high latency
+ * file systems.
+ */
+EXR_EXPORT
+exr_result_t exr_read_chunks (
+    exr_const_context_t     ctxt,
+    int                     part_index,
+    int                     count,
+    const exr_chunk_info_t* cinfos,
+    void* const*            packed_data);
+
+/** Read the chunk block info and the packed data of the scanline
+ * chunk containing @p y together.
+ *
+ * This is equivalent to exr_read_scanline_chunk_info() followed by
+ * exr_read_chunk(), but the chunk leader and the packed data are read
+ * with a single request when possible, halving the number of round
+ * trips on high latency file systems. The size of the packed data is
+ * estimated from the offset of the chunk next to it in the file, and
+ * read speculatively along with the leader. Should that estimate be
+ * short (i.e. the chunks were not written in order), the rest is read
+ * with a second request.
+ *
+ * The buffer pointed to by @p packed_data of @p packed_alloc_size
+ * bytes must be large enough to hold the packed data of the chunk,
+ * which the size returned by exr_get_chunk_unpacked_size() always
+ * is. The buffer may be written past the packed size of the chunk.
+ * Unless the default file routines are used, the leader is read in to
+ * the start of the buffer along with the packed data, so needs the
+ * room for that (at most 24 bytes) as well to avoid a second read.
+ *
+ * Deep data is not supported.
+ */
+EXR_EXPORT
+exr_result_t exr_read_scanline_chunk_with_info (
+    exr_const_context_t ctxt,
+    int                 part_index,
+    int                 y,
+    exr_chunk_info_t*   cinfo,
+    void*               packed_data,
+    uint64_t            packed_alloc_size);
+
+/** Read the chunk block info and the packed data of a tile together.
+ *
+ * This is the tiled equivalent of exr_read_scanline_chunk_with_info().
+ */
+EXR_EXPORT
+exr_result_t exr_read_tile_chunk_with_info (
+    exr_const_context_t ctxt,
+    int                 part_index,
+    int                 tilex,
+    int                 tiley,
+    int                 levelx,
+    int                 levely,
+    exr_chunk_info_t*   cinfo,
+    void*               packed_data,
+    uint64_t            packed_alloc_size);
+
 /**
  * Read chunk for deep data.
  *
@@ -121,6 +218,13 @@ exr_result_t exr_write_tile_chunk_info (
 
 /**
  * @p y must the appropriate starting y for the specified chunk.
+ *
+ * The chunks of the different parts of a multi-part file may be
+ * written interleaved, in any order of parts. Within a part, the
+ * chunks must be written in the order of the part's line order,
+ * unless that is \c EXR_LINEORDER_RANDOM_Y or the context was
+ * created with \c EXR_CONTEXT_FLAG_WRITE_UNORDERED_CHUNKS. This
+ * applies to all the chunk writing functions.
  */
 EXR_EXPORT
 exr_result_t exr_write_scanline_chunk (
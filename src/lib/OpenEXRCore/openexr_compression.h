@@ -45,16 +45,53 @@ exr_result_t exr_uncompress_buffer (
     size_t              out_bytes_avail,
     size_t*             actual_out);
 
+/** Retrieve how often the zip (i.e. exr_compress_buffer() and
+ * exr_uncompress_buffer()) and zstd codecs were able to re-use a
+ * previously allocated compressor or decompressor object instead of
+ * allocating a new one.
+ *
+ * These objects are cached per context, or in a smaller process wide
+ * cache when no context is provided (as is done by the C++ library),
+ * which is what is queried when @p ctxt is `NULL`. The objects in the
+ * process wide cache are freed when the library is unloaded.
+ */
+EXR_EXPORT
+exr_result_t exr_get_compression_cache_stats (
+    exr_const_context_t ctxt, uint64_t* hits, uint64_t* misses);
+
+/** Compress one chunk of zstd data in the layout all releases read:
+ * a serialized blosc2 super-chunk (frame). */
 EXR_EXPORT
 long exr_compress_zstd (
     char* inPtr, int inSize, void * outPtr, int outPtrSize);
 
+/** Compress one chunk of zstd data as a bare blosc2 chunk, without
+ * the frame around it.
+ *
+ * This is the layout of scanline parts with a \c zstdLinesPerChunk
+ * attribute greater than 1. Those parts cannot be read by releases
+ * predating the attribute, so only use this for such parts; tiles
+ * and single scanline chunks use exr_compress_zstd(). */
+EXR_EXPORT
+long exr_compress_zstd_chunk (
+    char* inPtr, int inSize, void * outPtr, int outPtrSize);
+
+/** Uncompress one chunk of zstd data written by either
+ * exr_compress_zstd() or exr_compress_zstd_chunk(). */
 EXR_EXPORT
 long exr_uncompress_zstd (
     const char* inPtr, uint64_t inSize, void ** outPtr, uint64_t outPtrSize);
 
+/** Number of scanlines stored in each chunk of a zstd compressed
+ * scanline part that has no \c zstdLinesPerChunk attribute.
+ *
+ * This is the default, and the only layout releases predating the
+ * attribute can read. Writers opt in to taller chunks, which are
+ * stored as bare blosc2 chunks (see exr_compress_zstd_chunk()), by
+ * setting the int attribute \c zstdLinesPerChunk (1 to 256) on the
+ * part before exr_write_header(). */
 EXR_EXPORT
-size_t exr_get_zstd_lines_per_chunk();
+size_t exr_get_zstd_lines_per_chunk ();
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -126,8 +126,9 @@ typedef int64_t (*exr_query_size_func_ptr_t) (
  * caching of data to give the appearance of being able to seek/read
  * atomically.
  *
- * TODO: This does not handle the ability to mmap a file and get to
- * zero copy
+ * If zero copy reads of the file data are desired, and the data is
+ * coming from a normal file, consider leaving this `NULL` and
+ * specifying \c EXR_CONTEXT_FLAG_USE_MMAP instead.
  */
 typedef int64_t (*exr_read_func_ptr_t) (
     exr_const_context_t         ctxt,
@@ -350,6 +351,37 @@ typedef struct _exr_context_initializer_v3
 /** @brief Writes an old-style, sorted header with minimal information */
 #define EXR_CONTEXT_FLAG_WRITE_LEGACY_HEADER (1 << 3)
 
+/** @brief Memory map the file when using the default read routines
+ *
+ * When no custom read function is provided, this requests that the
+ * file be mapped into memory instead of read with individual pread
+ * (or ReadFile) calls. The default decode pipeline will then point
+ * the packed buffer directly into the mapping instead of allocating
+ * and copying each chunk. If the mapping can not be established, the
+ * library silently falls back to the normal read routines. This is
+ * only valid for reading contexts.
+ */
+#define EXR_CONTEXT_FLAG_USE_MMAP (1 << 4)
+
+/** @brief Accept chunks in any order, from multiple threads at once
+ *
+ * Normally, the chunks of a part must be written in the order of
+ * the part's line order (unless that is \c EXR_LINEORDER_RANDOM_Y),
+ * and the chunk data is written to the file while the context is
+ * locked. With this flag, the chunks of a part may be written in any
+ * order: each write only reserves space at the end of the file for
+ * its chunk while the context is locked, then writes the chunk to
+ * that space concurrently with other writes. The chunk offset table
+ * of a part is written once all the chunks of the part have been.
+ *
+ * A custom write function must therefore be safe to call from
+ * several threads at once for different regions of the file. The
+ * chunks end up in the file in the order in which they were
+ * submitted, which readers handle through the offset table. This
+ * is only valid for writing contexts.
+ */
+#define EXR_CONTEXT_FLAG_WRITE_UNORDERED_CHUNKS (1 << 5)
+
 /* clang-format off */
 /** @brief Simple macro to initialize the context initializer with default values. */
 #define EXR_DEFAULT_CONTEXT_INITIALIZER                                        \
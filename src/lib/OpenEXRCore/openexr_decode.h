@@ -54,6 +54,15 @@ extern "C" {
  */
 #define EXR_DECODE_SAMPLE_DATA_ONLY ((uint16_t) (1 << 2))
 
+/**
+ * Set by exr_decoding_read_batch() (or exr_decoding_read_scanline_chunk()
+ * and exr_decoding_read_tile_chunk()) to indicate the packed buffer
+ * already holds the data for the current chunk, so the next call to
+ * exr_decoding_run() skips the read. It is cleared by that run or by
+ * exr_decoding_update().
+ */
+#define EXR_DECODE_PACKED_DATA_PRELOADED ((uint16_t) (1 << 3))
+
 /**
  * Struct meant to be used on a per-thread basis for reading exr data
  *
@@ -99,6 +108,11 @@ typedef struct _exr_decode_pipeline
      * If the caller wishes to take control of the buffer, simple
      * adopt the pointer and set it to `NULL` here. Be cognizant of any
      * custom allocators.
+     *
+     * When the context was created with @ref EXR_CONTEXT_FLAG_USE_MMAP,
+     * this may point directly into the read-only file mapping, in
+     * which case @ref packed_alloc_size is 0 and the buffer must not be
+     * written to or freed.
      */
     void* packed_buffer;
 
@@ -292,11 +306,143 @@ exr_result_t exr_decoding_update (
     const exr_chunk_info_t* cinfo,
     exr_decode_pipeline_t*  decode);
 
+/** Read the packed data for a set of decode pipelines in one go.
+ *
+ * Each pipeline should already be initialized (or updated) for the
+ * chunk it is to decode and have its default routines chosen. The
+ * packed data for all of them is then read using exr_read_chunks(),
+ * merging neighbouring chunks into as few requests as possible, such
+ * that the subsequent calls to exr_decoding_run() (possibly on
+ * separate threads) only have to decompress and unpack.
+ *
+ * Pipelines which do not use the default read routine, read deep
+ * data, or read uncompressed data directly to the destination, are
+ * left alone and will read as normal when run.
+ */
+EXR_EXPORT
+exr_result_t exr_decoding_read_batch (
+    exr_const_context_t     ctxt,
+    int                     part_index,
+    int                     count,
+    exr_decode_pipeline_t** decodes);
+
+/** Update a decode pipeline for the scanline chunk containing @p y,
+ * reading the chunk block info and the packed data together.
+ *
+ * This takes the place of calling exr_read_scanline_chunk_info() and
+ * exr_decoding_update(), but using
+ * exr_read_scanline_chunk_with_info() to read the chunk leader and
+ * the packed data in one request, such that the next call to
+ * exr_decoding_run() only has to decompress and unpack. Any channel
+ * decode pointers must be updated for the new chunk before that run
+ * as usual.
+ *
+ * The pipeline must already be initialized and have its routines
+ * chosen. Pipelines which do not use the default read routine, read
+ * deep data, or read uncompressed data directly to the destination
+ * are just updated and will read as normal when run.
+ */
+EXR_EXPORT
+exr_result_t exr_decoding_read_scanline_chunk (
+    exr_const_context_t    ctxt,
+    int                    part_index,
+    int                    y,
+    exr_decode_pipeline_t* decode);
+
+/** Tiled equivalent of exr_decoding_read_scanline_chunk(). */
+EXR_EXPORT
+exr_result_t exr_decoding_read_tile_chunk (
+    exr_const_context_t    ctxt,
+    int                    part_index,
+    int                    tilex,
+    int                    tiley,
+    int                    levelx,
+    int                    levely,
+    exr_decode_pipeline_t* decode);
+
 /** Execute the decoding pipeline. */
 EXR_EXPORT
 exr_result_t exr_decoding_run (
     exr_const_context_t ctxt, int part_index, exr_decode_pipeline_t* decode);
 
+/** A unit of work handed to an @ref exr_decode_executor_t. */
+typedef void (*exr_decode_task_fn_t) (void* task_data);
+
+/** Runs the tasks of an asynchronous decode (see exr_decoding_submit()).
+ *
+ * submit_fn must arrange for task(task_data) to be called exactly once,
+ * on any thread, and return 0. Tasks may run concurrently and in any
+ * order, and never wait on each other, so any thread pool (even one
+ * with a single thread) will do. If submit_fn returns non-zero, the
+ * task is run on the calling thread instead.
+ */
+typedef struct _exr_decode_executor
+{
+    void* executor_data;
+    int (*submit_fn) (
+        void* executor_data, exr_decode_task_fn_t task, void* task_data);
+} exr_decode_executor_t;
+
+/** Called once for each pipeline of a batch started with
+ * exr_decoding_submit(), when that pipeline has finished.
+ *
+ * @p index is the position of the pipeline in the submitted array and
+ * @p result what exr_decoding_run() (or the read before it)
+ * returned. This is called from whichever thread ran the task, and
+ * concurrently for different pipelines.
+ */
+typedef void (*exr_decode_complete_fn_t) (
+    exr_const_context_t    ctxt,
+    int                    part_index,
+    int                    index,
+    exr_decode_pipeline_t* decode,
+    exr_result_t           result,
+    void*                  userdata);
+
+/** Opaque handle to a batch of decodes started by exr_decoding_submit(). */
+typedef struct _exr_decode_batch* exr_decode_batch_t;
+
+/** Start decoding a set of pipelines without waiting for them.
+ *
+ * Each pipeline must be ready to run, as for exr_decoding_run(), and
+ * they all have to be for different chunks of the same part. The
+ * decode is split into two stages: a single I/O task reads the packed
+ * data of the pipelines in order, a few at a time using
+ * exr_decoding_read_batch(), and hands each pipeline on to its own
+ * task to decompress and unpack as soon as its data is in. Reading
+ * the next chunks thereby overlaps with decoding the previous ones.
+ *
+ * The tasks are run by @p executor, or if that is `NULL`, by a small
+ * pool of threads belonging to the context, which is started by the
+ * first such batch and stopped by exr_finish() (when the library is
+ * built without threading, everything is done before this returns).
+ * @p complete_fn, if not `NULL`, is called as each pipeline finishes.
+ *
+ * The pipelines, their output buffers, and the context must stay
+ * valid, and must not otherwise be used, until exr_decoding_wait()
+ * has been called on the returned @p batch, which must be done
+ * exactly once.
+ */
+EXR_EXPORT
+exr_result_t exr_decoding_submit (
+    exr_const_context_t          ctxt,
+    int                          part_index,
+    int                          count,
+    exr_decode_pipeline_t**      decodes,
+    const exr_decode_executor_t* executor,
+    exr_decode_complete_fn_t     complete_fn,
+    void*                        userdata,
+    exr_decode_batch_t*          batch);
+
+/** Wait for all pipelines of a batch to finish, and release the batch.
+ *
+ * All completion callbacks have returned by the time this returns.
+ * The result is that of the first pipeline to fail, or
+ * EXR_ERR_SUCCESS. @p batch is reset to `NULL`.
+ */
+EXR_EXPORT
+exr_result_t exr_decoding_wait (exr_decode_batch_t* batch);
+
 /** Free any intermediate memory in the decoding pipeline.
  *
  * This does *not* free any pointers referred to in the channel info
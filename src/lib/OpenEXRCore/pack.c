@@ -6,8 +6,165 @@
 #include "openexr_encode.h"
 
 #include "internal_coding.h"
+#include "internal_cpuid.h"
 #include "internal_xdr.h"
 
+#include <string.h>
+
+#if defined(__aarch64__) && !EXR_HOST_IS_NOT_LITTLE_ENDIAN
+#    define EXR_PACK_HAVE_NEON 1
+#    include <arm_neon.h>
+#endif
+
+#if (defined(__x86_64__) || defined(_M_X64)) &&                                \
+    (defined(__F16C__) || defined(__GNUC__) || defined(__clang__))
+#    define EXR_PACK_HAVE_F16C 1
+#    if defined(__AVX__) && defined(__F16C__) && defined(__SSE4_1__)
+#        define EXR_PACK_F16C_TARGET
+#    else
+#        define EXR_PACK_F16C_TARGET                                           \
+            __attribute__ ((target ("avx,f16c,sse4.1")))
+#    endif
+#endif
+
+/**************************************/
+
+static void
+float_to_half_buffer_impl (uint16_t* out, const float* in, int w)
+{
+    for (int x = 0; x < w; ++x)
+        out[x] = one_from_native16 (float_to_half (in[x]));
+}
+
+static void
+uint_to_half_buffer_impl (uint16_t* out, const uint32_t* in, int w)
+{
+    for (int x = 0; x < w; ++x)
+        out[x] = one_from_native16 (uint_to_half (in[x]));
+}
+
+#if defined(EXR_PACK_HAVE_F16C)
+
+EXR_PACK_F16C_TARGET static void
+float_to_half_buffer_f16c (uint16_t* out, const float* in, int w)
+{
+    while (w >= 8)
+    {
+        __m256 v = _mm256_loadu_ps (in);
+
+        /* the hardware quiets signalling NaNs where float_to_half
+         * keeps the payload as is, so leave any NaN to the latter */
+        if (_mm256_movemask_ps (_mm256_cmp_ps (v, v, _CMP_UNORD_Q)) == 0)
+            _mm_storeu_si128 (
+                (__m128i*) out,
+                _mm256_cvtps_ph (v, _MM_FROUND_TO_NEAREST_INT));
+        else
+            float_to_half_buffer_impl (out, in, 8);
+        out += 8;
+        in += 8;
+        w -= 8;
+    }
+    float_to_half_buffer_impl (out, in, w);
+}
+
+EXR_PACK_F16C_TARGET static void
+uint_to_half_buffer_f16c (uint16_t* out, const uint32_t* in, int w)
+{
+    const __m128i clampv = _mm_set1_epi32 (65505);
+    const __m128i maxv   = _mm_set1_epi32 (65504);
+    const __m128i infv   = _mm_set1_epi16 (0x7c00);
+
+    while (w >= 8)
+    {
+        /* anything past the largest half is infinity, clamping first
+         * keeps the values in signed range for the float conversion */
+        __m128i v0 =
+            _mm_min_epu32 (_mm_loadu_si128 ((const __m128i*) in), clampv);
+        __m128i v1 =
+            _mm_min_epu32 (_mm_loadu_si128 ((const __m128i*) (in + 4)), clampv);
+        __m128i big = _mm_packs_epi32 (
+            _mm_cmpgt_epi32 (v0, maxv), _mm_cmpgt_epi32 (v1, maxv));
+        __m128i h = _mm256_cvtps_ph (
+            _mm256_insertf128_ps (
+                _mm256_castps128_ps256 (_mm_cvtepi32_ps (v0)),
+                _mm_cvtepi32_ps (v1),
+                1),
+            _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128 ((__m128i*) out, _mm_blendv_epi8 (h, infv, big));
+        out += 8;
+        in += 8;
+        w -= 8;
+    }
+    uint_to_half_buffer_impl (out, in, w);
+}
+
+#endif /* EXR_PACK_HAVE_F16C */
+
+#if defined(EXR_PACK_HAVE_NEON)
+
+static void
+float_to_half_buffer_neon (uint16_t* out, const float* in, int w)
+{
+    while (w >= 4)
+    {
+        float32x4_t v = vld1q_f32 (in);
+
+        /* see float_to_half_buffer_f16c about NaN */
+        if (vminvq_u32 (vceqq_f32 (v, v)) != 0)
+            vst1_u16 (out, vreinterpret_u16_f16 (vcvt_f16_f32 (v)));
+        else
+            float_to_half_buffer_impl (out, in, 4);
+        out += 4;
+        in += 4;
+        w -= 4;
+    }
+    float_to_half_buffer_impl (out, in, w);
+}
+
+static void
+uint_to_half_buffer_neon (uint16_t* out, const uint32_t* in, int w)
+{
+    const uint32x4_t clampv = vdupq_n_u32 (65505);
+    const uint32x4_t maxv   = vdupq_n_u32 (65504);
+    const uint16x4_t infv   = vdup_n_u16 (0x7c00);
+
+    while (w >= 4)
+    {
+        uint32x4_t v   = vminq_u32 (vld1q_u32 (in), clampv);
+        uint16x4_t big = vmovn_u32 (vcgtq_u32 (v, maxv));
+        uint16x4_t h =
+            vreinterpret_u16_f16 (vcvt_f16_f32 (vcvtq_f32_u32 (v)));
+        vst1_u16 (out, vbsl_u16 (big, infv, h));
+        out += 4;
+        in += 4;
+        w -= 4;
+    }
+    uint_to_half_buffer_impl (out, in, w);
+}
+
+#endif /* EXR_PACK_HAVE_NEON */
+
+/* converts a run of contiguous values to little endian halves */
+static void (*float_to_half_buffer) (uint16_t*, const float*, int) =
+    &float_to_half_buffer_impl;
+static void (*uint_to_half_buffer) (uint16_t*, const uint32_t*, int) =
+    &uint_to_half_buffer_impl;
+
+static void
+choose_pack_impl (void)
+{
+#if defined(EXR_PACK_HAVE_F16C)
+    if (has_native_half ())
+    {
+        float_to_half_buffer = &float_to_half_buffer_f16c;
+        uint_to_half_buffer  = &uint_to_half_buffer_f16c;
+    }
+#elif defined(EXR_PACK_HAVE_NEON)
+    float_to_half_buffer = &float_to_half_buffer_neon;
+    uint_to_half_buffer  = &uint_to_half_buffer_neon;
+#endif
+}
+
 /**************************************/
 
 static exr_result_t
@@ -59,6 +216,13 @@ default_pack (exr_encode_pipeline_t* encode)
                     {
                         case EXR_PIXEL_HALF: {
                             uint16_t* dst = (uint16_t*) dstbuffer;
+#if !EXR_HOST_IS_NOT_LITTLE_ENDIAN
+                            if (pixincrement == 2)
+                            {
+                                memcpy (dst, cdata, chan_bytes);
+                                break;
+                            }
+#endif
                             for (int x = 0; x < w; ++x)
                             {
                                 unaligned_store16 (
@@ -70,6 +234,12 @@ default_pack (exr_encode_pipeline_t* encode)
                         }
                         case EXR_PIXEL_FLOAT: {
                             uint16_t* dst = (uint16_t*) dstbuffer;
+                            if (pixincrement == 4)
+                            {
+                                float_to_half_buffer (
+                                    dst, (const float*) cdata, w);
+                                break;
+                            }
                             for (int x = 0; x < w; ++x)
                             {
                                 uint16_t cval =
@@ -82,6 +252,12 @@ default_pack (exr_encode_pipeline_t* encode)
                         }
                         case EXR_PIXEL_UINT: {
                             uint16_t* dst = (uint16_t*) dstbuffer;
+                            if (pixincrement == 4)
+                            {
+                                uint_to_half_buffer (
+                                    dst, (const uint32_t*) cdata, w);
+                                break;
+                            }
                             for (int x = 0; x < w; ++x)
                             {
                                 uint16_t cval =
@@ -112,6 +288,13 @@ default_pack (exr_encode_pipeline_t* encode)
                         }
                         case EXR_PIXEL_FLOAT: {
                             uint32_t* dst = (uint32_t*) dstbuffer;
+#if !EXR_HOST_IS_NOT_LITTLE_ENDIAN
+                            if (pixincrement == 4)
+                            {
+                                memcpy (dst, cdata, chan_bytes);
+                                break;
+                            }
+#endif
                             for (int x = 0; x < w; ++x)
                             {
                                 unaligned_store32 (
@@ -163,6 +346,13 @@ default_pack (exr_encode_pipeline_t* encode)
                         }
                         case EXR_PIXEL_UINT: {
                             uint32_t* dst = (uint32_t*) dstbuffer;
+#if !EXR_HOST_IS_NOT_LITTLE_ENDIAN
+                            if (pixincrement == 4)
+                            {
+                                memcpy (dst, cdata, chan_bytes);
+                                break;
+                            }
+#endif
                             for (int x = 0; x < w; ++x)
                             {
                                 unaligned_store32 (
@@ -187,11 +377,143 @@ default_pack (exr_encode_pipeline_t* encode)
     return EXR_ERR_SUCCESS;
 }
 
+/**************************************/
+
+/* the user hands us all channels of each pixel next to each other
+ * (RGBA, ABGR or any other order), all stored as half in the file
+ * with no sampling. Returns the (shared) user element size, or 0 if
+ * the layout is anything else */
+static int
+interleaved_half_layout (const exr_encode_pipeline_t* encode, int nc)
+{
+    const exr_coding_channel_info_t* enc0 = encode->channels;
+    const uint8_t*                   base = NULL;
+    int                              ubpe, seen = 0;
+
+    if (encode->channel_count != nc) return 0;
+    if (enc0->user_data_type == EXR_PIXEL_HALF)
+        ubpe = 2;
+    else if (enc0->user_data_type == EXR_PIXEL_FLOAT)
+        ubpe = 4;
+    else
+        return 0;
+
+    for (int c = 0; c < nc; ++c)
+    {
+        const exr_coding_channel_info_t* encc = encode->channels + c;
+
+        if (encc->data_type != EXR_PIXEL_HALF ||
+            encc->user_data_type != enc0->user_data_type ||
+            encc->x_samples != 1 || encc->y_samples != 1 ||
+            encc->width != enc0->width ||
+            encc->height != encode->chunk.height ||
+            encc->user_pixel_stride != nc * ubpe ||
+            encc->user_line_stride != enc0->user_line_stride ||
+            !encc->encode_from_ptr)
+            return 0;
+        if (!base || encc->encode_from_ptr < base)
+            base = encc->encode_from_ptr;
+    }
+
+    for (int c = 0; c < nc; ++c)
+    {
+        ptrdiff_t off = encode->channels[c].encode_from_ptr - base;
+        if (off % ubpe != 0 || off >= nc * ubpe) return 0;
+        seen |= 1 << (off / ubpe);
+    }
+
+    return seen == (1 << nc) - 1 ? ubpe : 0;
+}
+
+/* converting a short run of pixels at a time keeps the de-interleaved
+ * values in L1 while letting the half conversion work on whole vectors */
+#define PACK_BLOCK_PIXELS 64
+
+static inline exr_result_t
+pack_interleaved_half (exr_encode_pipeline_t* encode, int nc)
+{
+    uint8_t* dstbuffer = encode->packed_buffer;
+    int      w, h, ubpe;
+    int32_t  linc;
+
+    ubpe = interleaved_half_layout (encode, nc);
+    /* the pointers may have been moved since the routines were chosen */
+    if (ubpe == 0) return default_pack (encode);
+
+    w    = encode->channels[0].width;
+    h    = encode->chunk.height;
+    linc = encode->channels[0].user_line_stride;
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; x += PACK_BLOCK_PIXELS)
+        {
+            int n = w - x;
+            if (n > PACK_BLOCK_PIXELS) n = PACK_BLOCK_PIXELS;
+
+            for (int c = 0; c < nc; ++c)
+            {
+                const exr_coding_channel_info_t* encc = encode->channels + c;
+                const uint8_t*                   cdata =
+                    encc->encode_from_ptr + (uint64_t) y * (uint64_t) linc +
+                    (uint64_t) x * (uint64_t) (nc * ubpe);
+                uint16_t* dst =
+                    ((uint16_t*) dstbuffer) + (size_t) c * (size_t) w + x;
+
+                if (ubpe == 4)
+                {
+                    const float* in = (const float*) cdata;
+                    float        tmp[PACK_BLOCK_PIXELS];
+
+                    for (int i = 0; i < n; ++i)
+                        tmp[i] = in[i * nc];
+                    float_to_half_buffer (dst, tmp, n);
+                }
+                else
+                {
+                    const uint16_t* in = (const uint16_t*) cdata;
+
+                    for (int i = 0; i < n; ++i)
+                        dst[i] = one_from_native16 (in[i * nc]);
+                }
+            }
+        }
+        dstbuffer += (size_t) nc * (size_t) w * 2;
+    }
+
+    encode->packed_bytes =
+        (uint64_t) (dstbuffer - (uint8_t*) encode->packed_buffer);
+    return EXR_ERR_SUCCESS;
+}
+
+static exr_result_t
+pack_half_3chan_interleave (exr_encode_pipeline_t* encode)
+{
+    return pack_interleaved_half (encode, 3);
+}
+
+static exr_result_t
+pack_half_4chan_interleave (exr_encode_pipeline_t* encode)
+{
+    return pack_interleaved_half (encode, 4);
+}
+
+/**************************************/
+
 internal_exr_pack_fn
 internal_exr_match_encode (exr_encode_pipeline_t* encode, int isdeep)
 {
-    (void) encode;
+    static int init_cpu_check = 1;
+    if (init_cpu_check)
+    {
+        choose_pack_impl ();
+        init_cpu_check = 0;
+    }
+
     if (isdeep) return &default_pack_deep;
 
+    if (interleaved_half_layout (encode, 4)) return &pack_half_4chan_interleave;
+    if (interleaved_half_layout (encode, 3)) return &pack_half_3chan_interleave;
+
     return &default_pack;
 }
@@ -2283,6 +2283,27 @@ internal_exr_compute_tile_information (
 
 /**************************************/
 
+static int32_t
+zstd_lines_per_chunk (exr_priv_part_t curpart)
+{
+    const exr_attribute_list_t* attrs = &(curpart->attributes);
+
+    for (int a = 0; a < attrs->num_attributes; ++a)
+    {
+        const exr_attribute_t* cur = attrs->entries[a];
+
+        if (0 != strcmp (cur->name, EXR_ZSTD_LINES_PER_CHUNK_STR)) continue;
+
+        if (cur->type != EXR_ATTR_INT || cur->i < 1 ||
+            cur->i > EXR_ZSTD_MAX_LINES_PER_CHUNK)
+            return -1;
+        return cur->i;
+    }
+    return 1;
+}
+
+/**************************************/
+
 int32_t
 internal_exr_compute_chunk_offset_size (exr_priv_part_t curpart)
 {
@@ -2353,6 +2374,7 @@ internal_exr_compute_chunk_offset_size (exr_priv_part_t curpart)
     }
     else
     {
+        int32_t  zstdLines;
         uint64_t linePerChunk, h;
         switch (curpart->comp_type)
         {
@@ -2366,7 +2388,11 @@ internal_exr_compute_chunk_offset_size (exr_priv_part_t curpart)
             case EXR_COMPRESSION_B44A:
             case EXR_COMPRESSION_DWAA: linePerChunk = 32; break;
             case EXR_COMPRESSION_DWAB: linePerChunk = 256; break;
-            case EXR_COMPRESSION_ZSTD: linePerChunk = exr_get_zstd_lines_per_chunk(); break;
+            case EXR_COMPRESSION_ZSTD:
+                zstdLines = zstd_lines_per_chunk (curpart);
+                if (zstdLines < 1) return -1;
+                linePerChunk = (uint64_t) zstdLines;
+                break;
             case EXR_COMPRESSION_LAST_TYPE:
             default:
                 /* ERROR CONDITION */
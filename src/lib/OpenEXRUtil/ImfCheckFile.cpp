@@ -96,7 +96,7 @@ readRgba (RgbaInputFile& in, bool reduceMemory, bool reduceTime)
                          static_cast<uint64_t> (dw.min.x) + 1;
             int      dx            = dw.min.x;
             uint64_t bytesPerPixel = calculateBytesPerPixel (in.header ());
-            uint64_t numLines = numLinesInBuffer (in.header ().compression ());
+            uint64_t numLines      = numLinesInBuffer (in.header ());
 
             if (reduceMemory &&
                 w * bytesPerPixel * numLines > gMaxBytesPerScanline)
@@ -155,7 +155,7 @@ readScanline (T& in, bool reduceMemory, bool reduceTime)
                      static_cast<uint64_t> (dw.min.x) + 1;
         int      dx            = dw.min.x;
         uint64_t bytesPerPixel = calculateBytesPerPixel (in.header ());
-        uint64_t numLines      = numLinesInBuffer (in.header ().compression ());
+        uint64_t numLines      = numLinesInBuffer (in.header ());
 
         if (reduceMemory && w * bytesPerPixel * numLines > gMaxBytesPerScanline)
         {
@@ -832,8 +832,7 @@ readMultiPart (MultiPartInputFile& in, bool reduceMemory, bool reduceTime)
         int      bytesPerPixel = calculateBytesPerPixel (in.header (part));
         uint64_t imageWidth    = static_cast<uint64_t> (b.max.x) -
                               static_cast<uint64_t> (b.min.x) + 1ll;
-        uint64_t scanlinesInBuffer =
-            numLinesInBuffer (in.header (part).compression ());
+        uint64_t scanlinesInBuffer = numLinesInBuffer (in.header (part));
 
         //
         // very wide scanline parts take excessive memory to read.
@@ -63,6 +63,13 @@ DeepImageChannel::sampleCounts () const
     return deepLevel ().sampleCounts ();
 }
 
+DeepSlice
+DeepImageChannel::slice () const
+{
+    const Box2i& dw = level ().dataWindow ();
+    return slice (_sampleListPointers, dw.min.y, dw.max.y);
+}
+
 void
 DeepImageChannel::resize ()
 {
@@ -75,8 +82,9 @@ template <class T>
 TypedDeepImageChannel<T>::TypedDeepImageChannel (
     DeepImageLevel& level, bool pLinear)
     : DeepImageChannel (level, pLinear)
-    , _sampleListPointers (0)
-    , _base (0)
+    , _positions (0)
+    , _minX (0)
+    , _minY (0)
     , _sampleBuffer (0)
 {
     resize ();
@@ -84,23 +92,43 @@ TypedDeepImageChannel<T>::TypedDeepImageChannel (
 
 template <class T> TypedDeepImageChannel<T>::~TypedDeepImageChannel ()
 {
-    delete[] _sampleListPointers;
     delete[] _sampleBuffer;
 }
 
 template <class T>
 DeepSlice
-TypedDeepImageChannel<T>::slice () const
+TypedDeepImageChannel<T>::slice (
+    vector<char*>& sampleListPointers, int minY, int maxY) const
 {
+    //
+    // Fill the table of per-pixel sample list pointers for rows
+    // minY through maxY.  The slice's base pointer is set up such
+    // that the first table entry corresponds to the pixel at the
+    // left edge of the data window in row minY.
+    //
+
+    size_t first = size_t (minY - _minY) * pixelsPerRow ();
+    size_t n     = size_t (maxY - minY + 1) * pixelsPerRow ();
+
+    sampleListPointers.resize (n);
+
+    for (size_t i = 0; i < n; ++i)
+        sampleListPointers[i] =
+            (char*) (_sampleBuffer + _positions[first + i]);
+
+    char** base = sampleListPointers.data () -
+                  (ptrdiff_t (minY) * pixelsPerRow () + _minX);
+
     return DeepSlice (
-        pixelType (),                  // type
-        (char*) _base,                 // base
-        sizeof (T*),                   // xStride
-        pixelsPerRow () * sizeof (T*), // yStride
-        sizeof (T),                    // sampleStride
+        pixelType (),                      // type
+        (char*) base,                      // base
+        sizeof (char*),                    // xStride
+        pixelsPerRow () * sizeof (char*),  // yStride
+        sizeof (T),                        // sampleStride
         xSampling (),
         ySampling ());
 }
+
 template <class T>
 void
 TypedDeepImageChannel<T>::setSamplesToZero (
@@ -110,16 +138,17 @@ TypedDeepImageChannel<T>::setSamplesToZero (
     // Expand the size of a sample list for a single pixel and
     // set the new samples in the list to 0.
     //
-    // i                The position of the affected pixel in
-    //                  the channel's _sampleListPointers.
+    // i                The index of the affected pixel.
     //
     // oldNumSamples    Original number of samples in the sample list.
     //
     // newNumSamples    New number of samples in the sample list.
     //
 
+    T* sampleList = _sampleBuffer + _positions[i];
+
     for (unsigned int j = oldNumSamples; j < newNumSamples; ++j)
-        _sampleListPointers[i][j] = 0;
+        sampleList[j] = 0;
 }
 
 template <class T>
@@ -134,8 +163,9 @@ TypedDeepImageChannel<T>::moveSampleList (
     // Resize the sample list for a single pixel and move it to a new
     // position in the sample buffer for this channel.
     //
-    // i                        The position of the affected pixel in
-    //                          the channel's _sampleListPointers.
+    // i                        The index of the affected pixel.  The
+    //                          sample count channel still holds the
+    //                          old position of the sample list.
     //
     // oldNumSamples            Original number of samples in sample list.
     //
@@ -152,7 +182,7 @@ TypedDeepImageChannel<T>::moveSampleList (
     //                          sample buffer.
     //
 
-    T* oldSampleList = _sampleListPointers[i];
+    T* oldSampleList = _sampleBuffer + _positions[i];
     T* newSampleList = _sampleBuffer + newSampleListPosition;
 
     if (oldNumSamples > newNumSamples)
@@ -168,8 +198,6 @@ TypedDeepImageChannel<T>::moveSampleList (
         for (unsigned int j = oldNumSamples; j < newNumSamples; ++j)
             newSampleList[j] = 0;
     }
-
-    _sampleListPointers[i] = newSampleList;
 }
 
 template <class T>
@@ -177,6 +205,7 @@ void
 TypedDeepImageChannel<T>::moveSamplesToNewBuffer (
     const unsigned int* oldNumSamples,
     const unsigned int* newNumSamples,
+    const size_t*       oldSampleListPositions,
     const size_t*       newSampleListPositions)
 {
     //
@@ -196,6 +225,9 @@ TypedDeepImageChannel<T>::moveSamplesToNewBuffer (
     //                          smaller than the old one, then samples at
     //                          the end of the old sample list are discarded.
     //
+    // oldSampleListPositions   The positions of the sample lists in the
+    //                          old sample buffer.
+    //
     // newSampleListPositions   The positions of the new sample lists in the
     //                          new sample buffer.
     //
@@ -205,7 +237,7 @@ TypedDeepImageChannel<T>::moveSamplesToNewBuffer (
 
     for (size_t i = 0; i < numPixels (); ++i)
     {
-        T* oldSampleList = _sampleListPointers[i];
+        T* oldSampleList = oldSampleBuffer + oldSampleListPositions[i];
         T* newSampleList = _sampleBuffer + newSampleListPositions[i];
 
         if (oldNumSamples[i] > newNumSamples[i])
@@ -221,11 +253,11 @@ TypedDeepImageChannel<T>::moveSamplesToNewBuffer (
             for (unsigned int j = oldNumSamples[i]; j < newNumSamples[i]; ++j)
                 newSampleList[j] = 0;
         }
-
-        _sampleListPointers[i] = newSampleList;
     }
 
     delete[] oldSampleBuffer;
+
+    resetBasePointer ();
 }
 
 template <class T>
@@ -233,8 +265,9 @@ void
 TypedDeepImageChannel<T>::initializeSampleLists ()
 {
     //
-    // Allocate a new set of sample lists for this channel, and
-    // construct zero-filled sample lists for the pixels.
+    // Allocate a new sample buffer for this channel, and fill it
+    // with zeroes.  The sample lists of the pixels are found through
+    // the sample list positions in the sample count channel.
     //
 
     delete[] _sampleBuffer;
@@ -242,20 +275,11 @@ TypedDeepImageChannel<T>::initializeSampleLists ()
     _sampleBuffer = 0; // set to 0 to prevent double deletion
                        // in case of an exception
 
-    const unsigned int* numSamples    = sampleCounts ().numSamples ();
-    const size_t* sampleListPositions = sampleCounts ().sampleListPositions ();
-
-    _sampleBuffer = new T[sampleCounts ().sampleBufferSize ()];
-
-    resetBasePointer ();
-
-    for (size_t i = 0; i < numPixels (); ++i)
-    {
-        _sampleListPointers[i] = _sampleBuffer + sampleListPositions[i];
+    size_t n      = sampleCounts ().sampleBufferSize ();
+    _sampleBuffer = new T[n];
 
-        for (unsigned int j = 0; j < numSamples[i]; ++j)
-            _sampleListPointers[i][j] = T (0);
-    }
+    for (size_t i = 0; i < n; ++i)
+        _sampleBuffer[i] = T (0);
 }
 
 template <class T>
@@ -263,10 +287,7 @@ void
 TypedDeepImageChannel<T>::resize ()
 {
     DeepImageChannel::resize ();
-
-    delete[] _sampleListPointers;
-    _sampleListPointers = 0;
-    _sampleListPointers = new T*[numPixels ()];
+    resetBasePointer ();
     initializeSampleLists ();
 }
 
@@ -274,9 +295,9 @@ template <class T>
 void
 TypedDeepImageChannel<T>::resetBasePointer ()
 {
-    _base = _sampleListPointers -
-            level ().dataWindow ().min.y * pixelsPerRow () -
-            level ().dataWindow ().min.x;
+    _positions = sampleCounts ().sampleListPositions ();
+    _minX      = level ().dataWindow ().min.x;
+    _minY      = level ().dataWindow ().min.y;
 }
 
 template <>
@@ -25,6 +25,8 @@
 
 #include "ImfDeepFrameBuffer.h"
 
+#include <vector>
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
 
 class DeepImageLevel;
@@ -40,17 +42,42 @@ class SampleCountChannel;
 // Sample storage is allocated only for pixels within the data window
 // of the level.
 //
+// The samples of all pixels are kept in one contiguous buffer per
+// channel.  Where the samples of a pixel start in that buffer is
+// recorded only once per level, by the sample count channel (see
+// SampleCountChannel::sampleListPositions()), and is the same for
+// all deep channels of the level.
+//
 
 class IMFUTIL_EXPORT_TYPE DeepImageChannel : public ImageChannel
 {
 public:
     //
-    // Construct an OpenEXR frame buffer slice for this channel.
-    // This function is needed reading an image from an OpenEXR
-    // file and for saving an image in an OpenEXR file.
+    // Construct an OpenEXR frame buffer slice for rows minY to maxY
+    // (in pixel space) of this channel.  This function is needed
+    // reading an image from an OpenEXR file and for saving an image
+    // in an OpenEXR file.
+    //
+    // A deep frame buffer slice points to a table with a pointer to
+    // the sample list of each pixel.  slice() fills sampleListPointers
+    // with those pointers for the given rows; the table must not be
+    // changed or destroyed while the slice is in use, and the slice
+    // becomes invalid when the sample counts change.
     //
 
-    virtual DeepSlice slice () const = 0;
+    virtual DeepSlice
+    slice (std::vector<char*>& sampleListPointers, int minY, int maxY)
+        const = 0;
+
+    //
+    // Construct an OpenEXR frame buffer slice for the whole data window
+    // of this channel.  The table of sample list pointers is kept by the
+    // channel; the slice becomes invalid when the sample counts change
+    // or when slice() is called again.
+    //
+
+    OPENEXR_DEPRECATED ("Use slice (sampleListPointers, minY, maxY)")
+    IMFUTIL_EXPORT DeepSlice slice () const;
 
     //
     // Access to the image level to which this channel belongs.
@@ -89,6 +116,7 @@ protected:
     virtual void moveSamplesToNewBuffer (
         const unsigned int* oldNumSamples,
         const unsigned int* newNumSamples,
+        const size_t*       oldSampleListPositions,
         const size_t*       newSampleListPositions) = 0;
 
     virtual void initializeSampleLists () = 0;
@@ -96,6 +124,9 @@ protected:
     IMFUTIL_EXPORT virtual void resize ();
 
     virtual void resetBasePointer () = 0;
+
+private:
+    mutable std::vector<char*> _sampleListPointers; // Table for slice()
 };
 
 template <class T>
@@ -110,12 +141,14 @@ public:
     virtual PixelType pixelType () const;
 
     //
-    // Construct an OpenEXR frame buffer slice for this channel.
-    // This function is needed reading an image from an OpenEXR
-    // file and for saving an image in an OpenEXR file.
+    // Construct an OpenEXR frame buffer slice for rows minY to maxY
+    // of this channel (see DeepImageChannel::slice(), above).
     //
 
-    virtual DeepSlice slice () const;
+    virtual DeepSlice slice (
+        std::vector<char*>& sampleListPointers, int minY, int maxY) const;
+
+    using DeepImageChannel::slice;
 
     //
     // Access to the pixel at pixel space location (x, y), without bounds
@@ -144,12 +177,44 @@ public:
     // rows or pixels results in undefined behavior.
     //
     // Rows are numbered from 0 to pixelsPerColumn()-1, and each row
-    // contains pixelsPerRow() values.  The number of samples in
-    // row(r)[i] is sampleCounts().row(r)[i].
+    // contains pixelsPerRow() values.  row(r)[i] is a pointer to the
+    // samples of pixel i, and the number of samples in row(r)[i] is
+    // sampleCounts().row(r)[i].
+    //
+    // Note: up to OpenEXR 3.2, row() returned a T* const* into a table
+    // of per-pixel pointers that the channel no longer keeps.  Code that
+    // indexes the row, row(r)[i], compiles unchanged; code that stores
+    // the row in a T* const* must use SampleListRow, or sampleBuffer()
+    // and sampleCounts().sampleListPositions().
     //
 
-    T* const*       row (int r);
-    const T* const* row (int r) const;
+    template <class S> class SampleListRow
+    {
+    public:
+        SampleListRow (S* samples, const size_t* positions);
+
+        S* operator[] (int i) const;
+
+    private:
+        S*            _samples;
+        const size_t* _positions;
+    };
+
+    SampleListRow<T>       row (int r);
+    SampleListRow<const T> row (int r) const;
+
+    //
+    // Access to the contiguous buffer that holds the samples of all
+    // pixels.  The samples of the pixel with index i (counting in
+    // row-major order from the top left corner of the data window)
+    // start at sampleBuffer()[sampleCounts().sampleListPositions()[i]].
+    // The sample list positions are the same for all deep channels of
+    // a level, so a loop over the samples of several channels can
+    // walk the positions once and index every channel's buffer.
+    //
+
+    T*       sampleBuffer ();
+    const T* sampleBuffer () const;
 
 private:
     friend class DeepImageLevel;
@@ -180,6 +245,7 @@ private:
     virtual void moveSamplesToNewBuffer (
         const unsigned int* oldNumSamples,
         const unsigned int* newNumSamples,
+        const size_t*       oldSampleListPositions,
         const size_t*       newSampleListPositions);
 
     IMFUTIL_HIDDEN
@@ -191,11 +257,14 @@ private:
     IMFUTIL_HIDDEN
     virtual void resetBasePointer ();
 
-    T** _sampleListPointers; // Array of pointers to per-pixel
-                             //sample lists
+    IMFUTIL_HIDDEN
+    size_t pixelIndex (int x, int y) const;
 
-    T** _base; // Base pointer for faster access
-               // to entries in _sampleListPointers
+    const size_t* _positions; // The level's sample list positions,
+                              // owned by the sample count channel
+
+    int _minX; // Data window origin, cached
+    int _minY; // for faster pixel access
 
     T* _sampleBuffer; // Contiguous memory block that
                       // contains all sample lists for
@@ -214,18 +283,25 @@ typedef TypedDeepImageChannel<unsigned int> DeepUIntChannel;
 // Implementation of templates and inline functions
 //-----------------------------------------------------------------------------
 
+template <class T>
+inline size_t
+TypedDeepImageChannel<T>::pixelIndex (int x, int y) const
+{
+    return size_t (y - _minY) * pixelsPerRow () + (x - _minX);
+}
+
 template <class T>
 inline T*
 TypedDeepImageChannel<T>::operator() (int x, int y)
 {
-    return _base[y * pixelsPerRow () + x];
+    return _sampleBuffer + _positions[pixelIndex (x, y)];
 }
 
 template <class T>
 inline const T*
 TypedDeepImageChannel<T>::operator() (int x, int y) const
 {
-    return _base[y * pixelsPerRow () + x];
+    return _sampleBuffer + _positions[pixelIndex (x, y)];
 }
 
 template <class T>
@@ -233,7 +309,7 @@ inline T*
 TypedDeepImageChannel<T>::at (int x, int y)
 {
     boundsCheck (x, y);
-    return _base[y * pixelsPerRow () + x];
+    return (*this) (x, y);
 }
 
 template <class T>
@@ -241,21 +317,54 @@ inline const T*
 TypedDeepImageChannel<T>::at (int x, int y) const
 {
     boundsCheck (x, y);
-    return _base[y * pixelsPerRow () + x];
+    return (*this) (x, y);
+}
+
+template <class T>
+template <class S>
+inline TypedDeepImageChannel<T>::SampleListRow<S>::SampleListRow (
+    S* samples, const size_t* positions)
+    : _samples (samples), _positions (positions)
+{
+    // empty
+}
+
+template <class T>
+template <class S>
+inline S*
+TypedDeepImageChannel<T>::SampleListRow<S>::operator[] (int i) const
+{
+    return _samples + _positions[i];
 }
 
 template <class T>
-inline T* const*
+inline typename TypedDeepImageChannel<T>::template SampleListRow<T>
 TypedDeepImageChannel<T>::row (int r)
 {
-    return _base + r * pixelsPerRow ();
+    return SampleListRow<T> (
+        _sampleBuffer, _positions + size_t (r) * pixelsPerRow ());
 }
 
 template <class T>
-inline const T* const*
+inline typename TypedDeepImageChannel<T>::template SampleListRow<const T>
 TypedDeepImageChannel<T>::row (int r) const
 {
-    return _base + r * pixelsPerRow ();
+    return SampleListRow<const T> (
+        _sampleBuffer, _positions + size_t (r) * pixelsPerRow ());
+}
+
+template <class T>
+inline T*
+TypedDeepImageChannel<T>::sampleBuffer ()
+{
+    return _sampleBuffer;
+}
+
+template <class T>
+inline const T*
+TypedDeepImageChannel<T>::sampleBuffer () const
+{
+    return _sampleBuffer;
 }
 
 #ifndef COMPILING_IMF_DEEP_IMAGE_CHANNEL
@@ -12,6 +12,8 @@
 #include "ImfDeepImageIO.h"
 #include <Iex.h>
 #include <ImfChannelList.h>
+#include <ImfCompression.h>
+#include <ImfCompressor.h>
 #include <ImfDeepScanLineInputFile.h>
 #include <ImfDeepScanLineOutputFile.h>
 #include <ImfDeepTiledInputFile.h>
@@ -20,8 +22,10 @@
 #include <ImfMultiPartInputFile.h>
 #include <ImfPartType.h>
 #include <ImfTestFile.h>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <vector>
 
 using namespace IMATH_NAMESPACE;
 using namespace IEX_NAMESPACE;
@@ -29,6 +33,67 @@ using namespace std;
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
+namespace
+{
+
+//
+// Deep frame buffer slices need a pointer to the sample list of every
+// pixel, but the channels of a deep image level keep only the sample
+// list positions.  Pixels are therefore read and written in bands of
+// scan lines, and the pointer tables are built for one band at a time.
+//
+
+typedef vector<vector<char*>> SampleListPointers;
+
+int
+bandHeight (const DeepImageLevel& level, const Header& hdr)
+{
+    //
+    // Around 64k pixels per band, rounded up to whole chunks of
+    // scan lines so that no chunk is read more than once.
+    //
+
+    int w = level.dataWindow ().max.x - level.dataWindow ().min.x + 1;
+    int n = numLinesInBuffer (hdr);
+    int h = max (1, (1 << 16) / max (w, 1));
+
+    return ((h + n - 1) / n) * n;
+}
+
+DeepFrameBuffer
+sampleCountFrameBuffer (const DeepImageLevel& level)
+{
+    DeepFrameBuffer fb;
+    fb.insertSampleCountSlice (level.sampleCounts ().slice ());
+    return fb;
+}
+
+DeepFrameBuffer
+bandFrameBuffer (
+    const DeepImageLevel& level,
+    SampleListPointers&   pointers,
+    int                   minY,
+    int                   maxY)
+{
+    DeepFrameBuffer fb = sampleCountFrameBuffer (level);
+    size_t          n  = 0;
+
+    for (DeepImageLevel::ConstIterator i = level.begin (); i != level.end ();
+         ++i)
+        ++n;
+
+    pointers.resize (n);
+    n = 0;
+
+    for (DeepImageLevel::ConstIterator i = level.begin (); i != level.end ();
+         ++i, ++n)
+        fb.insert (i.name (), i.channel ().slice (pointers[n], minY, maxY));
+
+    return fb;
+}
+
+} // namespace
+
 void
 saveDeepImage (
     const string&    fileName,
@@ -135,21 +200,36 @@ saveDeepScanLineImage (
     newHdr.compression () = ZIPS_COMPRESSION;
 
     const DeepImageLevel& level = img.level ();
-    DeepFrameBuffer       fb;
-
-    fb.insertSampleCountSlice (level.sampleCounts ().slice ());
 
     for (DeepImageLevel::ConstIterator i = level.begin (); i != level.end ();
          ++i)
     {
         newHdr.channels ().insert (i.name (), i.channel ().channel ());
-        fb.insert (i.name (), i.channel ().slice ());
     }
 
     DeepScanLineOutputFile out (fileName.c_str (), newHdr);
-    out.setFrameBuffer (fb);
-    out.writePixels (
-        newHdr.dataWindow ().max.y - newHdr.dataWindow ().min.y + 1);
+    SampleListPointers     pointers;
+    const Box2i&           dw   = newHdr.dataWindow ();
+    int                    band = bandHeight (level, out.header ());
+
+    //
+    // writePixels() proceeds in the file's line order.
+    //
+
+    for (int i = 0; i <= dw.max.y - dw.min.y; i += band)
+    {
+        int minY = dw.min.y + i;
+        int maxY = min (minY + band - 1, dw.max.y);
+
+        if (newHdr.lineOrder () == DECREASING_Y)
+        {
+            maxY = dw.max.y - i;
+            minY = max (maxY - band + 1, dw.min.y);
+        }
+
+        out.setFrameBuffer (bandFrameBuffer (level, pointers, minY, maxY));
+        out.writePixels (maxY - minY + 1);
+    }
 }
 
 void
@@ -175,24 +255,32 @@ loadDeepScanLineImage (const string& fileName, Header& hdr, DeepImage& img)
     img.resize (in.header ().dataWindow (), ONE_LEVEL, ROUND_DOWN);
 
     DeepImageLevel& level = img.level ();
-    DeepFrameBuffer fb;
+    const Box2i&    dw    = level.dataWindow ();
 
-    fb.insertSampleCountSlice (level.sampleCounts ().slice ());
-
-    for (DeepImageLevel::ConstIterator i = level.begin (); i != level.end ();
-         ++i)
-        fb.insert (i.name (), i.channel ().slice ());
-
-    in.setFrameBuffer (fb);
+    in.setFrameBuffer (sampleCountFrameBuffer (level));
 
     {
         SampleCountChannel::Edit edit (level.sampleCounts ());
 
-        in.readPixelSampleCounts (
-            level.dataWindow ().min.y, level.dataWindow ().max.y);
+        in.readPixelSampleCounts (dw.min.y, dw.max.y);
     }
 
-    in.readPixels (level.dataWindow ().min.y, level.dataWindow ().max.y);
+    SampleListPointers pointers;
+    int                band = bandHeight (level, in.header ());
+
+    for (int minY = dw.min.y; minY <= dw.max.y; minY += band)
+    {
+        int maxY = min (minY + band - 1, dw.max.y);
+
+        //
+        // setFrameBuffer() makes the file forget which sample counts
+        // it has read; reading them again leaves the level unchanged.
+        //
+
+        in.setFrameBuffer (bandFrameBuffer (level, pointers, minY, maxY));
+        in.readPixelSampleCounts (minY, maxY);
+        in.readPixels (minY, maxY);
+    }
 
     for (Header::ConstIterator i = in.header ().begin ();
          i != in.header ().end ();
@@ -216,16 +304,20 @@ void
 saveLevel (DeepTiledOutputFile& out, const DeepImage& img, int x, int y)
 {
     const DeepImageLevel& level = img.level (x, y);
-    DeepFrameBuffer       fb;
+    SampleListPointers    pointers;
 
-    fb.insertSampleCountSlice (level.sampleCounts ().slice ());
+    //
+    // One row of tiles at a time.
+    //
 
-    for (DeepImageLevel::ConstIterator i = level.begin (); i != level.end ();
-         ++i)
-        fb.insert (i.name (), i.channel ().slice ());
+    for (int dy = 0; dy < out.numYTiles (y); ++dy)
+    {
+        Box2i tw = out.dataWindowForTile (0, dy, x, y);
 
-    out.setFrameBuffer (fb);
-    out.writeTiles (0, out.numXTiles (x) - 1, 0, out.numYTiles (y) - 1, x, y);
+        out.setFrameBuffer (
+            bandFrameBuffer (level, pointers, tw.min.y, tw.max.y));
+        out.writeTiles (0, out.numXTiles (x) - 1, dy, dy, x, y);
+    }
 }
 
 } // namespace
@@ -319,15 +411,8 @@ void
 loadLevel (DeepTiledInputFile& in, DeepImage& img, int x, int y)
 {
     DeepImageLevel& level = img.level (x, y);
-    DeepFrameBuffer fb;
-
-    fb.insertSampleCountSlice (level.sampleCounts ().slice ());
 
-    for (DeepImageLevel::ConstIterator i = level.begin (); i != level.end ();
-         ++i)
-        fb.insert (i.name (), i.channel ().slice ());
-
-    in.setFrameBuffer (fb);
+    in.setFrameBuffer (sampleCountFrameBuffer (level));
 
     {
         SampleCountChannel::Edit edit (level.sampleCounts ());
@@ -336,7 +421,20 @@ loadLevel (DeepTiledInputFile& in, DeepImage& img, int x, int y)
             0, in.numXTiles (x) - 1, 0, in.numYTiles (y) - 1, x, y);
     }
 
-    in.readTiles (0, in.numXTiles (x) - 1, 0, in.numYTiles (y) - 1, x, y);
+    //
+    // One row of tiles at a time.
+    //
+
+    SampleListPointers pointers;
+
+    for (int dy = 0; dy < in.numYTiles (y); ++dy)
+    {
+        Box2i tw = in.dataWindowForTile (0, dy, x, y);
+
+        in.setFrameBuffer (
+            bandFrameBuffer (level, pointers, tw.min.y, tw.max.y));
+        in.readTiles (0, in.numXTiles (x) - 1, dy, dy, x, y);
+    }
 }
 
 } // namespace
@@ -77,13 +77,17 @@ void
 DeepImageLevel::moveSamplesToNewBuffer (
     const unsigned int* oldNumSamples,
     const unsigned int* newNumSamples,
+    const size_t*       oldSampleListPositions,
     const size_t*       newSampleListPositions)
 {
     for (ChannelMap::iterator j = _channels.begin (); j != _channels.end ();
          ++j)
     {
         j->second->moveSamplesToNewBuffer (
-            oldNumSamples, newNumSamples, newSampleListPositions);
+            oldNumSamples,
+            newNumSamples,
+            oldSampleListPositions,
+            newSampleListPositions);
     }
 }
 
@@ -147,6 +147,7 @@ private:
     void moveSamplesToNewBuffer (
         const unsigned int* oldNumSamples,
         const unsigned int* newNumSamples,
+        const size_t*       oldSampleListPositions,
         const size_t*       newSampleListPositions);
 
     IMF_HIDDEN
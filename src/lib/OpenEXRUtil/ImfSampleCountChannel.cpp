@@ -204,7 +204,10 @@ SampleCountChannel::set (int x, int y, unsigned int newNumSamples)
         _sampleBufferSize = roundBufferSizeUp (_totalSamplesOccupied);
 
         deepLevel ().moveSamplesToNewBuffer (
-            oldNumSamples, _numSamples, _sampleListPositions);
+            oldNumSamples,
+            _numSamples,
+            oldSampleListPositions,
+            _sampleListPositions);
 
         delete[] oldNumSamples;
         delete[] oldSampleListPositions;
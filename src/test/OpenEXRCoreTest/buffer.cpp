@@ -12,6 +12,7 @@
 #include <openexr.h>
 
 #include "test_value.h"
+#include <string>
 #include <vector>
 
 void
@@ -35,4 +36,73 @@ testBufferCompression (const std::string& tempdir)
         nullptr, cbuf.data (), outsz, &buf[0], buf.size (), &outsz));
     std::cout << "uncompressed size: " << outsz << std::endl;
     if (buf[0] != 'O') EXRCORE_TEST_FAIL (buf[0] != 'O');
+
+    // the (de)compressor objects are re-used between calls
+    uint64_t hits0, misses0, hits1, misses1;
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_get_compression_cache_stats (nullptr, nullptr, nullptr));
+    EXRCORE_TEST_RVAL (
+        exr_get_compression_cache_stats (nullptr, &hits0, &misses0));
+    for (int i = 0; i < 4; ++i)
+    {
+        EXRCORE_TEST_RVAL (exr_compress_buffer (
+            nullptr,
+            9,
+            buf.data (),
+            buf.size (),
+            &cbuf[0],
+            cbuf.size (),
+            &outsz));
+        EXRCORE_TEST_RVAL (exr_uncompress_buffer (
+            nullptr, cbuf.data (), outsz, &buf[0], buf.size (), &outsz));
+    }
+    EXRCORE_TEST_RVAL (
+        exr_get_compression_cache_stats (nullptr, &hits1, &misses1));
+    EXRCORE_TEST (hits1 - hits0 == 8);
+    EXRCORE_TEST (misses1 == misses0);
+
+    // objects for sizes that stop being requested age out of the pool
+    // instead of blocking re-use of everything else
+    std::vector<char> zbuf (2048, 'x'), zcbuf (4096);
+    for (int sz = 1000; sz < 1040; ++sz)
+        exr_compress_zstd_chunk (
+            zbuf.data (), sz, zcbuf.data (), zcbuf.size ());
+    EXRCORE_TEST_RVAL (
+        exr_get_compression_cache_stats (nullptr, &hits0, &misses0));
+    for (int i = 0; i < 2; ++i)
+    {
+        EXRCORE_TEST_RVAL (exr_compress_buffer (
+            nullptr,
+            9,
+            buf.data (),
+            buf.size (),
+            &cbuf[0],
+            cbuf.size (),
+            &outsz));
+        EXRCORE_TEST_RVAL (exr_uncompress_buffer (
+            nullptr, cbuf.data (), outsz, &buf[0], buf.size (), &outsz));
+    }
+    exr_compress_zstd_chunk (zbuf.data (), 1039, zcbuf.data (), zcbuf.size ());
+    EXRCORE_TEST_RVAL (
+        exr_get_compression_cache_stats (nullptr, &hits1, &misses1));
+    EXRCORE_TEST (hits1 - hits0 == 5);
+    EXRCORE_TEST (misses1 == misses0);
+
+    exr_context_t             f;
+    std::string               fn    = ILM_IMF_TEST_IMAGEDIR;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    fn += "comp_zip.exr";
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+    for (int i = 0; i < 3; ++i)
+    {
+        EXRCORE_TEST_RVAL (exr_compress_buffer (
+            f, 4, buf.data (), buf.size (), &cbuf[0], cbuf.size (), &outsz));
+        EXRCORE_TEST_RVAL (exr_uncompress_buffer (
+            f, cbuf.data (), outsz, &buf[0], buf.size (), &outsz));
+    }
+    EXRCORE_TEST_RVAL (exr_get_compression_cache_stats (f, &hits1, &misses1));
+    EXRCORE_TEST (hits1 == 4);
+    EXRCORE_TEST (misses1 == 2);
+    exr_finish (&f);
 }
@@ -34,6 +34,7 @@
 #include <ImfHuf.h>
 #include <ImfInputFile.h>
 #include <ImfOutputFile.h>
+#include <ImfStandardAttributes.h>
 #include <ImfTiledOutputFile.h>
 #include <half.h>
 #ifdef __linux
@@ -462,6 +463,53 @@ struct pixels
         }
     }
 
+    //
+    // Float bit patterns around the edges of the PXR24 conversion (FLT_MAX,
+    // values which round into the exponent of infinity, infinities, NaNs
+    // which lose their payload, denormals), and half values which B44 and
+    // DWA treat specially, mixed with random bits so every SIMD lane and
+    // the scalar tails see them
+    //
+
+    void fillSpecial ()
+    {
+        static const uint32_t fbits[] = {
+            0x00000000, 0x80000000, 0x00000001, 0x807fff80, 0x3f8000ff,
+            0x3f80ff80, 0x7f7fffff, 0xff7fffff, 0x7f7fff80, 0x7f7fff7f,
+            0x7f800000, 0xff800000, 0x7fc00000, 0x7f800001, 0xff800080,
+            0x7fffffff};
+        static const uint16_t hbits[] = {
+            0x0000, 0x8000, 0x0001, 0x83ff, 0x3c00, 0x7bff,
+            0xfbff, 0x7c00, 0xfc00, 0x7e00, 0x7c01, 0xfe01};
+        const int nf = sizeof (fbits) / sizeof (fbits[0]);
+        const int nh = sizeof (hbits) / sizeof (hbits[0]);
+        Rand48    rand;
+
+        for (int y = 0; y < _h; ++y)
+        {
+            for (int x = 0; x < _w; ++x)
+            {
+                size_t idx = y * _stride_x + x;
+                i[idx]     = rand.nexti ();
+                h[idx]     = (rand.nexti () & 1)
+                                 ? hbits[rand.nexti () % nh]
+                                 : (uint16_t) (rand.nexti ());
+                for (int c = 0; c < 4; ++c)
+                    rgba[c][idx] = hbits[rand.nexti () % nh];
+
+                union
+                {
+                    uint32_t i;
+                    float    f;
+                } u;
+                u.i = (rand.nexti () & 1) ? fbits[rand.nexti () % nf]
+                                          : (uint32_t) rand.nexti ();
+
+                f[idx] = u.f;
+            }
+        }
+    }
+
     static inline void compareExact (
         uint16_t    a,
         uint16_t    b,
@@ -1487,7 +1535,8 @@ testComp (const std::string& tempdir, exr_compression_t comp)
     p.fillPattern2 ();
     testWriteRead (p, tempdir, comp, "pattern2");
     p.fillRandom ();
-    testWriteRead (p, tempdir, comp, "random");
+    testWriteRead (p, tempdir, comp, "random");    p.fillSpecial ();
+    testWriteRead (p, tempdir, comp, "special");
 }
 
 ////////////////////////////////////////
@@ -1549,7 +1598,8 @@ testHUF (const std::string& tempdir)
         decode.h.data (),
         IMG_WIDTH,
         hspare.data (),
-        dsize));
+        dsize,
+        0));
     for (size_t i = 0; i < IMG_WIDTH; ++i)
     {
         EXRCORE_TEST (decode.h[i] == p.h[i]);
@@ -1584,7 +1634,8 @@ testHUF (const std::string& tempdir)
         decode.h.data (),
         IMG_WIDTH,
         hspare.data (),
-        dsize));
+        dsize,
+        0));
     for (size_t i = 0; i < IMG_WIDTH; ++i)
     {
         EXRCORE_TEST (decode.h[i] == p.h[i]);
@@ -1619,7 +1670,68 @@ testHUF (const std::string& tempdir)
         decode.h.data (),
         IMG_WIDTH,
         hspare.data (),
-        dsize));
+        dsize,
+        0));
+    for (size_t i = 0; i < IMG_WIDTH; ++i)
+    {
+        EXRCORE_TEST (decode.h[i] == p.h[i]);
+    }
+
+    // the same code table again, reusing the decoding tables
+    decode.fillZero ();
+    EXRCORE_TEST_RVAL (internal_huf_decompress (
+        NULL,
+        encoded.data (),
+        ebytes,
+        decode.h.data (),
+        IMG_WIDTH,
+        hspare.data (),
+        dsize,
+        1));
+    for (size_t i = 0; i < IMG_WIDTH; ++i)
+    {
+        EXRCORE_TEST (decode.h[i] == p.h[i]);
+    }
+
+    // and a different one, which has to rebuild them (encoding with
+    // other spare bytes, as it would go over the tables)
+    std::vector<uint8_t> espare (esize);
+    p.fillPattern2 ();
+    EXRCORE_TEST_RVAL (internal_huf_compress (
+        &ebytes,
+        encoded.data (),
+        encoded.size (),
+        p.h.data (),
+        IMG_WIDTH,
+        espare.data (),
+        esize));
+    EXRCORE_TEST_RVAL (internal_huf_decompress (
+        NULL,
+        encoded.data (),
+        ebytes,
+        decode.h.data (),
+        IMG_WIDTH,
+        hspare.data (),
+        dsize,
+        1));
+    for (size_t i = 0; i < IMG_WIDTH; ++i)
+    {
+        EXRCORE_TEST (decode.h[i] == p.h[i]);
+    }
+
+    // a newly allocated spare buffer holds garbage until cleared
+    std::vector<uint8_t> fresh (dsize, 0xa5);
+    internal_huf_decompress_clear_tables (fresh.data ());
+    decode.fillZero ();
+    EXRCORE_TEST_RVAL (internal_huf_decompress (
+        NULL,
+        encoded.data (),
+        ebytes,
+        decode.h.data (),
+        IMG_WIDTH,
+        fresh.data (),
+        dsize,
+        1));
     for (size_t i = 0; i < IMG_WIDTH; ++i)
     {
         EXRCORE_TEST (decode.h[i] == p.h[i]);
@@ -1688,10 +1800,167 @@ testDWABCompression (const std::string& tempdir)
     testComp (tempdir, EXR_COMPRESSION_DWAB);
 }
 
+static void
+writeZstdFile (
+    const std::string& fn, int linesPerChunk, const Array2D<half>& px)
+{
+    Header hdr (px.width (), px.height ());
+    hdr.compression () = ZSTD_COMPRESSION;
+    hdr.channels ().insert ("Y", Channel (IMF::HALF));
+    if (linesPerChunk > 0) addZstdLinesPerChunk (hdr, linesPerChunk);
+
+    FrameBuffer fb;
+    fb.insert (
+        "Y",
+        Slice (
+            IMF::HALF,
+            (char*) &px[0][0],
+            sizeof (half),
+            sizeof (half) * px.width ()));
+
+    OutputFile out (fn.c_str (), hdr);
+    out.setFrameBuffer (fb);
+    out.writePixels (static_cast<int> (px.height ()));
+}
+
+static void
+checkZstdFile (
+    const std::string& fn, int linesPerChunk, const Array2D<half>& px)
+{
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    int32_t                   lines, chunks;
+
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+    EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &lines));
+    EXRCORE_TEST_RVAL (exr_get_chunk_count (f, 0, &chunks));
+    EXRCORE_TEST (lines == linesPerChunk);
+    EXRCORE_TEST (
+        chunks == (static_cast<int32_t> (px.height ()) + lines - 1) / lines);
+    exr_finish (&f);
+
+    Array2D<half> restore (px.height (), px.width ());
+    InputFile     in (fn.c_str ());
+    FrameBuffer   fb;
+    fb.insert (
+        "Y",
+        Slice (
+            IMF::HALF,
+            (char*) &restore[0][0],
+            sizeof (half),
+            sizeof (half) * px.width ()));
+    in.setFrameBuffer (fb);
+    in.readPixels (0, static_cast<int> (px.height ()) - 1);
+
+    for (long y = 0; y < px.height (); ++y)
+        for (long x = 0; x < px.width (); ++x)
+            EXRCORE_TEST (restore[y][x].bits () == px[y][x].bits ());
+}
+
+//
+// Check the payload of every chunk: a serialized blosc2 frame, as
+// written by every release, or a bare blosc2 chunk for parts that
+// opted in to more than one line per chunk. For single line chunks,
+// the payload has to match exr_compress_zstd () byte for byte.
+//
+static void
+checkZstdChunks (const std::string& fn, bool framed, const Array2D<half>& px)
+{
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    exr_attr_box2i_t          dw;
+    int32_t                   lines;
+
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+    EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+    EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &lines));
+
+    for (int y = dw.min.y; y <= dw.max.y; y += lines)
+    {
+        exr_chunk_info_t cinfo;
+        EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+
+        std::vector<uint8_t> packed (cinfo.packed_size);
+        EXRCORE_TEST_RVAL (exr_read_chunk (f, 0, &cinfo, packed.data ()));
+
+        // stored raw when it does not compress
+        if (cinfo.packed_size == cinfo.unpacked_size) continue;
+
+        bool isFrame = packed.size () > 9 &&
+                       memcmp (packed.data () + 2, "b2frame", 7) == 0;
+        EXRCORE_TEST (isFrame == framed);
+
+        if (lines == 1)
+        {
+            std::vector<char> raw, expected (cinfo.unpacked_size);
+            for (long x = 0; x < px.width (); ++x)
+            {
+                uint16_t bits = px[y - dw.min.y][x].bits ();
+                raw.push_back (static_cast<char> (bits & 0xff));
+                raw.push_back (static_cast<char> (bits >> 8));
+            }
+            EXRCORE_TEST (raw.size () == cinfo.unpacked_size);
+
+            long n = exr_compress_zstd (
+                raw.data (),
+                static_cast<int> (raw.size ()),
+                expected.data (),
+                static_cast<int> (expected.size ()));
+            EXRCORE_TEST (n == static_cast<long> (packed.size ()));
+            EXRCORE_TEST (
+                memcmp (expected.data (), packed.data (), packed.size ()) ==
+                0);
+        }
+    }
+    exr_finish (&f);
+}
+
+static void
+testZstdLinesPerChunk (const std::string& tempdir)
+{
+    std::string   fn = tempdir + "imf_test_zstd_lines.exr";
+    Array2D<half> px (70, 37);
+
+    for (long y = 0; y < px.height (); ++y)
+        for (long x = 0; x < px.width (); ++x)
+            px[y][x] = half (static_cast<float> (x * y % 61));
+
+    // by default, files keep the layout earlier releases wrote and
+    // read: no attribute, one line per chunk, each one a blosc2 frame
+    writeZstdFile (fn, 0, px);
+    {
+        exr_context_t             f;
+        exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+        int32_t                   attrv;
+
+        EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+        EXRCORE_TEST_RVAL_FAIL (
+            EXR_ERR_NO_ATTR_BY_NAME,
+            exr_attr_get_int (f, 0, "zstdLinesPerChunk", &attrv));
+        exr_finish (&f);
+    }
+    EXRCORE_TEST (exr_get_zstd_lines_per_chunk () == 1);
+    checkZstdFile (fn, 1, px);
+    checkZstdChunks (fn, true, px);
+
+    // asking for one line per chunk changes nothing but the header
+    writeZstdFile (fn, 1, px);
+    checkZstdFile (fn, 1, px);
+    checkZstdChunks (fn, true, px);
+
+    // taller chunks are opt-in, and stored as bare blosc2 chunks
+    writeZstdFile (fn, 16, px);
+    checkZstdFile (fn, 16, px);
+    checkZstdChunks (fn, false, px);
+
+    remove (fn.c_str ());
+}
+
 void
 testZstdCompression (const std::string& tempdir)
 {
     testComp (tempdir, EXR_COMPRESSION_ZSTD);
+    testZstdLinesPerChunk (tempdir);
 }
 
 void
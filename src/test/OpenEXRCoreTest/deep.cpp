@@ -463,6 +463,19 @@ testReadDeep (const std::string& tempdir)
                 EXRCORE_TEST (packed.size () == (sampcount[N - 1]) * bps);
             }
 
+            // the index only knows the extent of the table and data
+            int32_t                       ccount;
+            std::vector<exr_chunk_info_t> index;
+            EXRCORE_TEST_RVAL (exr_get_chunk_index (f, 0, &ccount, NULL));
+            index.resize (ccount);
+            EXRCORE_TEST_RVAL (
+                exr_get_chunk_index (f, 0, &ccount, index.data ()));
+            EXRCORE_TEST (
+                index[cinfo.idx].data_offset == cinfo.sample_count_data_offset);
+            EXRCORE_TEST (
+                index[cinfo.idx].packed_size ==
+                cinfo.sample_count_table_size + cinfo.packed_size);
+
             EXRCORE_TEST_RVAL (
                 exr_read_scanline_chunk_info (f, 0, minY + height / 4, &cinfo));
             packed.resize (cinfo.packed_size);
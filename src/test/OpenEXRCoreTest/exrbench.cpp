@@ -0,0 +1,904 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright Contributors to the OpenEXR Project.
+
+//
+// exrbench: writes synthetic images for every combination of
+// compression, pixel type, storage (scanline, tiled, deep scanline,
+// deep tiled), image content and thread count, reads them back
+// through the core decode pipeline, and reports throughput, peak
+// memory and the time spent in each decode stage as JSON.
+//
+// Writing goes through the C++ library (so it exercises the global
+// thread pool), reading uses one core decode pipeline per thread,
+// with the read, decompress and unpack steps of the pipeline timed
+// separately.
+//
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#    include <windows.h>
+#    include <psapi.h>
+#else
+#    include <sys/resource.h>
+#endif
+
+#include <ImfChannelList.h>
+#include <ImfCompression.h>
+#include <ImfDeepFrameBuffer.h>
+#include <ImfDeepScanLineOutputFile.h>
+#include <ImfDeepTiledOutputFile.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfOutputFile.h>
+#include <ImfPartType.h>
+#include <ImfThreading.h>
+#include <ImfTiledOutputFile.h>
+#include <half.h>
+#include <openexr.h>
+
+using namespace OPENEXR_IMF_NAMESPACE;
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+const char* const kChannels[] = {"R", "G", "B", "A"};
+const int         kNumChannels = 4;
+const int         kTileSize    = 64;
+
+enum Storage
+{
+    SCANLINE,
+    TILED,
+    DEEP_SCANLINE,
+    DEEP_TILED,
+    NUM_STORAGE
+};
+
+const char* const kStorageNames[] = {
+    "scanline", "tiled", "deep_scanline", "deep_tiled"};
+
+const char* const kTypeNames[] = {"uint", "half", "float"};
+
+enum Content
+{
+    RAMP,
+    MATTE,
+    ID,
+    NUM_CONTENT
+};
+
+const char* const kContentNames[] = {"ramp", "matte", "id"};
+
+struct Config
+{
+    Storage     storage;
+    Compression compression;
+    PixelType   type;
+    Content     content;
+    int         threads;
+};
+
+struct Result
+{
+    uint64_t rawBytes   = 0;
+    uint64_t fileBytes  = 0;
+    uint64_t chunks     = 0;
+    double   writeSecs  = 0;
+    double   readSecs   = 0;
+    uint64_t readNs     = 0;
+    uint64_t decompNs   = 0;
+    uint64_t unpackNs   = 0;
+    uint64_t peakRssKiB = 0;
+    bool     ok         = true;
+};
+
+size_t
+typeSize (PixelType t)
+{
+    return t == HALF ? 2 : 4;
+}
+
+bool
+isDeep (Storage s)
+{
+    return s == DEEP_SCANLINE || s == DEEP_TILED;
+}
+
+bool
+isTiled (Storage s)
+{
+    return s == TILED || s == DEEP_TILED;
+}
+
+uint64_t
+peakRssKiB ()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo (GetCurrentProcess (), &pmc, sizeof (pmc)))
+        return pmc.PeakWorkingSetSize / 1024;
+    return 0;
+#else
+    struct rusage ru;
+    if (getrusage (RUSAGE_SELF, &ru) != 0) return 0;
+#    ifdef __APPLE__
+    return uint64_t (ru.ru_maxrss) / 1024;
+#    else
+    return uint64_t (ru.ru_maxrss);
+#    endif
+#endif
+}
+
+void
+error_handler (exr_const_context_t file, int code, const char* msg)
+{
+    std::cerr << "Core EXR ERROR (" << code << "): " << msg << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////
+// synthetic images
+////////////////////////////////////////////////////////////////////////
+
+unsigned
+hashValue (unsigned a, unsigned b, unsigned c)
+{
+    unsigned n = a * 73856093u ^ b * 19349663u ^ c * 83492791u;
+    return (n ^ (n >> 13)) * 1274126177u;
+}
+
+//
+// ramp: smooth ramps with a little noise, so every codec has something
+// to work with but nothing compresses to nothing
+//
+// matte: a few discs per channel, exactly 0 or 1 apart from a one
+// pixel antialiased edge, like a holdout or object matte
+//
+// id: small integers constant over irregular regions, like an object
+// or material ID pass
+//
+
+float
+sampleValue (Content content, int x, int y, int c, int s, int w, int h)
+{
+    switch (content)
+    {
+        case MATTE: {
+            float v = 0.f;
+            for (unsigned i = 0; i < 3; ++i)
+            {
+                unsigned n  = hashValue (i, unsigned (c), 1u);
+                float    dx = float (x) - float (n % unsigned (w));
+                float    dy = float (y) - float ((n >> 12) % unsigned (h));
+                float    r  = float (std::min (w, h)) / 8.f *
+                          (1.f + float (n >> 24) / 256.f);
+                float e = r - std::sqrt (dx * dx + dy * dy);
+                v       = std::max (v, std::min (std::max (e, 0.f), 1.f));
+            }
+            return v;
+        }
+        case ID: {
+            // cells of a jittered grid, so the edges are not aligned
+            // with the chunks
+            int      jx = int (hashValue (unsigned (y / 8), 0u, 2u) % 16u);
+            int      jy = int (hashValue (unsigned (x / 8), 0u, 3u) % 16u);
+            unsigned n  = hashValue (
+                unsigned ((x + jx) / 48), unsigned ((y + jy) / 32), 4u);
+            return c == 3 ? 1.f : float ((n >> 8) % 1000u);
+        }
+        default: break;
+    }
+
+    unsigned n = hashValue (unsigned (x), unsigned (y), unsigned (c * 4 + s));
+    return 0.25f * float (c + 1) * float (x) / float (w) +
+           0.5f * float (y) / float (h) + float (n >> 24) / 2048.f;
+}
+
+void
+storeValue (char* p, PixelType t, float v)
+{
+    switch (t)
+    {
+        case HALF: *reinterpret_cast<half*> (p) = half (v); break;
+        case FLOAT: *reinterpret_cast<float*> (p) = v; break;
+        default:
+            *reinterpret_cast<unsigned int*> (p) = unsigned (v * 1000.f);
+            break;
+    }
+}
+
+int
+deepSampleCount (int x, int y)
+{
+    return (x * 7 + y * 13) % 4;
+}
+
+//
+// the compressions deep images can be benchmarked with: the ones the
+// C++ library writes deep data with which the core can also read
+//
+
+bool
+deepCompression (Compression c)
+{
+    return isValidDeepCompression (c) &&
+           (c == NO_COMPRESSION || c == RLE_COMPRESSION ||
+            c == ZIPS_COMPRESSION);
+}
+
+Header
+makeHeader (const Config& cfg, int w, int h)
+{
+    Header hdr (w, h);
+    hdr.compression () = cfg.compression;
+    for (const char* c: kChannels)
+        hdr.channels ().insert (c, Channel (cfg.type));
+    if (isTiled (cfg.storage))
+        hdr.setTileDescription (
+            TileDescription (kTileSize, kTileSize, ONE_LEVEL));
+    return hdr;
+}
+
+//
+// write the image, returning the number of bytes of pixel data
+//
+
+uint64_t
+writeFlat (const std::string& fn, const Config& cfg, int w, int h)
+{
+    size_t            ts  = typeSize (cfg.type);
+    size_t            bpp = ts * kNumChannels;
+    std::vector<char> pixels (bpp * size_t (w) * size_t (h));
+
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+            for (int c = 0; c < kNumChannels; ++c)
+                storeValue (
+                    &pixels[(size_t (y) * w + x) * bpp + c * ts],
+                    cfg.type,
+                    sampleValue (cfg.content, x, y, c, 0, w, h));
+
+    FrameBuffer fb;
+    for (int c = 0; c < kNumChannels; ++c)
+        fb.insert (
+            kChannels[c],
+            Slice (cfg.type, &pixels[c * ts], bpp, bpp * size_t (w)));
+
+    Header hdr = makeHeader (cfg, w, h);
+    if (cfg.storage == TILED)
+    {
+        TiledOutputFile out (fn.c_str (), hdr);
+        out.setFrameBuffer (fb);
+        out.writeTiles (0, out.numXTiles () - 1, 0, out.numYTiles () - 1);
+    }
+    else
+    {
+        OutputFile out (fn.c_str (), hdr);
+        out.setFrameBuffer (fb);
+        out.writePixels (h);
+    }
+    return pixels.size ();
+}
+
+uint64_t
+writeDeep (const std::string& fn, const Config& cfg, int w, int h)
+{
+    size_t                    ts = typeSize (cfg.type);
+    size_t                    np = size_t (w) * size_t (h);
+    std::vector<unsigned int> counts (np);
+    size_t                    total = 0;
+
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+        {
+            counts[size_t (y) * w + x] = deepSampleCount (x, y);
+            total += counts[size_t (y) * w + x];
+        }
+
+    // one sample array per channel, and per pixel pointers into them
+    std::vector<std::vector<char>>  samples (kNumChannels);
+    std::vector<std::vector<char*>> pointers (kNumChannels);
+    for (int c = 0; c < kNumChannels; ++c)
+    {
+        samples[c].resize (std::max (total, size_t (1)) * ts);
+        pointers[c].resize (np);
+
+        char* p = samples[c].data ();
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x)
+            {
+                pointers[c][size_t (y) * w + x] = p;
+                for (int s = 0; s < deepSampleCount (x, y); ++s, p += ts)
+                    storeValue (
+                        p,
+                        cfg.type,
+                        sampleValue (cfg.content, x, y, c, s, w, h));
+            }
+    }
+
+    DeepFrameBuffer fb;
+    fb.insertSampleCountSlice (Slice (
+        UINT,
+        (char*) counts.data (),
+        sizeof (unsigned int),
+        sizeof (unsigned int) * size_t (w)));
+    for (int c = 0; c < kNumChannels; ++c)
+        fb.insert (
+            kChannels[c],
+            DeepSlice (
+                cfg.type,
+                (char*) pointers[c].data (),
+                sizeof (char*),
+                sizeof (char*) * size_t (w),
+                ts));
+
+    Header hdr = makeHeader (cfg, w, h);
+    if (cfg.storage == DEEP_TILED)
+    {
+        hdr.setType (DEEPTILE);
+        DeepTiledOutputFile out (fn.c_str (), hdr);
+        out.setFrameBuffer (fb);
+        out.writeTiles (0, out.numXTiles () - 1, 0, out.numYTiles () - 1);
+    }
+    else
+    {
+        hdr.setType (DEEPSCANLINE);
+        DeepScanLineOutputFile out (fn.c_str (), hdr);
+        out.setFrameBuffer (fb);
+        out.writePixels (h);
+    }
+    return total * ts * kNumChannels;
+}
+
+////////////////////////////////////////////////////////////////////////
+// timed reading
+////////////////////////////////////////////////////////////////////////
+
+//
+// per thread state, hung off the pipeline's decoding_user_data so the
+// timing wrappers below can find the real stage functions
+//
+
+struct Worker
+{
+    exr_result_t (*read_fn) (exr_decode_pipeline_t*);
+    exr_result_t (*decompress_fn) (exr_decode_pipeline_t*);
+    exr_result_t (*unpack_fn) (exr_decode_pipeline_t*);
+
+    uint64_t             readNs   = 0;
+    uint64_t             decompNs = 0;
+    uint64_t             unpackNs = 0;
+    std::vector<uint8_t> deepSamples;
+};
+
+uint64_t
+elapsedNs (Clock::time_point start)
+{
+    return uint64_t (std::chrono::duration_cast<std::chrono::nanoseconds> (
+                         Clock::now () - start)
+                         .count ());
+}
+
+exr_result_t
+timed_read (exr_decode_pipeline_t* decode)
+{
+    Worker*      w     = static_cast<Worker*> (decode->decoding_user_data);
+    auto         start = Clock::now ();
+    exr_result_t rv    = w->read_fn (decode);
+    w->readNs += elapsedNs (start);
+    return rv;
+}
+
+exr_result_t
+timed_decompress (exr_decode_pipeline_t* decode)
+{
+    Worker*      w     = static_cast<Worker*> (decode->decoding_user_data);
+    auto         start = Clock::now ();
+    exr_result_t rv    = w->decompress_fn (decode);
+    w->decompNs += elapsedNs (start);
+    return rv;
+}
+
+exr_result_t
+timed_unpack (exr_decode_pipeline_t* decode)
+{
+    Worker*      w     = static_cast<Worker*> (decode->decoding_user_data);
+    auto         start = Clock::now ();
+    exr_result_t rv    = w->unpack_fn (decode);
+    w->unpackNs += elapsedNs (start);
+    return rv;
+}
+
+//
+// deep chunks only know how many samples they hold once the sample
+// count table is decoded, which is when this is called
+//
+
+exr_result_t
+deep_realloc (exr_decode_pipeline_t* decode)
+{
+    Worker* w     = static_cast<Worker*> (decode->decoding_user_data);
+    size_t  total = 0;
+    for (int y = 0; y < decode->chunk.height; ++y)
+        total += size_t (
+            decode->sample_count_table[(y + 1) * decode->chunk.width - 1]);
+
+    size_t bytes = 0;
+    for (int c = 0; c < decode->channel_count; ++c)
+        bytes += total * decode->channels[c].bytes_per_element;
+    if (w->deepSamples.size () < bytes) w->deepSamples.resize (bytes);
+
+    uint8_t* p = w->deepSamples.data ();
+    for (int c = 0; c < decode->channel_count; ++c)
+    {
+        exr_coding_channel_info_t& ch = decode->channels[c];
+        ch.decode_to_ptr              = total ? p : NULL;
+        ch.user_bytes_per_element     = ch.bytes_per_element;
+        ch.user_data_type             = ch.data_type;
+        p += total * ch.bytes_per_element;
+    }
+    return EXR_ERR_SUCCESS;
+}
+
+struct ReadJob
+{
+    exr_context_t                 f;
+    bool                          deep;
+    std::vector<exr_chunk_info_t> chunks;
+    uint8_t*                      image;
+    size_t                        lineBytes;
+    size_t                        pixelBytes;
+    int                           minX, minY;
+    std::atomic<size_t>           next{0};
+    std::atomic<bool>             failed{false};
+};
+
+void
+readChunks (ReadJob& job, Worker& w)
+{
+    exr_decode_pipeline_t decode = EXR_DECODE_PIPELINE_INITIALIZER;
+    bool                  init   = false;
+    exr_result_t          rv     = EXR_ERR_SUCCESS;
+
+    for (size_t i = job.next++; i < job.chunks.size (); i = job.next++)
+    {
+        const exr_chunk_info_t& cinfo = job.chunks[i];
+
+        if (!init)
+            rv = exr_decoding_initialize (job.f, 0, &cinfo, &decode);
+        else
+            rv = exr_decoding_update (job.f, 0, &cinfo, &decode);
+        if (rv != EXR_ERR_SUCCESS) break;
+        init                       = true;
+        decode.decoding_user_data = &w;
+
+        if (!job.deep)
+        {
+            uint8_t* p = job.image +
+                         size_t (cinfo.start_y - job.minY) * job.lineBytes +
+                         size_t (cinfo.start_x - job.minX) * job.pixelBytes;
+            for (int c = 0; c < decode.channel_count; ++c)
+            {
+                exr_coding_channel_info_t& ch = decode.channels[c];
+                ch.decode_to_ptr              = p;
+                ch.user_pixel_stride          = int32_t (job.pixelBytes);
+                ch.user_line_stride           = int32_t (job.lineBytes);
+                ch.user_bytes_per_element     = ch.bytes_per_element;
+                ch.user_data_type             = ch.data_type;
+                p += ch.bytes_per_element;
+            }
+        }
+
+        rv = exr_decoding_choose_default_routines (job.f, 0, &decode);
+        if (rv != EXR_ERR_SUCCESS) break;
+
+        w.read_fn          = decode.read_fn;
+        w.decompress_fn    = decode.decompress_fn;
+        w.unpack_fn        = decode.unpack_and_convert_fn;
+        decode.read_fn     = &timed_read;
+        if (decode.decompress_fn) decode.decompress_fn = &timed_decompress;
+        if (decode.unpack_and_convert_fn)
+            decode.unpack_and_convert_fn = &timed_unpack;
+        if (job.deep) decode.realloc_nonimage_data_fn = &deep_realloc;
+
+        rv = exr_decoding_run (job.f, 0, &decode);
+        if (rv != EXR_ERR_SUCCESS) break;
+    }
+
+    if (rv != EXR_ERR_SUCCESS) job.failed = true;
+    exr_decoding_destroy (job.f, &decode);
+}
+
+bool
+collectChunks (exr_context_t f, Storage storage, ReadJob& job)
+{
+    exr_attr_box2i_t dw;
+    if (exr_get_data_window (f, 0, &dw) != EXR_ERR_SUCCESS) return false;
+
+    exr_chunk_info_t cinfo;
+    if (isTiled (storage))
+    {
+        uint32_t tx, ty;
+        if (exr_get_tile_descriptor (f, 0, &tx, &ty, NULL, NULL) !=
+            EXR_ERR_SUCCESS)
+            return false;
+        int nx = int ((dw.max.x - dw.min.x + tx) / tx);
+        int ny = int ((dw.max.y - dw.min.y + ty) / ty);
+        for (int y = 0; y < ny; ++y)
+            for (int x = 0; x < nx; ++x)
+            {
+                if (exr_read_tile_chunk_info (f, 0, x, y, 0, 0, &cinfo) !=
+                    EXR_ERR_SUCCESS)
+                    return false;
+                job.chunks.push_back (cinfo);
+            }
+    }
+    else
+    {
+        int32_t lines;
+        if (exr_get_scanlines_per_chunk (f, 0, &lines) != EXR_ERR_SUCCESS)
+            return false;
+        for (int y = dw.min.y; y <= dw.max.y; y += lines)
+        {
+            if (exr_read_scanline_chunk_info (f, 0, y, &cinfo) !=
+                EXR_ERR_SUCCESS)
+                return false;
+            job.chunks.push_back (cinfo);
+        }
+    }
+    job.minX = dw.min.x;
+    job.minY = dw.min.y;
+    return true;
+}
+
+bool
+readFile (const std::string& fn, const Config& cfg, int w, int h, Result& r)
+{
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &error_handler;
+
+    auto start = Clock::now ();
+    if (exr_start_read (&f, fn.c_str (), &cinit) != EXR_ERR_SUCCESS)
+        return false;
+
+    ReadJob job;
+    job.f          = f;
+    job.deep       = isDeep (cfg.storage);
+    job.pixelBytes = typeSize (cfg.type) * kNumChannels;
+    job.lineBytes  = job.pixelBytes * size_t (w);
+
+    std::vector<uint8_t> image;
+    if (!job.deep) image.resize (job.lineBytes * size_t (h));
+    job.image = image.data ();
+
+    bool ok = collectChunks (f, cfg.storage, job);
+
+    std::vector<Worker> workers (cfg.threads);
+    if (ok)
+    {
+        std::vector<std::thread> threads;
+        for (int t = 1; t < cfg.threads; ++t)
+            threads.emplace_back (readChunks, std::ref (job), std::ref (workers[t]));
+        readChunks (job, workers[0]);
+        for (auto& t: threads)
+            t.join ();
+        ok = !job.failed;
+    }
+
+    exr_finish (&f);
+    r.readSecs = std::chrono::duration<double> (Clock::now () - start).count ();
+
+    r.chunks   = job.chunks.size ();
+    r.readNs   = 0;
+    r.decompNs = 0;
+    r.unpackNs = 0;
+    for (auto& wk: workers)
+    {
+        r.readNs += wk.readNs;
+        r.decompNs += wk.decompNs;
+        r.unpackNs += wk.unpackNs;
+    }
+    return ok;
+}
+
+uint64_t
+fileSize (const std::string& fn)
+{
+    std::ifstream in (fn.c_str (), std::ios::binary | std::ios::ate);
+    return in ? uint64_t (in.tellg ()) : 0;
+}
+
+Result
+runConfig (
+    const Config& cfg, int w, int h, int iterations, const std::string& fn)
+{
+    Result r;
+
+    setGlobalThreadCount (cfg.threads > 1 ? cfg.threads : 0);
+
+    // keep the fastest of the iterations, for both writing and reading
+    for (int i = 0; i < iterations; ++i)
+    {
+        auto     start = Clock::now ();
+        uint64_t raw   = isDeep (cfg.storage) ? writeDeep (fn, cfg, w, h)
+                                              : writeFlat (fn, cfg, w, h);
+        double secs =
+            std::chrono::duration<double> (Clock::now () - start).count ();
+        if (i == 0 || secs < r.writeSecs) r.writeSecs = secs;
+        r.rawBytes  = raw;
+        r.fileBytes = fileSize (fn);
+
+        Result rr;
+        if (!readFile (fn, cfg, w, h, rr)) r.ok = false;
+        if (i == 0 || rr.readSecs < r.readSecs)
+        {
+            r.readSecs = rr.readSecs;
+            r.chunks   = rr.chunks;
+            r.readNs   = rr.readNs;
+            r.decompNs = rr.decompNs;
+            r.unpackNs = rr.unpackNs;
+        }
+    }
+
+    r.peakRssKiB = peakRssKiB ();
+    remove (fn.c_str ());
+    return r;
+}
+
+////////////////////////////////////////////////////////////////////////
+// reporting
+////////////////////////////////////////////////////////////////////////
+
+void
+writeJson (
+    std::ostream& out, const Config& cfg, int w, int h, const Result& r)
+{
+    std::string comp;
+    getCompressionNameFromId (cfg.compression, comp);
+
+    double mb = double (r.rawBytes) / (1024.0 * 1024.0);
+    out << "    {\"storage\": \"" << kStorageNames[cfg.storage]
+        << "\", \"compression\": \"" << comp << "\", \"type\": \""
+        << kTypeNames[cfg.type] << "\", \"content\": \""
+        << kContentNames[cfg.content] << "\", \"threads\": " << cfg.threads
+        << ", \"width\": " << w << ", \"height\": " << h
+        << ", \"ok\": " << (r.ok ? "true" : "false")
+        << ", \"raw_bytes\": " << r.rawBytes
+        << ", \"file_bytes\": " << r.fileBytes << ", \"chunks\": " << r.chunks
+        << ", \"write_s\": " << r.writeSecs
+        << ", \"write_mb_s\": " << (r.writeSecs > 0 ? mb / r.writeSecs : 0)
+        << ", \"read_s\": " << r.readSecs
+        << ", \"read_mb_s\": " << (r.readSecs > 0 ? mb / r.readSecs : 0)
+        << ", \"read_chunks_s\": "
+        << (r.readSecs > 0 ? double (r.chunks) / r.readSecs : 0)
+        << ", \"stage_read_ms\": " << double (r.readNs) * 1e-6
+        << ", \"stage_decompress_ms\": " << double (r.decompNs) * 1e-6
+        << ", \"stage_unpack_ms\": " << double (r.unpackNs) * 1e-6
+        << ", \"peak_rss_kib\": " << r.peakRssKiB << "}";
+}
+
+bool
+parseList (const char* arg, std::vector<std::string>& out)
+{
+    std::stringstream ss (arg);
+    std::string       item;
+    out.clear ();
+    while (std::getline (ss, item, ','))
+        if (!item.empty ()) out.push_back (item);
+    return !out.empty ();
+}
+
+int
+usageAndExit (const char* argv0, int ec)
+{
+    std::cerr
+        << "Usage: " << argv0
+        << " [options]\n"
+           "\n"
+           "Writes and reads back synthetic RGBA images for every\n"
+           "combination of the options below, printing the results as JSON.\n"
+           "\n"
+           "  --width <n>, --height <n>   image size (default 1024 x 512)\n"
+           "  --threads <list>            thread counts (default 1,2,4,8)\n"
+           "  --compression <list>        compression names (default all)\n"
+           "  --type <list>               half,float,uint (default all)\n"
+           "  --content <list>            ramp,matte,id (default ramp)\n"
+           "  --storage <list>            scanline,tiled,deep_scanline,\n"
+           "                              deep_tiled (default all)\n"
+           "  --iterations <n>            best of n runs (default 3)\n"
+           "  --tmpdir <dir>              where to put the images\n"
+           "  --output <file>             write the JSON there, not stdout\n";
+    return ec;
+}
+
+} // namespace
+
+int
+main (int argc, char* argv[])
+{
+    int         w = 1024, h = 512, iterations = 3;
+    std::string outName;
+#ifdef _WIN32
+    std::string tmpdir = ".";
+#else
+    std::string tmpdir = getenv ("TMPDIR") ? getenv ("TMPDIR") : "/tmp";
+#endif
+
+    std::vector<int>         threadCounts = {1, 2, 4, 8};
+    std::vector<Compression> compressions;
+    std::vector<PixelType>   types = {HALF, FLOAT, UINT};
+    std::vector<Storage>     storages;
+    std::vector<Content>     contents = {RAMP};
+    std::vector<std::string> items;
+
+    for (int c = 0; c < NUM_COMPRESSION_METHODS; ++c)
+        compressions.push_back (Compression (c));
+    for (int s = 0; s < NUM_STORAGE; ++s)
+        storages.push_back (Storage (s));
+
+    for (int a = 1; a < argc; ++a)
+    {
+        bool        more = a + 1 < argc;
+        const char* arg  = argv[a];
+        if (!strcmp (arg, "-h") || !strcmp (arg, "--help"))
+            return usageAndExit (argv[0], 0);
+        else if (!strcmp (arg, "--width") && more)
+            w = atoi (argv[++a]);
+        else if (!strcmp (arg, "--height") && more)
+            h = atoi (argv[++a]);
+        else if (!strcmp (arg, "--iterations") && more)
+            iterations = atoi (argv[++a]);
+        else if (!strcmp (arg, "--tmpdir") && more)
+            tmpdir = argv[++a];
+        else if (!strcmp (arg, "--output") && more)
+            outName = argv[++a];
+        else if (!strcmp (arg, "--threads") && more)
+        {
+            parseList (argv[++a], items);
+            threadCounts.clear ();
+            for (auto& i: items)
+                threadCounts.push_back (atoi (i.c_str ()));
+        }
+        else if (!strcmp (arg, "--compression") && more)
+        {
+            parseList (argv[++a], items);
+            compressions.clear ();
+            for (auto& i: items)
+            {
+                Compression c;
+                getCompressionIdFromName (i, c);
+                if (c == NUM_COMPRESSION_METHODS)
+                {
+                    std::cerr << "Unknown compression '" << i << "'\n";
+                    return usageAndExit (argv[0], 1);
+                }
+                compressions.push_back (c);
+            }
+        }
+        else if (!strcmp (arg, "--type") && more)
+        {
+            parseList (argv[++a], items);
+            types.clear ();
+            for (auto& i: items)
+            {
+                int t = 0;
+                while (t < NUM_PIXELTYPES && i != kTypeNames[t])
+                    ++t;
+                if (t == NUM_PIXELTYPES)
+                {
+                    std::cerr << "Unknown pixel type '" << i << "'\n";
+                    return usageAndExit (argv[0], 1);
+                }
+                types.push_back (PixelType (t));
+            }
+        }
+        else if (!strcmp (arg, "--content") && more)
+        {
+            parseList (argv[++a], items);
+            contents.clear ();
+            for (auto& i: items)
+            {
+                int n = 0;
+                while (n < NUM_CONTENT && i != kContentNames[n])
+                    ++n;
+                if (n == NUM_CONTENT)
+                {
+                    std::cerr << "Unknown content '" << i << "'\n";
+                    return usageAndExit (argv[0], 1);
+                }
+                contents.push_back (Content (n));
+            }
+        }
+        else if (!strcmp (arg, "--storage") && more)
+        {
+            parseList (argv[++a], items);
+            storages.clear ();
+            for (auto& i: items)
+            {
+                int s = 0;
+                while (s < NUM_STORAGE && i != kStorageNames[s])
+                    ++s;
+                if (s == NUM_STORAGE)
+                {
+                    std::cerr << "Unknown storage '" << i << "'\n";
+                    return usageAndExit (argv[0], 1);
+                }
+                storages.push_back (Storage (s));
+            }
+        }
+        else
+            return usageAndExit (argv[0], 1);
+    }
+
+    for (int t: threadCounts)
+        if (t < 1) return usageAndExit (argv[0], 1);
+    if (w < 1 || h < 1 || iterations < 1) return usageAndExit (argv[0], 1);
+
+    std::ofstream fout;
+    if (!outName.empty ())
+    {
+        fout.open (outName.c_str ());
+        if (!fout)
+        {
+            std::cerr << "Unable to open '" << outName
+                      << "': " << strerror (errno) << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = outName.empty () ? std::cout : fout;
+
+    std::string fn = tmpdir + "/exrbench_tmp.exr";
+    bool        first = true, allOk = true;
+
+    out << "{\n  \"results\": [\n";
+    for (Storage s: storages)
+        for (Compression c: compressions)
+        {
+            if (isDeep (s) && !deepCompression (c)) continue;
+
+            for (PixelType t: types)
+                for (Content n: contents)
+                    for (int threads: threadCounts)
+                    {
+                        Config cfg = {s, c, t, n, threads};
+                        Result r;
+                        try
+                        {
+                            r = runConfig (cfg, w, h, iterations, fn);
+                        }
+                        catch (const std::exception& e)
+                        {
+                            std::cerr << "ERROR: " << e.what () << std::endl;
+                            r.ok = false;
+                            remove (fn.c_str ());
+                        }
+                        allOk = allOk && r.ok;
+
+                        if (!first) out << ",\n";
+                        first = false;
+                        writeJson (out, cfg, w, h, r);
+                        out.flush ();
+                    }
+        }
+    out << "\n  ]\n}\n";
+
+    setGlobalThreadCount (0);
+    return allOk ? 0 : 1;
+}
@@ -176,6 +176,11 @@ main (int argc, char* argv[])
     TEST (testReadMultiPart, "core_read");
     TEST (testReadDeep, "core_read");
     TEST (testReadUnpack, "core_read");
+    TEST (testReadMMap, "core_read");
+    TEST (testReadChunks, "core_read");
+    TEST (testReadChunkWithInfo, "core_read");
+    TEST (testChunkIndex, "core_read");
+    TEST (testReadAsync, "core_read");
 
     TEST (testWriteBadArgs, "core_write");
     TEST (testWriteBadFiles, "core_write");
@@ -189,6 +194,8 @@ main (int argc, char* argv[])
     TEST (testWriteScans, "core_write");
     TEST (testWriteTiles, "core_write");
     TEST (testWriteMultiPart, "core_write");
+    TEST (testWriteUnorderedChunks, "core_write");
+    TEST (testWriteInterleavedParts, "core_write");
     TEST (testWriteDeep, "core_write");
 
     TEST (testHUF, "core_compression");
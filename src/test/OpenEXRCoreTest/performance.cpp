@@ -36,48 +36,28 @@ error_handler_new (exr_const_context_t file, int code, const char* msg)
     std::cerr << " (" << code << "): " << msg << std::endl;
 }
 
-class CoreReadTask : public Task
+// runs the tasks of an exr_decoding_submit() batch on the global pool
+class CoreDecodeTask : public Task
 {
 public:
-    CoreReadTask (TaskGroup* g, exr_context_t f, int y, uint8_t* ptr)
-        : Task (g), _f (f), _y (y), _ptr (ptr)
+    CoreDecodeTask (TaskGroup* g, exr_decode_task_fn_t fn, void* data)
+        : Task (g), _fn (fn), _data (data)
     {}
-    void execute () override
-    {
-        exr_chunk_info_t      cinfo = {0};
-        exr_decode_pipeline_t chunk;
-        exr_result_t rv = exr_read_scanline_chunk_info (_f, 0, _y, &cinfo);
-        if (rv == EXR_ERR_SUCCESS)
-            rv = exr_decoding_initialize (_f, 0, &cinfo, &chunk);
-        if (rv == EXR_ERR_SUCCESS)
-        {
-            uint8_t* curchanptr    = _ptr;
-            int      bytesperpixel = 0;
-            for (int c = 0; c < chunk.channel_count; ++c)
-                bytesperpixel += chunk.channels[c].bytes_per_element;
-            for (int c = 0; c < chunk.channel_count; ++c)
-            {
-                exr_coding_channel_info_t& outc = chunk.channels[c];
-                outc.decode_to_ptr              = curchanptr;
-                outc.user_pixel_stride          = bytesperpixel;
-                outc.user_line_stride           = outc.width * bytesperpixel;
-                outc.user_bytes_per_element =
-                    chunk.channels[c].bytes_per_element;
-                curchanptr += chunk.channels[c].bytes_per_element;
-            }
-
-            rv = exr_decoding_choose_default_routines (_f, 0, &chunk);
-        }
-        if (rv == EXR_ERR_SUCCESS) rv = exr_decoding_run (_f, 0, &chunk);
-        exr_decoding_destroy (_f, &chunk);
-    }
+    void execute () override { _fn (_data); }
 
 private:
-    exr_context_t _f;
-    int           _y;
-    uint8_t*      _ptr;
+    exr_decode_task_fn_t _fn;
+    void*                _data;
 };
 
+static int
+submit_to_pool (void* group, exr_decode_task_fn_t fn, void* data)
+{
+    ThreadPool::addGlobalTask (
+        new CoreDecodeTask (static_cast<TaskGroup*> (group), fn, data));
+    return 0;
+}
+
 //#define THREADS 0
 #define THREADS 16
 
@@ -132,16 +112,68 @@ read_pixels_raw (exr_context_t f)
         uint8_t* imgptr = rawBuf.data ();
 
 #if THREADS > 0
-        TaskGroup   taskgroup;
-        ThreadPool& tp = ThreadPool::globalThreadPool ();
+        std::vector<exr_decode_pipeline_t>  chunks (ccount);
+        std::vector<exr_decode_pipeline_t*> dptrs;
+        exr_result_t                        rv;
 
-        for (int y = dw.min.y; y <= dw.max.y;)
+        for (int y = dw.min.y, ci = 0; y <= dw.max.y; ++ci)
         {
-            tp.addTask (new CoreReadTask (&taskgroup, f, y, imgptr));
+            exr_chunk_info_t       cinfo = {0};
+            exr_decode_pipeline_t& chunk = chunks[ci];
+
+            chunk = EXR_DECODE_PIPELINE_INITIALIZER;
+            rv    = exr_read_scanline_chunk_info (f, 0, y, &cinfo);
+            if (rv == EXR_ERR_SUCCESS)
+                rv = exr_decoding_initialize (f, 0, &cinfo, &chunk);
+            if (rv != EXR_ERR_SUCCESS)
+                throw std::runtime_error ("unable to init decoding pipeline");
+
+            uint8_t* curchanptr    = imgptr;
+            int      bytesperpixel = 0;
+            for (int c = 0; c < chunk.channel_count; ++c)
+                bytesperpixel += chunk.channels[c].bytes_per_element;
+            for (int c = 0; c < chunk.channel_count; ++c)
+            {
+                exr_coding_channel_info_t& outc = chunk.channels[c];
+                outc.decode_to_ptr              = curchanptr;
+                outc.user_pixel_stride          = bytesperpixel;
+                outc.user_line_stride           = outc.width * bytesperpixel;
+                outc.user_bytes_per_element =
+                    chunk.channels[c].bytes_per_element;
+                curchanptr += chunk.channels[c].bytes_per_element;
+            }
+
+            rv = exr_decoding_choose_default_routines (f, 0, &chunk);
+            if (rv != EXR_ERR_SUCCESS)
+                throw std::runtime_error ("unable to choose default routines");
+            dptrs.push_back (&chunk);
+
             imgptr += sizePerChunk;
             y += linesread;
             ret += linesread * w;
         }
+
+        {
+            TaskGroup             taskgroup;
+            exr_decode_executor_t exec = {&taskgroup, &submit_to_pool};
+            exr_decode_batch_t    batch;
+
+            rv = exr_decoding_submit (
+                f,
+                0,
+                (int) dptrs.size (),
+                dptrs.data (),
+                &exec,
+                NULL,
+                NULL,
+                &batch);
+            if (rv == EXR_ERR_SUCCESS) rv = exr_decoding_wait (&batch);
+        }
+
+        for (auto& chunk: chunks)
+            exr_decoding_destroy (f, &chunk);
+        if (rv != EXR_ERR_SUCCESS)
+            throw std::runtime_error ("unable to run decoding pipelines");
 #else
         exr_chunk_info_t      cinfo = {0};
         exr_decode_pipeline_t chunk = {0};
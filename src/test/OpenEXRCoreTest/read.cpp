@@ -12,9 +12,12 @@
 #include <math.h>
 #include <string.h>
 
+#include <deque>
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 static void
 err_cb (exr_const_context_t f, int code, const char* msg)
@@ -616,3 +619,895 @@ testReadUnpack (const std::string& tempdir)
 
     exr_finish (&f);
 }
+
+/* how decodeAllScanlines hands out the channel buffers: one per
+ * channel, one buffer laid out like the chunk in the file, or with
+ * the odd channels left out of the result, either after decoding
+ * them or by not giving the decoder anywhere to put them */
+enum DecodeLayout
+{
+    DECODE_SEPARATE,
+    DECODE_PACKED,
+    DECODE_DROP_ODD,
+    DECODE_SKIP_ODD
+};
+
+static void
+decodeAllScanlines (
+    const std::string&    fn,
+    int                   flags,
+    std::vector<uint8_t>& allpixels,
+    bool                  withinfo = false,
+    DecodeLayout          layout   = DECODE_SEPARATE)
+{
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &err_cb;
+    cinit.flags                     = flags;
+
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+
+    exr_attr_box2i_t dw;
+    int32_t          lpc;
+    EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+    EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &lpc));
+
+    exr_decode_pipeline_t decoder = EXR_DECODE_PIPELINE_INITIALIZER;
+    std::vector<std::unique_ptr<uint8_t[]>> chanbufs;
+    for (int y = dw.min.y; y <= dw.max.y; y += lpc)
+    {
+        exr_chunk_info_t cinfo;
+        if (y == dw.min.y)
+        {
+            EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+            EXRCORE_TEST_RVAL (
+                exr_decoding_initialize (f, 0, &cinfo, &decoder));
+        }
+        else if (withinfo)
+        {
+            EXRCORE_TEST_RVAL (
+                exr_decoding_read_scanline_chunk (f, 0, y, &decoder));
+            if (decoder.read_fn && decoder.decompress_fn)
+                EXRCORE_TEST (
+                    (decoder.decode_flags & EXR_DECODE_PACKED_DATA_PRELOADED) !=
+                    0);
+        }
+        else
+        {
+            EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+            EXRCORE_TEST_RVAL (exr_decoding_update (f, 0, &cinfo, &decoder));
+        }
+
+        chanbufs.clear ();
+        if (layout == DECODE_PACKED)
+        {
+            int32_t linebytes = 0;
+            for (int c = 0; c < decoder.channel_count; ++c)
+                linebytes += decoder.channels[c].width *
+                             decoder.channels[c].bytes_per_element;
+
+            size_t nbytes = (size_t) linebytes * (size_t) decoder.chunk.height;
+            chanbufs.emplace_back (new uint8_t[nbytes > 0 ? nbytes : 1]);
+            memset (chanbufs.back ().get (), 0, nbytes);
+
+            uint8_t* cur = chanbufs.back ().get ();
+            for (int c = 0; c < decoder.channel_count; ++c)
+            {
+                exr_coding_channel_info_t& curc = decoder.channels[c];
+                curc.decode_to_ptr              = cur;
+                curc.user_pixel_stride          = curc.bytes_per_element;
+                curc.user_line_stride           = linebytes;
+                cur += curc.width * curc.bytes_per_element;
+            }
+        }
+        else
+        {
+            for (int c = 0; c < decoder.channel_count; ++c)
+            {
+                exr_coding_channel_info_t& curc = decoder.channels[c];
+                size_t nbytes = (size_t) curc.width * (size_t) curc.height *
+                                (size_t) curc.bytes_per_element;
+
+                chanbufs.emplace_back (new uint8_t[nbytes > 0 ? nbytes : 1]);
+                memset (chanbufs.back ().get (), 0, nbytes);
+                curc.decode_to_ptr =
+                    nbytes > 0 ? chanbufs.back ().get () : NULL;
+                if (layout == DECODE_SKIP_ODD && (c % 2) != 0)
+                    curc.decode_to_ptr = NULL;
+                curc.user_pixel_stride = curc.bytes_per_element;
+                curc.user_line_stride  = curc.width * curc.bytes_per_element;
+            }
+        }
+
+        if (y == dw.min.y)
+        {
+            EXRCORE_TEST_RVAL (
+                exr_decoding_choose_default_routines (f, 0, &decoder));
+        }
+        EXRCORE_TEST_RVAL (exr_decoding_run (f, 0, &decoder));
+
+        for (int c = 0; c < decoder.channel_count; ++c)
+        {
+            const exr_coding_channel_info_t& curc = decoder.channels[c];
+            if ((layout == DECODE_DROP_ODD || layout == DECODE_SKIP_ODD) &&
+                (c % 2) != 0)
+                continue;
+            if (!curc.decode_to_ptr) continue;
+
+            for (int16_t cy = 0; cy < curc.height; ++cy)
+            {
+                const uint8_t* cdata =
+                    curc.decode_to_ptr + (size_t) cy * curc.user_line_stride;
+                allpixels.insert (
+                    allpixels.end (),
+                    cdata,
+                    cdata + (size_t) curc.width *
+                                (size_t) curc.bytes_per_element);
+            }
+        }
+    }
+
+    EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
+    exr_finish (&f);
+}
+
+void
+testReadMMap (const std::string& tempdir)
+{
+    /* includes b44 as that decompresses in place when the chunk
+     * does not compress, which must not touch the mapped file */
+    const char* files[] = {
+        "v1.7.test.interleaved.exr",
+        "comp_none.exr",
+        "comp_rle.exr",
+        "comp_zip.exr",
+        "comp_piz.exr",
+        "comp_b44.exr"};
+
+    for (auto name: files)
+    {
+        std::string          fn = ILM_IMF_TEST_IMAGEDIR;
+        std::vector<uint8_t> readpix, mappix;
+
+        fn += name;
+        decodeAllScanlines (fn, 0, readpix);
+        decodeAllScanlines (fn, EXR_CONTEXT_FLAG_USE_MMAP, mappix);
+        EXRCORE_TEST (!readpix.empty ());
+        EXRCORE_TEST (readpix == mappix);
+    }
+
+    /* uncompressed chunks are read straight in to the channels, in
+     * one read when the buffers have the layout of the chunk, and
+     * skipping over channels which have no buffer */
+    const char* uncompfiles[] = {"comp_none.exr", "v1.7.test.planar.exr"};
+
+    for (auto name: uncompfiles)
+    {
+        std::string fn = ILM_IMF_TEST_IMAGEDIR;
+        fn += name;
+        for (int flags: {0, (int) EXR_CONTEXT_FLAG_USE_MMAP})
+        {
+            std::vector<uint8_t> sep, packed, dropped, skipped;
+
+            decodeAllScanlines (fn, flags, sep);
+            decodeAllScanlines (fn, flags, packed, false, DECODE_PACKED);
+            decodeAllScanlines (fn, flags, dropped, false, DECODE_DROP_ODD);
+            decodeAllScanlines (fn, flags, skipped, false, DECODE_SKIP_ODD);
+            EXRCORE_TEST (!sep.empty ());
+            EXRCORE_TEST (sep == packed);
+            EXRCORE_TEST (!dropped.empty ());
+            EXRCORE_TEST (dropped == skipped);
+        }
+    }
+}
+
+static int64_t
+stdio_read_func (
+    exr_const_context_t         f,
+    void*                       userdata,
+    void*                       buffer,
+    uint64_t                    sz,
+    uint64_t                    offset,
+    exr_stream_error_func_ptr_t errcb)
+{
+    FILE* fp = static_cast<FILE*> (userdata);
+    if (fseek (fp, (long) offset, SEEK_SET) != 0) return -1;
+    return (int64_t) fread (buffer, 1, sz, fp);
+}
+
+static void
+compareChunkReads (exr_context_t f)
+{
+    int32_t ccount;
+    EXRCORE_TEST_RVAL (exr_get_chunk_count (f, 0, &ccount));
+
+    exr_attr_box2i_t dw;
+    int32_t          lpc;
+    EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+    EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &lpc));
+
+    std::vector<exr_chunk_info_t>     cinfos;
+    std::vector<std::vector<uint8_t>> single, batch;
+    for (int y = dw.min.y; y <= dw.max.y; y += lpc)
+    {
+        exr_chunk_info_t cinfo;
+        EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+        cinfos.push_back (cinfo);
+        single.emplace_back (cinfo.packed_size);
+        EXRCORE_TEST_RVAL (exr_read_chunk (f, 0, &cinfo, single.back ().data ()));
+    }
+    EXRCORE_TEST (cinfos.size () == (size_t) ccount);
+
+    // everything, in reverse, then every other chunk so nothing merges
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        std::vector<exr_chunk_info_t> req;
+        std::vector<void*>            bufs;
+        std::vector<size_t>           which;
+
+        batch.clear ();
+        batch.resize (cinfos.size ());
+        for (size_t c = 0; c < cinfos.size (); ++c)
+        {
+            size_t idx = (pass == 1) ? (cinfos.size () - c - 1) : c;
+            if (pass == 2 && (c % 2) != 0) continue;
+            batch[idx].assign (cinfos[idx].packed_size, 0xAB);
+            req.push_back (cinfos[idx]);
+            bufs.push_back (batch[idx].data ());
+            which.push_back (idx);
+        }
+
+        EXRCORE_TEST_RVAL (exr_read_chunks (
+            f, 0, (int) req.size (), req.data (), bufs.data ()));
+        for (size_t c: which)
+            EXRCORE_TEST (batch[c] == single[c]);
+    }
+
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT, exr_read_chunks (f, 0, -1, NULL, NULL));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT, exr_read_chunks (f, 0, 1, NULL, NULL));
+    EXRCORE_TEST_RVAL (exr_read_chunks (f, 0, 0, NULL, NULL));
+}
+
+void
+testReadChunks (const std::string& tempdir)
+{
+    const char* files[] = {
+        "v1.7.test.interleaved.exr", "comp_zips.exr", "comp_piz.exr"};
+
+    for (auto name: files)
+    {
+        exr_context_t             f;
+        std::string               fn    = ILM_IMF_TEST_IMAGEDIR;
+        exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+        cinit.error_handler_fn          = &err_cb;
+
+        fn += name;
+        EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+        compareChunkReads (f);
+        exr_finish (&f);
+
+        // custom read routine, no vectored reads available
+        FILE* fp = fopen (fn.c_str (), "rb");
+        EXRCORE_TEST (fp != NULL);
+        cinit.user_data = fp;
+        cinit.read_fn   = &stdio_read_func;
+        EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+        compareChunkReads (f);
+        exr_finish (&f);
+        fclose (fp);
+    }
+
+    // batch reading for decoders gives the same pixels
+    std::string fn = ILM_IMF_TEST_IMAGEDIR;
+    fn += "comp_zips.exr";
+
+    std::vector<uint8_t> expected;
+    decodeAllScanlines (fn, 0, expected);
+
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &err_cb;
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+
+    int32_t ccount;
+    EXRCORE_TEST_RVAL (exr_get_chunk_count (f, 0, &ccount));
+
+    exr_attr_box2i_t dw;
+    int32_t          lpc;
+    EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+    EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &lpc));
+
+    std::vector<exr_decode_pipeline_t>      decoders (ccount);
+    std::vector<exr_decode_pipeline_t*>     dptrs;
+    std::vector<std::unique_ptr<uint8_t[]>> chanbufs;
+    for (int c = 0; c < ccount; ++c)
+    {
+        exr_chunk_info_t cinfo;
+        EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (
+            f, 0, dw.min.y + c * lpc, &cinfo));
+
+        exr_decode_pipeline_t& decoder = decoders[c];
+        decoder                        = EXR_DECODE_PIPELINE_INITIALIZER;
+        EXRCORE_TEST_RVAL (exr_decoding_initialize (f, 0, &cinfo, &decoder));
+        for (int ch = 0; ch < decoder.channel_count; ++ch)
+        {
+            exr_coding_channel_info_t& curc = decoder.channels[ch];
+            size_t nbytes = (size_t) curc.width * (size_t) curc.height *
+                            (size_t) curc.bytes_per_element;
+
+            chanbufs.emplace_back (new uint8_t[nbytes > 0 ? nbytes : 1]);
+            curc.decode_to_ptr = nbytes > 0 ? chanbufs.back ().get () : NULL;
+            curc.user_pixel_stride = curc.bytes_per_element;
+            curc.user_line_stride  = curc.width * curc.bytes_per_element;
+        }
+        EXRCORE_TEST_RVAL (
+            exr_decoding_choose_default_routines (f, 0, &decoder));
+        dptrs.push_back (&decoder);
+    }
+
+    EXRCORE_TEST_RVAL (
+        exr_decoding_read_batch (f, 0, (int) dptrs.size (), dptrs.data ()));
+
+    std::vector<uint8_t> allpixels;
+    size_t               curbuf = 0;
+    for (auto* decoder: dptrs)
+    {
+        EXRCORE_TEST (
+            (decoder->decode_flags & EXR_DECODE_PACKED_DATA_PRELOADED) != 0);
+        EXRCORE_TEST_RVAL (exr_decoding_run (f, 0, decoder));
+        EXRCORE_TEST (
+            (decoder->decode_flags & EXR_DECODE_PACKED_DATA_PRELOADED) == 0);
+        for (int ch = 0; ch < decoder->channel_count; ++ch)
+        {
+            const exr_coding_channel_info_t& curc = decoder->channels[ch];
+            const uint8_t* cdata = chanbufs[curbuf++].get ();
+            allpixels.insert (
+                allpixels.end (),
+                cdata,
+                cdata + (size_t) curc.width * (size_t) curc.height *
+                            (size_t) curc.bytes_per_element);
+        }
+        EXRCORE_TEST_RVAL (exr_decoding_destroy (f, decoder));
+    }
+    EXRCORE_TEST (allpixels == expected);
+
+    exr_finish (&f);
+}
+
+static void
+compareChunkWithInfo (
+    exr_context_t f, const exr_chunk_info_t& cinfo, bool reversed)
+{
+    exr_chunk_info_t     wi;
+    exr_storage_t        storage;
+    uint64_t             bufsize;
+    std::vector<uint8_t> expect (cinfo.packed_size);
+
+    EXRCORE_TEST_RVAL (exr_get_storage (f, 0, &storage));
+    EXRCORE_TEST_RVAL (exr_get_chunk_unpacked_size (f, 0, &bufsize));
+    EXRCORE_TEST_RVAL (exr_read_chunk (f, 0, &cinfo, expect.data ()));
+
+    // any chunk fits in the unpacked size of the largest one
+    std::vector<uint8_t> buf (bufsize, 0xAB);
+
+    if (storage == EXR_STORAGE_TILED)
+    {
+        EXRCORE_TEST_RVAL (exr_read_tile_chunk_with_info (
+            f,
+            0,
+            cinfo.start_x,
+            cinfo.start_y,
+            cinfo.level_x,
+            cinfo.level_y,
+            &wi,
+            buf.data (),
+            buf.size ()));
+    }
+    else
+    {
+        EXRCORE_TEST_RVAL (exr_read_scanline_chunk_with_info (
+            f, 0, cinfo.start_y, &wi, buf.data (), buf.size ()));
+    }
+
+    EXRCORE_TEST (wi.idx == cinfo.idx);
+    EXRCORE_TEST (wi.start_x == cinfo.start_x);
+    EXRCORE_TEST (wi.start_y == cinfo.start_y);
+    EXRCORE_TEST (wi.width == cinfo.width);
+    EXRCORE_TEST (wi.height == cinfo.height);
+    EXRCORE_TEST (wi.data_offset == cinfo.data_offset);
+    EXRCORE_TEST (wi.packed_size == cinfo.packed_size);
+    EXRCORE_TEST (wi.unpacked_size == cinfo.unpacked_size);
+    EXRCORE_TEST (
+        memcmp (buf.data (), expect.data (), cinfo.packed_size) == 0);
+
+    // the buffer has to hold the packed data, whatever was guessed
+    if (!reversed && cinfo.packed_size > 1 && storage != EXR_STORAGE_TILED)
+    {
+        EXRCORE_TEST_RVAL_FAIL (
+            EXR_ERR_INVALID_ARGUMENT,
+            exr_read_scanline_chunk_with_info (
+                f,
+                0,
+                cinfo.start_y,
+                &wi,
+                buf.data (),
+                cinfo.packed_size - 1));
+    }
+}
+
+static void
+compareChunksWithInfo (exr_context_t f)
+{
+    std::vector<exr_chunk_info_t> cinfos;
+    exr_storage_t                 storage;
+
+    EXRCORE_TEST_RVAL (exr_get_storage (f, 0, &storage));
+    if (storage == EXR_STORAGE_TILED)
+    {
+        int32_t               levelsx, levelsy;
+        exr_tile_level_mode_t levelmode;
+        EXRCORE_TEST_RVAL (exr_get_tile_levels (f, 0, &levelsx, &levelsy));
+        EXRCORE_TEST_RVAL (
+            exr_get_tile_descriptor (f, 0, NULL, NULL, &levelmode, NULL));
+
+        for (int ly = 0; ly < levelsy; ++ly)
+        {
+            for (int lx = 0; lx < levelsx; ++lx)
+            {
+                int32_t tilew, tileh, levw, levh;
+                if (levelmode != EXR_TILE_RIPMAP_LEVELS && lx != ly) continue;
+                EXRCORE_TEST_RVAL (
+                    exr_get_tile_sizes (f, 0, lx, ly, &tilew, &tileh));
+                EXRCORE_TEST_RVAL (
+                    exr_get_level_sizes (f, 0, lx, ly, &levw, &levh));
+                for (int ty = 0; ty < (levh + tileh - 1) / tileh; ++ty)
+                {
+                    for (int tx = 0; tx < (levw + tilew - 1) / tilew; ++tx)
+                    {
+                        exr_chunk_info_t cinfo;
+                        EXRCORE_TEST_RVAL (exr_read_tile_chunk_info (
+                            f, 0, tx, ty, lx, ly, &cinfo));
+                        cinfos.push_back (cinfo);
+                    }
+                }
+            }
+        }
+    }
+    else
+    {
+        exr_attr_box2i_t dw;
+        int32_t          lpc;
+        EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+        EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &lpc));
+        for (int y = dw.min.y; y <= dw.max.y; y += lpc)
+        {
+            exr_chunk_info_t cinfo;
+            EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+            cinfos.push_back (cinfo);
+        }
+    }
+    EXRCORE_TEST (!cinfos.empty ());
+
+    for (const auto& cinfo: cinfos)
+        compareChunkWithInfo (f, cinfo, false);
+    for (auto c = cinfos.rbegin (); c != cinfos.rend (); ++c)
+        compareChunkWithInfo (f, *c, true);
+}
+
+void
+testReadChunkWithInfo (const std::string& tempdir)
+{
+    const char* files[] = {
+        "v1.7.test.interleaved.exr",
+        "comp_none.exr",
+        "comp_zips.exr",
+        "comp_piz.exr",
+        "v1.7.test.tiled.exr"};
+
+    for (auto name: files)
+    {
+        exr_context_t             f;
+        std::string               fn    = ILM_IMF_TEST_IMAGEDIR;
+        exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+        cinit.error_handler_fn          = &err_cb;
+
+        fn += name;
+        EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+        compareChunksWithInfo (f);
+        exr_finish (&f);
+
+        // custom read routine, no vectored reads available
+        FILE* fp = fopen (fn.c_str (), "rb");
+        EXRCORE_TEST (fp != NULL);
+        cinit.user_data = fp;
+        cinit.read_fn   = &stdio_read_func;
+        EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+        compareChunksWithInfo (f);
+        exr_finish (&f);
+        fclose (fp);
+    }
+
+    // reading through the decoder gives the same pixels
+    const char* decfiles[] = {"comp_none.exr", "comp_zips.exr", "comp_b44.exr"};
+    for (auto name: decfiles)
+    {
+        std::string          fn = ILM_IMF_TEST_IMAGEDIR;
+        std::vector<uint8_t> readpix, infopix;
+
+        fn += name;
+        decodeAllScanlines (fn, 0, readpix);
+        decodeAllScanlines (fn, 0, infopix, true);
+        EXRCORE_TEST (!readpix.empty ());
+        EXRCORE_TEST (readpix == infopix);
+    }
+}
+
+static void
+compareChunkIndex (exr_context_t f)
+{
+    int32_t       ccount = -1, small;
+    exr_storage_t storage;
+
+    EXRCORE_TEST_RVAL (exr_get_storage (f, 0, &storage));
+    EXRCORE_TEST_RVAL (exr_get_chunk_index (f, 0, &ccount, NULL));
+    EXRCORE_TEST (ccount > 0);
+
+    std::vector<exr_chunk_info_t> index (ccount);
+    small = ccount - 1;
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_get_chunk_index (f, 0, &small, index.data ()));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_get_chunk_index (f, 0, NULL, index.data ()));
+    EXRCORE_TEST_RVAL (exr_get_chunk_index (f, 0, &ccount, index.data ()));
+    EXRCORE_TEST (ccount == (int32_t) index.size ());
+
+    for (int c = 0; c < ccount; ++c)
+    {
+        const exr_chunk_info_t& idx = index[c];
+        exr_chunk_info_t        cinfo;
+
+        EXRCORE_TEST (idx.idx == c);
+        if (storage == EXR_STORAGE_TILED)
+        {
+            EXRCORE_TEST_RVAL (exr_read_tile_chunk_info (
+                f,
+                0,
+                idx.start_x,
+                idx.start_y,
+                idx.level_x,
+                idx.level_y,
+                &cinfo));
+        }
+        else
+        {
+            EXRCORE_TEST_RVAL (
+                exr_read_scanline_chunk_info (f, 0, idx.start_y, &cinfo));
+        }
+
+        EXRCORE_TEST (cinfo.idx == idx.idx);
+        EXRCORE_TEST (cinfo.type == idx.type);
+        EXRCORE_TEST (cinfo.compression == idx.compression);
+        EXRCORE_TEST (cinfo.start_x == idx.start_x);
+        EXRCORE_TEST (cinfo.start_y == idx.start_y);
+        EXRCORE_TEST (cinfo.width == idx.width);
+        EXRCORE_TEST (cinfo.height == idx.height);
+        EXRCORE_TEST (cinfo.level_x == idx.level_x);
+        EXRCORE_TEST (cinfo.level_y == idx.level_y);
+        EXRCORE_TEST (cinfo.data_offset == idx.data_offset);
+        EXRCORE_TEST (cinfo.unpacked_size == idx.unpacked_size);
+        // these were all written in one go, so there are no gaps
+        EXRCORE_TEST (cinfo.packed_size == idx.packed_size);
+    }
+}
+
+void
+testChunkIndex (const std::string& tempdir)
+{
+    const char* files[] = {
+        "v1.7.test.interleaved.exr",
+        "comp_none.exr",
+        "comp_zips.exr",
+        "comp_piz.exr",
+        "comp_dwab_v2.exr",
+        "v1.7.test.tiled.exr"};
+
+    for (auto name: files)
+    {
+        exr_context_t             f;
+        std::string               fn    = ILM_IMF_TEST_IMAGEDIR;
+        exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+        cinit.error_handler_fn          = &err_cb;
+
+        fn += name;
+        EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+        compareChunkIndex (f);
+        exr_finish (&f);
+    }
+}
+
+namespace
+{
+
+struct AsyncChunks
+{
+    std::vector<exr_decode_pipeline_t>      decoders;
+    std::vector<exr_decode_pipeline_t*>     dptrs;
+    std::vector<std::unique_ptr<uint8_t[]>> chanbufs;
+
+    std::mutex                lock;
+    std::vector<int>          completed;
+    std::vector<exr_result_t> results;
+};
+
+// collects the tasks, to be run by the test itself
+struct QueueExecutor
+{
+    std::deque<std::pair<exr_decode_task_fn_t, void*>> tasks;
+};
+
+int
+queue_submit (void* data, exr_decode_task_fn_t task, void* task_data)
+{
+    static_cast<QueueExecutor*> (data)->tasks.emplace_back (task, task_data);
+    return 0;
+}
+
+int
+refuse_submit (void*, exr_decode_task_fn_t, void*)
+{
+    return 1;
+}
+
+void
+async_complete (
+    exr_const_context_t,
+    int,
+    int                    index,
+    exr_decode_pipeline_t* decode,
+    exr_result_t           result,
+    void*                  userdata)
+{
+    AsyncChunks*                chunks = static_cast<AsyncChunks*> (userdata);
+    std::lock_guard<std::mutex> lk (chunks->lock);
+
+    EXRCORE_TEST (decode == chunks->dptrs[index]);
+    ++chunks->completed[index];
+    chunks->results[index] = result;
+}
+
+void
+setupAsyncChunks (exr_context_t f, AsyncChunks& chunks)
+{
+    int32_t          ccount, lpc;
+    exr_attr_box2i_t dw;
+
+    EXRCORE_TEST_RVAL (exr_get_chunk_count (f, 0, &ccount));
+    EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+    EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &lpc));
+
+    chunks.decoders.resize (ccount);
+    chunks.completed.assign (ccount, 0);
+    chunks.results.assign (ccount, EXR_ERR_UNKNOWN);
+    for (int c = 0; c < ccount; ++c)
+    {
+        exr_chunk_info_t cinfo;
+        EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (
+            f, 0, dw.min.y + c * lpc, &cinfo));
+
+        exr_decode_pipeline_t& decoder = chunks.decoders[c];
+        decoder                        = EXR_DECODE_PIPELINE_INITIALIZER;
+        EXRCORE_TEST_RVAL (exr_decoding_initialize (f, 0, &cinfo, &decoder));
+        for (int ch = 0; ch < decoder.channel_count; ++ch)
+        {
+            exr_coding_channel_info_t& curc = decoder.channels[ch];
+            size_t nbytes = (size_t) curc.width * (size_t) curc.height *
+                            (size_t) curc.bytes_per_element;
+
+            chunks.chanbufs.emplace_back (
+                new uint8_t[nbytes > 0 ? nbytes : 1]);
+            curc.decode_to_ptr =
+                nbytes > 0 ? chunks.chanbufs.back ().get () : NULL;
+            curc.user_pixel_stride = curc.bytes_per_element;
+            curc.user_line_stride  = curc.width * curc.bytes_per_element;
+        }
+        EXRCORE_TEST_RVAL (
+            exr_decoding_choose_default_routines (f, 0, &decoder));
+        chunks.dptrs.push_back (&decoder);
+    }
+}
+
+void
+finishAsyncChunks (
+    exr_context_t               f,
+    AsyncChunks&                chunks,
+    const std::vector<uint8_t>& expected)
+{
+    std::vector<uint8_t> allpixels;
+    size_t               curbuf = 0;
+
+    for (size_t d = 0; d < chunks.dptrs.size (); ++d)
+    {
+        exr_decode_pipeline_t* decoder = chunks.dptrs[d];
+
+        EXRCORE_TEST (chunks.completed[d] == 1);
+        EXRCORE_TEST (chunks.results[d] == EXR_ERR_SUCCESS);
+        for (int ch = 0; ch < decoder->channel_count; ++ch)
+        {
+            const exr_coding_channel_info_t& curc = decoder->channels[ch];
+            const uint8_t* cdata = chunks.chanbufs[curbuf++].get ();
+            allpixels.insert (
+                allpixels.end (),
+                cdata,
+                cdata + (size_t) curc.width * (size_t) curc.height *
+                            (size_t) curc.bytes_per_element);
+        }
+        EXRCORE_TEST_RVAL (exr_decoding_destroy (f, decoder));
+    }
+    EXRCORE_TEST (allpixels == expected);
+}
+
+} // namespace
+
+void
+testReadAsync (const std::string& tempdir)
+{
+    const char* files[] = {"comp_none.exr", "comp_zips.exr", "comp_piz.exr"};
+
+    for (auto name: files)
+    {
+        std::string fn = ILM_IMF_TEST_IMAGEDIR;
+        fn += name;
+
+        std::vector<uint8_t> expected;
+        decodeAllScanlines (fn, 0, expected);
+
+        exr_context_t             f;
+        exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+        cinit.error_handler_fn          = &err_cb;
+        EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+
+        // internal thread pool
+        {
+            AsyncChunks        chunks;
+            exr_decode_batch_t batch;
+
+            setupAsyncChunks (f, chunks);
+            EXRCORE_TEST_RVAL (exr_decoding_submit (
+                f,
+                0,
+                (int) chunks.dptrs.size (),
+                chunks.dptrs.data (),
+                NULL,
+                &async_complete,
+                &chunks,
+                &batch));
+            EXRCORE_TEST_RVAL (exr_decoding_wait (&batch));
+            EXRCORE_TEST (batch == NULL);
+            finishAsyncChunks (f, chunks, expected);
+        }
+
+        // two batches in flight on the threads started by the first
+        {
+            AsyncChunks        chunks[2];
+            exr_decode_batch_t batch[2];
+
+            for (int b = 0; b < 2; ++b)
+            {
+                setupAsyncChunks (f, chunks[b]);
+                EXRCORE_TEST_RVAL (exr_decoding_submit (
+                    f,
+                    0,
+                    (int) chunks[b].dptrs.size (),
+                    chunks[b].dptrs.data (),
+                    NULL,
+                    &async_complete,
+                    &chunks[b],
+                    &batch[b]));
+            }
+            for (int b = 0; b < 2; ++b)
+            {
+                EXRCORE_TEST_RVAL (exr_decoding_wait (&batch[b]));
+                finishAsyncChunks (f, chunks[b], expected);
+            }
+        }
+
+        // caller's executor, run here once submitted
+        {
+            AsyncChunks           chunks;
+            QueueExecutor         queue;
+            exr_decode_executor_t exec = {&queue, &queue_submit};
+            exr_decode_batch_t    batch;
+
+            setupAsyncChunks (f, chunks);
+            EXRCORE_TEST_RVAL (exr_decoding_submit (
+                f,
+                0,
+                (int) chunks.dptrs.size (),
+                chunks.dptrs.data (),
+                &exec,
+                &async_complete,
+                &chunks,
+                &batch));
+
+            // only the read task is queued so far
+            EXRCORE_TEST (queue.tasks.size () == 1);
+            EXRCORE_TEST (chunks.completed[0] == 0);
+
+            size_t ntasks = 0;
+            while (!queue.tasks.empty ())
+            {
+                auto t = queue.tasks.front ();
+                queue.tasks.pop_front ();
+                t.first (t.second);
+                ++ntasks;
+            }
+            EXRCORE_TEST (ntasks == chunks.dptrs.size () + 1);
+            EXRCORE_TEST_RVAL (exr_decoding_wait (&batch));
+            finishAsyncChunks (f, chunks, expected);
+        }
+
+        // executor that refuses the tasks, so they run inline
+        {
+            AsyncChunks           chunks;
+            exr_decode_executor_t exec = {NULL, &refuse_submit};
+            exr_decode_batch_t    batch;
+
+            setupAsyncChunks (f, chunks);
+            EXRCORE_TEST_RVAL (exr_decoding_submit (
+                f,
+                0,
+                (int) chunks.dptrs.size (),
+                chunks.dptrs.data (),
+                &exec,
+                &async_complete,
+                &chunks,
+                &batch));
+            for (int c: chunks.completed)
+                EXRCORE_TEST (c == 1);
+            EXRCORE_TEST_RVAL (exr_decoding_wait (&batch));
+            finishAsyncChunks (f, chunks, expected);
+        }
+
+        exr_finish (&f);
+    }
+
+    std::string fn = ILM_IMF_TEST_IMAGEDIR;
+    fn += "comp_zips.exr";
+
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &err_cb;
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+
+    exr_decode_batch_t    batch = NULL;
+    exr_decode_executor_t exec  = {NULL, NULL};
+
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_decoding_submit (f, 0, 0, NULL, NULL, NULL, NULL, NULL));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_decoding_submit (f, 0, -1, NULL, NULL, NULL, NULL, &batch));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_decoding_submit (f, 0, 0, NULL, &exec, NULL, NULL, &batch));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_ARGUMENT_OUT_OF_RANGE,
+        exr_decoding_submit (f, 1, 0, NULL, NULL, NULL, NULL, &batch));
+    EXRCORE_TEST (batch == NULL);
+    EXRCORE_TEST_RVAL_FAIL (EXR_ERR_INVALID_ARGUMENT, exr_decoding_wait (NULL));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT, exr_decoding_wait (&batch));
+
+    // nothing to decode still gives a batch to wait on
+    EXRCORE_TEST_RVAL (
+        exr_decoding_submit (f, 0, 0, NULL, NULL, NULL, NULL, &batch));
+    EXRCORE_TEST (batch != NULL);
+    EXRCORE_TEST_RVAL (exr_decoding_wait (&batch));
+
+    exr_finish (&f);
+}
@@ -15,6 +15,8 @@
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <thread>
+#include <vector>
 
 static void
 err_cb (exr_const_context_t f, exr_result_t code, const char* msg)
@@ -1268,9 +1270,286 @@ void
 testUpdateMeta (const std::string& tempdir)
 {}
 
+static void
+writeScanFile (
+    const std::string&                 fn,
+    int                                w,
+    int                                h,
+    exr_compression_t                  comp,
+    const std::vector<const char*>&    names,
+    const std::vector<const uint8_t*>& ptrs,
+    exr_pixel_type_t                   utype,
+    int32_t                            pixelstride,
+    int32_t                            linestride)
+{
+    exr_context_t             f;
+    int                       partidx;
+    int32_t                   scansperchunk;
+    exr_encode_pipeline_t     encoder;
+    exr_chunk_info_t          cinfo;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &err_cb;
+
+    EXRCORE_TEST_RVAL (
+        exr_start_write (&f, fn.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+    EXRCORE_TEST_RVAL (
+        exr_add_part (f, "scan", EXR_STORAGE_SCANLINE, &partidx));
+    EXRCORE_TEST_RVAL (
+        exr_initialize_required_attr_simple (f, partidx, w, h, comp));
+    for (const char* n: names)
+    {
+        EXRCORE_TEST_RVAL (exr_add_channel (
+            f, partidx, n, EXR_PIXEL_HALF, EXR_PERCEPTUALLY_LOGARITHMIC, 1, 1));
+    }
+    EXRCORE_TEST_RVAL (exr_write_header (f));
+    EXRCORE_TEST_RVAL (
+        exr_get_scanlines_per_chunk (f, partidx, &scansperchunk));
+
+    for (int y = 0; y < h; y += scansperchunk)
+    {
+        EXRCORE_TEST_RVAL (
+            exr_write_scanline_chunk_info (f, partidx, y, &cinfo));
+        if (y == 0)
+        {
+            EXRCORE_TEST_RVAL (
+                exr_encoding_initialize (f, partidx, &cinfo, &encoder));
+        }
+        else
+        {
+            EXRCORE_TEST_RVAL (
+                exr_encoding_update (f, partidx, &cinfo, &encoder));
+        }
+
+        for (int c = 0; c < encoder.channel_count; ++c)
+        {
+            exr_coding_channel_info_t& curchan = encoder.channels[c];
+            size_t                     n       = 0;
+
+            while (n < names.size () &&
+                   strcmp (names[n], curchan.channel_name) != 0)
+                ++n;
+            EXRCORE_TEST (n < names.size ());
+
+            curchan.user_data_type         = utype;
+            curchan.user_bytes_per_element = (utype == EXR_PIXEL_HALF) ? 2 : 4;
+            curchan.user_pixel_stride      = pixelstride;
+            curchan.user_line_stride       = linestride;
+            curchan.encode_from_ptr =
+                ptrs[n] + (size_t) y * (size_t) linestride;
+        }
+
+        if (y == 0)
+        {
+            EXRCORE_TEST_RVAL (
+                exr_encoding_choose_default_routines (f, partidx, &encoder));
+        }
+        EXRCORE_TEST_RVAL (exr_encoding_run (f, partidx, &encoder));
+    }
+    EXRCORE_TEST_RVAL (exr_encoding_destroy (f, &encoder));
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+}
+
+static std::vector<uint8_t>
+readRawChunks (const std::string& fn)
+{
+    exr_context_t             f;
+    int32_t                   scansperchunk;
+    exr_attr_box2i_t          dw;
+    std::vector<uint8_t>      ret;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &err_cb;
+
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+    EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+    EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &scansperchunk));
+    for (int y = dw.min.y; y <= dw.max.y; y += scansperchunk)
+    {
+        exr_chunk_info_t cinfo;
+        size_t           cur = ret.size ();
+
+        EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+        ret.resize (cur + cinfo.packed_size);
+        EXRCORE_TEST_RVAL (exr_read_chunk (f, 0, &cinfo, ret.data () + cur));
+    }
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+    remove (fn.c_str ());
+    return ret;
+}
+
+static uint16_t
+firstHalf (const std::vector<uint8_t>& raw, size_t idx)
+{
+    return (uint16_t) (raw[idx * 2] | (raw[idx * 2 + 1] << 8));
+}
+
 void
 testWriteScans (const std::string& tempdir)
-{}
+{
+    // odd width so the conversion kernels have a tail to deal with,
+    // and values which all need care when rounding to half
+    const int               w = 37, h = 19;
+    const float             specials[] = {
+        0.f,
+        -0.f,
+        1.f,
+        -2.5f,
+        65504.f,
+        65519.f,
+        65520.f,
+        1e10f,
+        -1e10f,
+        std::numeric_limits<float>::infinity (),
+        -std::numeric_limits<float>::infinity (),
+        std::numeric_limits<float>::quiet_NaN (),
+        std::numeric_limits<float>::signaling_NaN (),
+        6.0e-8f,
+        2.98e-8f,
+        1e-10f,
+        5.96046448e-08f,
+        1.00048828125f, // tie, rounds down to even
+        1.00146484375f, // tie, rounds up to even
+        0.333333f};
+    const size_t            nspecial = sizeof (specials) / sizeof (float);
+    const size_t            plane    = (size_t) w * h;
+    const exr_compression_t comps[]  = {
+        EXR_COMPRESSION_NONE, EXR_COMPRESSION_ZIP};
+
+    for (int nc = 3; nc <= 4; ++nc)
+    {
+        // in memory as RGB(A), ends up in the file as (A)BGR
+        std::vector<const char*> names = {"R", "G", "B"};
+        if (nc == 4) names.push_back ("A");
+
+        std::vector<float>    inter (plane * nc);
+        std::vector<float>    planar (plane * nc);
+        std::vector<float>    padded (plane * nc * 2);
+        std::vector<uint16_t> hinter (plane * nc);
+        std::vector<uint16_t> hpadded (plane * nc * 2);
+        std::vector<uint32_t> uplanar (plane * nc);
+        std::vector<uint32_t> upadded (plane * nc * 2);
+
+        uint32_t seed = 12345;
+        for (int y = 0; y < h; ++y)
+        {
+            for (int x = 0; x < w; ++x)
+            {
+                for (int c = 0; c < nc; ++c)
+                {
+                    size_t i = ((size_t) y * w + x) * nc + c;
+                    size_t j = c * plane + (size_t) y * w + x;
+                    float  v;
+                    seed = seed * 1664525u + 1013904223u;
+                    if ((seed >> 28) < 3)
+                        v = specials[(seed >> 8) % nspecial];
+                    else
+                        v = ldexpf (
+                            (float) (int32_t) (seed >> 4) / (float) (1 << 27),
+                            (int) ((seed >> 16) % 40) - 26);
+                    inter[i]      = v;
+                    planar[j]     = v;
+                    padded[j * 2] = v;
+
+                    uint16_t hv = (uint16_t) (seed >> 7);
+                    hinter[i]      = hv;
+                    hpadded[j * 2] = hv;
+
+                    uint32_t uv = (seed & 0x1000) ? (seed >> 15) : (seed >> 1);
+                    if ((seed & 0x3f) == 0) uv = 65504;
+                    if ((seed & 0x3f) == 1) uv = 65505;
+                    if ((seed & 0x3f) == 2) uv = 0xffffffff;
+                    uplanar[j]     = uv;
+                    upadded[j * 2] = uv;
+                }
+            }
+        }
+        // make sure the signalling NaN lands somewhere
+        inter[5 * nc] = planar[5] = padded[10] =
+            std::numeric_limits<float>::signaling_NaN ();
+
+        for (exr_compression_t comp: comps)
+        {
+            std::string fn = tempdir + "testwritescans.exr";
+            std::vector<const uint8_t*> ptrs (nc);
+
+            // the per-pixel path with a padded stride is the reference
+            for (int c = 0; c < nc; ++c)
+                ptrs[c] = (const uint8_t*) (padded.data () + c * plane * 2);
+            writeScanFile (
+                fn, w, h, comp, names, ptrs, EXR_PIXEL_FLOAT, 8, w * 8);
+            std::vector<uint8_t> ref = readRawChunks (fn);
+
+            if (comp == EXR_COMPRESSION_NONE)
+            {
+                // first line of the last channel in the file is R
+                size_t ridx = (size_t) (nc - 1) * w;
+                // the signalling NaN must stay signalling (quiet bit clear)
+                EXRCORE_TEST (firstHalf (ref, ridx + 5) == 0x7d00);
+                for (int x = 0; x < w; ++x)
+                {
+                    float v = padded[(size_t) x * 2];
+                    if (v == 1.f)
+                        EXRCORE_TEST (firstHalf (ref, ridx + x) == 0x3c00);
+                    if (v == 65520.f)
+                        EXRCORE_TEST (firstHalf (ref, ridx + x) == 0x7c00);
+                }
+            }
+
+            for (int c = 0; c < nc; ++c)
+                ptrs[c] = (const uint8_t*) (planar.data () + c * plane);
+            writeScanFile (
+                fn, w, h, comp, names, ptrs, EXR_PIXEL_FLOAT, 4, w * 4);
+            EXRCORE_TEST (readRawChunks (fn) == ref);
+
+            for (int c = 0; c < nc; ++c)
+                ptrs[c] = (const uint8_t*) (inter.data () + c);
+            writeScanFile (
+                fn,
+                w,
+                h,
+                comp,
+                names,
+                ptrs,
+                EXR_PIXEL_FLOAT,
+                nc * 4,
+                w * nc * 4);
+            EXRCORE_TEST (readRawChunks (fn) == ref);
+
+            // half to half
+            for (int c = 0; c < nc; ++c)
+                ptrs[c] = (const uint8_t*) (hpadded.data () + c * plane * 2);
+            writeScanFile (
+                fn, w, h, comp, names, ptrs, EXR_PIXEL_HALF, 4, w * 4);
+            ref = readRawChunks (fn);
+
+            for (int c = 0; c < nc; ++c)
+                ptrs[c] = (const uint8_t*) (hinter.data () + c);
+            writeScanFile (
+                fn,
+                w,
+                h,
+                comp,
+                names,
+                ptrs,
+                EXR_PIXEL_HALF,
+                nc * 2,
+                w * nc * 2);
+            EXRCORE_TEST (readRawChunks (fn) == ref);
+
+            // uint to half
+            for (int c = 0; c < nc; ++c)
+                ptrs[c] = (const uint8_t*) (upadded.data () + c * plane * 2);
+            writeScanFile (
+                fn, w, h, comp, names, ptrs, EXR_PIXEL_UINT, 8, w * 8);
+            ref = readRawChunks (fn);
+
+            for (int c = 0; c < nc; ++c)
+                ptrs[c] = (const uint8_t*) (uplanar.data () + c * plane);
+            writeScanFile (
+                fn, w, h, comp, names, ptrs, EXR_PIXEL_UINT, 4, w * 4);
+            EXRCORE_TEST (readRawChunks (fn) == ref);
+        }
+    }
+}
 
 void
 testWriteTiles (const std::string& tempdir)
@@ -1396,3 +1675,345 @@ testWriteMultiPart (const std::string& tempdir)
     EXRCORE_TEST_RVAL (exr_finish (&outf));
     remove (outfn.c_str ());
 }
+
+static void
+writeUnorderedScanFile (
+    const std::string& fn,
+    int                w,
+    int                h,
+    exr_compression_t  comp,
+    const uint16_t*    pixels,
+    int                nthreads)
+{
+    exr_context_t             f;
+    int                       partidx;
+    int32_t                   scansperchunk, chunks;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &err_cb;
+    cinit.flags |= EXR_CONTEXT_FLAG_WRITE_UNORDERED_CHUNKS;
+
+    EXRCORE_TEST_RVAL (
+        exr_start_write (&f, fn.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+    EXRCORE_TEST_RVAL (
+        exr_add_part (f, "scan", EXR_STORAGE_SCANLINE, &partidx));
+    EXRCORE_TEST_RVAL (
+        exr_initialize_required_attr_simple (f, partidx, w, h, comp));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        f, partidx, "Y", EXR_PIXEL_HALF, EXR_PERCEPTUALLY_LOGARITHMIC, 1, 1));
+    EXRCORE_TEST_RVAL (exr_write_header (f));
+    EXRCORE_TEST_RVAL (
+        exr_get_scanlines_per_chunk (f, partidx, &scansperchunk));
+    EXRCORE_TEST_RVAL (exr_get_chunk_count (f, partidx, &chunks));
+
+    // every thread encodes every nthreads-th chunk, last one first
+    auto encodeChunks = [&] (int t) {
+        exr_encode_pipeline_t encoder;
+        exr_chunk_info_t      cinfo;
+        bool                  first = true;
+
+        for (int c = chunks - 1 - t; c >= 0; c -= nthreads)
+        {
+            int y = c * scansperchunk;
+
+            EXRCORE_TEST_RVAL (
+                exr_write_scanline_chunk_info (f, partidx, y, &cinfo));
+            if (first)
+            {
+                EXRCORE_TEST_RVAL (
+                    exr_encoding_initialize (f, partidx, &cinfo, &encoder));
+            }
+            else
+            {
+                EXRCORE_TEST_RVAL (
+                    exr_encoding_update (f, partidx, &cinfo, &encoder));
+            }
+
+            exr_coding_channel_info_t& curchan = encoder.channels[0];
+            curchan.user_data_type         = EXR_PIXEL_HALF;
+            curchan.user_bytes_per_element = 2;
+            curchan.user_pixel_stride      = 2;
+            curchan.user_line_stride       = w * 2;
+            curchan.encode_from_ptr =
+                (const uint8_t*) (pixels + (size_t) y * (size_t) w);
+
+            if (first)
+            {
+                EXRCORE_TEST_RVAL (exr_encoding_choose_default_routines (
+                    f, partidx, &encoder));
+                first = false;
+            }
+            EXRCORE_TEST_RVAL (exr_encoding_run (f, partidx, &encoder));
+        }
+        if (!first) EXRCORE_TEST_RVAL (exr_encoding_destroy (f, &encoder));
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; ++t)
+        threads.emplace_back (encodeChunks, t);
+    for (auto& t: threads)
+        t.join ();
+
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+}
+
+// an in-memory stream that fails the next write when asked to
+struct FailingStream
+{
+    std::vector<uint8_t> data;
+    bool                 failNext = false;
+};
+
+static int64_t
+failing_write (
+    exr_const_context_t         ctxt,
+    void*                       userdata,
+    const void*                 buffer,
+    uint64_t                    sz,
+    uint64_t                    offset,
+    exr_stream_error_func_ptr_t error_cb)
+{
+    FailingStream* s = static_cast<FailingStream*> (userdata);
+    if (s->failNext)
+    {
+        s->failNext = false;
+        error_cb (ctxt, EXR_ERR_WRITE_IO, "Simulated write failure");
+        return -1;
+    }
+    if (s->data.size () < offset + sz) s->data.resize (offset + sz);
+    memcpy (s->data.data () + offset, buffer, sz);
+    return (int64_t) sz;
+}
+
+void
+testWriteUnorderedChunks (const std::string& tempdir)
+{
+    const int                   w = 53, h = 71;
+    const exr_compression_t     comps[] = {
+        EXR_COMPRESSION_NONE, EXR_COMPRESSION_ZIPS, EXR_COMPRESSION_ZIP};
+    std::string                 fn = tempdir + "testunorderedchunks.exr";
+    std::vector<uint16_t>       pixels ((size_t) w * h);
+    std::vector<const char*>    names = {"Y"};
+    std::vector<const uint8_t*> ptrs  = {(const uint8_t*) pixels.data ()};
+
+    uint32_t seed = 4321;
+    for (auto& p: pixels)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        p    = (uint16_t) ((seed >> 12) & 0x7bff);
+    }
+
+    for (exr_compression_t comp: comps)
+    {
+        // the chunks are stored in a different order, but must hold
+        // the same data as the ones written in order
+        writeScanFile (
+            fn, w, h, comp, names, ptrs, EXR_PIXEL_HALF, 2, w * 2);
+        std::vector<uint8_t> ref = readRawChunks (fn);
+
+        for (int nthreads = 1; nthreads <= 4; nthreads += 3)
+        {
+            writeUnorderedScanFile (
+                fn, w, h, comp, pixels.data (), nthreads);
+            EXRCORE_TEST (readRawChunks (fn) == ref);
+        }
+    }
+
+    // a chunk may only be written once, and without the flag, the
+    // chunks must still be written in order
+    std::vector<uint8_t> line ((size_t) w * 2);
+    for (int unordered = 0; unordered < 2; ++unordered)
+    {
+        exr_context_t             f;
+        int                       partidx;
+        exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+        cinit.error_handler_fn          = &err_cb;
+        if (unordered) cinit.flags |= EXR_CONTEXT_FLAG_WRITE_UNORDERED_CHUNKS;
+
+        EXRCORE_TEST_RVAL (exr_start_write (
+            &f, fn.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+        EXRCORE_TEST_RVAL (
+            exr_add_part (f, "scan", EXR_STORAGE_SCANLINE, &partidx));
+        EXRCORE_TEST_RVAL (exr_initialize_required_attr_simple (
+            f, partidx, w, 2, EXR_COMPRESSION_NONE));
+        EXRCORE_TEST_RVAL (exr_add_channel (
+            f,
+            partidx,
+            "Y",
+            EXR_PIXEL_HALF,
+            EXR_PERCEPTUALLY_LOGARITHMIC,
+            1,
+            1));
+        EXRCORE_TEST_RVAL (exr_write_header (f));
+
+        if (unordered)
+        {
+            EXRCORE_TEST_RVAL (exr_write_scanline_chunk (
+                f, partidx, 1, line.data (), line.size ()));
+            EXRCORE_TEST_RVAL_FAIL (
+                EXR_ERR_INCORRECT_CHUNK,
+                exr_write_scanline_chunk (
+                    f, partidx, 1, line.data (), line.size ()));
+            EXRCORE_TEST_RVAL (exr_write_scanline_chunk (
+                f, partidx, 0, line.data (), line.size ()));
+        }
+        else
+        {
+            EXRCORE_TEST_RVAL_FAIL (
+                EXR_ERR_INCORRECT_CHUNK,
+                exr_write_scanline_chunk (
+                    f, partidx, 1, line.data (), line.size ()));
+            EXRCORE_TEST_RVAL (exr_write_scanline_chunk (
+                f, partidx, 0, line.data (), line.size ()));
+            EXRCORE_TEST_RVAL (exr_write_scanline_chunk (
+                f, partidx, 1, line.data (), line.size ()));
+        }
+        EXRCORE_TEST_RVAL (exr_finish (&f));
+        remove (fn.c_str ());
+    }
+
+    // a chunk whose write failed can be written again
+    for (int unordered = 0; unordered < 2; ++unordered)
+    {
+        FailingStream             s;
+        exr_context_t             f;
+        int                       partidx;
+        exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+        cinit.error_handler_fn          = &err_cb;
+        cinit.write_fn                  = &failing_write;
+        cinit.user_data                 = &s;
+        if (unordered) cinit.flags |= EXR_CONTEXT_FLAG_WRITE_UNORDERED_CHUNKS;
+
+        EXRCORE_TEST_RVAL (exr_start_write (
+            &f, fn.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+        EXRCORE_TEST_RVAL (
+            exr_add_part (f, "scan", EXR_STORAGE_SCANLINE, &partidx));
+        EXRCORE_TEST_RVAL (exr_initialize_required_attr_simple (
+            f, partidx, w, 2, EXR_COMPRESSION_NONE));
+        EXRCORE_TEST_RVAL (exr_add_channel (
+            f,
+            partidx,
+            "Y",
+            EXR_PIXEL_HALF,
+            EXR_PERCEPTUALLY_LOGARITHMIC,
+            1,
+            1));
+        EXRCORE_TEST_RVAL (exr_write_header (f));
+
+        s.failNext = true;
+        EXRCORE_TEST_RVAL_FAIL (
+            EXR_ERR_WRITE_IO,
+            exr_write_scanline_chunk (
+                f, partidx, 0, line.data (), line.size ()));
+        EXRCORE_TEST_RVAL (exr_write_scanline_chunk (
+            f, partidx, 0, line.data (), line.size ()));
+        EXRCORE_TEST_RVAL (exr_write_scanline_chunk (
+            f, partidx, 1, line.data (), line.size ()));
+        EXRCORE_TEST_RVAL (exr_finish (&f));
+    }
+}
+
+void
+testWriteInterleavedParts (const std::string& tempdir)
+{
+    exr_context_t             f;
+    std::string               fn = tempdir + "testinterleavedparts.exr";
+    int                       partidx;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &err_cb;
+
+    // two scanline parts of different heights around a tiled one,
+    // 8, 4 and 5 chunks
+    const char*   names[]  = {"a", "b", "c"};
+    const int     height[] = {8, 8, 5};
+    const int     w = 16, tw = 8, th = 4;
+    exr_storage_t storage[] = {
+        EXR_STORAGE_SCANLINE, EXR_STORAGE_TILED, EXR_STORAGE_SCANLINE};
+    int32_t chunks[3];
+
+    EXRCORE_TEST_RVAL (
+        exr_start_write (&f, fn.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+    for (int p = 0; p < 3; ++p)
+    {
+        EXRCORE_TEST_RVAL (exr_add_part (f, names[p], storage[p], &partidx));
+        EXRCORE_TEST (partidx == p);
+        EXRCORE_TEST_RVAL (exr_initialize_required_attr_simple (
+            f, p, w, height[p], EXR_COMPRESSION_NONE));
+        EXRCORE_TEST_RVAL (exr_add_channel (
+            f, p, "Y", EXR_PIXEL_HALF, EXR_PERCEPTUALLY_LOGARITHMIC, 1, 1));
+        if (storage[p] == EXR_STORAGE_TILED)
+        {
+            EXRCORE_TEST_RVAL (exr_set_tile_descriptor (
+                f, p, tw, th, EXR_TILE_ONE_LEVEL, EXR_TILE_ROUND_DOWN));
+        }
+    }
+    EXRCORE_TEST_RVAL (exr_write_header (f));
+    for (int p = 0; p < 3; ++p)
+        EXRCORE_TEST_RVAL (exr_get_chunk_count (f, p, &chunks[p]));
+    EXRCORE_TEST (chunks[0] == 8 && chunks[1] == 4 && chunks[2] == 5);
+
+    // each chunk is filled with a byte identifying it
+    std::vector<uint8_t> line ((size_t) w * 2);
+    std::vector<uint8_t> tile ((size_t) tw * th * 2);
+
+    for (int c = 0; c < 8; ++c)
+    {
+        for (int p = 0; p < 3; ++p)
+        {
+            if (c >= chunks[p]) continue;
+
+            uint8_t id = (uint8_t) (p * 16 + c);
+            if (storage[p] == EXR_STORAGE_TILED)
+            {
+                memset (tile.data (), id, tile.size ());
+                EXRCORE_TEST_RVAL (exr_write_tile_chunk (
+                    f, p, c % 2, c / 2, 0, 0, tile.data (), tile.size ()));
+            }
+            else
+            {
+                memset (line.data (), id, line.size ());
+                EXRCORE_TEST_RVAL (exr_write_scanline_chunk (
+                    f, p, c, line.data (), line.size ()));
+            }
+        }
+
+        if (c == 4)
+        {
+            EXRCORE_TEST_RVAL_FAIL (
+                EXR_ERR_INCORRECT_PART,
+                exr_write_scanline_chunk (
+                    f, 2, 0, line.data (), line.size ()));
+        }
+    }
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+    for (int p = 0; p < 3; ++p)
+    {
+        for (int c = 0; c < chunks[p]; ++c)
+        {
+            exr_chunk_info_t     cinfo;
+            std::vector<uint8_t> data;
+
+            if (storage[p] == EXR_STORAGE_TILED)
+            {
+                EXRCORE_TEST_RVAL (exr_read_tile_chunk_info (
+                    f, p, c % 2, c / 2, 0, 0, &cinfo));
+            }
+            else
+            {
+                EXRCORE_TEST_RVAL (
+                    exr_read_scanline_chunk_info (f, p, c, &cinfo));
+            }
+            data.resize (cinfo.packed_size);
+            EXRCORE_TEST_RVAL (exr_read_chunk (f, p, &cinfo, data.data ()));
+            EXRCORE_TEST (
+                data.size () ==
+                (storage[p] == EXR_STORAGE_TILED ? tile.size ()
+                                                 : line.size ()));
+            for (uint8_t b: data)
+                EXRCORE_TEST (b == (uint8_t) (p * 16 + c));
+        }
+    }
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+    remove (fn.c_str ());
+}
@@ -11,6 +11,7 @@
 #include "OpenEXRConfigInternal.h"
 
 #include "testAttributes.h"
+#include "testB44Blocks.h"
 #include "testB44ExpLogTable.h"
 #include "testBackwardCompatibility.h"
 #include "testBadTypeAttributes.h"
@@ -54,6 +55,7 @@
 #include "testOptimizedInterleavePatterns.h"
 #include "testPartHelper.h"
 #include "testPreviewImage.h"
+#include "testPxr24.h"
 #include "testRgba.h"
 #include "testRgbaThreading.h"
 #include "testRle.h"
@@ -63,6 +65,7 @@
 #include "testStandardAttributes.h"
 #include "testTiledCompression.h"
 #include "testTiledCopyPixels.h"
+#include "testTiledLevels.h"
 #include "testTiledLineOrder.h"
 #include "testTiledRgba.h"
 #include "testTiledYa.h"
@@ -201,6 +204,7 @@ main (int argc, char* argv[])
     TEST (testTiledCopyPixels, "basic");
     TEST (testTiledCompression, "basic");
     TEST (testTiledLineOrder, "basic");
+    TEST (testTiledLevels, "basic");
     TEST (testScanLineApi, "basic");
     TEST (testExistingStreams, "core");
     TEST (testStandardAttributes, "core");
@@ -231,6 +235,8 @@ main (int argc, char* argv[])
     TEST (testFutureProofing, "core");
     TEST (testDwaCompressorSimd, "basic");
     TEST (testRle, "core");
+    TEST (testPxr24, "core");
+    TEST (testB44Blocks, "core");
     TEST (testB44ExpLogTable, "core");
     TEST (testDwaLookups, "core");
     TEST (testIDManifest, "core");
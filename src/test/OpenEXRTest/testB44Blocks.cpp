@@ -0,0 +1,493 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include <ImathRandom.h>
+#include <ImfChannelList.h>
+#include <ImfCompressor.h>
+#include <ImfHeader.h>
+#include <ImfNamespace.h>
+#include <algorithm>
+#include <assert.h>
+#include <iostream>
+#include <string.h>
+#include <string>
+#include <vector>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+#include "b44ExpLogTable.h"
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace IMATH_NAMESPACE;
+using namespace std;
+
+namespace
+{
+
+//
+// Scalar versions of the B44 block packing and unpacking, the output
+// of which the vectorized code in the library must match bit for bit
+//
+
+int
+shiftAndRound (int x, int shift)
+{
+    x <<= 1;
+    int a = (1 << shift) - 1;
+    shift += 1;
+    int b = (x >> shift) & 1;
+    return (x + a + b) >> shift;
+}
+
+int
+referencePack (
+    const unsigned short s[16],
+    unsigned char        b[14],
+    bool                 optFlatFields,
+    bool                 exactMax)
+{
+    unsigned short t[16];
+
+    for (int i = 0; i < 16; ++i)
+    {
+        if ((s[i] & 0x7c00) == 0x7c00)
+            t[i] = 0x8000;
+        else if (s[i] & 0x8000)
+            t[i] = ~s[i];
+        else
+            t[i] = s[i] | 0x8000;
+    }
+
+    unsigned short tMax = 0;
+
+    for (int i = 0; i < 16; ++i)
+        if (tMax < t[i]) tMax = t[i];
+
+    int shift = -1;
+    int d[16];
+    int r[15];
+    int rMin;
+    int rMax;
+
+    const int bias = 0x20;
+
+    do
+    {
+        shift += 1;
+
+        for (int i = 0; i < 16; ++i)
+            d[i] = shiftAndRound (tMax - t[i], shift);
+
+        r[0] = d[0] - d[4] + bias;
+        r[1] = d[4] - d[8] + bias;
+        r[2] = d[8] - d[12] + bias;
+
+        r[3] = d[0] - d[1] + bias;
+        r[4] = d[4] - d[5] + bias;
+        r[5] = d[8] - d[9] + bias;
+        r[6] = d[12] - d[13] + bias;
+
+        r[7]  = d[1] - d[2] + bias;
+        r[8]  = d[5] - d[6] + bias;
+        r[9]  = d[9] - d[10] + bias;
+        r[10] = d[13] - d[14] + bias;
+
+        r[11] = d[2] - d[3] + bias;
+        r[12] = d[6] - d[7] + bias;
+        r[13] = d[10] - d[11] + bias;
+        r[14] = d[14] - d[15] + bias;
+
+        rMin = r[0];
+        rMax = r[0];
+
+        for (int i = 1; i < 15; ++i)
+        {
+            if (rMin > r[i]) rMin = r[i];
+
+            if (rMax < r[i]) rMax = r[i];
+        }
+    } while (rMin < 0 || rMax > 0x3f);
+
+    if (rMin == bias && rMax == bias && optFlatFields)
+    {
+        b[0] = (t[0] >> 8);
+        b[1] = (unsigned char) t[0];
+        b[2] = 0xfc;
+
+        return 3;
+    }
+
+    if (exactMax) t[0] = tMax - (d[0] << shift);
+
+    b[0] = (t[0] >> 8);
+    b[1] = (unsigned char) t[0];
+
+    b[2] = (unsigned char) ((shift << 2) | (r[0] >> 4));
+    b[3] = (unsigned char) ((r[0] << 4) | (r[1] >> 2));
+    b[4] = (unsigned char) ((r[1] << 6) | r[2]);
+
+    b[5] = (unsigned char) ((r[3] << 2) | (r[4] >> 4));
+    b[6] = (unsigned char) ((r[4] << 4) | (r[5] >> 2));
+    b[7] = (unsigned char) ((r[5] << 6) | r[6]);
+
+    b[8]  = (unsigned char) ((r[7] << 2) | (r[8] >> 4));
+    b[9]  = (unsigned char) ((r[8] << 4) | (r[9] >> 2));
+    b[10] = (unsigned char) ((r[9] << 6) | r[10]);
+
+    b[11] = (unsigned char) ((r[11] << 2) | (r[12] >> 4));
+    b[12] = (unsigned char) ((r[12] << 4) | (r[13] >> 2));
+    b[13] = (unsigned char) ((r[13] << 6) | r[14]);
+
+    return 14;
+}
+
+void
+referenceUnpack14 (const unsigned char b[14], unsigned short s[16])
+{
+    s[0] = (b[0] << 8) | b[1];
+
+    unsigned short shift = (b[2] >> 2);
+    unsigned short bias  = (0x20u << shift);
+
+    s[4]  = s[0] + ((((b[2] << 4) | (b[3] >> 4)) & 0x3fu) << shift) - bias;
+    s[8]  = s[4] + ((((b[3] << 2) | (b[4] >> 6)) & 0x3fu) << shift) - bias;
+    s[12] = s[8] + ((b[4] & 0x3fu) << shift) - bias;
+
+    s[1]  = s[0] + ((unsigned int) (b[5] >> 2) << shift) - bias;
+    s[5]  = s[4] + ((((b[5] << 4) | (b[6] >> 4)) & 0x3fu) << shift) - bias;
+    s[9]  = s[8] + ((((b[6] << 2) | (b[7] >> 6)) & 0x3fu) << shift) - bias;
+    s[13] = s[12] + ((b[7] & 0x3fu) << shift) - bias;
+
+    s[2]  = s[1] + ((unsigned int) (b[8] >> 2) << shift) - bias;
+    s[6]  = s[5] + ((((b[8] << 4) | (b[9] >> 4)) & 0x3fu) << shift) - bias;
+    s[10] = s[9] + ((((b[9] << 2) | (b[10] >> 6)) & 0x3fu) << shift) - bias;
+    s[14] = s[13] + ((b[10] & 0x3fu) << shift) - bias;
+
+    s[3]  = s[2] + ((unsigned int) (b[11] >> 2) << shift) - bias;
+    s[7]  = s[6] + ((((b[11] << 4) | (b[12] >> 4)) & 0x3fu) << shift) - bias;
+    s[11] = s[10] + ((((b[12] << 2) | (b[13] >> 6)) & 0x3fu) << shift) - bias;
+    s[15] = s[14] + ((b[13] & 0x3fu) << shift) - bias;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        if (s[i] & 0x8000)
+            s[i] &= 0x7fff;
+        else
+            s[i] = ~s[i];
+    }
+}
+
+void
+referenceUnpack3 (const unsigned char b[3], unsigned short s[16])
+{
+    s[0] = (b[0] << 8) | b[1];
+
+    if (s[0] & 0x8000)
+        s[0] &= 0x7fff;
+    else
+        s[0] = ~s[0];
+
+    for (int i = 1; i < 16; ++i)
+        s[i] = s[0];
+}
+
+//
+// Half bit patterns which pack() maps specially: zeroes, denormals,
+// HALF_MAX, infinities and NaNs
+//
+
+const unsigned short specialHalfs[] = {
+    0x0000, 0x8000, 0x0001, 0x8001, 0x03ff, 0x83ff, 0x3c00, 0xbc00,
+    0x7bff, 0xfbff, 0x7c00, 0xfc00, 0x7c01, 0x7e00, 0x7fff, 0xffff};
+
+const int numSpecialHalfs = sizeof (specialHalfs) / sizeof (specialHalfs[0]);
+
+unsigned short
+randomHalf (Rand48& rand48)
+{
+    if (rand48.nextf () < .25)
+        return specialHalfs[rand48.nexti () % numSpecialHalfs];
+
+    return (unsigned short) rand48.nexti ();
+}
+
+//
+// A 4x4 block which is flat (the 3 byte encoding with B44A), made of
+// special values only, flat apart from one NaN or infinity, close
+// together so that small shifts are used, or random
+//
+
+void
+fillBlock (unsigned short s[16], Rand48& rand48)
+{
+    switch (rand48.nexti () % 5)
+    {
+        case 0:
+        {
+            unsigned short v = randomHalf (rand48);
+
+            for (int i = 0; i < 16; ++i)
+                s[i] = v;
+        }
+        break;
+
+        case 1:
+            for (int i = 0; i < 16; ++i)
+                s[i] = specialHalfs[rand48.nexti () % numSpecialHalfs];
+            break;
+
+        case 2:
+        {
+            unsigned short v = randomHalf (rand48);
+
+            for (int i = 0; i < 16; ++i)
+                s[i] = v;
+
+            s[rand48.nexti () % 16] =
+                specialHalfs[10 + rand48.nexti () % (numSpecialHalfs - 10)];
+        }
+        break;
+
+        case 3:
+        {
+            unsigned short v    = (unsigned short) rand48.nexti ();
+            int            bits = rand48.nexti () % 12;
+
+            for (int i = 0; i < 16; ++i)
+                s[i] = v + (rand48.nexti () & ((1 << bits) - 1));
+        }
+        break;
+
+        default:
+            for (int i = 0; i < 16; ++i)
+                s[i] = (unsigned short) rand48.nexti ();
+            break;
+    }
+}
+
+//
+// Compress a w by h image with a linear and a perceptually linear HALF
+// channel, check the packed blocks, including the padded ones along the
+// right and bottom edges, against the scalar packer, and check that
+// uncompressing gives what the scalar unpacker gives.
+//
+
+void
+testImage (int w, int h, Compression comp, Rand48& rand48)
+{
+    const bool optFlatFields = (comp == B44A_COMPRESSION);
+
+    int                    bw = (w + 3) / 4, bh = (h + 3) / 4;
+    vector<unsigned short> pixels[2];
+
+    for (int c = 0; c < 2; ++c)
+    {
+        vector<unsigned short> padded (bw * 4 * bh * 4);
+
+        for (int by = 0; by < bh; ++by)
+        {
+            for (int bx = 0; bx < bw; ++bx)
+            {
+                unsigned short s[16];
+                fillBlock (s, rand48);
+
+                for (int i = 0; i < 16; ++i)
+                    padded[(by * 4 + i / 4) * bw * 4 + bx * 4 + i % 4] = s[i];
+            }
+        }
+
+        pixels[c].resize (w * h);
+
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x)
+                pixels[c][y * w + x] = padded[y * bw * 4 + x];
+    }
+
+    Header hdr (w, h);
+    hdr.compression () = comp;
+    hdr.channels ().insert ("H", Channel (HALF));
+    hdr.channels ().insert ("L", Channel (HALF, 1, 1, true));
+
+    size_t       lineSize = w * 2 * sizeof (unsigned short);
+    vector<char> in (lineSize * h);
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int c = 0; c < 2; ++c)
+        {
+            memcpy (
+                in.data () + y * lineSize + c * w * sizeof (unsigned short),
+                pixels[c].data () + y * w,
+                w * sizeof (unsigned short));
+        }
+    }
+
+    Compressor* compressor = newCompressor (comp, lineSize, hdr);
+    assert (compressor);
+    assert (compressor->numScanLines () >= h);
+
+    const char* compressed;
+    int         compressedSize =
+        compressor->compress (in.data (), (int) in.size (), 0, compressed);
+
+    //
+    // Pack and unpack the same blocks with the scalar code.
+    //
+
+    vector<unsigned char>  expected;
+    vector<unsigned short> decoded[2];
+
+    for (int c = 0; c < 2; ++c)
+    {
+        const bool pLinear = (c == 1);
+
+        decoded[c].resize (w * h);
+
+        for (int by = 0; by < bh; ++by)
+        {
+            for (int bx = 0; bx < bw; ++bx)
+            {
+                unsigned short s[16];
+
+                for (int i = 0; i < 16; ++i)
+                {
+                    int x = min (bx * 4 + i % 4, w - 1);
+                    int y = min (by * 4 + i / 4, h - 1);
+                    s[i]  = pixels[c][y * w + x];
+                }
+
+                if (pLinear)
+                    for (int i = 0; i < 16; ++i)
+                        s[i] = expTable[s[i]];
+
+                unsigned char b[14];
+                int           n =
+                    referencePack (s, b, optFlatFields, !pLinear);
+
+                expected.insert (expected.end (), b, b + n);
+
+                if (n == 3)
+                    referenceUnpack3 (b, s);
+                else
+                    referenceUnpack14 (b, s);
+
+                if (pLinear)
+                    for (int i = 0; i < 16; ++i)
+                        s[i] = logTable[s[i]];
+
+                for (int i = 0; i < 16; ++i)
+                {
+                    int x = bx * 4 + i % 4;
+                    int y = by * 4 + i / 4;
+
+                    if (x < w && y < h) decoded[c][y * w + x] = s[i];
+                }
+            }
+        }
+    }
+
+    if (compressedSize != (int) expected.size ())
+    {
+        cout << w << " x " << h << ": " << compressedSize
+             << " compressed bytes, expected " << expected.size () << endl;
+        assert (false);
+    }
+
+    for (size_t i = 0; i < expected.size (); ++i)
+    {
+        if ((unsigned char) compressed[i] != expected[i])
+        {
+            cout << w << " x " << h << ": compressed byte " << i << " is "
+                 << int ((unsigned char) compressed[i]) << ", expected "
+                 << int (expected[i]) << endl;
+            assert (false);
+        }
+    }
+
+    const char* out;
+    int         outSize =
+        compressor->uncompress (compressed, compressedSize, 0, out);
+    assert (outSize == (int) in.size ());
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int c = 0; c < 2; ++c)
+        {
+            for (int x = 0; x < w; ++x)
+            {
+                unsigned short v;
+
+                memcpy (
+                    &v,
+                    out + y * lineSize + (c * w + x) * sizeof (v),
+                    sizeof (v));
+
+                if (v != decoded[c][y * w + x])
+                {
+                    cout << w << " x " << h << ": channel " << c
+                         << " pixel " << x << ", " << y << " is 0x" << hex
+                         << v << ", expected 0x" << decoded[c][y * w + x]
+                         << dec << endl;
+                    assert (false);
+                }
+            }
+        }
+    }
+
+    delete compressor;
+}
+
+} // namespace
+
+void
+testB44Blocks (const string&)
+{
+    cout << "B44 block packing:" << endl;
+
+    try
+    {
+        Compression comps[] = {B44_COMPRESSION, B44A_COMPRESSION};
+
+        for (int i = 0; i < 2; ++i)
+        {
+            Rand48 rand48 (i);
+
+            cout << "   " << (i ? "B44A" : "B44")
+                 << ": comparing with the reference packer" << endl;
+
+            for (int h = 1; h <= 9; ++h)
+                for (int w = 1; w <= 13; ++w)
+                    for (int iter = 0; iter < 10; ++iter)
+                        testImage (w, h, comps[i], rand48);
+
+            for (int iter = 0; iter < 50; ++iter)
+            {
+                testImage (
+                    (int) rand48.nextf (1.0, 300.0),
+                    (int) rand48.nextf (1.0, 32.0),
+                    comps[i],
+                    rand48);
+            }
+        }
+    }
+    catch (const exception& e)
+    {
+        cout << "unexpected exception: " << e.what () << endl;
+        assert (false);
+    }
+    catch (...)
+    {
+        cout << "unexpected exception" << endl;
+        assert (false);
+    }
+
+    cout << "ok\n" << endl;
+}
@@ -0,0 +1,12 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef TESTB44BLOCKS_H_
+#define TESTB44BLOCKS_H_
+
+#include <string>
+void testB44Blocks (const std::string&);
+
+#endif /* TESTB44BLOCKS_H_ */
@@ -11,6 +11,7 @@
 #include "random.h"
 
 #include <Iex.h>
+#include <algorithm>
 #include <assert.h>
 #include <iostream>
 #include <ostream>
@@ -24,6 +25,7 @@
 #include <ImfChannelList.h>
 #include <ImfCompositeDeepScanLine.h>
 #include <ImfCompression.h>
+#include <ImfDeepCompositing.h>
 #include <ImfDeepFrameBuffer.h>
 #include <ImfDeepScanLineInputPart.h>
 #include <ImfDeepScanLineOutputPart.h>
@@ -54,6 +56,7 @@ using OPENEXR_IMF_NAMESPACE::MultiPartInputFile;
 using IMATH_NAMESPACE::Box2i;
 using OPENEXR_IMF_NAMESPACE::CompositeDeepScanLine;
 using OPENEXR_IMF_NAMESPACE::DeepFrameBuffer;
+using OPENEXR_IMF_NAMESPACE::DeepCompositing;
 using OPENEXR_IMF_NAMESPACE::DEEPSCANLINE;
 using OPENEXR_IMF_NAMESPACE::DeepSlice;
 using OPENEXR_IMF_NAMESPACE::FLOAT;
@@ -638,6 +641,122 @@ test_parts (
     remove (fn.c_str ());
 }
 
+//
+// the original one-sample-at-a-time compositing loop, which the default
+// DeepCompositing must match exactly
+//
+void
+reference_composite (
+    vector<float>&              outputs,
+    const vector<const float*>& inputs,
+    const vector<int>&          order)
+{
+    for (size_t c = 0; c < outputs.size (); c++)
+        outputs[c] = 0.0f;
+    for (size_t i = 0; i < order.size (); i++)
+    {
+        float alpha = outputs[2];
+        if (alpha >= 1.0f) return;
+        for (size_t c = 0; c < outputs.size (); c++)
+            outputs[c] += (1.0f - alpha) * inputs[c][order[i]];
+    }
+}
+
+// composites back to front, to check a replaced sort() is used
+class ReverseCompositing : public DeepCompositing
+{
+public:
+    void sort (
+        int          order[],
+        const float* inputs[],
+        const char*  channel_names[],
+        int          num_channels,
+        int          num_samples,
+        int          sources) override
+    {
+        for (int i = 0; i < num_samples; i++)
+            order[i] = num_samples - 1 - i;
+    }
+};
+
+void
+test_composite_pixel ()
+{
+    cout << "Testing DeepCompositing::composite_pixel directly\n" << endl;
+
+    DeepCompositing    comp;
+    ReverseCompositing reverse;
+
+    // sample counts either side of the small pixel limit, and channel
+    // counts either side of a multiple of four
+    for (int num_channels = 3; num_channels <= 9; num_channels++)
+    {
+        for (int num_samples = 0; num_samples <= 80; num_samples += 7)
+        {
+            vector<vector<float>> samples (num_channels);
+            vector<const float*>  inputs (num_channels);
+            vector<const char*>   names (num_channels, "C");
+            for (int c = 0; c < num_channels; c++)
+            {
+                samples[c].resize (num_samples + 1);
+                for (int s = 0; s < num_samples; s++)
+                {
+                    if (c < 2)
+                        // few distinct depths, so ties happen
+                        samples[c][s] = float (random_int (8));
+                    else
+                        samples[c][s] = random_float (c == 2 ? 0.2f : 4.0f);
+                }
+                inputs[c] = &samples[c][0];
+            }
+
+            vector<float> expected (num_channels);
+            vector<float> outputs (num_channels);
+
+            for (int sources = 1; sources <= 2; sources++)
+            {
+                vector<int> order (num_samples);
+                for (int i = 0; i < num_samples; i++)
+                    order[i] = i;
+                if (sources > 1)
+                {
+                    std::stable_sort (
+                        order.begin (), order.end (), [&] (int a, int b) {
+                            if (inputs[0][a] != inputs[0][b])
+                                return inputs[0][a] < inputs[0][b];
+                            return inputs[1][a] < inputs[1][b];
+                        });
+                }
+
+                reference_composite (expected, inputs, order);
+                comp.composite_pixel (
+                    &outputs[0],
+                    &inputs[0],
+                    &names[0],
+                    num_channels,
+                    num_samples,
+                    sources);
+                assert (outputs == expected);
+
+                if (sources > 1)
+                {
+                    for (int i = 0; i < num_samples; i++)
+                        order[i] = num_samples - 1 - i;
+                    reference_composite (expected, inputs, order);
+                    reverse.composite_pixel (
+                        &outputs[0],
+                        &inputs[0],
+                        &names[0],
+                        num_channels,
+                        num_samples,
+                        sources);
+                    assert (outputs == expected);
+                }
+            }
+        }
+    }
+}
+
 } // namespace
 
 void
@@ -652,6 +771,8 @@ testCompositeDeepScanLine (const std::string& tempDir)
 
     random_reseed (1);
 
+    test_composite_pixel ();
+
     for (int pass = 0; pass < 2; pass++)
     {
 
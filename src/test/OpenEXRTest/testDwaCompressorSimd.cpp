@@ -545,6 +545,158 @@ testFromHalfZigZag ()
 #endif // IMF_HAVE_NEON_AARCH64
 }
 
+//
+// Fill a block of DCT coefficients for testQuantize (). Most are
+// random, the rest are values the vector conversion or candidate
+// search could get wrong: zeros of either sign, float and half
+// denormals, NaNs with and without payloads, infinities, and the
+// values around HALF_MAX.
+//
+
+float
+floatFromBits (unsigned int bits)
+{
+    float f;
+    memcpy (&f, &bits, sizeof (f));
+    return f;
+}
+
+void
+fillQuantizeBlock (float* coef, float* tolerance, Rand48& rand48)
+{
+    static const float special[] = {
+        0.f,
+        -0.f,
+        1e-40f,
+        -1e-40f,
+        floatFromBits (0x00000001),
+        6e-8f,
+        -6e-8f,
+        3e-5f,
+        floatFromBits (0x7fc00000),
+        floatFromBits (0xffc00001),
+        floatFromBits (0x7f800001),
+        floatFromBits (0x7fa00000),
+        floatFromBits (0x7f800000),
+        floatFromBits (0xff800000),
+        HALF_MAX,
+        -HALF_MAX,
+        65519.f,
+        65520.f,
+        -65520.f,
+        1e10f};
+
+    const int numSpecial = sizeof (special) / sizeof (special[0]);
+
+    for (int i = 0; i < 64; ++i)
+    {
+        float r = rand48.nextf ();
+
+        if (r < .2)
+            coef[i] = special[rand48.nexti () % numSpecial];
+        else if (r < .6)
+            coef[i] = (float) 140000 * (rand48.nextf () - .5);
+        else
+            coef[i] = (float) (rand48.nextf () - .5);
+
+        r = rand48.nextf ();
+
+        if (r < .1)
+            tolerance[i] = 0.f;
+        else if (r < .15)
+            tolerance[i] = floatFromBits (0x7f800000);
+        else
+            tolerance[i] = (float) rand48.nextf (0, 2) * fabsf (coef[i]);
+    }
+}
+
+void
+compareQuantize (
+    const unsigned short* expected,
+    const unsigned short* test,
+    const float*          coef,
+    const float*          tolerance)
+{
+    for (int i = 0; i < 64; ++i)
+    {
+        if (expected[i] != test[i])
+        {
+            int z = zigZagOrder[i];
+
+            cout << "At index " << i << ": coefficient " << coef[z]
+                 << ", tolerance " << tolerance[z] << ", expecting 0x" << hex
+                 << expected[i] << "; got 0x" << test[i] << dec << endl;
+            assert (false);
+        }
+    }
+}
+
+//
+// Test quantizing a block of DCT coefficients, and finding the
+// zero runs in the result, against the scalar implementations
+//
+void
+testQuantize ()
+{
+    const int            numIter = 200000;
+    Rand48               rand48 (0);
+    SimdAlignedBuffer64f coef;
+    SimdAlignedBuffer64f tolerance;
+    unsigned short       expected[64];
+    unsigned short       test[64];
+
+    cout << "   Quantization of DCT coefficients" << endl;
+
+    cout << "      zeroMask64()" << endl;
+    for (int iter = 0; iter < numIter; ++iter)
+    {
+        fillQuantizeBlock (coef._buffer, tolerance._buffer, rand48);
+        quantizeCoeffs64_scalar (expected, coef._buffer, tolerance._buffer);
+
+        uint64_t mask = 0;
+        for (int i = 0; i < 64; ++i)
+            if (expected[i] == 0) mask |= (uint64_t) 1 << i;
+
+        assert (zeroMask64 (expected) == mask);
+    }
+
+#ifdef IMF_HAVE_F16C_TARGET
+    CpuId cpuid;
+    if (cpuid.avx && cpuid.f16c)
+    {
+        cout << "      quantizeCoeffs64_f16c()" << endl;
+        for (int iter = 0; iter < numIter; ++iter)
+        {
+            fillQuantizeBlock (coef._buffer, tolerance._buffer, rand48);
+
+            quantizeCoeffs64_scalar (
+                expected, coef._buffer, tolerance._buffer);
+            quantizeCoeffs64_f16c (test, coef._buffer, tolerance._buffer);
+
+            compareQuantize (
+                expected, test, coef._buffer, tolerance._buffer);
+        }
+    }
+#endif // IMF_HAVE_F16C_TARGET
+
+#ifdef IMF_HAVE_NEON_AARCH64
+    {
+        cout << "      quantizeCoeffs64_neon()" << endl;
+        for (int iter = 0; iter < numIter; ++iter)
+        {
+            fillQuantizeBlock (coef._buffer, tolerance._buffer, rand48);
+
+            quantizeCoeffs64_scalar (
+                expected, coef._buffer, tolerance._buffer);
+            quantizeCoeffs64_neon (test, coef._buffer, tolerance._buffer);
+
+            compareQuantize (
+                expected, test, coef._buffer, tolerance._buffer);
+        }
+    }
+#endif // IMF_HAVE_NEON_AARCH64
+}
+
 } // namespace
 
 void
@@ -559,6 +711,7 @@ testDwaCompressorSimd (const string&)
         testInterleave ();
         testFloatToHalf ();
         testFromHalfZigZag ();
+        testQuantize ();
 
         testDct ();
     }
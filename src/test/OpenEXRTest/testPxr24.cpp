@@ -0,0 +1,262 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include <ImathRandom.h>
+#include <ImfChannelList.h>
+#include <ImfCompressor.h>
+#include <ImfHeader.h>
+#include <assert.h>
+#include <iostream>
+#include <openexr_compression.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace IMATH_NAMESPACE;
+using namespace std;
+
+namespace
+{
+
+//
+// Bit at a time version of the 32 to 24 bit float conversion of the
+// PXR24 compressor, the output of which the library must not change
+//
+
+unsigned int
+referenceFloatToFloat24 (unsigned int bits)
+{
+    unsigned int s = bits & 0x80000000;
+    unsigned int e = bits & 0x7f800000;
+    unsigned int m = bits & 0x007fffff;
+    unsigned int i;
+
+    if (e == 0x7f800000)
+    {
+        if (m)
+        {
+            m >>= 8;
+            i = (e >> 8) | m | (m == 0);
+        }
+        else
+            i = e >> 8;
+    }
+    else
+    {
+        i = ((e | m) + (m & 0x00000080)) >> 8;
+
+        if (i >= 0x7f8000) i = (e | m) >> 8;
+    }
+
+    return (s >> 8) | i;
+}
+
+//
+// Scalar version of the per row transform, the differences between
+// neighbouring pixels split in to byte planes, most significant first
+//
+
+void
+referenceRow (
+    const unsigned int* pixels, int w, int numBytes, unsigned char* out)
+{
+    unsigned int previousPixel = 0;
+
+    for (int x = 0; x < w; ++x)
+    {
+        unsigned int diff = pixels[x] - previousPixel;
+        previousPixel     = pixels[x];
+
+        for (int b = 0; b < numBytes; ++b)
+            out[b * w + x] =
+                (unsigned char) (diff >> (8 * (numBytes - 1 - b)));
+    }
+}
+
+//
+// Float bit patterns the conversion to 24 bits could get wrong
+//
+
+const unsigned int specialFloats[] = {
+    0x00000000, // 0
+    0x80000000, // -0
+    0x00000001, // smallest denormal
+    0x007fffff, // largest denormal
+    0x807fff80, // negative denormal which rounds up
+    0x3f800000, // 1
+    0x3f8000ff, // 1, rounds up
+    0x3f80007f, // 1, rounds down
+    0x3f80ff80, // ties round up
+    0x7f7fffff, // FLT_MAX, truncated instead of rounded
+    0xff7fffff, // -FLT_MAX
+    0x7f7fff80, // rounds in to the exponent of infinity
+    0x7f7fff7f, // largest that rounds down
+    0x7f800000, // inf
+    0xff800000, // -inf
+    0x7fc00000, // quiet NaN
+    0xffc00000, // negative quiet NaN
+    0x7f800001, // NaN which loses its whole payload
+    0x7f8000ff, // the same, more low bits set
+    0xff800080, // negative NaN with a payload bit left
+    0x7fffffff  // NaN with all significand bits set
+};
+
+const int numSpecialFloats = sizeof (specialFloats) / sizeof (specialFloats[0]);
+
+//
+// Compress one scan line of w pixels with a FLOAT, a HALF and a UINT
+// channel, check that the transform before zlib matches the scalar
+// version, and that uncompressing gives back the 24 bit floats and
+// the unchanged half and unsigned int values.
+//
+
+void
+testRow (int w, Rand48& rand48)
+{
+    vector<unsigned int>   f (w), f24 (w), h (w), u (w);
+    vector<unsigned short> h16 (w);
+
+    for (int x = 0; x < w; ++x)
+    {
+        float r = rand48.nextf ();
+
+        if (r < .25)
+            f[x] = specialFloats[rand48.nexti () % numSpecialFloats];
+        else if (r < .5)
+            f[x] = (rand48.nexti () & 0x80000000) | 0x7f7fff00 |
+                   (rand48.nexti () & 0xff);
+        else
+            f[x] = (unsigned int) rand48.nexti ();
+
+        f24[x] = referenceFloatToFloat24 (f[x]);
+        h[x] = h16[x] = (unsigned short) rand48.nexti ();
+        u[x]          = (unsigned int) rand48.nexti ();
+    }
+
+    Header hdr (w, 1);
+    hdr.compression () = PXR24_COMPRESSION;
+    hdr.channels ().insert ("F", Channel (FLOAT));
+    hdr.channels ().insert ("H", Channel (HALF));
+    hdr.channels ().insert ("U", Channel (UINT));
+
+    size_t       lineSize = w * (sizeof (float) + 2 + sizeof (unsigned int));
+    vector<char> in (lineSize);
+    char*        p = in.data ();
+
+    memcpy (p, f.data (), w * sizeof (float));
+    p += w * sizeof (float);
+    memcpy (p, h16.data (), w * 2);
+    p += w * 2;
+    memcpy (p, u.data (), w * sizeof (unsigned int));
+
+    Compressor* c = newCompressor (PXR24_COMPRESSION, lineSize, hdr);
+    assert (c);
+
+    const char* compressed;
+    int         compressedSize =
+        c->compress (in.data (), (int) lineSize, 0, compressed);
+
+    //
+    // Byte planes, 3 for FLOAT, 2 for HALF and 4 for UINT
+    //
+
+    vector<unsigned char> planes (9 * w), expected (9 * w);
+    size_t                planesSize = 0;
+
+    assert (
+        exr_uncompress_buffer (
+            nullptr,
+            compressed,
+            compressedSize,
+            planes.data (),
+            planes.size (),
+            &planesSize) == EXR_ERR_SUCCESS);
+    assert (planesSize == planes.size ());
+
+    referenceRow (f24.data (), w, 3, expected.data ());
+    referenceRow (h.data (), w, 2, expected.data () + 3 * w);
+    referenceRow (u.data (), w, 4, expected.data () + 5 * w);
+
+    for (size_t i = 0; i < planes.size (); ++i)
+    {
+        if (planes[i] != expected[i])
+        {
+            cout << "width " << w << ": byte " << i << " of the transformed "
+                 << "row is " << int (planes[i]) << ", expected "
+                 << int (expected[i]) << endl;
+            assert (false);
+        }
+    }
+
+    const char* out;
+    int         outSize = c->uncompress (compressed, compressedSize, 0, out);
+    assert (outSize == (int) lineSize);
+
+    for (int x = 0; x < w; ++x)
+    {
+        unsigned int   fv, uv;
+        unsigned short hv;
+
+        memcpy (&fv, out + x * sizeof (float), sizeof (fv));
+        memcpy (&hv, out + w * sizeof (float) + x * 2, sizeof (hv));
+        memcpy (&uv, out + w * (sizeof (float) + 2) + x * sizeof (uv), 4);
+
+        if (fv != f24[x] << 8)
+        {
+            cout << "width " << w << ": float 0x" << hex << f[x]
+                 << " came back as 0x" << fv << ", expected 0x" << (f24[x] << 8)
+                 << dec << endl;
+            assert (false);
+        }
+
+        assert (hv == h16[x]);
+        assert (uv == u[x]);
+    }
+
+    delete c;
+}
+
+} // namespace
+
+void
+testPxr24 (const string&)
+{
+    cout << "PXR24 row transform:" << endl;
+
+    try
+    {
+        Rand48 rand48 (0);
+
+        cout << "   Comparing rows of every width up to 100 with the "
+                "reference encoding"
+             << endl;
+
+        for (int w = 1; w <= 100; ++w)
+            for (int iter = 0; iter < 20; ++iter)
+                testRow (w, rand48);
+
+        cout << "   Comparing wide rows with the reference encoding" << endl;
+
+        for (int iter = 0; iter < 100; ++iter)
+            testRow ((int) rand48.nextf (100.0, 5000.0), rand48);
+    }
+    catch (const exception& e)
+    {
+        cout << "unexpected exception: " << e.what () << endl;
+        assert (false);
+    }
+    catch (...)
+    {
+        cout << "unexpected exception" << endl;
+        assert (false);
+    }
+
+    cout << "ok\n" << endl;
+}
@@ -0,0 +1,12 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef TESTPXR24_H_
+#define TESTPXR24_H_
+
+#include <string>
+void testPxr24 (const std::string&);
+
+#endif /* TESTPXR24_H_ */
@@ -11,17 +11,23 @@
 #include "compareDwa.h"
 
 #include <IlmThread.h>
+#include <IlmThreadPool.h>
 #include <ImathRandom.h>
 #include <ImfArray.h>
 #include <ImfRgbaFile.h>
 #include <ImfThreading.h>
 #include <assert.h>
+#include <atomic>
 #include <stdio.h>
 #include <string>
 
 using namespace OPENEXR_IMF_NAMESPACE;
 using namespace std;
 using namespace IMATH_NAMESPACE;
+using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskGroup;
+using ILMTHREAD_NAMESPACE::ThreadPool;
+using ILMTHREAD_NAMESPACE::WorkStealingThreadPoolProvider;
 
 namespace
 {
@@ -157,6 +163,33 @@ writeReadRGBA (
     remove (fileName);
 }
 
+//
+// A task which adds more tasks to the pool from within a worker
+//
+
+class CountTask : public Task
+{
+public:
+    CountTask (TaskGroup* group, std::atomic<int>& count, int depth)
+        : Task (group), _count (count), _depth (depth)
+    {}
+
+    void execute () override
+    {
+        ++_count;
+        if (_depth > 0)
+        {
+            for (int i = 0; i < 4; ++i)
+                ThreadPool::addGlobalTask (
+                    new CountTask (group (), _count, _depth - 1));
+        }
+    }
+
+private:
+    std::atomic<int>& _count;
+    int               _depth;
+};
+
 } // namespace
 
 void
@@ -243,6 +276,50 @@ testRgbaThreading (const std::string& tempDir)
         }
 
         cout << "ok\n" << endl;
+
+        cout << "Testing the work-stealing thread provider" << endl;
+
+        ThreadPool& pool = ThreadPool::globalThreadPool ();
+        pool.setThreadProvider (new WorkStealingThreadPoolProvider (4));
+
+        for (int i = 0; i < 1000; i++)
+            pool.setNumThreads (int (rand1.nextf () * 31 + 1.5f));
+
+        for (int numThreads = 1; numThreads <= 8; numThreads *= 2)
+        {
+            pool.setNumThreads (numThreads);
+            cout << "number of threads: " << pool.numThreads () << endl;
+
+            {
+                // 1 + 4 + 16 + 64 + 256 tasks
+                std::atomic<int> count (0);
+                {
+                    TaskGroup group;
+                    pool.addTask (new CountTask (&group, count, 4));
+                }
+                assert (count == 341);
+            }
+
+            for (int comp = 0; comp < NUM_COMPRESSION_METHODS; ++comp)
+            {
+                for (int lorder = 0; lorder < RANDOM_Y; ++lorder)
+                {
+                    writeReadRGBA (
+                        (tempDir + "imf_test_rgba.exr").c_str (),
+                        W,
+                        H,
+                        p1,
+                        WRITE_RGBA,
+                        LineOrder (lorder),
+                        Compression (comp));
+                }
+            }
+        }
+
+        // back to the default provider
+        setGlobalThreadCount (0);
+
+        cout << "ok\n" << endl;
     }
     catch (const std::exception& e)
     {
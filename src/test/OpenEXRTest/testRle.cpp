@@ -54,18 +54,86 @@ generateData (char* buffer, int bufferLen)
     }
 }
 
-// Compress, decompress, and compare with the original
+// Generate short runs of random lengths, so runs and literals start and
+// end at every offset within a vector
 void
-testRoundTrip (int bufferLen)
+generateShortRuns (char* buffer, int bufferLen, Rand48& rand48)
+{
+    int i = 0;
+
+    while (i < bufferLen)
+    {
+        char value  = (char) rand48.nexti ();
+        int  runLen = (int) rand48.nextf (1.0, 5.0);
+
+        if (rand48.nextf () < .05) runLen = (int) rand48.nextf (100.0, 300.0);
+
+        for (int j = 0; j < runLen && i < bufferLen; ++j)
+            buffer[i++] = value;
+    }
+}
+
+// Byte at a time version of rleCompress (), the encoding of which the
+// library must not change
+int
+referenceCompress (int inLength, const char in[], signed char out[])
+{
+    const int    minRun   = 3;
+    const int    maxRun   = 127;
+    const char*  inEnd    = in + inLength;
+    const char*  runStart = in;
+    const char*  runEnd   = in + 1;
+    signed char* outWrite = out;
+
+    while (runStart < inEnd)
+    {
+        while (runEnd < inEnd && *runStart == *runEnd &&
+               runEnd - runStart - 1 < maxRun)
+            ++runEnd;
+
+        if (runEnd - runStart >= minRun)
+        {
+            *outWrite++ = (runEnd - runStart) - 1;
+            *outWrite++ = *(signed char*) runStart;
+            runStart    = runEnd;
+        }
+        else
+        {
+            while (runEnd < inEnd &&
+                   ((runEnd + 1 >= inEnd || *runEnd != *(runEnd + 1)) ||
+                    (runEnd + 2 >= inEnd || *(runEnd + 1) != *(runEnd + 2))) &&
+                   runEnd - runStart < maxRun)
+                ++runEnd;
+
+            *outWrite++ = runStart - runEnd;
+
+            while (runStart < runEnd)
+                *outWrite++ = *(signed char*) (runStart++);
+        }
+
+        ++runEnd;
+    }
+
+    return outWrite - out;
+}
+
+// Compress, compare with the reference encoding, decompress, and
+// compare with the original
+void
+testRoundTrip (const char* src, int bufferLen)
 {
-    char*        src        = new char[bufferLen];
     signed char* compressed = new signed char[2 * bufferLen];
+    signed char* reference  = new signed char[2 * bufferLen];
     char*        test       = new char[bufferLen];
 
-    generateData (src, bufferLen);
-
     int compressedLen = rleCompress (bufferLen, src, compressed);
 
+    assert (compressedLen == referenceCompress (bufferLen, src, reference));
+    for (int i = 0; i < compressedLen; ++i)
+    {
+        assert (compressed[i] == reference[i]);
+    }
+
     assert (rleUncompress (compressedLen, bufferLen, compressed, test) > 0);
 
     for (int i = 0; i < bufferLen; ++i)
@@ -73,11 +141,22 @@ testRoundTrip (int bufferLen)
         assert (src[i] == test[i]);
     }
 
-    delete[] src;
     delete[] compressed;
+    delete[] reference;
     delete[] test;
 }
 
+void
+testRoundTrip (int bufferLen)
+{
+    char* src = new char[bufferLen];
+
+    generateData (src, bufferLen);
+    testRoundTrip (src, bufferLen);
+
+    delete[] src;
+}
+
 } // namespace
 
 void
@@ -97,6 +176,16 @@ testRle (const string&)
         {
             testRoundTrip ((int) rand48.nextf (100.0, 1000000.0));
         }
+
+        cout << "   Comparing short runs with the reference encoding " << endl;
+
+        char buffer[4096];
+        for (int iter = 0; iter < numIter; ++iter)
+        {
+            int len = (int) rand48.nextf (1.0, sizeof (buffer));
+            generateShortRuns (buffer, len, rand48);
+            testRoundTrip (buffer, len);
+        }
     }
     catch (const exception& e)
     {
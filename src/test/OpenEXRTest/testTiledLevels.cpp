@@ -0,0 +1,418 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include <ImathFun.h>
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfThreading.h>
+#include <ImfTiledInputFile.h>
+#include <ImfTiledLevels.h>
+#include <ImfTiledOutputFile.h>
+#include <half.h>
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "random.h"
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace std;
+using namespace IMATH_NAMESPACE;
+
+namespace
+{
+
+//
+// A straightforward implementation of the level generation, to
+// check writeTiledLevels() against. This is the algorithm that
+// exrmaketiled used before the library took it over; the library
+// must produce the exact same pixels.
+//
+
+template <class T> struct Plane
+{
+    int       w;
+    int       h;
+    vector<T> p;
+
+    Plane () : w (0), h (0) {}
+    Plane (int width, int height) : w (width), h (height), p (w * h) {}
+
+    T& operator() (int x, int y) { return p[y * w + x]; }
+    T  operator() (int x, int y) const { return p[y * w + x]; }
+};
+
+int
+mirror (int x, int w)
+{
+    int d = divp (x, w);
+    int m = modp (x, w);
+    return (d & 1) ? w - 1 - m : m;
+}
+
+template <class T>
+double
+sample (const Plane<T>& c, bool inX, double p, int q, LevelExtrapolation ext)
+{
+    int    n  = inX ? c.w : c.h;
+    int    ps = IMATH_NAMESPACE::floor (p);
+    int    pt = ps + 1;
+    double s  = pt - p;
+    double t  = 1 - s;
+    double vs = 0.0;
+    double vt = 0.0;
+
+    if (ext == EXTRAPOLATE_BLACK)
+    {
+        if (ps >= 0 && ps < n) vs = inX ? c (ps, q) : c (q, ps);
+        if (pt >= 0 && pt < n) vt = inX ? c (pt, q) : c (q, pt);
+    }
+    else
+    {
+        if (ext == EXTRAPOLATE_CLAMP)
+        {
+            ps = IMATH_NAMESPACE::clamp (ps, 0, n - 1);
+            pt = IMATH_NAMESPACE::clamp (pt, 0, n - 1);
+        }
+        else if (ext == EXTRAPOLATE_PERIODIC)
+        {
+            ps = modp (ps, n);
+            pt = modp (pt, n);
+        }
+        else
+        {
+            ps = mirror (ps, n);
+            pt = mirror (pt, n);
+        }
+
+        vs = inX ? c (ps, q) : c (q, ps);
+        vt = inX ? c (pt, q) : c (q, pt);
+    }
+
+    return s * vs + t * vt;
+}
+
+template <class T>
+void
+reduce (
+    const Plane<T>&    c0,
+    Plane<T>&          c1,
+    bool               inX,
+    bool               filter,
+    LevelExtrapolation ext,
+    bool               odd)
+{
+    int n0 = inX ? c0.w : c0.h;
+    int n1 = inX ? c1.w : c1.h;
+
+    double f      = (n1 > 1) ? double (n0 - 2) / (n1 - 1) : 1;
+    int    offset = odd ? ((n0 - 1) - 2 * (n1 - 1)) : 0;
+
+    for (int y = 0; y < c1.h; ++y)
+    {
+        for (int x = 0; x < c1.w; ++x)
+        {
+            int    i = inX ? x : y;
+            int    q = inX ? y : x;
+            double p = i * f;
+
+            if (!filter)
+            {
+                c1 (x, y) = inX ? c0 (2 * x + offset, y)
+                                : c0 (x, 2 * y + offset);
+                continue;
+            }
+
+            c1 (x, y) = T (
+                0.125 * sample (c0, inX, p - 1, q, ext) +
+                0.375 * sample (c0, inX, p, q, ext) +
+                0.375 * sample (c0, inX, p + 1, q, ext) +
+                0.125 * sample (c0, inX, p + 2, q, ext));
+        }
+    }
+}
+
+//
+// The test image: a half, a float and an unsigned int channel.
+// The unsigned int channel holds ids, and is not filtered.
+//
+
+struct Image
+{
+    Plane<half>         r;
+    Plane<float>        z;
+    Plane<unsigned int> id;
+
+    Image () {}
+    Image (int w, int h) : r (w, h), z (w, h), id (w, h) {}
+};
+
+void
+reduceImage (
+    const Image&       i0,
+    Image&             i1,
+    bool               inX,
+    LevelExtrapolation ext,
+    bool               odd)
+{
+    reduce (i0.r, i1.r, inX, true, ext, odd);
+    reduce (i0.z, i1.z, inX, true, ext, odd);
+    reduce (i0.id, i1.id, inX, false, ext, odd);
+}
+
+Image
+referenceLevel (
+    const Image&          image0,
+    const TiledInputFile& in,
+    int                   lx,
+    int                   ly,
+    LevelExtrapolation    extX,
+    LevelExtrapolation    extY)
+{
+    if (in.header ().tileDescription ().mode == MIPMAP_LEVELS)
+    {
+        Image image = image0;
+
+        for (int l = 1; l <= lx; ++l)
+        {
+            Image tmp (in.levelWidth (l), in.levelHeight (l - 1));
+            reduceImage (image, tmp, true, extX, l & 1);
+
+            image = Image (in.levelWidth (l), in.levelHeight (l));
+            reduceImage (tmp, image, false, extY, l & 1);
+        }
+
+        return image;
+    }
+
+    Image image = image0;
+
+    for (int l = 0; l < ly; ++l)
+    {
+        Image tmp (in.levelWidth (0), in.levelHeight (l + 1));
+        reduceImage (image, tmp, false, extY, l & 1);
+        image = tmp;
+    }
+
+    for (int l = 0; l < lx; ++l)
+    {
+        Image tmp (in.levelWidth (l + 1), in.levelHeight (ly));
+        reduceImage (image, tmp, true, extX, l & 1);
+        image = tmp;
+    }
+
+    return image;
+}
+
+template <class T>
+bool
+samePixels (const Plane<T>& a, const Plane<T>& b)
+{
+    return a.w == b.w && a.h == b.h &&
+           memcmp (&a.p[0], &b.p[0], a.p.size () * sizeof (T)) == 0;
+}
+
+void
+writeRead (
+    const string&      fileName,
+    int                width,
+    int                height,
+    LevelMode          mode,
+    LevelRoundingMode  rmode,
+    LevelExtrapolation extX,
+    LevelExtrapolation extY,
+    bool               interleaved)
+{
+    cout << "size " << width << " x " << height << ", levelMode " << mode
+         << ", roundingMode " << rmode << ", extrapolation " << extX << " "
+         << extY << (interleaved ? ", interleaved" : "") << endl;
+
+    Box2i dataWindow (V2i (-3, 5), V2i (width - 4, height + 4));
+
+    Header hdr (dataWindow, dataWindow);
+    hdr.channels ().insert ("R", Channel (HALF));
+    hdr.channels ().insert ("Z", Channel (FLOAT));
+    hdr.channels ().insert ("id", Channel (UINT));
+    hdr.setTileDescription (TileDescription (16, 8, mode, rmode));
+
+    Image image0 (width, height);
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            image0.r (x, y)  = half (random_float (4) - 1);
+            image0.z (x, y)  = sin (x * 0.3) * 1000 + y + random_float (1);
+            image0.id (x, y) = random_int (1000);
+        }
+    }
+
+    //
+    // The frame buffer either points at the image planes, or at a
+    // copy of the image with the channels interleaved.
+    //
+
+    struct Pixel
+    {
+        half         r;
+        float        z;
+        unsigned int id;
+    };
+
+    vector<Pixel> pixels (width * height);
+    FrameBuffer   fb;
+
+    if (interleaved)
+    {
+        for (int i = 0; i < width * height; ++i)
+        {
+            pixels[i].r  = image0.r.p[i];
+            pixels[i].z  = image0.z.p[i];
+            pixels[i].id = image0.id.p[i];
+        }
+
+        size_t ys = sizeof (Pixel) * width;
+
+        fb.insert (
+            "R",
+            Slice::Make (
+                HALF, &pixels[0].r, dataWindow, sizeof (Pixel), ys));
+        fb.insert (
+            "Z",
+            Slice::Make (
+                FLOAT, &pixels[0].z, dataWindow, sizeof (Pixel), ys));
+        fb.insert (
+            "id",
+            Slice::Make (
+                UINT, &pixels[0].id, dataWindow, sizeof (Pixel), ys));
+    }
+    else
+    {
+        fb.insert ("R", Slice::Make (HALF, &image0.r.p[0], dataWindow));
+        fb.insert ("Z", Slice::Make (FLOAT, &image0.z.p[0], dataWindow));
+        fb.insert ("id", Slice::Make (UINT, &image0.id.p[0], dataWindow));
+    }
+
+    set<string> doNotFilter;
+    doNotFilter.insert ("id");
+
+    remove (fileName.c_str ());
+
+    {
+        TiledOutputFile out (fileName.c_str (), hdr);
+        writeTiledLevels (out, fb, extX, extY, doNotFilter);
+    }
+
+    TiledInputFile in (fileName.c_str ());
+
+    for (int ly = 0; ly < in.numYLevels (); ++ly)
+    {
+        for (int lx = 0; lx < in.numXLevels (); ++lx)
+        {
+            if (!in.isValidLevel (lx, ly)) continue;
+
+            Box2i dw = in.dataWindowForLevel (lx, ly);
+            int   w  = in.levelWidth (lx);
+            int   h  = in.levelHeight (ly);
+            Image level (w, h);
+
+            FrameBuffer lfb;
+            lfb.insert ("R", Slice::Make (HALF, &level.r.p[0], dw));
+            lfb.insert ("Z", Slice::Make (FLOAT, &level.z.p[0], dw));
+            lfb.insert ("id", Slice::Make (UINT, &level.id.p[0], dw));
+
+            in.setFrameBuffer (lfb);
+            in.readTiles (
+                0, in.numXTiles (lx) - 1, 0, in.numYTiles (ly) - 1, lx, ly);
+
+            Image ref = referenceLevel (image0, in, lx, ly, extX, extY);
+
+            assert (samePixels (level.r, ref.r));
+            assert (samePixels (level.z, ref.z));
+            assert (samePixels (level.id, ref.id));
+        }
+    }
+
+    remove (fileName.c_str ());
+}
+
+void
+writeRead (const string& fileName, int width, int height)
+{
+    const LevelExtrapolation ext[][2] = {
+        {EXTRAPOLATE_CLAMP, EXTRAPOLATE_CLAMP},
+        {EXTRAPOLATE_BLACK, EXTRAPOLATE_MIRROR},
+        {EXTRAPOLATE_PERIODIC, EXTRAPOLATE_BLACK},
+        {EXTRAPOLATE_MIRROR, EXTRAPOLATE_PERIODIC}};
+
+    for (int e = 0; e < 4; ++e)
+    {
+        for (int rmode = 0; rmode < NUM_ROUNDINGMODES; ++rmode)
+        {
+            writeRead (
+                fileName,
+                width,
+                height,
+                MIPMAP_LEVELS,
+                LevelRoundingMode (rmode),
+                ext[e][0],
+                ext[e][1],
+                e & 1);
+
+            writeRead (
+                fileName,
+                width,
+                height,
+                RIPMAP_LEVELS,
+                LevelRoundingMode (rmode),
+                ext[e][0],
+                ext[e][1],
+                !(e & 1));
+        }
+    }
+}
+
+} // namespace
+
+void
+testTiledLevels (const std::string& tempDir)
+{
+    try
+    {
+        cout << "Testing generation of mipmap and ripmap levels" << endl;
+
+        random_reseed (1);
+
+        string fileName = tempDir + "imf_test_tiled_levels.exr";
+        int    threads  = globalThreadCount ();
+
+        for (int n = 0; n < 2; ++n)
+        {
+            setGlobalThreadCount (n == 0 ? 0 : 3);
+
+            writeRead (fileName, 1, 1);
+            writeRead (fileName, 1, 37);
+            writeRead (fileName, 83, 2);
+            writeRead (fileName, 171, 109);
+        }
+
+        setGlobalThreadCount (threads);
+
+        cout << "ok\n" << endl;
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "ERROR -- caught exception: " << e.what () << endl;
+        assert (false);
+    }
+}
@@ -90,6 +90,14 @@ writeCopyReadONE (
 
         remove (fileName);
         TiledOutputFile out (fileName, hdr);
+
+        //
+        // When seeking, also limit the memory for out-of-order tiles
+        // to a few tiles, so that the others go to the spill file.
+        //
+
+        if (triggerBuffering && triggerSeeks)
+            out.setTileBufferBudget (3 * xSize * ySize * sizeof (half));
         out.setFrameBuffer (fb);
 
         int i;
@@ -242,6 +250,14 @@ writeCopyReadMIP (
         remove (fileName);
         TiledOutputFile out (fileName, hdr);
 
+        //
+        // When seeking, also limit the memory for out-of-order tiles
+        // to a few tiles, so that the others go to the spill file.
+        //
+
+        if (triggerBuffering && triggerSeeks)
+            out.setTileBufferBudget (3 * xSize * ySize * sizeof (half));
+
         int numLevels = out.numLevels ();
         levels.resizeErase (numLevels);
 
@@ -439,6 +455,14 @@ writeCopyReadRIP (
         remove (fileName);
         TiledOutputFile out (fileName, hdr);
 
+        //
+        // When seeking, also limit the memory for out-of-order tiles
+        // to a few tiles, so that the others go to the spill file.
+        //
+
+        if (triggerBuffering && triggerSeeks)
+            out.setTileBufferBudget (3 * xSize * ySize * sizeof (half));
+
         levels.resizeErase (out.numYLevels (), out.numXLevels ());
 
         int i;
@@ -114,6 +114,76 @@ fill5_16bit (
             a[y][x] = b[y][x] = ((x + y) & 1) ? 0 : 0xffff;
 }
 
+//
+// A block at a time version of wav2Encode (), the output of which the
+// library must not change
+//
+
+void
+referenceEnc (
+    unsigned short  a,
+    unsigned short  b,
+    bool            w14,
+    unsigned short& l,
+    unsigned short& h)
+{
+    if (w14)
+    {
+        short as = a;
+        short bs = b;
+
+        l = short ((as + bs) >> 1);
+        h = short (as - bs);
+    }
+    else
+    {
+        int ao = (a + (1 << 15)) & 0xffff;
+        int m  = ((ao + b) >> 1);
+        int d  = ao - b;
+
+        if (d < 0) m = (m + (1 << 15)) & 0xffff;
+
+        l = m;
+        h = d & 0xffff;
+    }
+}
+
+void
+referenceEncode (Array2D<unsigned short>& a, int nx, int ny, unsigned short mx)
+{
+    bool w14 = (mx < (1 << 14));
+    int  n   = (nx > ny) ? ny : nx;
+
+    for (int p = 1, p2 = 2; p2 <= n; p = p2, p2 <<= 1)
+    {
+        int y = 0;
+
+        for (; y <= ny - p2; y += p2)
+        {
+            int x = 0;
+
+            for (; x <= nx - p2; x += p2)
+            {
+                unsigned short i00, i01, i10, i11;
+
+                referenceEnc (a[y][x], a[y][x + p], w14, i00, i01);
+                referenceEnc (a[y + p][x], a[y + p][x + p], w14, i10, i11);
+                referenceEnc (i00, i10, w14, a[y][x], a[y + p][x]);
+                referenceEnc (i01, i11, w14, a[y][x + p], a[y + p][x + p]);
+            }
+
+            if (nx & p)
+                referenceEnc (a[y][x], a[y + p][x], w14, a[y][x], a[y + p][x]);
+        }
+
+        if (ny & p)
+        {
+            for (int x = 0; x <= nx - p2; x += p2)
+                referenceEnc (a[y][x], a[y][x + p], w14, a[y][x], a[y][x + p]);
+        }
+    }
+}
+
 unsigned short
 maxValue (const Array2D<unsigned short>& a, int nx, int ny)
 {
@@ -141,6 +211,18 @@ wavEncodeDecode (
 
     wav2Encode (&a[0][0], nx, 1, ny, nx, mx);
 
+    Array2D<unsigned short> r (ny, nx);
+
+    for (int y = 0; y < ny; ++y)
+        for (int x = 0; x < nx; ++x)
+            r[y][x] = b[y][x];
+
+    referenceEncode (r, nx, ny, mx);
+
+    for (int y = 0; y < ny; ++y)
+        for (int x = 0; x < nx; ++x)
+            assert (a[y][x] == r[y][x]);
+
     //cout << "decoding " << flush;
 
     wav2Decode (&a[0][0], nx, 1, ny, nx, mx);
@@ -0,0 +1,239 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+//-----------------------------------------------------------------------------
+//
+//  Measures how reading scanline files (InputFile::readPixels, which
+//  hands the work to ScanLineInputFile) scales with the number of
+//  threads in the global thread pool, for the default and the
+//  work-stealing thread pool providers, while several files are read
+//  at the same time.
+//
+//-----------------------------------------------------------------------------
+
+#include <IlmThreadPool.h>
+#include <ImfArray.h>
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfInputFile.h>
+#include <ImfOutputFile.h>
+#include <ImfThreading.h>
+#include <half.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tmpDir.h"
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace ILMTHREAD_NAMESPACE;
+
+namespace
+{
+
+const char* const kChannels[] = {"R", "G", "B", "A"};
+
+void
+writeTestFile (const std::string& fn, int w, int h, Compression comp)
+{
+    Header hdr (w, h);
+    hdr.compression () = comp;
+
+    Array2D<half> pixels (h, w);
+    unsigned      seed = 1;
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            // smooth with a bit of noise, so there is something to
+            // compress but it does not compress to nothing
+            seed         = seed * 1664525u + 1013904223u;
+            pixels[y][x] = half (
+                0.5f + 0.25f * float (x) / float (w) +
+                0.25f * float (y) / float (h) +
+                float (seed >> 24) / 4096.f);
+        }
+    }
+
+    FrameBuffer fb;
+    for (const char* c: kChannels)
+    {
+        hdr.channels ().insert (c, Channel (HALF));
+        fb.insert (
+            c,
+            Slice (
+                HALF, (char*) &pixels[0][0], sizeof (half), sizeof (half) * w));
+    }
+
+    OutputFile out (fn.c_str (), hdr);
+    out.setFrameBuffer (fb);
+    out.writePixels (h);
+}
+
+void
+readFile (const std::string& fn, int iterations)
+{
+    for (int i = 0; i < iterations; ++i)
+    {
+        InputFile                     in (fn.c_str ());
+        const IMATH_NAMESPACE::Box2i& dw = in.header ().dataWindow ();
+        int                           w  = dw.max.x - dw.min.x + 1;
+        int                           h  = dw.max.y - dw.min.y + 1;
+
+        std::vector<half> pixels (size_t (w) * size_t (h) * 4);
+        char* base = (char*) (pixels.data () - dw.min.x * 4 -
+                              ptrdiff_t (dw.min.y) * w * 4);
+
+        FrameBuffer fb;
+        int         c = 0;
+        for (const char* name: kChannels)
+        {
+            fb.insert (
+                name,
+                Slice (
+                    HALF,
+                    base + c * sizeof (half),
+                    4 * sizeof (half),
+                    4 * sizeof (half) * w));
+            ++c;
+        }
+
+        in.setFrameBuffer (fb);
+        in.readPixels (dw.min.y, dw.max.y);
+    }
+}
+
+double
+timeReads (const std::string& fn, int files, int iterations)
+{
+    auto start = std::chrono::steady_clock::now ();
+
+    std::vector<std::thread> readers;
+    for (int f = 0; f < files; ++f)
+        readers.emplace_back (readFile, fn, iterations);
+    for (auto& t: readers)
+        t.join ();
+
+    return std::chrono::duration<double> (
+               std::chrono::steady_clock::now () - start)
+        .count ();
+}
+
+void
+setProvider (bool stealing, int threads)
+{
+    ThreadPool& pool = ThreadPool::globalThreadPool ();
+
+    // go through no threads at all so a fresh provider is made
+    setGlobalThreadCount (0);
+    if (stealing)
+        pool.setThreadProvider (new WorkStealingThreadPoolProvider (threads));
+    else
+        setGlobalThreadCount (threads);
+}
+
+int
+usageAndExit (const char* argv0, int ec)
+{
+    std::cerr
+        << "Usage: " << argv0
+        << " [--files <n>] [--iterations <n>] [--max-threads <n>]\n"
+           "       [--provider default|stealing|both] [--zip] [<file.exr>]\n"
+           "\n"
+           "Reads the file (or a generated 1920x1080 RGBA image) with\n"
+           "<files> concurrent readers, doubling the size of the global\n"
+           "thread pool from 1 up to <max-threads> (128 by default).\n";
+    return ec;
+}
+
+} // namespace
+
+int
+main (int argc, char* argv[])
+{
+    std::string fn;
+    int         files      = 4;
+    int         iterations = 4;
+    int         maxThreads = 128;
+    bool        doDefault = true, doStealing = true;
+    Compression comp      = ZIPS_COMPRESSION;
+
+    for (int a = 1; a < argc; ++a)
+    {
+        if (!strcmp (argv[a], "-h") || !strcmp (argv[a], "--help"))
+            return usageAndExit (argv[0], 0);
+        else if (!strcmp (argv[a], "--files") && a + 1 < argc)
+            files = atoi (argv[++a]);
+        else if (!strcmp (argv[a], "--iterations") && a + 1 < argc)
+            iterations = atoi (argv[++a]);
+        else if (!strcmp (argv[a], "--max-threads") && a + 1 < argc)
+            maxThreads = atoi (argv[++a]);
+        else if (!strcmp (argv[a], "--provider") && a + 1 < argc)
+        {
+            ++a;
+            doDefault  = strcmp (argv[a], "stealing") != 0;
+            doStealing = strcmp (argv[a], "default") != 0;
+        }
+        else if (!strcmp (argv[a], "--zip"))
+            comp = ZIP_COMPRESSION;
+        else if (argv[a][0] != '-' && fn.empty ())
+            fn = argv[a];
+        else
+            return usageAndExit (argv[0], 1);
+    }
+
+    if (files < 1 || iterations < 1 || maxThreads < 1)
+        return usageAndExit (argv[0], 1);
+
+    bool generated = fn.empty ();
+    if (generated)
+    {
+        fn = IMF_TMP_DIR "imf_thread_performance.exr";
+        writeTestFile (fn, 1920, 1080, comp);
+    }
+
+    std::cout << "threads" << std::setw (16) << "default s" << std::setw (16)
+              << "stealing s" << std::setw (16) << "speedup" << "\n";
+
+    double baseDefault = 0, baseStealing = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        double tDefault = 0, tStealing = 0;
+        if (doDefault)
+        {
+            setProvider (false, threads);
+            tDefault = timeReads (fn, files, iterations);
+            if (threads == 1) baseDefault = tDefault;
+        }
+        if (doStealing)
+        {
+            setProvider (true, threads);
+            tStealing = timeReads (fn, files, iterations);
+            if (threads == 1) baseStealing = tStealing;
+        }
+
+        // speedup over one thread, for each provider
+        std::cout << std::setw (7) << threads << std::fixed
+                  << std::setprecision (4) << std::setw (16) << tDefault
+                  << std::setw (16) << tStealing << std::setprecision (2)
+                  << std::setw (8)
+                  << (tDefault > 0 ? baseDefault / tDefault : 0.0)
+                  << std::setw (8)
+                  << (tStealing > 0 ? baseStealing / tStealing : 0.0)
+                  << std::endl;
+    }
+
+    setGlobalThreadCount (0);
+    if (generated) remove (fn.c_str ());
+    return 0;
+}
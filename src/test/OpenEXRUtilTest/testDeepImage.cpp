@@ -440,6 +440,29 @@ testSetSampleCounts (const Box2i& dataWindow)
                 assert (channel (x, y)[j] == oldSamples[j]);
         }
     }
+
+    //
+    // The sample lists are all stored in a single buffer, at the
+    // positions kept by the sample count channel.
+    //
+
+    const size_t* positions = sampleCounts.sampleListPositions ();
+
+    for (int r = 0; r < channel.pixelsPerColumn (); ++r)
+    {
+        for (int i = 0; i < channel.pixelsPerRow (); ++i)
+        {
+            int x = dataWindow.min.x + i;
+            int y = dataWindow.min.y + r;
+
+            assert (channel.row (r)[i] == channel.at (x, y));
+            assert (channel.row (r)[i] == channel.sampleBuffer () + *positions);
+
+            assert (
+                *positions++ + sampleCounts.at (x, y) <=
+                sampleCounts.sampleBufferSize ());
+        }
+    }
 }
 
 void
@@ -9,6 +9,7 @@
 
 #include <Iex.h>
 #include <ImfDeepImage.h>
+#include <ImfDeepImageIO.h>
 #include <ImfFlatImage.h>
 #include <ImfHeader.h>
 #include <ImfImageIO.h>
@@ -16,6 +17,7 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstdlib>
 
 using namespace OPENEXR_IMF_NAMESPACE;
 using namespace IMATH_NAMESPACE;
@@ -191,6 +193,150 @@ testDeepTiledImage2 (const string& fileName)
     delete img2;
 }
 
+//
+// Round-trip deep images large enough that the deep image I/O functions
+// have to split each level into several bands of scan lines or rows of
+// tiles, and check every sample count and sample value.
+//
+
+unsigned int
+testSampleCount (int x, int y)
+{
+    return abs (x * 7 + y * 3) % 5;
+}
+
+float
+testSampleValue (int x, int y, unsigned int i, int l)
+{
+    return float (abs (x * 13 + y * 5 + int (i) * 3 + l) % 1024);
+}
+
+void
+fillDeepImage (DeepImage& img)
+{
+    for (int l = 0; l < img.numLevels (); ++l)
+    {
+        DeepImageLevel& level = img.level (l);
+        const Box2i&    dw    = level.dataWindow ();
+
+        {
+            SampleCountChannel::Edit edit (level.sampleCounts ());
+            unsigned int*            counts = edit.sampleCounts ();
+
+            for (int y = dw.min.y; y <= dw.max.y; ++y)
+                for (int x = dw.min.x; x <= dw.max.x; ++x)
+                    *counts++ = testSampleCount (x, y);
+        }
+
+        TypedDeepImageChannel<half>&  h = level.typedChannel<half> ("H");
+        TypedDeepImageChannel<float>& z = level.typedChannel<float> ("Z");
+
+        for (int y = dw.min.y; y <= dw.max.y; ++y)
+        {
+            for (int x = dw.min.x; x <= dw.max.x; ++x)
+            {
+                for (unsigned int i = 0; i < testSampleCount (x, y); ++i)
+                {
+                    float v        = testSampleValue (x, y, i, l);
+                    h.at (x, y)[i] = half (v);
+                    z.at (x, y)[i] = v + 0.5f;
+                }
+            }
+        }
+    }
+}
+
+void
+checkDeepImage (const DeepImage& img, int numLevels, const Box2i& dataWindow)
+{
+    assert (img.numLevels () == numLevels);
+    assert (img.dataWindow () == dataWindow);
+
+    for (int l = 0; l < img.numLevels (); ++l)
+    {
+        const DeepImageLevel& level = img.level (l);
+        const Box2i&          dw    = level.dataWindow ();
+
+        const SampleCountChannel&           counts = level.sampleCounts ();
+        const TypedDeepImageChannel<half>&  h = level.typedChannel<half> ("H");
+        const TypedDeepImageChannel<float>& z =
+            level.typedChannel<float> ("Z");
+
+        for (int y = dw.min.y; y <= dw.max.y; ++y)
+        {
+            for (int x = dw.min.x; x <= dw.max.x; ++x)
+            {
+                assert (counts.at (x, y) == testSampleCount (x, y));
+
+                for (unsigned int i = 0; i < testSampleCount (x, y); ++i)
+                {
+                    float v = testSampleValue (x, y, i, l);
+                    assert (h.at (x, y)[i] == half (v));
+                    assert (z.at (x, y)[i] == v + 0.5f);
+                }
+            }
+        }
+    }
+}
+
+void
+testDeepScanLineRoundTrip (const string& fileName, LineOrder lineOrder)
+{
+    cout << "deep scan line round trip, "
+         << (lineOrder == INCREASING_Y ? "increasing" : "decreasing") << " y"
+         << endl;
+
+    Box2i dataWindow (V2i (-3, 5), V2i (294, 604));
+
+    DeepImage img1 (dataWindow, ONE_LEVEL, ROUND_DOWN);
+    img1.insertChannel ("H", HALF);
+    img1.insertChannel ("Z", FLOAT);
+    fillDeepImage (img1);
+
+    Header hdr1;
+    hdr1.lineOrder ()   = lineOrder;
+    hdr1.compression () = ZIP_COMPRESSION;
+
+    saveDeepScanLineImage (fileName, hdr1, img1);
+
+    Header    hdr2;
+    DeepImage img2;
+    loadDeepScanLineImage (fileName, hdr2, img2);
+
+    assert (hdr2.lineOrder () == lineOrder);
+    checkDeepImage (img2, 1, dataWindow);
+}
+
+void
+testDeepTiledRoundTrip (const string& fileName, LineOrder lineOrder)
+{
+    cout << "deep tiled round trip, "
+         << (lineOrder == INCREASING_Y ? "increasing" : "decreasing") << " y"
+         << endl;
+
+    Box2i dataWindow (V2i (-3, 5), V2i (294, 604));
+
+    DeepImage img1 (dataWindow, MIPMAP_LEVELS, ROUND_DOWN);
+    img1.insertChannel ("H", HALF);
+    img1.insertChannel ("Z", FLOAT);
+    fillDeepImage (img1);
+
+    Header hdr1;
+    hdr1.lineOrder ()   = lineOrder;
+    hdr1.compression () = ZIPS_COMPRESSION;
+    hdr1.setTileDescription (TileDescription (32, 16));
+
+    saveDeepTiledImage (fileName, hdr1, img1);
+
+    Header    hdr2;
+    DeepImage img2;
+    loadDeepTiledImage (fileName, hdr2, img2);
+
+    assert (hdr2.lineOrder () == lineOrder);
+    assert (hdr2.tileDescription ().mode == MIPMAP_LEVELS);
+    checkDeepImage (img2, img1.numLevels (), dataWindow);
+}
+
 } // namespace
 
 void
@@ -208,6 +354,10 @@ testIO (const string& tempDir)
         testDeepScanLineImage2 (tempDir + "io.exr");
         testDeepTiledImage1 (tempDir + "io.exr");
         testDeepTiledImage2 (tempDir + "io.exr");
+        testDeepScanLineRoundTrip (tempDir + "io.exr", INCREASING_Y);
+        testDeepScanLineRoundTrip (tempDir + "io.exr", DECREASING_Y);
+        testDeepTiledRoundTrip (tempDir + "io.exr", INCREASING_Y);
+        testDeepTiledRoundTrip (tempDir + "io.exr", DECREASING_Y);
 
         cout << "ok\n" << endl;
     }
@@ -137,6 +137,86 @@ split (const std::string& str, const char sep)
     return words;
 }
 
+////////////////////////////////////////////////////////////////////////
+//    Threading
+//
+//    Decoding and encoding run with the GIL released, so that other
+//    Python threads can make progress meanwhile.  Every file object has
+//    its own lock, so only one thread at a time uses a given file, and
+//    the stream classes below take the GIL back whenever they call into
+//    Python (possibly from one of the library's worker threads).
+////////////////////////////////////////////////////////////////////////
+
+class GILState
+{
+public:
+    GILState () : _state (PyGILState_Ensure ()) {}
+    ~GILState () { PyGILState_Release (_state); }
+
+private:
+    PyGILState_STATE _state;
+};
+
+//
+// Raise ValueError and return false if the file has been closed.
+//
+
+static bool
+checkOpened (int isOpened)
+{
+    if (isOpened) return true;
+    PyErr_SetString (PyExc_ValueError, "I/O operation on closed file");
+    return false;
+}
+
+//
+// Run f() holding the file lock, with the GIL released.  A C++
+// exception thrown by f() becomes an IOError; returns false if so.
+// Unless isOpened is null, f() is skipped and ValueError raised when
+// the file was closed by another thread while this one waited for
+// the lock.
+//
+
+template <class F>
+static bool
+runWithoutGIL (PyThread_type_lock lock, const int* isOpened, F f)
+{
+    std::string error;
+    bool        ok     = true;
+    int         opened = 1;
+
+    // what Py_BEGIN_ALLOW_THREADS / Py_END_ALLOW_THREADS expand to
+    PyThreadState* save = PyEval_SaveThread ();
+    PyThread_acquire_lock (lock, WAIT_LOCK);
+    if (isOpened) opened = *isOpened;
+    try
+    {
+        if (opened) f ();
+    }
+    catch (const std::exception& e)
+    {
+        error = e.what ();
+        ok    = false;
+    }
+    PyThread_release_lock (lock);
+    PyEval_RestoreThread (save);
+
+    if (!checkOpened (opened)) return false;
+    if (!ok) PyErr_SetString (PyExc_IOError, error.c_str ());
+    return ok;
+}
+
+//
+// runWithoutGIL() for an InputFileC or OutputFileC that must be open.
+//
+
+template <class T, class F>
+static bool
+runOpenWithoutGIL (T* object, F f)
+{
+    return runWithoutGIL (object->lock, &object->is_opened, f);
+}
+
 ////////////////////////////////////////////////////////////////////////
 //    Istream and Ostream derivatives
 ////////////////////////////////////////////////////////////////////////
@@ -158,6 +238,7 @@ private:
 bool
 C_IStream::read (char c[], int n)
 {
+    GILState gil;
     PyObject* data =
         PyObject_CallMethod (_fo, (char*) "read", (char*) "(i)", n);
     if (data != NULL && PyString_AsString (data) &&
@@ -179,6 +260,7 @@ C_IStream::fileName () const
 Int64
 C_IStream::tellg ()
 {
+    GILState gil;
     PyObject* rv = PyObject_CallMethod (_fo, (char*) "tell", NULL);
     if (rv != NULL && PyNumber_Check (rv))
     {
@@ -194,6 +276,7 @@ C_IStream::tellg ()
 void
 C_IStream::seekg (Int64 pos)
 {
+    GILState gil;
     PyObject* data =
         PyObject_CallMethod (_fo, (char*) "seek", (char*) "(L)", pos);
     if (data != NULL) { Py_DECREF (data); }
@@ -223,6 +306,7 @@ private:
 void
 C_OStream::write (const char* c, int n)
 {
+    GILState gil;
     PyObject* data =
         PyObject_CallMethod (_fo, (char*) "write", (char*) "(s#)", c, n);
     if (data != NULL) { Py_DECREF (data); }
@@ -238,6 +322,7 @@ C_OStream::fileName () const
 Int64
 C_OStream::tellp ()
 {
+    GILState gil;
     PyObject* rv = PyObject_CallMethod (_fo, (char*) "tell", NULL);
     if (rv != NULL && PyNumber_Check (rv))
     {
@@ -253,6 +338,7 @@ C_OStream::tellp ()
 void
 C_OStream::seekp (Int64 pos)
 {
+    GILState gil;
     PyObject* data =
         PyObject_CallMethod (_fo, (char*) "seek", (char*) "(L)", pos);
     if (data != NULL) { Py_DECREF (data); }
@@ -267,17 +353,27 @@ C_OStream::clear ()
 //    InputFile
 ////////////////////////////////////////////////////////////////////////
 
+static void
+releaseviews (std::vector<Py_buffer>& views)
+{
+    for (size_t i = 0; i < views.size (); i++)
+        PyBuffer_Release (&views[i]);
+}
+
 typedef struct
 {
     PyObject_HEAD InputFile i;
     PyObject*               fo;
     C_IStream*              istream;
     int                     is_opened;
+    PyThread_type_lock      lock;
 } InputFileC;
 
 static PyObject*
 channel (PyObject* self, PyObject* args, PyObject* kw)
 {
+    if (!checkOpened (((InputFileC*) self)->is_opened)) return NULL;
+
     InputFile* file = &((InputFileC*) self)->i;
 
     Box2i dw = file->header ().dataWindow ();
@@ -355,8 +451,7 @@ channel (PyObject* self, PyObject* args, PyObject* kw)
 
     char* pixels = PyString_AsString (r);
 
-    try
-    {
+    bool ok = runOpenWithoutGIL ((InputFileC*) self, [&] () {
         FrameBuffer frameBuffer;
         size_t      xstride = typeSize;
         size_t      ystride = typeSize * width;
@@ -373,10 +468,11 @@ channel (PyObject* self, PyObject* args, PyObject* kw)
                 0.0));
         file->setFrameBuffer (frameBuffer);
         file->readPixels (miny, maxy);
-    }
-    catch (const std::exception& e)
+    });
+
+    if (!ok)
     {
-        PyErr_SetString (PyExc_IOError, e.what ());
+        Py_DECREF (r);
         return NULL;
     }
 
@@ -386,6 +482,8 @@ channel (PyObject* self, PyObject* args, PyObject* kw)
 static PyObject*
 channels (PyObject* self, PyObject* args, PyObject* kw)
 {
+    if (!checkOpened (((InputFileC*) self)->is_opened)) return NULL;
+
     InputFile* file = &((InputFileC*) self)->i;
 
     Box2i dw = file->header ().dataWindow ();
@@ -504,11 +602,488 @@ channels (PyObject* self, PyObject* args, PyObject* kw)
         Py_DECREF (item);
     }
     Py_DECREF (iterator);
-    file->setFrameBuffer (frameBuffer);
-    file->readPixels (miny, maxy);
+
+    bool ok = runOpenWithoutGIL ((InputFileC*) self, [&] () {
+        file->setFrameBuffer (frameBuffer);
+        file->readPixels (miny, maxy);
+    });
+
+    if (!ok)
+    {
+        Py_DECREF (retval);
+        return NULL;
+    }
 
     return retval;
 }
+
+////////////////////////////////////////////////////////////////////////
+//    PixelArray
+//
+//    A block of pixels for one channel, exported through the buffer
+//    protocol as a 2D array of height x width values with format 'e'
+//    (HALF), 'f' (FLOAT) or 'I' (UINT), so numpy.asarray() or
+//    memoryview() can use it without a copy.
+////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    PyObject_HEAD char* data;
+    const char*         format;
+    Py_ssize_t          itemsize;
+    Py_ssize_t          shape[2];
+    Py_ssize_t          strides[2];
+} PixelArrayC;
+
+static void
+PixelArray_dealloc (PyObject* self)
+{
+    PyMem_Free (((PixelArrayC*) self)->data);
+    PyObject_Del (self);
+}
+
+static int
+PixelArray_getbuffer (PyObject* self, Py_buffer* view, int flags)
+{
+    PixelArrayC* a = (PixelArrayC*) self;
+
+    view->obj = self;
+    Py_INCREF (self);
+    view->buf        = a->data;
+    view->len        = a->shape[0] * a->shape[1] * a->itemsize;
+    view->readonly   = 0;
+    view->itemsize   = a->itemsize;
+    view->format     = (flags & PyBUF_FORMAT) ? (char*) a->format : NULL;
+    view->ndim       = (flags & PyBUF_ND) ? 2 : 1;
+    view->shape      = (flags & PyBUF_ND) ? a->shape : NULL;
+    view->strides    = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? a->strides
+                                                                  : NULL;
+    view->suboffsets = NULL;
+    view->internal   = NULL;
+    return 0;
+}
+
+static PyBufferProcs PixelArray_as_buffer = {
+    PixelArray_getbuffer,
+    0,
+};
+
+static PyTypeObject PixelArray_Type = {
+    PyVarObject_HEAD_INIT (&PyType_Type, 0) "OpenEXR.PixelArray",
+    sizeof (PixelArrayC),
+    0,
+    (destructor) PixelArray_dealloc,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+
+    0,
+    0,
+    0,
+    0,
+    0,
+
+    &PixelArray_as_buffer,
+
+    Py_TPFLAGS_DEFAULT,
+
+    "OpenEXR pixels of one channel, exported through the buffer protocol",
+
+    /* the rest are NULLs */
+};
+
+static const char*
+pixelFormat (Imf::PixelType pt)
+{
+    switch (pt)
+    {
+        case HALF: return "e";
+        case FLOAT: return "f";
+        case UINT: return "I";
+        default: return NULL;
+    }
+}
+
+static PyObject*
+newPixelArray (Imf::PixelType pt, int width, int height)
+{
+    PixelArrayC* a = PyObject_New (PixelArrayC, &PixelArray_Type);
+    if (a == NULL) return NULL;
+
+    a->format     = pixelFormat (pt);
+    a->itemsize   = pt == HALF ? 2 : 4;
+    a->shape[0]   = height;
+    a->shape[1]   = width;
+    a->strides[0] = a->itemsize * width;
+    a->strides[1] = a->itemsize;
+    a->data       = (char*) PyMem_Malloc (a->strides[0] * height);
+    if (a->data == NULL)
+    {
+        PyObject_Del (a);
+        return PyErr_NoMemory ();
+    }
+    return (PyObject*) a;
+}
+
+//
+// does the struct-syntax format of a buffer hold values of type pt?
+// (the item size has been checked already)
+//
+
+static bool
+formatMatches (const char* format, Imf::PixelType pt)
+{
+    if (format == NULL) return true;
+
+    const unsigned short one = 1;
+    if (format[0] == '@' || format[0] == '=' ||
+        (format[0] == '<' && *(const char*) &one == 1))
+        format++;
+
+    if (format[0] == '\0' || format[1] != '\0') return false;
+
+    // a 32 bit unsigned is an 'L' where long is 32 bits
+    return format[0] == pixelFormat (pt)[0] ||
+           (pt == UINT && format[0] == 'L');
+}
+
+//
+// Add a slice to frameBuffer which reads scan lines miny to maxy of
+// channel cname into the writable buffer exported by out, or into a
+// new PixelArray if out is NULL or None.  The buffer may be a 2D
+// height x width array with any positive strides, or a 1D array of
+// height * width values.  Returns a new reference to the object read
+// into, with its buffer view appended to views, or NULL with an
+// exception set.
+//
+
+static PyObject*
+insertArraySlice (
+    const Header&           header,
+    const char*             cname,
+    PyObject*               pixel_type,
+    int                     miny,
+    int                     maxy,
+    PyObject*               out,
+    FrameBuffer&            frameBuffer,
+    std::vector<Py_buffer>& views)
+{
+    const Channel* channelPtr = header.channels ().findChannel (cname);
+    if (channelPtr == NULL)
+    {
+        return PyErr_Format (
+            PyExc_TypeError, "There is no channel '%s' in the image", cname);
+    }
+
+    Imf::PixelType pt = channelPtr->type;
+    if (pixel_type != NULL && pixel_type != Py_None)
+    {
+        PyObject* v = PyObject_GetAttrString (pixel_type, "v");
+        if (v == NULL)
+        {
+            return PyErr_Format (PyExc_TypeError, "Invalid PixelType object");
+        }
+        pt = PixelType (PyLong_AsLong (v));
+        Py_DECREF (v);
+    }
+    if (pixelFormat (pt) == NULL)
+    {
+        PyErr_SetString (PyExc_TypeError, "Unknown type");
+        return NULL;
+    }
+
+    const Box2i& dw        = header.dataWindow ();
+    int          xSampling = channelPtr->xSampling;
+    int          ySampling = channelPtr->ySampling;
+    int          width     = (dw.max.x - dw.min.x + 1) / xSampling;
+    int          height    = (maxy - miny + 1) / ySampling;
+    Py_ssize_t   typeSize  = pt == HALF ? 2 : 4;
+
+    PyObject* r;
+    if (out == NULL || out == Py_None)
+    {
+        r = newPixelArray (pt, width, height);
+        if (r == NULL) return NULL;
+    }
+    else
+    {
+        r = out;
+        Py_INCREF (r);
+    }
+
+    Py_buffer view;
+    if (PyObject_GetBuffer (r, &view, PyBUF_RECORDS) != 0)
+    {
+        Py_DECREF (r);
+        return PyErr_Format (
+            PyExc_TypeError,
+            "Output for channel '%s' must be a writable buffer",
+            cname);
+    }
+
+    Py_ssize_t xstride = 0, ystride = 0;
+    if (view.ndim == 2 && view.shape[0] == height && view.shape[1] == width)
+    {
+        xstride = view.strides[1];
+        ystride = view.strides[0];
+    }
+    else if (
+        view.ndim == 1 && view.shape[0] == Py_ssize_t (width) * height)
+    {
+        xstride = view.strides[0];
+        ystride = view.strides[0] * width;
+    }
+
+    const char* problem = NULL;
+    if (view.itemsize != typeSize || !formatMatches (view.format, pt))
+        problem = "has the wrong item type";
+    else if (xstride <= 0 || ystride <= 0)
+        problem = "has the wrong shape or negative strides";
+
+    if (problem)
+    {
+        PyBuffer_Release (&view);
+        Py_DECREF (r);
+        return PyErr_Format (
+            PyExc_TypeError,
+            "Output for channel '%s' %s, expected %d x %d values of "
+            "format '%s'",
+            cname,
+            problem,
+            height,
+            width,
+            pixelFormat (pt));
+    }
+
+    views.push_back (view);
+    frameBuffer.insert (
+        cname,
+        Slice (
+            pt,
+            (char*) view.buf - dw.min.x * xstride / xSampling -
+                miny * ystride / ySampling,
+            xstride,
+            ystride,
+            xSampling,
+            ySampling,
+            0.0));
+    return r;
+}
+
+static bool
+checkScanLines (const Box2i& dw, int miny, int maxy)
+{
+    if (maxy < miny)
+    {
+        PyErr_SetString (PyExc_TypeError, "scanLine1 must be <= scanLine2");
+        return false;
+    }
+    if (miny < dw.min.y)
+    {
+        PyErr_SetString (
+            PyExc_TypeError, "scanLine1 cannot be outside dataWindow");
+        return false;
+    }
+    if (maxy > dw.max.y)
+    {
+        PyErr_SetString (
+            PyExc_TypeError, "scanLine2 cannot be outside dataWindow");
+        return false;
+    }
+    return true;
+}
+
+//
+// As channel(), but decodes straight into a buffer instead of a copy:
+// either the one given as "out", or a new PixelArray.
+//
+
+static PyObject*
+channelArray (PyObject* self, PyObject* args, PyObject* kw)
+{
+    if (!checkOpened (((InputFileC*) self)->is_opened)) return NULL;
+
+    InputFile* file = &((InputFileC*) self)->i;
+
+    Box2i dw   = file->header ().dataWindow ();
+    int   miny = dw.min.y;
+    int   maxy = dw.max.y;
+
+    char*     cname;
+    PyObject* pixel_type = NULL;
+    PyObject* out        = NULL;
+    char*     keywords[] = {
+        (char*) "cname",
+        (char*) "pixel_type",
+        (char*) "scanLine1",
+        (char*) "scanLine2",
+        (char*) "out",
+        NULL};
+    if (!PyArg_ParseTupleAndKeywords (
+            args,
+            kw,
+            "s|OiiO",
+            keywords,
+            &cname,
+            &pixel_type,
+            &miny,
+            &maxy,
+            &out))
+        return NULL;
+
+    if (!checkScanLines (dw, miny, maxy)) return NULL;
+
+    FrameBuffer            frameBuffer;
+    std::vector<Py_buffer> views;
+
+    PyObject* r = insertArraySlice (
+        file->header (),
+        cname,
+        pixel_type,
+        miny,
+        maxy,
+        out,
+        frameBuffer,
+        views);
+    if (r == NULL) return NULL;
+
+    bool ok = runOpenWithoutGIL ((InputFileC*) self, [&] () {
+        file->setFrameBuffer (frameBuffer);
+        file->readPixels (miny, maxy);
+    });
+
+    releaseviews (views);
+    if (!ok)
+    {
+        Py_DECREF (r);
+        return NULL;
+    }
+    return r;
+}
+
+//
+// As channels(), but decodes straight into buffers, see channelArray().
+// "out", if given, is a sequence with one buffer per channel.
+//
+
+static PyObject*
+channelArrays (PyObject* self, PyObject* args, PyObject* kw)
+{
+    if (!checkOpened (((InputFileC*) self)->is_opened)) return NULL;
+
+    InputFile* file = &((InputFileC*) self)->i;
+
+    Box2i dw   = file->header ().dataWindow ();
+    int   miny = dw.min.y;
+    int   maxy = dw.max.y;
+
+    PyObject* clist;
+    PyObject* pixel_type = NULL;
+    PyObject* out        = NULL;
+    char*     keywords[] = {
+        (char*) "cnames",
+        (char*) "pixel_type",
+        (char*) "scanLine1",
+        (char*) "scanLine2",
+        (char*) "out",
+        NULL};
+    if (!PyArg_ParseTupleAndKeywords (
+            args,
+            kw,
+            "O|OiiO",
+            keywords,
+            &clist,
+            &pixel_type,
+            &miny,
+            &maxy,
+            &out))
+        return NULL;
+
+    if (!checkScanLines (dw, miny, maxy)) return NULL;
+
+    PyObject* names = PySequence_Fast (clist, "Channel list must be iterable");
+    if (names == NULL) return NULL;
+
+    PyObject* outs = NULL;
+    if (out != NULL && out != Py_None)
+    {
+        outs = PySequence_Fast (out, "out must be a sequence of buffers");
+        if (outs == NULL ||
+            PySequence_Fast_GET_SIZE (outs) != PySequence_Fast_GET_SIZE (names))
+        {
+            if (outs != NULL)
+            {
+                PyErr_SetString (
+                    PyExc_TypeError, "out must have one buffer per channel");
+                Py_DECREF (outs);
+            }
+            Py_DECREF (names);
+            return NULL;
+        }
+    }
+
+    FrameBuffer            frameBuffer;
+    std::vector<Py_buffer> views;
+    Py_ssize_t             n      = PySequence_Fast_GET_SIZE (names);
+    PyObject*              retval = PyList_New (n);
+
+    for (Py_ssize_t c = 0; retval != NULL && c < n; c++)
+    {
+        const char* cname = NULL;
+        PyObject*   item  = PySequence_Fast_GET_ITEM (names, c);
+        if (PyUnicode_Check (item))
+            cname = PyUnicode_AsUTF8 (item);
+        else if (PyBytes_Check (item))
+            cname = PyBytes_AsString (item);
+        else
+            PyErr_SetString (PyExc_TypeError, "Channel names must be strings");
+
+        PyObject* r = NULL;
+        if (cname != NULL)
+        {
+            r = insertArraySlice (
+                file->header (),
+                cname,
+                pixel_type,
+                miny,
+                maxy,
+                outs ? PySequence_Fast_GET_ITEM (outs, c) : NULL,
+                frameBuffer,
+                views);
+        }
+        if (r == NULL)
+        {
+            Py_DECREF (retval);
+            retval = NULL;
+        }
+        else
+            PyList_SET_ITEM (retval, c, r);
+    }
+
+    Py_XDECREF (outs);
+    Py_DECREF (names);
+
+    if (retval != NULL)
+    {
+        bool ok = runOpenWithoutGIL ((InputFileC*) self, [&] () {
+            file->setFrameBuffer (frameBuffer);
+            file->readPixels (miny, maxy);
+        });
+        if (!ok)
+        {
+            Py_DECREF (retval);
+            retval = NULL;
+        }
+    }
+
+    releaseviews (views);
+    return retval;
+}
 static PyObject*
 inclose (PyObject* self, PyObject* args)
 {
@@ -517,7 +1092,8 @@ inclose (PyObject* self, PyObject* args)
     {
         pc->is_opened   = 0;
         InputFile* file = &((InputFileC*) self)->i;
-        file->~InputFile ();
+        if (!runWithoutGIL (pc->lock, NULL, [&] () { file->~InputFile (); }))
+            return NULL;
     }
     Py_RETURN_NONE;
 }
@@ -784,6 +1360,8 @@ dict_from_header (Header h)
 static PyObject*
 inheader (PyObject* self, PyObject* args)
 {
+    if (!checkOpened (((InputFileC*) self)->is_opened)) return NULL;
+
     InputFile* file = &((InputFileC*) self)->i;
     return dict_from_header (file->header ());
 }
@@ -791,6 +1369,8 @@ inheader (PyObject* self, PyObject* args)
 static PyObject*
 isComplete (PyObject* self, PyObject* args)
 {
+    if (!checkOpened (((InputFileC*) self)->is_opened)) return NULL;
+
     InputFile* file = &((InputFileC*) self)->i;
     return PyBool_FromLong (file->isComplete ());
 }
@@ -800,6 +1380,12 @@ static PyMethodDef InputFile_methods[] = {
     {"header", inheader, METH_VARARGS},
     {"channel", (PyCFunction) channel, METH_VARARGS | METH_KEYWORDS},
     {"channels", (PyCFunction) channels, METH_VARARGS | METH_KEYWORDS},
+    {"channelArray",
+     (PyCFunction) channelArray,
+     METH_VARARGS | METH_KEYWORDS},
+    {"channelArrays",
+     (PyCFunction) channelArrays,
+     METH_VARARGS | METH_KEYWORDS},
     {"close", inclose, METH_VARARGS},
     {"isComplete", isComplete, METH_VARARGS},
     {NULL, NULL},
@@ -810,7 +1396,11 @@ InputFile_dealloc (PyObject* self)
 {
     InputFileC* object = ((InputFileC*) self);
     if (object->fo) Py_DECREF (object->fo);
-    Py_DECREF (inclose (self, NULL));
+    if (object->lock)
+    {
+        Py_XDECREF (inclose (self, NULL));
+        PyThread_free_lock (object->lock);
+    }
     PyObject_Del (self);
 }
 
@@ -869,6 +1459,13 @@ makeInputFile (PyObject* self, PyObject* args, PyObject* kwds)
     PyObject*   fo;
     char*       filename = NULL;
 
+    if (object->lock == NULL) object->lock = PyThread_allocate_lock ();
+    if (object->lock == NULL)
+    {
+        PyErr_NoMemory ();
+        return -1;
+    }
+
     if (PyArg_ParseTuple (args, "O:InputFile", &fo))
     {
         if (PyString_Check (fo))
@@ -920,18 +1517,14 @@ typedef struct
     C_OStream*               ostream;
     PyObject*                fo;
     int                      is_opened;
+    PyThread_type_lock       lock;
 } OutputFileC;
 
-static void
-releaseviews (std::vector<Py_buffer>& views)
-{
-    for (size_t i = 0; i < views.size (); i++)
-        PyBuffer_Release (&views[i]);
-}
-
 static PyObject*
 outwrite (PyObject* self, PyObject* args)
 {
+    if (!checkOpened (((OutputFileC*) self)->is_opened)) return NULL;
+
     OutputFile* file = &((OutputFileC*) self)->o;
 
     // long height = PyLong_AsLong(PyTuple_GetItem(args, 1));
@@ -1039,24 +1632,21 @@ outwrite (PyObject* self, PyObject* args)
         }
     }
 
-    try
-    {
+    bool ok = runOpenWithoutGIL ((OutputFileC*) self, [&] () {
         file->setFrameBuffer (frameBuffer);
         file->writePixels (height);
-    }
-    catch (const std::exception& e)
-    {
-        releaseviews (views);
-        PyErr_SetString (PyExc_IOError, e.what ());
-        return NULL;
-    }
+    });
+
     releaseviews (views);
+    if (!ok) return NULL;
     Py_RETURN_NONE;
 }
 
 static PyObject*
 outcurrentscanline (PyObject* self, PyObject* args)
 {
+    if (!checkOpened (((OutputFileC*) self)->is_opened)) return NULL;
+
     OutputFile* file = &((OutputFileC*) self)->o;
     return PyLong_FromLong (file->currentScanLine ());
 }
@@ -1069,7 +1659,8 @@ outclose (PyObject* self, PyObject* args)
     {
         oc->is_opened    = 0;
         OutputFile* file = &oc->o;
-        file->~OutputFile ();
+        if (!runWithoutGIL (oc->lock, NULL, [&] () { file->~OutputFile (); }))
+            return NULL;
     }
     Py_RETURN_NONE;
 }
@@ -1087,7 +1678,11 @@ OutputFile_dealloc (PyObject* self)
 {
     OutputFileC* object = ((OutputFileC*) self);
     if (object->fo) Py_DECREF (object->fo);
-    Py_DECREF (outclose (self, NULL));
+    if (object->lock)
+    {
+        Py_XDECREF (outclose (self, NULL));
+        PyThread_free_lock (object->lock);
+    }
     PyObject_Del (self);
 }
 
@@ -1149,6 +1744,13 @@ makeOutputFile (PyObject* self, PyObject* args, PyObject* kwds)
 
     OutputFileC* object = (OutputFileC*) self;
 
+    if (object->lock == NULL) object->lock = PyThread_allocate_lock ();
+    if (object->lock == NULL)
+    {
+        PyErr_NoMemory ();
+        return -1;
+    }
+
     if (PyArg_ParseTuple (
             args, "OO!:OutputFile", &fo, &PyDict_Type, &header_dict))
     {
@@ -1501,8 +2103,10 @@ MOD_INIT (OpenEXR)
     OutputFile_Type.tp_init = makeOutputFile;
     if (PyType_Ready (&InputFile_Type) != 0) return MOD_ERROR_VAL;
     if (PyType_Ready (&OutputFile_Type) != 0) return MOD_ERROR_VAL;
+    if (PyType_Ready (&PixelArray_Type) != 0) return MOD_ERROR_VAL;
     PyModule_AddObject (m, "InputFile", (PyObject*) &InputFile_Type);
     PyModule_AddObject (m, "OutputFile", (PyObject*) &OutputFile_Type);
+    PyModule_AddObject (m, "PixelArray", (PyObject*) &PixelArray_Type);
 
 #if PYTHON_API_VERSION >= 1007
     OpenEXR_error = PyErr_NewException ((char*) "OpenEXR.error", NULL, NULL);
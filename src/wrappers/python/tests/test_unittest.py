@@ -252,6 +252,153 @@ def test_write_chunk():
     
 testList.append(("test_write_chunk", test_write_chunk))
 
+#
+# Read into buffers, new or given, and check they match channel()
+#
+
+def test_channel_array():
+    w, h = 37, 11
+    hdr = OpenEXR.Header(w, h)
+    hdr['channels'] = {'R' : Imath.Channel(FLOAT),
+                       'G' : Imath.Channel(HALF),
+                       'L' : Imath.Channel(UINT)}
+    r = array('f', [random.random() for n in range(w * h)]).tobytes()
+    l = array('I', [n * 7 for n in range(w * h)]).tobytes()
+    x = OpenEXR.OutputFile("array.exr", hdr)
+    x.writePixels({'R': r, 'G': array('H', range(w * h)).tobytes(), 'L': l})
+    x.close()
+
+    i = OpenEXR.InputFile("array.exr")
+    for c, fmt in [('R', 'f'), ('G', 'e'), ('L', 'I')]:
+        m = memoryview(i.channelArray(c))
+        assert m.format == fmt and m.shape == (h, w) and not m.readonly
+        assert m.tobytes() == i.channel(c)
+
+    # a caller's 2D buffer
+    out = memoryview(bytearray(4 * w * h)).cast('f', (h, w))
+    assert i.channelArray('R', out = out) is out
+    assert out.tobytes() == r
+
+    # a strided one: every other float of a bigger buffer
+    big = memoryview(bytearray(8 * w * h)).cast('f')
+    i.channelArray('R', out = big[1::2])
+    assert big[1::2].tobytes() == r
+    assert big[0::2].tobytes() == bytes(4 * w * h)
+
+    # a few scan lines, as another type
+    m = memoryview(i.channelArray('R', HALF, scanLine1 = 3, scanLine2 = 5))
+    assert m.format == 'e' and m.shape == (3, w)
+    assert m.tobytes() == i.channel('R', HALF, 3, 5)
+
+    # several channels in one go
+    outs = [memoryview(bytearray(4 * w * h)).cast('f', (h, w)),
+            memoryview(bytearray(4 * w * h)).cast('I', (h, w))]
+    res = i.channelArrays(['R', 'L'], out = outs)
+    assert res[0] is outs[0] and res[1] is outs[1]
+    assert outs[0].tobytes() == r and outs[1].tobytes() == l
+    assert [memoryview(a).tobytes() for a in i.channelArrays(['G', 'R'])] == \
+        i.channels(['G', 'R'])
+
+    # buffers that do not fit are refused
+    for bad in [bytes(4 * w * h),
+                memoryview(bytearray(4 * w * h)).cast('I', (h, w)),
+                memoryview(bytearray(4 * w * (h + 1))).cast('f', (h + 1, w))]:
+        try:
+            i.channelArray('R', out = bad)
+        except TypeError:
+            pass
+        else:
+            assert 0
+
+    print("channel array ok")
+
+testList.append(("test_channel_array", test_channel_array))
+
+#
+# Read and write from several threads at once, both through file names
+# and python file objects
+#
+
+def test_threads():
+    import threading
+
+    w, h = 64, 64
+    data = array('f', [random.random() for n in range(w * h)]).tobytes()
+    hdr = OpenEXR.Header(w, h)
+    hdr['channels'] = {'R' : Imath.Channel(FLOAT)}
+    hdr['compression'] = Imath.Compression(Imath.Compression.ZIP_COMPRESSION)
+
+    errors = []
+    def work(n):
+        try:
+            name = "thread%d.exr" % n
+            x = OpenEXR.OutputFile(name, hdr)
+            x.writePixels({'R': data})
+            x.close()
+            for k in range(5):
+                if k % 2:
+                    with open(name, "rb") as f:
+                        i = OpenEXR.InputFile(f)
+                        assert i.channel('R') == data
+                        i.close()
+                else:
+                    i = OpenEXR.InputFile(name)
+                    assert memoryview(i.channelArray('R')).tobytes() == data
+        except Exception as e:
+            errors.append(e)
+
+    threads = [threading.Thread(target = work, args = (n,)) for n in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert not errors, errors
+
+    # many threads sharing one file
+    shared = OpenEXR.InputFile("thread0.exr")
+    def read_shared():
+        try:
+            for k in range(10):
+                assert shared.channel('R') == data
+        except Exception as e:
+            errors.append(e)
+
+    threads = [threading.Thread(target = read_shared) for n in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert not errors, errors
+
+    # closing a file that other threads are reading from
+    def read_until_closed():
+        try:
+            while True:
+                assert shared.channel('R') == data
+        except ValueError:
+            pass
+        except Exception as e:
+            errors.append(e)
+
+    threads = [threading.Thread(target = read_until_closed) for n in range(4)]
+    for t in threads:
+        t.start()
+    shared.close()
+    for t in threads:
+        t.join()
+    assert not errors, errors
+
+    try:
+        shared.channel('R')
+    except ValueError:
+        pass
+    else:
+        assert False, "reading a closed file should raise ValueError"
+
+    print("threads ok")
+
+testList.append(("test_threads", test_threads))
+
 for test in testList:
     funcName = test[0]
     print ("")